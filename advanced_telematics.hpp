@@ -0,0 +1,3788 @@
+#pragma once
+
+#define _USE_MATH_DEFINES
+#include <iostream>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <deque>
+#include <queue>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <random>
+#include <iomanip>
+#include <algorithm>
+#include <array>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <memory>
+#include <functional>
+#include <numeric>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <ctime>
+#include <future>
+#include <regex>
+#include <set>
+
+#if defined(_WIN32)
+#include <ctime>
+#endif
+
+#include "telematics/alert_dispatch.hpp"
+#include "telematics/alert_lifecycle.hpp"
+#include "telematics/allocators.hpp"
+#include "telematics/arrow_ipc.hpp"
+#include "telematics/clock.hpp"
+#include "telematics/compressed_history.hpp"
+#include "telematics/eco_score.hpp"
+#include "telematics/event_time.hpp"
+#include "telematics/fleet_query.hpp"
+#include "telematics/forecasting.hpp"
+#include "telematics/geo_distance.hpp"
+#include "telematics/journal.hpp"
+#include "telematics/live_feed.hpp"
+#include "telematics/metrics.hpp"
+#include "telematics/overload.hpp"
+#include "telematics/partitioning.hpp"
+#include "telematics/pattern_clusters.hpp"
+#include "telematics/report_writer.hpp"
+#include "telematics/csv_schema.hpp"
+#include "telematics/shared_state.hpp"
+#include "telematics/timer_wheel.hpp"
+#include "telematics/trip_engine.hpp"
+#include "telematics/vehicle_metrics.hpp"
+#include "telematics/window_operators.hpp"
+
+// ============================================================================
+// ENHANCED UTILITY FUNCTIONS
+// ============================================================================
+
+constexpr double deg2rad(double deg) { return deg * M_PI / 180.0; }
+
+double haversine(double lat1, double lon1, double lat2, double lon2);
+
+// Enhanced timestamp formatting with milliseconds
+std::string formatTimestamp(const std::chrono::system_clock::time_point& tp);
+
+// operator new calls since start, when built with TELEMATICS_COUNT_ALLOCATIONS
+// (heapAllocationCountAvailable() says which); aligned forms are not counted
+bool heapAllocationCountAvailable();
+uint64_t heapAllocationCount();          // whole process
+uint64_t threadHeapAllocationCount();    // calling thread only
+
+// ============================================================================
+// ENHANCED ENUMS AND DATA STRUCTURES
+// ============================================================================
+
+enum class AnomalyType {
+    SPEED_OUT_OF_RANGE,
+    RPM_OUT_OF_RANGE,
+    TEMP_OUT_OF_RANGE,
+    SUDDEN_SPEED_CHANGE,
+    SUDDEN_RPM_CHANGE,
+    SUDDEN_TEMP_CHANGE,
+    ENGINE_STALL,
+    OVERHEATING_PATTERN,
+    ERRATIC_BEHAVIOR,
+    SENSOR_FAILURE,
+    FUEL_LEAK,
+    MAINTENANCE_REQUIRED,
+    GEOFENCE_VIOLATION,
+    HARSH_ACCELERATION,
+    HARSH_BRAKING,
+    VEHICLE_OFFLINE
+};
+
+enum class VehicleState {
+    NORMAL,
+    WARNING,
+    CRITICAL,
+    OFFLINE,
+    MAINTENANCE
+};
+
+enum class AlertPriority {
+    LOW = 1,
+    MEDIUM = 2,
+    HIGH = 3,
+    CRITICAL = 4,
+    EMERGENCY = 5
+};
+
+// Enhanced sensor reading with additional fields
+struct SensorReading {
+    std::chrono::system_clock::time_point timestamp;   // device (event) time
+    std::chrono::system_clock::time_point received_at; // stamped on ingest
+    uint64_t sequence_number = 0;                      // per-vehicle, from 1; 0 = unsequenced, never deduplicated
+    int vehicle_id = 0;
+    double speed_kmph = 0.0;
+    double rpm = 0.0;
+    double engine_temp_celsius = 0.0;
+    double fuel_level_percent = 0.0;
+    double throttle_position_percent = 0.0;
+    bool engine_on = true;
+    double latitude = 0.0;
+    double longitude = 0.0;
+    
+    // Enhanced fields
+    double acceleration_ms2 = 0.0;
+    double brake_pressure_bar = 0.0;
+    double oil_pressure_bar = 0.0;
+    double battery_voltage = 12.0;
+    int odometer_km = 0;
+    bool abs_active = false;
+    bool traction_control_active = false;
+    
+    SensorReading() = default;
+    
+    SensorReading(int vid, double speed, double r, double temp, double fuel = 50.0,
+                  double throttle = 0.0, bool engine = true, double lat = 0.0, double lon = 0.0)
+        : SensorReading(std::chrono::system_clock::now(), vid, speed, r, temp, fuel,
+                        throttle, engine, lat, lon) {}
+    
+    // Device-supplied event time
+    SensorReading(std::chrono::system_clock::time_point device_time, int vid, double speed,
+                  double r, double temp, double fuel = 50.0, double throttle = 0.0,
+                  bool engine = true, double lat = 0.0, double lon = 0.0)
+        : timestamp(device_time),
+          vehicle_id(vid), speed_kmph(speed), rpm(r), engine_temp_celsius(temp),
+          fuel_level_percent(fuel), throttle_position_percent(throttle),
+          engine_on(engine), latitude(lat), longitude(lon) {}
+    
+    std::string getTimestampString() const {
+        return formatTimestamp(timestamp);
+    }
+    
+    // One enhanced_sensor_data.csv row, without the newline
+    std::string toCSV() const;
+};
+
+template <>
+struct CsvSchema<SensorReading> {
+    static constexpr auto columns = std::make_tuple(
+        csvColumn("Timestamp", &SensorReading::timestamp),
+        csvColumn("VehicleID", &SensorReading::vehicle_id),
+        csvColumn("Speed", &SensorReading::speed_kmph),
+        csvColumn("RPM", &SensorReading::rpm),
+        csvColumn("Temperature", &SensorReading::engine_temp_celsius),
+        csvColumn("FuelLevel", &SensorReading::fuel_level_percent),
+        csvColumn("Throttle", &SensorReading::throttle_position_percent),
+        csvColumn("EngineOn", &SensorReading::engine_on),
+        csvColumn("Latitude", &SensorReading::latitude),
+        csvColumn("Longitude", &SensorReading::longitude),
+        csvColumn("Acceleration", &SensorReading::acceleration_ms2),
+        csvColumn("BrakePressure", &SensorReading::brake_pressure_bar),
+        csvColumn("OilPressure", &SensorReading::oil_pressure_bar),
+        csvColumn("BatteryVoltage", &SensorReading::battery_voltage),
+        csvColumn("Odometer", &SensorReading::odometer_km),
+        csvColumn("ABSActive", &SensorReading::abs_active),
+        csvColumn("TractionControlActive", &SensorReading::traction_control_active));
+};
+
+inline std::string SensorReading::toCSV() const {
+    CsvRowWriter row(192);
+    row.append(*this);
+    return row.str().substr(0, row.size() - 1);
+}
+
+// Records are kept for the life of the process, so their texts live in one
+// process-wide pool instead of three heap strings per record
+inline TextPool& anomalyTextPool() {
+    static TextPool pool;
+    return pool;
+}
+
+// Enhanced anomaly record with additional metadata
+struct AnomalyRecord {
+    std::chrono::system_clock::time_point timestamp;
+    int vehicle_id;
+    std::string_view sensor_name;     // in anomalyTextPool()
+    double value;
+    AnomalyType type;
+    std::string_view description;     // in anomalyTextPool()
+    int severity;
+    AlertPriority priority;
+    bool acknowledged = false;
+    std::string_view location_info;   // in anomalyTextPool()
+    
+    AnomalyRecord(int vid, std::string_view sensor, double val, AnomalyType t,
+                  std::string_view desc, int sev = 3, std::string_view loc = {},
+                  std::chrono::system_clock::time_point at = std::chrono::system_clock::now())
+        : timestamp(at),
+          vehicle_id(vid), sensor_name(anomalyTextPool().intern(sensor)), value(val), type(t),
+          description(anomalyTextPool().intern(desc)), severity(sev),
+          location_info(anomalyTextPool().intern(loc)) {
+        priority = static_cast<AlertPriority>(std::min(5, std::max(1, sev)));
+    }
+    
+    std::string getTimestampString() const {
+        return formatTimestamp(timestamp);
+    }
+    
+    std::string getSeverityString() const {
+        switch(severity) {
+            case 1: return "LOW";
+            case 2: return "MINOR";
+            case 3: return "MODERATE";
+            case 4: return "HIGH";
+            case 5: return "CRITICAL";
+            default: return "UNKNOWN";
+        }
+    }
+    
+    std::string getTypeString() const { return typeCode(type); }
+    
+    // Short code used in the anomaly log
+    static const char* typeCode(AnomalyType type) {
+        switch(type) {
+            case AnomalyType::SPEED_OUT_OF_RANGE: return "SPEED_RANGE";
+            case AnomalyType::RPM_OUT_OF_RANGE: return "RPM_RANGE";
+            case AnomalyType::TEMP_OUT_OF_RANGE: return "TEMP_RANGE";
+            case AnomalyType::SUDDEN_SPEED_CHANGE: return "SPEED_SPIKE";
+            case AnomalyType::SUDDEN_RPM_CHANGE: return "RPM_SPIKE";
+            case AnomalyType::SUDDEN_TEMP_CHANGE: return "TEMP_SPIKE";
+            case AnomalyType::ENGINE_STALL: return "ENGINE_STALL";
+            case AnomalyType::OVERHEATING_PATTERN: return "OVERHEATING";
+            case AnomalyType::ERRATIC_BEHAVIOR: return "ERRATIC";
+            case AnomalyType::SENSOR_FAILURE: return "SENSOR_FAIL";
+            case AnomalyType::FUEL_LEAK: return "FUEL_LEAK";
+            case AnomalyType::MAINTENANCE_REQUIRED: return "MAINTENANCE";
+            case AnomalyType::GEOFENCE_VIOLATION: return "GEOFENCE";
+            case AnomalyType::HARSH_ACCELERATION: return "HARSH_ACCEL";
+            case AnomalyType::HARSH_BRAKING: return "HARSH_BRAKE";
+            case AnomalyType::VEHICLE_OFFLINE: return "OFFLINE";
+            default: return "UNKNOWN";
+        }
+    }
+};
+
+// One line of enhanced_anomalies.csv; views into the caller's strings
+struct AnomalyLogRow {
+    std::chrono::system_clock::time_point timestamp;
+    int vehicle_id = 0;
+    std::string_view sensor;
+    double value = 0.0;
+    const char* type = "";
+    std::string_view description;
+    int severity = 0;
+    int priority = 0;
+    std::string_view location;
+    double ml_score = 0.0;
+    const char* event = "";
+};
+
+template <>
+struct CsvSchema<AnomalyLogRow> {
+    static constexpr auto columns = std::make_tuple(
+        csvColumn("Timestamp", &AnomalyLogRow::timestamp),
+        csvColumn("VehicleID", &AnomalyLogRow::vehicle_id),
+        csvColumn("Sensor", &AnomalyLogRow::sensor),
+        csvColumn("Value", &AnomalyLogRow::value),
+        csvColumn("Type", &AnomalyLogRow::type),
+        csvColumn("Description", &AnomalyLogRow::description),
+        csvColumn("Severity", &AnomalyLogRow::severity),
+        csvColumn("Priority", &AnomalyLogRow::priority),
+        csvColumn("Location", &AnomalyLogRow::location),
+        csvColumn("MLScore", &AnomalyLogRow::ml_score),
+        csvColumn("Event", &AnomalyLogRow::event));
+};
+
+// One line of system_performance.csv
+struct PerformanceLogRow {
+    std::chrono::system_clock::time_point timestamp;
+    int total_readings = 0;
+    int total_anomalies = 0;
+    double processing_ms = 0.0;
+    double memory_mb = 0.0;
+    const char* degraded_mode = "NORMAL";
+    uint64_t mode_transitions = 0;
+    uint64_t shed_ml = 0;
+    uint64_t shed_log_rows = 0;
+    uint64_t shed_analytics = 0;
+    uint64_t shed_duplicates = 0;
+};
+
+template <>
+struct CsvSchema<PerformanceLogRow> {
+    static constexpr auto columns = std::make_tuple(
+        csvColumn("Timestamp", &PerformanceLogRow::timestamp),
+        csvColumn("TotalReadings", &PerformanceLogRow::total_readings),
+        csvColumn("TotalAnomalies", &PerformanceLogRow::total_anomalies),
+        csvColumn("ProcessingTimeMs", &PerformanceLogRow::processing_ms, 3),
+        csvColumn("MemoryUsageMB", &PerformanceLogRow::memory_mb, 1),
+        csvColumn("DegradedMode", &PerformanceLogRow::degraded_mode),
+        csvColumn("ModeTransitions", &PerformanceLogRow::mode_transitions),
+        csvColumn("ShedMLScoring", &PerformanceLogRow::shed_ml),
+        csvColumn("ShedLogRows", &PerformanceLogRow::shed_log_rows),
+        csvColumn("ShedAnalytics", &PerformanceLogRow::shed_analytics),
+        csvColumn("ShedDuplicateReadings", &PerformanceLogRow::shed_duplicates));
+};
+
+// Wire form shared by the partition transport and the journal
+void encodeAnomaly(WireWriter& out, const AnomalyRecord& a);
+AnomalyRecord decodeAnomaly(WireReader& in);
+
+// What the alert lifecycle remembers about an open condition
+struct AlertPayload {
+    AnomalyType type;
+    std::string_view sensor;        // in anomalyTextPool()
+    std::string_view description;   // in anomalyTextPool()
+    std::string_view location;      // in anomalyTextPool()
+    int severity;
+};
+
+using VehicleAlertTracker = AlertTracker<AlertPayload>;
+
+// Identifies a condition per vehicle: the anomaly type plus the sensor and
+// location (e.g. geofence name) that distinguish conditions of the same type
+inline uint64_t alertKey(AnomalyType type, std::string_view sensor, std::string_view location) {
+    uint64_t hash = 14695981039346656037ULL; // FNV-1a
+    auto mix = [&hash](unsigned char byte) {
+        hash ^= byte;
+        hash *= 1099511628211ULL;
+    };
+    mix(static_cast<unsigned char>(type));
+    for (char ch : sensor) mix(static_cast<unsigned char>(ch));
+    mix(0);
+    for (char ch : location) mix(static_cast<unsigned char>(ch));
+    return hash;
+}
+
+// Per-vehicle accumulators updated on every reading
+enum class VehicleMetric {
+    SPEED_SUM,
+    SPEED_SAMPLES,
+    HARSH_ACCELERATIONS,
+    HARSH_BRAKES,
+    COUNT
+};
+
+template <>
+struct MetricKeyTraits<VehicleMetric> {
+    static constexpr std::array<const char*, 4> names = {
+        "total_speed_sum", "speed_count", "harsh_accelerations", "harsh_brakes"};
+};
+
+using VehicleMetrics = TypedMetrics<VehicleMetric>;
+
+// Enhanced vehicle profile with maintenance tracking
+struct VehicleProfile {
+    int vehicle_id;
+    std::string make_model;
+    std::string license_plate;
+    VehicleState current_state;
+    std::chrono::system_clock::time_point last_seen;
+    double total_distance_km;
+    int total_anomalies;
+    double avg_fuel_efficiency;   // km per litre over the vehicle's life, 0 until fuel is used
+    
+    // Last known position with cached latitude trig; the route itself lives
+    // in the trip tracker
+    bool has_position = false;
+    GeoPoint last_position;
+    
+    // Enhanced fields
+    std::chrono::system_clock::time_point last_maintenance;
+    int maintenance_interval_km = 10000;
+    double max_speed_recorded = 0.0;
+    double avg_speed = 0.0;
+    int harsh_events_count = 0;
+    VehicleMetrics performance_metrics;
+    int pattern_group = -1;   // PatternClusterDetector group, set on first reading
+    uint32_t heartbeat_timer = TimerWheel::NONE;   // re-armed on every reading
+    EcoAccumulator eco;   // fuel use and driving style per trip, day and lifetime
+    
+    VehicleProfile(int id = 0, const std::string& model = "Unknown Vehicle", 
+                   const std::string& plate = "",
+                   std::chrono::system_clock::time_point now = std::chrono::system_clock::now())
+        : vehicle_id(id), make_model(model), license_plate(plate),
+          current_state(VehicleState::NORMAL),
+          last_seen(now),
+          total_distance_km(0.0), total_anomalies(0), avg_fuel_efficiency(0.0),
+          last_maintenance(now - std::chrono::hours(24*30)) {}
+};
+
+// Geofence structure for location-based alerts
+struct Geofence {
+    std::string name;
+    double center_lat;
+    double center_lon;
+    double radius_km;
+    bool is_restricted; // true for restricted areas, false for allowed areas
+    
+    bool isInside(double lat, double lon) const {
+        return haversine(center_lat, center_lon, lat, lon) <= radius_km;
+    }
+};
+
+// Channels kept in the compressed long-horizon history
+enum HistoryChannel : size_t {
+    HIST_SPEED,
+    HIST_RPM,
+    HIST_TEMP,
+    HIST_FUEL,
+    HIST_THROTTLE,
+    HIST_ACCELERATION,
+    HIST_BRAKE_PRESSURE,
+    HIST_OIL_PRESSURE,
+    HIST_BATTERY,
+    HIST_LATITUDE,
+    HIST_LONGITUDE,
+    HIST_CHANNEL_COUNT
+};
+
+inline const char* historyChannelName(size_t channel) {
+    static const char* names[HIST_CHANNEL_COUNT] = {
+        "speed", "rpm", "temp", "fuel", "throttle", "acceleration", "brake_pressure",
+        "oil_pressure", "battery", "latitude", "longitude"
+    };
+    return channel < HIST_CHANNEL_COUNT ? names[channel] : "unknown";
+}
+
+using ChannelValues = std::array<double, HIST_CHANNEL_COUNT>;
+using VehicleHistory = CompressedSeries<HIST_CHANNEL_COUNT>;
+using VehicleHistoryColumns = HistoryColumns<HIST_CHANNEL_COUNT>;
+using VehicleWindowSet = WindowSet<HIST_CHANNEL_COUNT>;
+using VehicleForecastSet = ForecastSet<HIST_CHANNEL_COUNT, 16>;   // seasons of up to 16 readings
+
+inline ChannelValues channelValues(const SensorReading& reading) {
+    ChannelValues values;
+    values[HIST_SPEED] = reading.speed_kmph;
+    values[HIST_RPM] = reading.rpm;
+    values[HIST_TEMP] = reading.engine_temp_celsius;
+    values[HIST_FUEL] = reading.fuel_level_percent;
+    values[HIST_THROTTLE] = reading.throttle_position_percent;
+    values[HIST_ACCELERATION] = reading.acceleration_ms2;
+    values[HIST_BRAKE_PRESSURE] = reading.brake_pressure_bar;
+    values[HIST_OIL_PRESSURE] = reading.oil_pressure_bar;
+    values[HIST_BATTERY] = reading.battery_voltage;
+    values[HIST_LATITUDE] = reading.latitude;
+    values[HIST_LONGITUDE] = reading.longitude;
+    return values;
+}
+
+inline int64_t toEpochMillis(const std::chrono::system_clock::time_point& tp) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(tp.time_since_epoch()).count();
+}
+
+inline VehicleHistory::Config makeVehicleHistoryConfig() {
+    VehicleHistory::Config config;
+    // Quantise to the precision the sensors actually deliver
+    config.resolution[HIST_SPEED] = 0.01;
+    config.resolution[HIST_RPM] = 1.0;
+    config.resolution[HIST_TEMP] = 0.01;
+    config.resolution[HIST_FUEL] = 0.01;
+    config.resolution[HIST_THROTTLE] = 0.1;
+    config.resolution[HIST_ACCELERATION] = 0.01;
+    config.resolution[HIST_BRAKE_PRESSURE] = 0.01;
+    config.resolution[HIST_OIL_PRESSURE] = 0.01;
+    config.resolution[HIST_BATTERY] = 0.01;
+    config.resolution[HIST_LATITUDE] = 1e-6;  // ~0.1 m
+    config.resolution[HIST_LONGITUDE] = 1e-6;
+    return config;
+}
+
+// ============================================================================
+// MACHINE LEARNING ANOMALY DETECTOR
+// ============================================================================
+
+class MLAnomalyDetector {
+private:
+    struct FeatureVector {
+        double speed;
+        double rpm;
+        double temperature;
+        double acceleration;
+        double fuel_consumption_rate;
+        double time_of_day; // 0-24 hours
+        double day_of_week; // 0-6
+    };
+    static constexpr size_t FEATURES = 7;
+    
+    struct FeatureModel {
+        std::array<double, FEATURES> means{};
+        std::array<double, FEATURES> stds{};
+    };
+    
+    //USED MAP FOR OPTIMIZATION
+    std::map<int, FeatureModel> models;
+    
+    // Training features only live for one trainModel() call
+    MonotonicArena scratch{64 * 1024};
+    
+public:
+    void trainModel(int vehicle_id, const RingDeque<SensorReading>& historical_data) {
+        if (historical_data.size() < 50) return; // Need sufficient data
+        
+        {
+            ArenaVector<FeatureVector> features{ArenaAllocator<FeatureVector>(scratch)};
+            features.reserve(historical_data.size());
+            for (size_t i = 1; i < historical_data.size(); ++i) {
+                const auto& current = historical_data[i];
+                const auto& previous = historical_data[i-1];
+                
+                FeatureVector fv;
+                fv.speed = current.speed_kmph;
+                fv.rpm = current.rpm;
+                fv.temperature = current.engine_temp_celsius;
+                fv.acceleration = current.acceleration_ms2;
+                fv.fuel_consumption_rate = 0.0;
+                
+                // Calculate fuel consumption rate
+                auto time_diff = std::chrono::duration_cast<std::chrono::seconds>(
+                    current.timestamp - previous.timestamp).count();
+                if (time_diff > 0) {
+                    fv.fuel_consumption_rate = (previous.fuel_level_percent - current.fuel_level_percent) / time_diff;
+                }
+                
+                // Time features
+                auto time_t = std::chrono::system_clock::to_time_t(current.timestamp);
+                struct tm* tm_info = std::localtime(&time_t);
+                fv.time_of_day = tm_info->tm_hour + tm_info->tm_min / 60.0;
+                fv.day_of_week = tm_info->tm_wday;
+                
+                features.push_back(fv);
+            }
+            
+            calculateStatistics(features, models[vehicle_id]);
+        }
+        scratch.reset();
+    }
+    
+    double calculateAnomalyScore(int vehicle_id, const SensorReading& reading) {
+        auto model = models.find(vehicle_id);
+        if (model == models.end()) {
+            return 0.00; // No training data available
+        }
+        
+        FeatureVector fv;
+        fv.speed = reading.speed_kmph;
+        fv.rpm = reading.rpm;
+        fv.temperature = reading.engine_temp_celsius;
+        fv.acceleration = reading.acceleration_ms2;
+        fv.fuel_consumption_rate = 0.0;
+        
+        auto time_t = std::chrono::system_clock::to_time_t(reading.timestamp);
+        struct tm* tm_info = std::localtime(&time_t);
+        fv.time_of_day = tm_info->tm_hour + tm_info->tm_min / 60.0;
+        fv.day_of_week = tm_info->tm_wday;
+        
+        return calculateMahalanobisDistance(model->second, fv);
+    }
+    
+    // Bytes held for training scratch, for the status report
+    size_t scratchCapacity() const { return scratch.capacity(); }
+    
+private:
+    static std::array<double, FEATURES> asArray(const FeatureVector& fv) {
+        return {fv.speed, fv.rpm, fv.temperature, fv.acceleration,
+                fv.fuel_consumption_rate, fv.time_of_day, fv.day_of_week};
+    }
+    
+    static void calculateStatistics(const ArenaVector<FeatureVector>& data, FeatureModel& model) {
+        if (data.empty()) return;
+        
+        // Calculate means
+        std::array<double, FEATURES> means{};
+        for (const auto& fv : data) {
+            const auto values = asArray(fv);
+            for (size_t f = 0; f < FEATURES; ++f) means[f] += values[f];
+        }
+        
+        for (auto& mean : means) {
+            mean /= data.size();
+        }
+        
+        // Calculate standard deviations
+        std::array<double, FEATURES> stds{};
+        for (const auto& fv : data) {
+            const auto values = asArray(fv);
+            for (size_t f = 0; f < FEATURES; ++f) stds[f] += (values[f] - means[f]) * (values[f] - means[f]);
+        }
+        
+        for (auto& std : stds) {
+            std = std::sqrt(std / data.size());
+        }
+        
+        model.means = means;
+        model.stds = stds;
+    }
+    
+    static double calculateMahalanobisDistance(const FeatureModel& model, const FeatureVector& fv) {
+        const auto values = asArray(fv);
+        double distance = 0.0;
+        for (size_t f = 0; f < FEATURES; ++f) {
+            double normalized = (values[f] - model.means[f]) / (model.stds[f] + 1e-6);
+            distance += normalized * normalized;
+        }
+        
+        return std::sqrt(distance);
+    }
+};
+
+// ============================================================================
+// ENHANCED ANALYTICS ENGINE
+// ============================================================================
+
+class AdvancedAnalytics {
+private:
+    std::map<int, std::vector<double>> speed_trends;
+    std::map<int, std::vector<double>> rpm_trends;
+    std::map<int, std::vector<double>> temp_trends;
+    std::map<int, std::vector<double>> fuel_trends;
+    std::map<int, std::vector<double>> acceleration_trends;
+    
+public:
+    struct Statistics {
+        double mean = 0.0;
+        double median = 0.0;
+        double std_deviation = 0.0;
+        double min_val = 0.0;
+        double max_val = 0.0;
+        double percentile_95 = 0.0;
+        double trend_slope = 0.0;
+        double coefficient_of_variation = 0.0;
+        int outlier_count = 0;
+    };
+    
+    static Statistics calculateStatistics(const std::vector<double>& data) {
+        Statistics stats = {};
+        if (data.empty()) return stats;
+        
+        // Order statistics by selection rather than a full sort: the report
+        // computes these for every channel of every vehicle
+        std::vector<double> ordered = data;
+        size_t n = ordered.size();
+        auto extremes = std::minmax_element(ordered.begin(), ordered.end());
+        stats.min_val = *extremes.first;
+        stats.max_val = *extremes.second;
+        stats.mean = std::accumulate(data.begin(), data.end(), 0.0) / n;
+        
+        size_t p95_idx = static_cast<size_t>(0.95 * (n - 1));
+        std::nth_element(ordered.begin(), ordered.begin() + p95_idx, ordered.end());
+        stats.percentile_95 = ordered[p95_idx];
+        
+        // Everything left of the p95 element is no greater, so the median is
+        // selected from that prefix
+        auto upper_median = ordered.begin() + n / 2;
+        std::nth_element(ordered.begin(), upper_median, ordered.begin() + p95_idx + 1);
+        stats.median = *upper_median;
+        if (n % 2 == 0) stats.median = (*std::max_element(ordered.begin(), upper_median) + *upper_median) / 2.0;
+        
+        double variance = 0.0;
+        for (double val : data) variance += (val - stats.mean) * (val - stats.mean);
+        stats.std_deviation = std::sqrt(variance / n);
+        
+        stats.coefficient_of_variation = stats.mean != 0 ? 
+            stats.std_deviation / std::abs(stats.mean) : 0.0;
+        
+        // Count outliers (values beyond 2 standard deviations)
+        double lower_bound = stats.mean - 2 * stats.std_deviation;
+        double upper_bound = stats.mean + 2 * stats.std_deviation;
+        stats.outlier_count = std::count_if(data.begin(), data.end(),
+            [lower_bound, upper_bound](double val) {
+                return val < lower_bound || val > upper_bound;
+            });
+        
+        // Calculate trend slope
+        if (n >= 2) {
+            double sum_x = 0, sum_y = 0, sum_xy = 0, sum_x2 = 0;
+            for (size_t i = 0; i < n; ++i) {
+                sum_x += i;
+                sum_y += data[i];
+                sum_xy += i * data[i];
+                sum_x2 += i * i;
+            }
+            double n_d = static_cast<double>(n);
+            double denom = (n_d * sum_x2 - sum_x * sum_x);
+            if (denom != 0.0)
+                stats.trend_slope = (n_d * sum_xy - sum_x * sum_y) / denom;
+        }
+        
+        return stats;
+    }
+    
+    void updateTrends(int vehicle_id, const SensorReading& reading) {
+        const size_t MAX_TREND_SIZE = 200; // Increased for better analysis
+        
+        auto updateTrend = [MAX_TREND_SIZE](std::vector<double>& trend, double value) {
+            trend.push_back(value);
+            if (trend.size() > MAX_TREND_SIZE) trend.erase(trend.begin());
+        };
+        
+        updateTrend(speed_trends[vehicle_id], reading.speed_kmph);
+        updateTrend(rpm_trends[vehicle_id], reading.rpm);
+        updateTrend(temp_trends[vehicle_id], reading.engine_temp_celsius);
+        updateTrend(fuel_trends[vehicle_id], reading.fuel_level_percent);
+        updateTrend(acceleration_trends[vehicle_id], reading.acceleration_ms2);
+    }
+    
+    // Channels in the order of the analytics command
+    enum TrendChannel { TREND_SPEED, TREND_RPM, TREND_TEMP, TREND_FUEL, TREND_ACCELERATION, TREND_COUNT };
+    using Trends = std::array<std::vector<double>, TREND_COUNT>;
+    
+    // Copies of a vehicle's trends, for computing statistics outside the
+    // caller's lock; empty for unknown vehicles
+    Trends copyTrends(int vehicle_id) const {
+        Trends trends;
+        const std::map<int, std::vector<double>>* sources[TREND_COUNT] = {
+            &speed_trends, &rpm_trends, &temp_trends, &fuel_trends, &acceleration_trends};
+        for (size_t c = 0; c < TREND_COUNT; ++c) {
+            auto it = sources[c]->find(vehicle_id);
+            if (it != sources[c]->end()) trends[c] = it->second;
+        }
+        return trends;
+    }
+    
+    Statistics getSpeedStats(int vehicle_id) { return calculateStatistics(speed_trends[vehicle_id]); }
+    Statistics getRPMStats(int vehicle_id) { return calculateStatistics(rpm_trends[vehicle_id]); }
+    Statistics getTempStats(int vehicle_id) { return calculateStatistics(temp_trends[vehicle_id]); }
+    Statistics getFuelStats(int vehicle_id) { return calculateStatistics(fuel_trends[vehicle_id]); }
+    Statistics getAccelerationStats(int vehicle_id) { return calculateStatistics(acceleration_trends[vehicle_id]); }
+    
+    // Predictive analytics
+    double predictNextValue(const std::vector<double>& trend) {
+        if (trend.size() < 3) return 0.0;
+        
+        // Simple linear extrapolation
+        double slope = (trend.back() - trend[trend.size()-2]);
+        return trend.back() + slope;
+    }
+    
+    // Seasonal pattern detection
+    std::vector<double> detectSeasonalPattern(const std::vector<double>& data, int period = 24) {
+        std::vector<double> seasonal_avg(period, 0.0);
+        std::vector<int> seasonal_count(period, 0);
+        
+        for (size_t i = 0; i < data.size(); ++i) {
+            int seasonal_index = i % period;
+            seasonal_avg[seasonal_index] += data[i];
+            seasonal_count[seasonal_index]++;
+        }
+        
+        for (int i = 0; i < period; ++i) {
+            if (seasonal_count[i] > 0) {
+                seasonal_avg[i] /= seasonal_count[i];
+            }
+        }
+        
+        return seasonal_avg;
+    }
+};
+
+// ============================================================================
+// ENHANCED DATA MANAGER CLASS
+// ============================================================================
+
+// Construction options; the defaults are what the interactive application uses
+struct DataManagerOptions {
+    uint32_t seed = 0;              // simulator RNG seed, 0 = std::random_device
+    size_t window_size = 200;       // per-vehicle raw readings kept for ML training
+    bool write_logs = true;         // enhanced_*.csv and system_performance.csv in the working directory
+    bool sample_fleet = true;       // the 20 demo vehicles and four demo geofences
+    const Clock* clock = nullptr;   // null = system_clock; must outlive the manager
+    OverloadConfig overload;        // degraded modes under load
+    int64_t offline_after_ms = 30 * 1000;   // silence before a registered vehicle is OFFLINE
+    int64_t heartbeat_tick_ms = 1000;       // resolution of the offline check
+    EcoConfig eco;                  // fuel-efficiency and eco-score thresholds and weights
+    VehicleHistory::Config history = makeVehicleHistoryConfig();   // block size, retention, resolution
+    size_t journal_snapshot_anomalies = 256;   // newest anomalies per vehicle a journal snapshot keeps
+};
+
+// Figures behind the `status` command. Counts merge across partitions by
+// addition; geofences and lateness are configuration echoes and take the max.
+struct FleetStatus {
+    uint64_t readings = 0;
+    uint64_t anomalies = 0;
+    uint64_t vehicles = 0;
+    uint64_t geofences = 0;
+    EventTimeCounters ingest;
+    uint64_t buffered = 0;
+    int64_t allowed_lateness_ms = 0;
+    uint64_t open_alerts = 0;
+    AlertCounters alerts;
+    uint64_t history_samples = 0;
+    uint64_t history_bytes = 0;
+    uint64_t trips = 0;
+    uint64_t trip_bytes = 0;
+    uint64_t trip_raw_bytes = 0;
+    uint64_t memory_bytes = 0;
+    uint64_t heap_allocations = 0;       // whole process; 0 when not counted
+    uint64_t pipeline_allocations = 0;   // made while processing readings
+    uint64_t scratch_bytes = 0;          // per-reading arena capacity
+    uint64_t degraded_mode = 0;          // DegradedMode; the most degraded partition
+    uint64_t mode_transitions = 0;
+    std::array<uint64_t, SHED_KINDS> shed{};   // by ShedWork
+    double ingest_latency_us = 0.0;      // smoothed; the slowest partition
+    uint64_t offline = 0;                // vehicles OFFLINE now
+    uint64_t offline_events = 0;         // times a vehicle went OFFLINE
+    
+    void merge(const FleetStatus& other) {
+        readings += other.readings;
+        anomalies += other.anomalies;
+        vehicles += other.vehicles;
+        geofences = std::max(geofences, other.geofences);
+        ingest.accepted += other.ingest.accepted;
+        ingest.reordered += other.ingest.reordered;
+        ingest.duplicates += other.ingest.duplicates;
+        ingest.late_dropped += other.ingest.late_dropped;
+        ingest.forced_releases += other.ingest.forced_releases;
+        buffered += other.buffered;
+        allowed_lateness_ms = std::max(allowed_lateness_ms, other.allowed_lateness_ms);
+        open_alerts += other.open_alerts;
+        alerts.opened += other.alerts.opened;
+        alerts.summaries += other.alerts.summaries;
+        alerts.cleared += other.alerts.cleared;
+        alerts.reopened += other.alerts.reopened;
+        alerts.deduplicated += other.alerts.deduplicated;
+        alerts.rate_limited += other.alerts.rate_limited;
+        history_samples += other.history_samples;
+        history_bytes += other.history_bytes;
+        trips += other.trips;
+        trip_bytes += other.trip_bytes;
+        trip_raw_bytes += other.trip_raw_bytes;
+        memory_bytes += other.memory_bytes;
+        heap_allocations += other.heap_allocations;
+        pipeline_allocations += other.pipeline_allocations;
+        scratch_bytes += other.scratch_bytes;
+        degraded_mode = std::max(degraded_mode, other.degraded_mode);
+        mode_transitions += other.mode_transitions;
+        for (size_t i = 0; i < SHED_KINDS; ++i) shed[i] += other.shed[i];
+        ingest_latency_us = std::max(ingest_latency_us, other.ingest_latency_us);
+        offline += other.offline;
+        offline_events += other.offline_events;
+    }
+};
+
+// One line of the system report's vehicle summary
+struct VehicleSummary {
+    int vehicle_id = 0;
+    std::string make_model;
+    std::string license_plate;
+    VehicleState state = VehicleState::NORMAL;
+    double total_distance_km = 0.0;
+    double avg_speed = 0.0;
+    double max_speed = 0.0;
+    int total_anomalies = 0;
+    int harsh_events_count = 0;
+    double l_per_100km = std::numeric_limits<double>::quiet_NaN();   // NaN = too little distance
+    double eco_score = std::numeric_limits<double>::quiet_NaN();     // lifetime, 0-100
+    double eco_trip_score = std::numeric_limits<double>::quiet_NaN();
+    double eco_day_score = std::numeric_limits<double>::quiet_NaN();
+};
+
+enum class ReportFormat { TEXT, CSV, JSON };
+
+struct ReportOptions {
+    ReportFormat format = ReportFormat::TEXT;
+    bool include_analytics = false;   // per-channel trend statistics, as in the analytics command
+    size_t threads = 0;               // formatting threads, 0 = one per hardware thread
+    size_t chunk_vehicles = 512;      // vehicles per formatted chunk
+};
+
+// .csv and .json pick those formats; anything else is text
+inline ReportFormat reportFormatFor(const std::string& filename) {
+    auto endsWith = [&filename](const char* suffix) {
+        const size_t n = std::strlen(suffix);
+        return filename.size() >= n && filename.compare(filename.size() - n, n, suffix) == 0;
+    };
+    if (endsWith(".csv")) return ReportFormat::CSV;
+    if (endsWith(".json")) return ReportFormat::JSON;
+    return ReportFormat::TEXT;
+}
+
+// Trend statistics per vehicle, indexed by AdvancedAnalytics::TrendChannel
+using ReportAnalytics = std::array<AdvancedAnalytics::Statistics, AdvancedAnalytics::TREND_COUNT>;
+
+// Fills `out` with analytics for `count` vehicles starting at `vehicles`.
+// Called from the report's formatting threads.
+using ReportAnalyticsSource = std::function<void(const VehicleSummary* vehicles, size_t count,
+                                                 std::vector<ReportAnalytics>& out)>;
+
+class AdvancedDataManager {
+private:
+    // Benchmarks drive private pipeline stages directly
+    friend class TelematicsBenchmarkAccess;
+    
+    static const int MAX_VEHICLES = 50;
+    
+    const DataManagerOptions options;
+    
+    std::unordered_map<int, RingDeque<SensorReading>> vehicle_data_windows;
+    
+    // Event-time ingest: per-vehicle reorder buffer and duplicate filter
+    static const size_t REORDER_CAPACITY = 32;
+    struct VehicleIngestState {
+        ReorderBuffer<SensorReading, REORDER_CAPACITY> reorder;
+        SequenceWindow sequences;
+        uint64_t released = 0;   // readings handed to the pipeline; what overload sampling counts
+    };
+    std::unordered_map<int, VehicleIngestState> ingest_states;
+    EventTimeConfig event_time_config;
+    EventTimeCounters event_time_counters;
+    
+    // Device-side state of the simulator (last reading generated per vehicle)
+    std::unordered_map<int, SensorReading> last_generated_readings;
+    std::unordered_map<int, uint64_t> next_sequence_numbers;
+    std::unordered_map<int, std::vector<AnomalyRecord>> detected_anomalies;
+    std::unordered_map<int, VehicleProfile> vehicle_profiles;
+    std::unordered_map<int, VehicleHistory> vehicle_histories;
+    std::unordered_map<int, TripTracker> trip_trackers;
+    
+    // Incremental windows shared by the windowed detectors
+    WindowLayout window_layout;
+    std::unordered_map<int, VehicleWindowSet> vehicle_windows;
+    size_t fuel_rate_window = 0;
+    size_t speed_change_window = 0;
+    size_t rpm_change_window = 0;
+    size_t temp_rate_window = 0;
+    size_t temp_trend_window = 0;
+    
+    // One-step-ahead forecasting models, same layout for every vehicle
+    ForecastLayout forecast_layout;
+    std::unordered_map<int, VehicleForecastSet> vehicle_forecasts;
+    size_t temp_forecast = 0;
+    size_t fuel_forecast = 0;
+    size_t oil_forecast = 0;
+    size_t battery_forecast = 0;
+    std::vector<Geofence> geofences;
+    
+    // Structure-of-arrays view of the geofences for the batch distance kernel
+    std::vector<double> geofence_lats;
+    std::vector<double> geofence_lons;
+    std::vector<double> geofence_distances;
+    
+    // Tables exposed to the ad-hoc query command
+    enum VehicleQueryField : size_t {
+        VQ_VEHICLE_ID, VQ_MAKE_MODEL, VQ_PLATE, VQ_STATE,
+        VQ_SPEED, VQ_RPM, VQ_TEMP, VQ_FUEL, VQ_OIL_PRESSURE, VQ_BATTERY,
+        VQ_DISTANCE, VQ_AVG_SPEED, VQ_MAX_SPEED, VQ_ANOMALIES, VQ_HARSH_EVENTS,
+        VQ_L_PER_100KM, VQ_IDLE_PCT, VQ_OVERSPEED_PCT, VQ_ECO_SCORE, VQ_ECO_TRIP, VQ_ECO_DAY,
+        VQ_OPEN_ALERTS, VQ_SEEN_AGO
+    };
+    enum ReadingQueryField : size_t {
+        RQ_VEHICLE_ID, RQ_MAKE_MODEL, RQ_STATE, RQ_AGE,
+        RQ_CHANNEL_BASE  // followed by one field per HistoryChannel
+    };
+    enum AnomalyQueryField : size_t {
+        AQ_VEHICLE_ID, AQ_MAKE_MODEL, AQ_TYPE, AQ_SENSOR, AQ_VALUE,
+        AQ_SEVERITY, AQ_LOCATION, AQ_AGE
+    };
+    static const size_t QUERY_VEHICLES_PER_CHUNK = 1024;
+    std::map<std::string, QuerySchema> query_tables;
+    
+    VehicleAlertTracker alert_tracker;
+    AdvancedAnalytics analytics;
+    MLAnomalyDetector ml_detector;
+    PatternClusterDetector pattern_detector;
+    
+    // Operational metrics, scraped without data_mutex
+    MetricsRegistry metrics;
+    struct PipelineMetrics {
+        Counter readings;
+        Counter anomalies;
+        Counter ingest_accepted, ingest_reordered, ingest_duplicate, ingest_late, ingest_forced;
+        Counter alerts_opened, alerts_summary, alerts_cleared, alerts_reopened, alerts_suppressed;
+        Counter heap_allocations;
+        std::array<Gauge, 5> vehicles_by_state;   // indexed by VehicleState
+        Gauge reorder_buffered;
+        Histogram stage_total, stage_profile, stage_history, stage_windows, stage_forecast, stage_analytics,
+                  stage_detection, stage_geofence, stage_output;
+    } pipeline_metrics;
+    
+    // Delivers recorded anomalies to external sinks, highest priority first; stopped unless enabled
+    AlertDispatcher alert_dispatcher{metrics, options.clock};
+    
+    // Degraded modes under load; fed by every processSensorReading call
+    OverloadController overload{metrics, options.overload};
+    std::atomic<uint32_t> ingest_waiting{0};   // callers queued on data_mutex
+    
+    // Heartbeat deadline of every registered vehicle; expired by checkHeartbeats
+    TimerWheel heartbeat_wheel{options.heartbeat_tick_ms, toEpochMillis(clockNow(options.clock))};
+    uint64_t offline_events = 0;
+    std::thread heartbeat_thread;
+    
+    // Latest per-vehicle state for the dashboard stream; serialised off the hot path
+    FleetFeed live_feed;
+    
+    // Fleet state table for out-of-process readers; closed unless enabled
+    SharedFleetWriter shared_fleet;
+    
+    // Write-ahead journal of anomalies and profile counters; closed unless enabled
+    enum class JournalRecordType : uint8_t { PROFILE = 1, ANOMALY = 2 };
+    JournalWriter journal;
+    JournalConfig journal_settings;
+    std::string journal_record;   // encode buffer, reused
+    CsvRowWriter log_row;         // enhanced_*.csv rows, written through as formatted
+    ReportBuffer alert_text;      // descriptions composed by detectors
+    ReportBuffer event_text;      // summary and cleared descriptions
+    bool journal_warned = false;
+    
+    std::mutex data_mutex;
+    std::condition_variable data_condition;
+    std::atomic<bool> running{true};
+    std::atomic<bool> paused{false};
+    std::atomic<int> total_readings_processed{0};
+    std::atomic<int> total_anomalies_detected{0};
+    uint64_t pipeline_allocations = 0;   // heap allocations in processOrderedReading
+    
+    // Enhanced random distributions
+    std::random_device rd;
+    std::mt19937 gen;
+    std::uniform_real_distribution<> speed_dist;
+    std::uniform_real_distribution<> rpm_dist;
+    std::uniform_real_distribution<> temp_dist;
+    std::uniform_real_distribution<> fuel_dist;
+    std::uniform_real_distribution<> throttle_dist;
+    std::uniform_int_distribution<> vehicle_dist;
+    std::uniform_real_distribution<> anomaly_chance;
+    std::uniform_real_distribution<> location_dist;
+    std::normal_distribution<> acceleration_dist;
+    std::uniform_real_distribution<> brake_pressure_dist;
+    std::uniform_real_distribution<> oil_pressure_dist;
+    std::uniform_real_distribution<> battery_voltage_dist;
+    
+    std::ofstream data_log_file;
+    std::ofstream anomaly_log_file;
+    std::ofstream performance_log_file;
+    
+public:
+    explicit AdvancedDataManager(const DataManagerOptions& opts = DataManagerOptions())
+        : options(opts), gen(opts.seed ? opts.seed : rd()),
+        speed_dist(20.0, 120.0),
+        rpm_dist(800.0, 6000.0),
+        temp_dist(80.0, 95.0),
+        fuel_dist(5.0, 95.0),
+        throttle_dist(0.0, 100.0),
+        vehicle_dist(1, 20),
+        anomaly_chance(0.0, 1.0),
+        location_dist(-90.0, 90.0),
+        acceleration_dist(0.0, 2.0),
+        brake_pressure_dist(0.0, 10.0),
+        oil_pressure_dist(2.0, 6.0),
+        battery_voltage_dist(11.5, 14.5)
+    {
+        if (options.write_logs) initializeLogFiles();
+        if (options.sample_fleet) {
+            initializeVehicleProfiles();
+            initializeGeofences();
+        }
+        initializeWindowDetectors();
+        initializeForecasts();
+        initializeQueryTables();
+        initializeMetrics();
+        initializeLiveFeed();
+    }
+    
+    ~AdvancedDataManager() {
+        running = false;
+        data_condition.notify_all();
+        if (heartbeat_thread.joinable()) heartbeat_thread.join();
+        stopAlertDispatch();
+        closeJournal();
+        closeLogFiles();
+    }
+    
+private:
+    void initializeLogFiles() {
+        data_log_file.open("enhanced_sensor_data.csv");
+        anomaly_log_file.open("enhanced_anomalies.csv");
+        performance_log_file.open("system_performance.csv");
+        
+        if (data_log_file.is_open()) data_log_file << csvHeader<SensorReading>();
+        if (anomaly_log_file.is_open()) anomaly_log_file << csvHeader<AnomalyLogRow>();
+        if (performance_log_file.is_open()) performance_log_file << csvHeader<PerformanceLogRow>();
+    }
+    
+    void closeLogFiles() {
+        if (data_log_file.is_open()) data_log_file.close();
+        if (anomaly_log_file.is_open()) anomaly_log_file.close();
+        if (performance_log_file.is_open()) performance_log_file.close();
+    }
+    
+public:
+    // The demo fleet: make/model and plate for vehicles 1-20
+    static const std::vector<std::pair<std::string, std::string>>& sampleVehicles() {
+        static const std::vector<std::pair<std::string, std::string>> vehicles = {
+            {"Honda Civic", "ABC-123"}, {"Toyota Camry", "DEF-456"}, {"Ford F-150", "GHI-789"},
+            {"BMW X3", "JKL-012"}, {"Tesla Model 3", "MNO-345"}, {"Chevrolet Silverado", "PQR-678"},
+            {"Nissan Altima", "STU-901"}, {"Hyundai Elantra", "VWX-234"}, {"Mercedes C-Class", "YZA-567"},
+            {"Audi A4", "BCD-890"}, {"Volkswagen Jetta", "EFG-123"}, {"Subaru Outback", "HIJ-456"},
+            {"Mazda CX-5", "KLM-789"}, {"Jeep Wrangler", "NOP-012"}, {"Kia Sorento", "QRS-345"},
+            {"Volvo XC90", "TUV-678"}, {"Lexus RX", "WXY-901"}, {"Acura MDX", "ZAB-234"},
+            {"Infiniti Q50", "CDE-567"}, {"Cadillac Escalade", "FGH-890"}
+        };
+        return vehicles;
+    }
+    
+    static std::vector<Geofence> sampleGeofences() {
+        return {
+            {"Downtown Area", 40.7128, -74.0060, 5.0, false},
+            {"Industrial Zone", 40.6892, -74.0445, 3.0, true},
+            {"School Zone", 40.7589, -73.9851, 1.0, true},
+            {"Highway Rest Area", 40.7505, -73.9934, 2.0, false}
+        };
+    }
+    
+private:
+    void initializeVehicleProfiles() {
+        const auto& vehicles = sampleVehicles();
+        for (int i = 1; i <= 20; ++i) {
+            vehicle_profiles[i] = VehicleProfile(i, vehicles[i-1].first, vehicles[i-1].second, now());
+            armHeartbeat(vehicle_profiles[i], toEpochMillis(now()));
+        }
+    }
+    
+    void initializeGeofences() {
+        geofences = sampleGeofences();
+        rebuildGeofenceIndex();
+    }
+    
+    void initializeWindowDetectors() {
+        fuel_rate_window = window_layout.subscribe(HIST_FUEL, 60 * 1000, WINDOW_RATE);
+        speed_change_window = window_layout.subscribe(HIST_SPEED, 3 * 1000, WINDOW_MIN | WINDOW_MAX);
+        rpm_change_window = window_layout.subscribe(HIST_RPM, 3 * 1000, WINDOW_MIN | WINDOW_MAX);
+        temp_rate_window = window_layout.subscribe(HIST_TEMP, 30 * 1000, WINDOW_RATE);
+        temp_trend_window = window_layout.subscribe(HIST_TEMP, 2 * 60 * 1000, WINDOW_EWMA | WINDOW_SUM);
+    }
+    
+    // Simulated channels have no periodic component, so these are plain Holt
+    // models; set season_length to switch a channel to Holt-Winters
+    void initializeForecasts() {
+        ForecastConfig drift;
+        drift.alpha = 0.3;
+        drift.beta = 0.05;
+        temp_forecast = forecast_layout.subscribe(HIST_TEMP, drift);
+        oil_forecast = forecast_layout.subscribe(HIST_OIL_PRESSURE, drift);
+        battery_forecast = forecast_layout.subscribe(HIST_BATTERY, drift);
+        
+        // Fuel moves slowly; smooth harder so the trend is the consumption rate
+        ForecastConfig slow;
+        slow.alpha = 0.1;
+        slow.beta = 0.01;
+        fuel_forecast = forecast_layout.subscribe(HIST_FUEL, slow);
+    }
+    
+    void initializeMetrics() {
+        auto& m = pipeline_metrics;
+        m.readings = Counter(metrics, "telematics_readings_processed_total", "Readings processed in event-time order");
+        m.anomalies = Counter(metrics, "telematics_anomalies_detected_total", "Anomaly records emitted (opened and ongoing)");
+        
+        const char* ingest_help = "Readings by event-time ingest outcome";
+        m.ingest_accepted = Counter(metrics, "telematics_ingest_readings_total", ingest_help, "result=\"accepted\"");
+        m.ingest_reordered = Counter(metrics, "telematics_ingest_readings_total", ingest_help, "result=\"reordered\"");
+        m.ingest_duplicate = Counter(metrics, "telematics_ingest_readings_total", ingest_help, "result=\"duplicate\"");
+        m.ingest_late = Counter(metrics, "telematics_ingest_readings_total", ingest_help, "result=\"late\"");
+        m.ingest_forced = Counter(metrics, "telematics_ingest_readings_total", ingest_help, "result=\"forced\"");
+        
+        const char* alert_help = "Alert lifecycle events";
+        m.alerts_opened = Counter(metrics, "telematics_alert_events_total", alert_help, "event=\"opened\"");
+        m.alerts_summary = Counter(metrics, "telematics_alert_events_total", alert_help, "event=\"summary\"");
+        m.alerts_cleared = Counter(metrics, "telematics_alert_events_total", alert_help, "event=\"cleared\"");
+        m.alerts_reopened = Counter(metrics, "telematics_alert_events_total", alert_help, "event=\"reopened\"");
+        m.alerts_suppressed = Counter(metrics, "telematics_alert_events_total", alert_help, "event=\"suppressed\"");
+        m.heap_allocations = Counter(metrics, "telematics_pipeline_heap_allocations_total",
+                                     "Heap allocations made while processing readings");
+        
+        const VehicleState states[] = {VehicleState::NORMAL, VehicleState::WARNING, VehicleState::CRITICAL,
+                                       VehicleState::OFFLINE, VehicleState::MAINTENANCE};
+        for (VehicleState state : states) {
+            m.vehicles_by_state[static_cast<size_t>(state)] = Gauge(metrics, "telematics_vehicles",
+                "Vehicles by current state", "state=\"" + getStateString(state) + "\"");
+        }
+        for (const auto& pair : vehicle_profiles) {
+            m.vehicles_by_state[static_cast<size_t>(pair.second.current_state)].add(1);
+        }
+        m.reorder_buffered = Gauge(metrics, "telematics_reorder_buffered_readings", "Readings waiting in reorder buffers");
+        
+        const char* stage_name = "telematics_stage_duration_seconds";
+        const char* stage_help = "Per-reading processing time by pipeline stage";
+        const auto buckets = Histogram::latencyBuckets();
+        m.stage_total = Histogram(metrics, stage_name, stage_help, "stage=\"total\"", buckets);
+        m.stage_profile = Histogram(metrics, stage_name, stage_help, "stage=\"profile\"", buckets);
+        m.stage_history = Histogram(metrics, stage_name, stage_help, "stage=\"history\"", buckets);
+        m.stage_windows = Histogram(metrics, stage_name, stage_help, "stage=\"windows\"", buckets);
+        m.stage_forecast = Histogram(metrics, stage_name, stage_help, "stage=\"forecast\"", buckets);
+        m.stage_analytics = Histogram(metrics, stage_name, stage_help, "stage=\"analytics\"", buckets);
+        m.stage_detection = Histogram(metrics, stage_name, stage_help, "stage=\"detection\"", buckets);
+        m.stage_geofence = Histogram(metrics, stage_name, stage_help, "stage=\"geofence\"", buckets);
+        m.stage_output = Histogram(metrics, stage_name, stage_help, "stage=\"output\"", buckets);
+    }
+    
+    void initializeLiveFeed() {
+        for (const auto& pair : vehicle_profiles) {
+            const VehicleProfile& profile = pair.second;
+            live_feed.registerVehicle(profile.vehicle_id, profile.make_model, profile.license_plate);
+            FeedVehicle vehicle;
+            vehicle.id = profile.vehicle_id;
+            vehicle.state = stateName(profile.current_state);
+            vehicle.last_seen_ms = toEpochMillis(profile.last_seen);
+            live_feed.publishVehicle(vehicle);
+        }
+    }
+    
+    void initializeQueryTables() {
+        const auto NUMBER = QueryFieldKind::NUMBER;
+        const auto TEXT = QueryFieldKind::TEXT;
+        
+        // Field order must match the *QueryField enums
+        QuerySchema vehicles("vehicles", false);
+        vehicles.add("vehicle_id", NUMBER);
+        vehicles.add("make_model", TEXT);
+        vehicles.add("plate", TEXT);
+        vehicles.add("state", TEXT);
+        vehicles.add("speed", NUMBER);
+        vehicles.add("rpm", NUMBER);
+        vehicles.add("temp", NUMBER);
+        vehicles.add("fuel", NUMBER);
+        vehicles.add("oil_pressure", NUMBER);
+        vehicles.add("battery", NUMBER);
+        vehicles.add("distance_km", NUMBER);
+        vehicles.add("avg_speed", NUMBER);
+        vehicles.add("max_speed", NUMBER);
+        vehicles.add("anomalies", NUMBER);
+        vehicles.add("harsh_events", NUMBER);
+        vehicles.add("l_per_100km", NUMBER);
+        vehicles.add("idle_pct", NUMBER);
+        vehicles.add("overspeed_pct", NUMBER);
+        vehicles.add("eco_score", NUMBER);
+        vehicles.add("eco_trip", NUMBER);
+        vehicles.add("eco_day", NUMBER);
+        vehicles.add("open_alerts", NUMBER);
+        vehicles.add("seen_ago_s", NUMBER);
+        
+        QuerySchema readings("readings", true);
+        readings.add("vehicle_id", NUMBER);
+        readings.add("make_model", TEXT);
+        readings.add("state", TEXT);
+        readings.add("age_s", NUMBER);
+        for (size_t c = 0; c < HIST_CHANNEL_COUNT; ++c) readings.add(historyChannelName(c), NUMBER);
+        
+        QuerySchema anomalies("anomalies", true);
+        anomalies.add("vehicle_id", NUMBER);
+        anomalies.add("make_model", TEXT);
+        anomalies.add("type", TEXT);
+        anomalies.add("sensor", TEXT);
+        anomalies.add("value", NUMBER);
+        anomalies.add("severity", NUMBER);
+        anomalies.add("location", TEXT);
+        anomalies.add("age_s", NUMBER);
+        
+        query_tables["vehicles"] = vehicles;
+        query_tables["readings"] = readings;
+        query_tables["anomalies"] = anomalies;
+    }
+    
+    void rebuildGeofenceIndex() {
+        geofence_lats.clear();
+        geofence_lons.clear();
+        for (const auto& geofence : geofences) {
+            geofence_lats.push_back(geofence.center_lat);
+            geofence_lons.push_back(geofence.center_lon);
+        }
+        geofence_distances.assign(geofences.size(), 0.0);
+    }
+    
+public:
+    // Ingests a reading in arrival order. Readings are buffered per vehicle
+    // and processed in event-time order once the watermark passes them.
+    void processSensorReading(const SensorReading& incoming) {
+        const auto call_start = std::chrono::steady_clock::now();
+        const uint32_t waiting = ingest_waiting.fetch_add(1, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(data_mutex);
+        ingest_waiting.fetch_sub(1, std::memory_order_relaxed);
+        
+        ingestReading(incoming);
+        
+        const auto call_end = std::chrono::steady_clock::now();
+        const auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(call_end - call_start).count();
+        if (overload.observe(static_cast<uint64_t>(latency), waiting, call_end)) {
+            logPerformance(latency / 1e6);
+        }
+    }
+    
+    // Releases readings that have waited longer than max_hold_ms, for
+    // vehicles that have gone quiet
+    void flushReorderBuffers() {
+        std::lock_guard<std::mutex> lock(data_mutex);
+        const int64_t now_ms = toEpochMillis(now());
+        for (auto& pair : ingest_states) {
+            VehicleIngestState& state = pair.second;
+            size_t released = state.reorder.drain(event_time_config, now_ms,
+                [this, &state](const SensorReading& r) { processOrderedReading(r, ++state.released); });
+            pipeline_metrics.reorder_buffered.add(-static_cast<int64_t>(released));
+        }
+    }
+    
+    // Marks vehicles whose heartbeat deadline has passed OFFLINE; returns how
+    // many. Called by the heartbeat monitor, or by a driver of simulated time.
+    size_t checkHeartbeats() {
+        std::lock_guard<std::mutex> lock(data_mutex);
+        return expireHeartbeats();
+    }
+    
+    // Checks heartbeats every heartbeat_tick_ms until the manager stops running
+    void startHeartbeatMonitor() {
+        if (heartbeat_thread.joinable()) return;
+        heartbeat_thread = std::thread([this] {
+            const auto tick = std::chrono::milliseconds(options.heartbeat_tick_ms);
+            std::unique_lock<std::mutex> lock(data_mutex);
+            while (running) {
+                data_condition.wait_for(lock, tick, [this] { return !running; });
+                if (running) expireHeartbeats();
+            }
+        });
+    }
+    
+    void setEventTimeConfig(const EventTimeConfig& config) {
+        std::lock_guard<std::mutex> lock(data_mutex);
+        event_time_config = config;
+    }
+    
+private:
+    void ingestReading(const SensorReading& incoming) {
+        SensorReading reading = incoming;
+        reading.received_at = now();
+        const int64_t now_ms = toEpochMillis(reading.received_at);
+        auto& state = ingest_states[reading.vehicle_id];
+        
+        if (reading.sequence_number != 0 &&
+            state.sequences.checkAndMark(reading.sequence_number) != SequenceWindow::Result::NEW) {
+            event_time_counters.duplicates++;
+            pipeline_metrics.ingest_duplicate.inc();
+            return;
+        }
+        
+        auto process = [this, &state](const SensorReading& r) { processOrderedReading(r, ++state.released); };
+        auto forced = [this, &state](const SensorReading& r) {
+            event_time_counters.forced_releases++;
+            pipeline_metrics.ingest_forced.inc();
+            processOrderedReading(r, ++state.released);
+        };
+        
+        size_t buffered_before = state.reorder.size();
+        auto admit = state.reorder.insert(toEpochMillis(reading.timestamp), now_ms, reading, forced);
+        if (admit == decltype(state.reorder)::Admit::LATE) {
+            event_time_counters.late_dropped++;
+            pipeline_metrics.ingest_late.inc();
+            return;
+        }
+        event_time_counters.accepted++;
+        pipeline_metrics.ingest_accepted.inc();
+        if (admit == decltype(state.reorder)::Admit::REORDERED) {
+            event_time_counters.reordered++;
+            pipeline_metrics.ingest_reordered.inc();
+        }
+        
+        state.reorder.drain(event_time_config, now_ms, process);
+        pipeline_metrics.reorder_buffered.add(static_cast<int64_t>(state.reorder.size()) -
+                                              static_cast<int64_t>(buffered_before));
+    }
+    
+    // `nth` counts the vehicle's readings from 1 in pipeline order; the
+    // overload sampling uses it, since sequence numbers may be absent (0) or
+    // step by more than one
+    void processOrderedReading(const SensorReading& reading, uint64_t nth) {
+        auto start_time = std::chrono::high_resolution_clock::now();
+        const uint64_t allocations_before = threadHeapAllocationCount();
+        auto stage_start = std::chrono::steady_clock::now();
+        const auto pipeline_start = stage_start;
+        auto lap = [&stage_start](const Histogram& stage) {
+            auto now = std::chrono::steady_clock::now();
+            stage.observeNanos(std::chrono::duration_cast<std::chrono::nanoseconds>(now - stage_start).count());
+            stage_start = now;
+        };
+        
+        int vehicle_id = reading.vehicle_id;
+        total_readings_processed++;
+        pipeline_metrics.readings.inc();
+        
+        // Update vehicle profile
+        auto profile_it = vehicle_profiles.find(vehicle_id);
+        const int previous_state = profile_it != vehicle_profiles.end()
+            ? static_cast<int>(profile_it->second.current_state) : -1;
+        if (profile_it != vehicle_profiles.end()) {
+            updateVehicleProfile(vehicle_id, reading);
+            armHeartbeat(profile_it->second, toEpochMillis(now()));
+        }
+        
+        // Add to sliding window
+        auto& window = vehicle_data_windows.try_emplace(vehicle_id, options.window_size + 1).first->second;
+        
+        // Under the heaviest shedding a reading that only repeats the last
+        // one gets the safety rules and nothing else, unless it is the one
+        // bringing an OFFLINE vehicle back
+        if (overload.at(DegradedMode::SHED_DUPLICATES) && previous_state != static_cast<int>(VehicleState::OFFLINE) &&
+            !window.empty() && sameState(window.back(), reading)) {
+            detectSafetyCritical(reading, 0.0);
+            overload.shed(ShedWork::DUPLICATE_READINGS);
+            return;
+        }
+        window.push_back(reading);
+        if (window.size() > options.window_size) {
+            window.pop_front();
+        }
+        lap(pipeline_metrics.stage_profile);
+        
+        // Append to compressed long-horizon history and incremental windows
+        const int64_t ts_ms = toEpochMillis(reading.timestamp);
+        const ChannelValues values = channelValues(reading);
+        recordHistory(vehicle_id, ts_ms, values);
+        lap(pipeline_metrics.stage_history);
+        const VehicleWindowSet& windows = updateWindows(vehicle_id, ts_ms, values);
+        lap(pipeline_metrics.stage_windows);
+        // Coarse analytics: trends and forecasts follow every Nth reading
+        const bool coarse = overload.at(DegradedMode::COARSE_ANALYTICS) &&
+                            nth % overload.settings().analytics_every != 0;
+        if (coarse) overload.shed(ShedWork::ANALYTICS);
+        const VehicleForecastSet& forecasts = coarse ? forecastSet(vehicle_id) : updateForecasts(vehicle_id, values);
+        lap(pipeline_metrics.stage_forecast);
+        
+        // Update analytics
+        if (!coarse) analytics.updateTrends(vehicle_id, reading);
+        
+        // Train ML model periodically
+        const bool score_ml = !overload.at(DegradedMode::SKIP_ML);
+        if (!score_ml) overload.shed(ShedWork::ML_SCORING);
+        if (score_ml && window.size() >= 100 &&
+            total_readings_processed % 100 == 0) {
+            ml_detector.trainModel(vehicle_id, window);
+        }
+        
+        // Joint operating pattern against the vehicle's make/model group
+        const double pattern_score = score_ml && profile_it != vehicle_profiles.end()
+            ? observePattern(profile_it->second, reading, window) : 0.0;
+        lap(pipeline_metrics.stage_analytics);
+        
+        // Detect anomalies
+        detectEnhancedAnomalies(reading, windows, forecasts, pattern_score, score_ml);
+        lap(pipeline_metrics.stage_detection);
+        
+        // Check geofences
+        checkGeofenceViolations(reading);
+        lap(pipeline_metrics.stage_geofence);
+        
+        // Log data
+        if (data_log_file.is_open() && overload.at(DegradedMode::SAMPLE_LOGS) &&
+            nth % overload.settings().log_sample_every != 0) {
+            overload.shed(ShedWork::LOG_ROWS);
+        } else if (data_log_file.is_open()) {
+            log_row.append(reading);
+            log_row.writeTo(data_log_file);
+            data_log_file.flush();
+        }
+        
+        // Close conditions that were not reported for this reading
+        alert_tracker.sweep(vehicle_id, ts_ms, [this, vehicle_id](const VehicleAlertTracker::Condition& c) {
+            pipeline_metrics.alerts_cleared.inc();
+            announceAlertCleared(vehicle_id, c);
+        });
+        
+        updateVehicleState(vehicle_id);
+        if (profile_it != vehicle_profiles.end() &&
+            static_cast<int>(profile_it->second.current_state) != previous_state) {
+            pipeline_metrics.vehicles_by_state[previous_state].add(-1);
+            pipeline_metrics.vehicles_by_state[static_cast<size_t>(profile_it->second.current_state)].add(1);
+        }
+        if (profile_it != vehicle_profiles.end()) {
+            publishFeedVehicle(profile_it->second, reading);
+            if (shared_fleet.isOpen()) publishSharedVehicle(profile_it->second, &reading);
+            if (journal.isOpen()) journalProfile(profile_it->second);
+        }
+        live_feed.publishTotals(total_readings_processed.load(), total_anomalies_detected.load());
+        lap(pipeline_metrics.stage_output);
+        pipeline_metrics.stage_total.observeNanos(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            stage_start - pipeline_start).count());
+        
+        // Zero once every vehicle has been seen, except for alert and trip records
+        const uint64_t allocations = threadHeapAllocationCount() - allocations_before;
+        pipeline_allocations += allocations;
+        pipeline_metrics.heap_allocations.inc(allocations);
+        
+        // Log performance metrics
+        auto end_time = std::chrono::high_resolution_clock::now();
+        auto processing_time = std::chrono::duration_cast<std::chrono::microseconds>(
+            end_time - start_time).count() / 1000.0; // Convert to milliseconds
+        
+        if (total_readings_processed % 100 == 0) logPerformance(processing_time);
+    }
+    
+    // A performance log row; also written whenever the degraded mode changes
+    void logPerformance(double processing_ms) {
+        if (!performance_log_file.is_open()) return;
+        const OverloadStats load = overload.stats();
+        PerformanceLogRow row;
+        row.timestamp = now();
+        row.total_readings = total_readings_processed;
+        row.total_anomalies = total_anomalies_detected;
+        row.processing_ms = processing_ms;
+        row.memory_mb = 0.0;   // placeholder
+        row.degraded_mode = degradedModeName(load.mode);
+        row.mode_transitions = load.transitions;
+        row.shed_ml = load.shed[static_cast<size_t>(ShedWork::ML_SCORING)];
+        row.shed_log_rows = load.shed[static_cast<size_t>(ShedWork::LOG_ROWS)];
+        row.shed_analytics = load.shed[static_cast<size_t>(ShedWork::ANALYTICS)];
+        row.shed_duplicates = load.shed[static_cast<size_t>(ShedWork::DUPLICATE_READINGS)];
+        log_row.append(row);
+        log_row.writeTo(performance_log_file);
+        performance_log_file.flush();
+    }
+    
+    // Same operating state as the previous reading, within sensor noise
+    static bool sameState(const SensorReading& previous, const SensorReading& current) {
+        return previous.engine_on == current.engine_on &&
+               std::abs(previous.speed_kmph - current.speed_kmph) < 0.5 &&
+               std::abs(previous.rpm - current.rpm) < 50.0 &&
+               std::abs(previous.engine_temp_celsius - current.engine_temp_celsius) < 0.5 &&
+               std::abs(previous.fuel_level_percent - current.fuel_level_percent) < 0.1 &&
+               std::abs(previous.acceleration_ms2 - current.acceleration_ms2) < 0.2 &&
+               std::abs(previous.oil_pressure_bar - current.oil_pressure_bar) < 0.05 &&
+               std::abs(previous.battery_voltage - current.battery_voltage) < 0.05;
+    }
+    
+private:
+    void publishFeedVehicle(const VehicleProfile& profile, const SensorReading& reading) {
+        FeedVehicle vehicle;
+        vehicle.id = profile.vehicle_id;
+        vehicle.state = stateName(profile.current_state);
+        vehicle.last_seen_ms = toEpochMillis(profile.last_seen);
+        vehicle.total_distance = profile.total_distance_km;
+        vehicle.avg_speed = profile.avg_speed;
+        vehicle.max_speed = profile.max_speed_recorded;
+        vehicle.harsh_events = profile.harsh_events_count;
+        vehicle.total_anomalies = profile.total_anomalies;
+        
+        FeedReading& r = vehicle.reading;
+        r.speed = reading.speed_kmph;
+        r.rpm = reading.rpm;
+        r.temperature = reading.engine_temp_celsius;
+        r.fuel_level = reading.fuel_level_percent;
+        r.throttle_position = reading.throttle_position_percent;
+        r.engine_on = reading.engine_on;
+        r.latitude = reading.latitude;
+        r.longitude = reading.longitude;
+        r.acceleration = reading.acceleration_ms2;
+        r.brake_pressure = reading.brake_pressure_bar;
+        r.oil_pressure = reading.oil_pressure_bar;
+        r.battery_voltage = reading.battery_voltage;
+        r.odometer = reading.odometer_km;
+        r.abs_active = reading.abs_active;
+        r.traction_control_active = reading.traction_control_active;
+        live_feed.publishVehicle(vehicle);
+    }
+    
+    // A PROFILE record carries the engine's reading total and one vehicle's
+    // counters; replaying the newest one per vehicle restores them
+    static void encodeProfileCounters(WireWriter& out, const VehicleProfile& profile) {
+        out.put(profile.vehicle_id);
+        out.put(toEpochMillis(profile.last_seen));
+        out.put(profile.total_distance_km);
+        out.put(profile.total_anomalies);
+        out.put(profile.harsh_events_count);
+        out.put(profile.max_speed_recorded);
+        out.put(profile.avg_speed);
+        out.put(profile.avg_fuel_efficiency);
+        out.put(profile.performance_metrics);
+        out.put(profile.eco);
+    }
+    
+    void decodeProfileCounters(WireReader& in, VehicleProfile& profile) {
+        profile.last_seen = std::chrono::system_clock::time_point(std::chrono::milliseconds(in.get<int64_t>()));
+        profile.total_distance_km = in.get<double>();
+        profile.total_anomalies = in.get<int>();
+        profile.harsh_events_count = in.get<int>();
+        profile.max_speed_recorded = in.get<double>();
+        profile.avg_speed = in.get<double>();
+        profile.avg_fuel_efficiency = in.get<double>();
+        profile.performance_metrics = in.get<VehicleMetrics>();
+        profile.eco = in.get<EcoAccumulator>();
+    }
+    
+    void journalProfile(const VehicleProfile& profile) {
+        journal_record.clear();
+        WireWriter out(journal_record);
+        out.put(static_cast<uint64_t>(total_readings_processed.load()));
+        encodeProfileCounters(out, profile);
+        journal.append(static_cast<uint8_t>(JournalRecordType::PROFILE), journal_record);
+        
+        if (journal.checkpointDue()) journal.checkpoint(journalSnapshotBuilder());
+        if (!journal.healthy() && !journal_warned) {
+            journal_warned = true;
+            std::cerr << "Warning: journal stopped, state is no longer durable (" << journal.lastError() << ")\n";
+        }
+    }
+    
+    // Everything the journal protects: totals, profiles and the newest
+    // journal_snapshot_anomalies anomalies of each vehicle. Profiles are
+    // encoded here, under data_mutex; the anomaly tail is only copied (the
+    // records are plain values) and encoded by the journal's flusher.
+    JournalSnapshotBuilder journalSnapshotBuilder() {
+        const uint64_t readings = total_readings_processed.load();
+        const uint64_t anomalies = total_anomalies_detected.load();
+        const size_t frame_bytes = journal_settings.snapshot_frame_bytes;
+        
+        JournalSnapshot frames;
+        std::string body;
+        uint64_t count = 0;
+        for (const auto& pair : vehicle_profiles) {
+            WireWriter out(body);
+            out.putString(pair.second.make_model);
+            out.putString(pair.second.license_plate);
+            encodeProfileCounters(out, pair.second);
+            count++;
+            if (body.size() >= frame_bytes) sealSnapshotFrame(frames, readings, anomalies, false, count, body);
+        }
+        // The first frame carries the totals even for an empty fleet
+        if (count > 0 || frames.empty()) sealSnapshotFrame(frames, readings, anomalies, false, count, body);
+        
+        std::vector<AnomalyRecord> tail;
+        for (const auto& pair : detected_anomalies) {
+            const size_t keep = std::min(pair.second.size(), options.journal_snapshot_anomalies);
+            tail.insert(tail.end(), pair.second.end() - static_cast<std::ptrdiff_t>(keep), pair.second.end());
+        }
+        return [frames = std::move(frames), tail = std::move(tail), readings, anomalies, frame_bytes]() mutable {
+            std::string body;
+            uint64_t count = 0;
+            for (const AnomalyRecord& anomaly : tail) {
+                WireWriter out(body);
+                encodeAnomaly(out, anomaly);
+                count++;
+                if (body.size() >= frame_bytes) sealSnapshotFrame(frames, readings, anomalies, true, count, body);
+            }
+            if (count > 0) sealSnapshotFrame(frames, readings, anomalies, true, count, body);
+            return std::move(frames);
+        };
+    }
+    
+    // One snapshot frame as applyJournalSnapshot reads it: the totals, then
+    // the `count` profiles or anomalies encoded in `body`. Resets both.
+    static void sealSnapshotFrame(JournalSnapshot& frames, uint64_t readings, uint64_t anomalies,
+                                  bool anomaly_body, uint64_t& count, std::string& body) {
+        std::string& frame = frames.emplace_back();
+        WireWriter out(frame);
+        out.put(readings);
+        out.put(anomalies);
+        out.put(static_cast<uint32_t>(anomaly_body ? 0 : count));
+        if (!anomaly_body) frame.append(body);
+        out.put(static_cast<uint64_t>(anomaly_body ? count : 0));
+        if (anomaly_body) frame.append(body);
+        body.clear();
+        count = 0;
+    }
+    
+    // Profiles first seen in the journal are registered as unknown vehicles
+    VehicleProfile& recoveredProfile(int vehicle_id, const std::string& make_model = "Unknown Vehicle",
+                                     const std::string& license_plate = "") {
+        auto it = vehicle_profiles.find(vehicle_id);
+        if (it == vehicle_profiles.end()) {
+            it = vehicle_profiles.emplace(vehicle_id, VehicleProfile(vehicle_id, make_model, license_plate, now())).first;
+            armHeartbeat(it->second, toEpochMillis(now()));
+            pipeline_metrics.vehicles_by_state[static_cast<size_t>(VehicleState::NORMAL)].add(1);
+            live_feed.registerVehicle(vehicle_id, make_model, license_plate);
+        }
+        return it->second;
+    }
+    
+    // One snapshot frame; a snapshot splits its profiles and anomalies
+    // across frames that each repeat the totals
+    void applyJournalSnapshot(const char* data, size_t size) {
+        WireReader in(data, size);
+        total_readings_processed = static_cast<int>(in.get<uint64_t>());
+        total_anomalies_detected = static_cast<int>(in.get<uint64_t>());
+        uint32_t profiles = in.get<uint32_t>();
+        for (uint32_t i = 0; i < profiles && in.ok(); ++i) {
+            std::string make_model = in.getString();
+            std::string license_plate = in.getString();
+            int vehicle_id = in.get<int>();
+            decodeProfileCounters(in, recoveredProfile(vehicle_id, make_model, license_plate));
+        }
+        uint64_t anomalies = in.get<uint64_t>();
+        for (uint64_t i = 0; i < anomalies && in.ok(); ++i) {
+            AnomalyRecord anomaly = decodeAnomaly(in);
+            detected_anomalies[anomaly.vehicle_id].push_back(std::move(anomaly));
+        }
+    }
+    
+    void applyJournalRecord(uint8_t type, const char* data, size_t size) {
+        WireReader in(data, size);
+        switch (static_cast<JournalRecordType>(type)) {
+            case JournalRecordType::PROFILE: {
+                total_readings_processed = static_cast<int>(in.get<uint64_t>());
+                int vehicle_id = in.get<int>();
+                decodeProfileCounters(in, recoveredProfile(vehicle_id));
+                break;
+            }
+            case JournalRecordType::ANOMALY: {
+                AnomalyRecord anomaly = decodeAnomaly(in);
+                detected_anomalies[anomaly.vehicle_id].push_back(std::move(anomaly));
+                total_anomalies_detected++;
+                break;
+            }
+        }
+    }
+    
+    // `reading` is null for vehicles that have not reported yet
+    void publishSharedVehicle(const VehicleProfile& profile, const SensorReading* reading) {
+        SharedVehicleRow row;
+        row.vehicle_id = profile.vehicle_id;
+        row.state = static_cast<uint8_t>(profile.current_state);
+        row.last_seen_ms = toEpochMillis(profile.last_seen);
+        row.total_anomalies = profile.total_anomalies;
+        row.harsh_events = profile.harsh_events_count;
+        row.total_distance_km = profile.total_distance_km;
+        row.avg_speed = profile.avg_speed;
+        row.max_speed = profile.max_speed_recorded;
+        row.avg_fuel_efficiency = profile.avg_fuel_efficiency;
+        
+        if (reading) {
+            row.timestamp_ms = toEpochMillis(reading->timestamp);
+            row.sequence_number = reading->sequence_number;
+            row.flags = static_cast<uint8_t>((reading->engine_on ? SHARED_FLAG_ENGINE_ON : 0) |
+                                             (reading->abs_active ? SHARED_FLAG_ABS_ACTIVE : 0) |
+                                             (reading->traction_control_active ? SHARED_FLAG_TRACTION_CONTROL : 0));
+            row.odometer_km = reading->odometer_km;
+            row.speed = reading->speed_kmph;
+            row.rpm = reading->rpm;
+            row.temperature = reading->engine_temp_celsius;
+            row.fuel_level = reading->fuel_level_percent;
+            row.throttle_position = reading->throttle_position_percent;
+            row.latitude = reading->latitude;
+            row.longitude = reading->longitude;
+            row.acceleration = reading->acceleration_ms2;
+            row.brake_pressure = reading->brake_pressure_bar;
+            row.oil_pressure = reading->oil_pressure_bar;
+            row.battery_voltage = reading->battery_voltage;
+        } else if (profile.has_position) {
+            row.latitude = profile.last_position.latitude;
+            row.longitude = profile.last_position.longitude;
+        }
+        shared_fleet.publish(row);
+    }
+    
+    void recordHistory(int vehicle_id, int64_t ts_ms, const ChannelValues& values) {
+        auto it = vehicle_histories.find(vehicle_id);
+        if (it == vehicle_histories.end()) {
+            it = vehicle_histories.emplace(vehicle_id, VehicleHistory(options.history)).first;
+        }
+        it->second.append(ts_ms, values);
+    }
+    
+    VehicleWindowSet& updateWindows(int vehicle_id, int64_t ts_ms, const ChannelValues& values) {
+        auto it = vehicle_windows.find(vehicle_id);
+        if (it == vehicle_windows.end()) {
+            it = vehicle_windows.emplace(vehicle_id, VehicleWindowSet(window_layout)).first;
+        }
+        it->second.update(ts_ms, values);
+        return it->second;
+    }
+    
+    VehicleForecastSet& forecastSet(int vehicle_id) {
+        auto it = vehicle_forecasts.find(vehicle_id);
+        if (it == vehicle_forecasts.end()) {
+            it = vehicle_forecasts.emplace(vehicle_id, VehicleForecastSet(forecast_layout)).first;
+        }
+        return it->second;
+    }
+    
+    const VehicleForecastSet& updateForecasts(int vehicle_id, const ChannelValues& values) {
+        VehicleForecastSet& forecasts = forecastSet(vehicle_id);
+        forecasts.update(values);
+        return forecasts;
+    }
+    
+    void updateVehicleProfile(int vehicle_id, const SensorReading& reading) {
+        auto& profile = vehicle_profiles[vehicle_id];
+        profile.last_seen = reading.timestamp;
+        
+        // Update distance and route
+        double distance = 0.0;
+        if (profile.has_position) {
+            GeoPoint position = advanceGeoPoint(profile.last_position, reading.latitude, reading.longitude);
+            distance = fastDistanceKm(profile.last_position, position);
+            profile.total_distance_km += distance;
+            profile.last_position = position;
+        } else {
+            profile.last_position = makeGeoPoint(reading.latitude, reading.longitude);
+            profile.has_position = true;
+        }
+        
+        auto tracker = trip_trackers.find(vehicle_id);
+        if (tracker == trip_trackers.end()) {
+            tracker = trip_trackers.emplace(vehicle_id, TripTracker(vehicle_id, TripConfig{})).first;
+        }
+        TripSample sample;
+        sample.timestamp_ms = toEpochMillis(reading.timestamp);
+        sample.latitude = reading.latitude;
+        sample.longitude = reading.longitude;
+        sample.speed_kmph = reading.speed_kmph;
+        sample.acceleration_ms2 = reading.acceleration_ms2;
+        sample.step_distance_km = distance;
+        sample.engine_on = reading.engine_on;
+        tracker->second.addSample(sample);
+        
+        // Fuel use and driving style, per trip as the tracker splits them
+        EcoSample eco_sample;
+        eco_sample.timestamp_ms = sample.timestamp_ms;
+        eco_sample.step_distance_km = distance;
+        eco_sample.speed_kmph = reading.speed_kmph;
+        eco_sample.fuel_level_percent = reading.fuel_level_percent;
+        eco_sample.throttle_percent = reading.throttle_position_percent;
+        eco_sample.brake_pressure_bar = reading.brake_pressure_bar;
+        eco_sample.acceleration_ms2 = reading.acceleration_ms2;
+        eco_sample.odometer_km = reading.odometer_km;
+        eco_sample.engine_on = reading.engine_on;
+        eco_sample.trip_id = tracker->second.inTrip() ? tracker->second.currentTrip().trip_id : 0;
+        profile.eco.update(options.eco, eco_sample);
+        const double km_per_litre = profile.eco.totals(EcoWindow::LIFETIME).kmPerLitre();
+        if (std::isfinite(km_per_litre)) profile.avg_fuel_efficiency = km_per_litre;
+        
+        // Update performance metrics
+        profile.max_speed_recorded = std::max(profile.max_speed_recorded, reading.speed_kmph);
+        
+        // Update average speed (simple moving average)
+        auto& metrics = profile.performance_metrics;
+        metrics.add<VehicleMetric::SPEED_SUM>(reading.speed_kmph);
+        metrics.increment<VehicleMetric::SPEED_SAMPLES>();
+        profile.avg_speed = metrics.at<VehicleMetric::SPEED_SUM>() / metrics.at<VehicleMetric::SPEED_SAMPLES>();
+        
+        // Check for harsh events
+        if (std::abs(reading.acceleration_ms2) > 4.0) { // Harsh acceleration/braking
+            profile.harsh_events_count++;
+            if (reading.acceleration_ms2 > 0.0) metrics.increment<VehicleMetric::HARSH_ACCELERATIONS>();
+            else metrics.increment<VehicleMetric::HARSH_BRAKES>();
+        }
+    }
+    
+    void checkGeofenceViolations(const SensorReading& reading) {
+        if (geofences.empty()) return;
+        
+        // Reuse the cached trig from the profile update when it is this fix
+        GeoPoint position;
+        auto profile = vehicle_profiles.find(reading.vehicle_id);
+        if (profile != vehicle_profiles.end() && profile->second.has_position &&
+            profile->second.last_position.latitude == reading.latitude &&
+            profile->second.last_position.longitude == reading.longitude) {
+            position = profile->second.last_position;
+        } else {
+            position = makeGeoPoint(reading.latitude, reading.longitude);
+        }
+        haversineBatchKm(position, geofence_lats.data(), geofence_lons.data(),
+                         geofences.size(), geofence_distances.data());
+        
+        for (size_t i = 0; i < geofences.size(); ++i) {
+            const auto& geofence = geofences[i];
+            bool inside = geofence_distances[i] <= geofence.radius_km;
+            
+            if (geofence.is_restricted && inside) {
+                alert_text.clear();
+                alert_text.append("Vehicle entered restricted area: ").append(geofence.name);
+                addEnhancedAnomaly(reading.vehicle_id, "location", 0.0,
+                    AnomalyType::GEOFENCE_VIOLATION, alert_text.str(), 4, geofence.name);
+            }
+        }
+    }
+    
+    double observePattern(VehicleProfile& profile, const SensorReading& reading,
+                          const RingDeque<SensorReading>& window) {
+        if (profile.pattern_group < 0) {
+            profile.pattern_group = static_cast<int>(pattern_detector.groupFor(profile.make_model));
+        }
+        // Fuel use since the previous reading; refuelling counts as none
+        double fuel_rate = 0.0;
+        if (window.size() >= 2) {
+            const SensorReading& previous = window[window.size() - 2];
+            auto seconds = std::chrono::duration_cast<std::chrono::seconds>(
+                reading.timestamp - previous.timestamp).count();
+            if (seconds > 0) {
+                fuel_rate = std::max(0.0, (previous.fuel_level_percent - reading.fuel_level_percent) / seconds);
+            }
+        }
+        return pattern_detector.observe(static_cast<uint32_t>(profile.pattern_group),
+            {reading.speed_kmph, reading.rpm, reading.engine_temp_celsius, reading.acceleration_ms2, fuel_rate});
+    }
+    
+    bool detectEnhancedAnomalies(const SensorReading& current, 
+                                const VehicleWindowSet& windows,
+                                const VehicleForecastSet& forecasts,
+                                double pattern_score, bool score_ml) {
+        // Get ML anomaly score
+        double ml_score = score_ml ? ml_detector.calculateAnomalyScore(current.vehicle_id, current) : 0.0;
+        
+        bool anomaly_found = detectSafetyCritical(current, ml_score);
+        
+        // Enhanced range-based detection
+        if (current.speed_kmph > 200.0 || current.speed_kmph < -5.0) {
+            addEnhancedAnomaly(current.vehicle_id, "speed", current.speed_kmph,
+                AnomalyType::SPEED_OUT_OF_RANGE, "Speed outside safe range", 4, "", ml_score);
+            anomaly_found = true;
+        }
+        
+        if (current.rpm > 8000.0 || (current.rpm < 400.0 && current.engine_on && current.speed_kmph > 10.0)) {
+            addEnhancedAnomaly(current.vehicle_id, "rpm", current.rpm,
+                AnomalyType::RPM_OUT_OF_RANGE, "RPM outside normal range", 3, "", ml_score);
+            anomaly_found = true;
+        }
+        
+        // Battery voltage monitoring
+        bool battery_open = isAlertOpen(current.vehicle_id, AnomalyType::SENSOR_FAILURE, "battery");
+        double battery_low = battery_open ? 11.3 : 11.0;
+        double battery_high = battery_open ? 14.7 : 15.0;
+        if (current.battery_voltage < battery_low || current.battery_voltage > battery_high) {
+            addEnhancedAnomaly(current.vehicle_id, "battery", current.battery_voltage,
+                AnomalyType::SENSOR_FAILURE, "Battery voltage abnormal", 3, "", ml_score);
+            anomaly_found = true;
+        }
+        
+        // Windowed detectors
+        anomaly_found |= detectWindowedAnomalies(current, windows, ml_score);
+        anomaly_found |= detectForecastAnomalies(current, forecasts, ml_score);
+        
+        // ML-based anomaly detection
+        if (ml_score > 3.0) { // Threshold for ML anomaly
+            addEnhancedAnomaly(current.vehicle_id, "ml_pattern", ml_score,
+                AnomalyType::ERRATIC_BEHAVIOR, "ML detected unusual pattern", 3, "", ml_score);
+            anomaly_found = true;
+        }
+        if (pattern_score > pattern_detector.threshold()) {
+            addEnhancedAnomaly(current.vehicle_id, "fleet_pattern", pattern_score,
+                AnomalyType::ERRATIC_BEHAVIOR, "Unusual combination of readings for this model", 3, "", ml_score);
+            anomaly_found = true;
+        }
+        
+        // Maintenance prediction
+        checkMaintenanceRequirements(current);
+        
+        return anomaly_found;
+    }
+    
+    // Threshold rules that run in every degraded mode
+    bool detectSafetyCritical(const SensorReading& current, double ml_score) {
+        bool anomaly_found = false;
+        
+        // Range checks use a lower exit threshold while their alert is open
+        double temp_limit = isAlertOpen(current.vehicle_id, AnomalyType::TEMP_OUT_OF_RANGE, "temperature")
+            ? 105.0 : 110.0;
+        if (current.engine_temp_celsius > temp_limit) {
+            addEnhancedAnomaly(current.vehicle_id, "temperature", current.engine_temp_celsius,
+                AnomalyType::TEMP_OUT_OF_RANGE, "Engine overheating detected", 5, "", ml_score);
+            anomaly_found = true;
+        }
+        
+        // Enhanced acceleration-based detection
+        if (std::abs(current.acceleration_ms2) > 6.0) {
+            AnomalyType type = current.acceleration_ms2 > 0 ? 
+                AnomalyType::HARSH_ACCELERATION : AnomalyType::HARSH_BRAKING;
+            const char* desc = current.acceleration_ms2 > 0 ?
+                "Harsh acceleration detected" : "Harsh braking detected";
+            
+            addEnhancedAnomaly(current.vehicle_id, "acceleration", current.acceleration_ms2,
+                type, desc, 3, "", ml_score);
+            anomaly_found = true;
+        }
+        
+        // Oil pressure monitoring
+        double oil_limit = isAlertOpen(current.vehicle_id, AnomalyType::SENSOR_FAILURE, "oil_pressure")
+            ? 1.3 : 1.0;
+        if (current.oil_pressure_bar < oil_limit && current.engine_on) {
+            addEnhancedAnomaly(current.vehicle_id, "oil_pressure", current.oil_pressure_bar,
+                AnomalyType::SENSOR_FAILURE, "Critically low oil pressure", 5, "", ml_score);
+            anomaly_found = true;
+        }
+        
+        return anomaly_found;
+    }
+    
+    bool detectWindowedAnomalies(const SensorReading& current, const VehicleWindowSet& windows,
+                                 double ml_score) {
+        bool anomaly_found = false;
+        
+        // Fuel leak: sustained drop over the last minute
+        const auto& fuel = windows[fuel_rate_window];
+        if (fuel.count() >= 10 && fuel.coveredMs() >= 10 * 1000) {
+            double fuel_drop_rate = -fuel.ratePerSecond() * 60.0; // Percent per minute
+            if (fuel_drop_rate > 2.0) {
+                addEnhancedAnomaly(current.vehicle_id, "fuel", fuel_drop_rate,
+                    AnomalyType::FUEL_LEAK, "Potential fuel leak detected", 4, "", ml_score);
+                anomaly_found = true;
+            }
+        }
+        
+        // Sudden changes within a few seconds
+        const auto& speed = windows[speed_change_window];
+        if (speed.count() >= 2 && speed.range() > 50.0) {
+            addEnhancedAnomaly(current.vehicle_id, "speed", speed.range(),
+                AnomalyType::SUDDEN_SPEED_CHANGE, "Sudden speed change detected", 3, "", ml_score);
+            anomaly_found = true;
+        }
+        
+        const auto& rpm = windows[rpm_change_window];
+        if (rpm.count() >= 2 && rpm.range() > 3000.0) {
+            addEnhancedAnomaly(current.vehicle_id, "rpm", rpm.range(),
+                AnomalyType::SUDDEN_RPM_CHANGE, "Sudden RPM change detected", 3, "", ml_score);
+            anomaly_found = true;
+        }
+        
+        const auto& temp_rate = windows[temp_rate_window];
+        if (temp_rate.count() >= 2 && temp_rate.ratePerSecond() > 0.5) {
+            addEnhancedAnomaly(current.vehicle_id, "temperature", temp_rate.ratePerSecond(),
+                AnomalyType::SUDDEN_TEMP_CHANGE, "Rapid temperature rise detected", 4, "", ml_score);
+            anomaly_found = true;
+        }
+        
+        // Overheating pattern: smoothed temperature close to the limit
+        const auto& temp_trend = windows[temp_trend_window];
+        if (temp_trend.coveredMs() >= 30 * 1000 && temp_trend.ewma() > 105.0 &&
+            temp_trend.ewma() > temp_trend.mean()) {
+            addEnhancedAnomaly(current.vehicle_id, "temperature", temp_trend.ewma(),
+                AnomalyType::OVERHEATING_PATTERN, "Sustained temperature rise toward limit", 4, "", ml_score);
+            anomaly_found = true;
+        }
+        
+        return anomaly_found;
+    }
+    
+    bool detectForecastAnomalies(const SensorReading& current, const VehicleForecastSet& forecasts,
+                                 double ml_score) {
+        bool anomaly_found = false;
+        
+        // Temperature trending into the overheating limit within a minute of
+        // readings, raised before the range check would fire
+        const double temp_limit = 110.0;
+        const auto& temp = forecasts[temp_forecast];
+        if (forecasts.ready(temp_forecast) && current.engine_temp_celsius <= temp_limit) {
+            double steps = temp.stepsUntil(temp_limit);
+            if (steps <= 60.0 && temp.getLevel() > 95.0) {
+                alert_text.clear();
+                alert_text.append("Temperature forecast to reach ").appendInt(static_cast<int64_t>(temp_limit))
+                          .append("°C in ~").appendInt(static_cast<int64_t>(std::ceil(steps))).append(" readings");
+                addEnhancedAnomaly(current.vehicle_id, "temperature_forecast", forecasts.forecast(temp_forecast, 60),
+                    AnomalyType::OVERHEATING_PATTERN, alert_text.str(), 4, "", ml_score);
+                anomaly_found = true;
+            }
+        }
+        
+        return anomaly_found;
+    }
+    
+    void checkMaintenanceRequirements(const SensorReading& reading) {
+        auto& profile = vehicle_profiles[reading.vehicle_id];
+        
+        // Check if maintenance is due based on distance
+        auto time_since_maintenance = std::chrono::duration_cast<std::chrono::hours>(
+            reading.timestamp - profile.last_maintenance).count();
+        
+        if (profile.total_distance_km > profile.maintenance_interval_km || 
+            time_since_maintenance > 24 * 30 * 3) { // 3 months
+            
+            addEnhancedAnomaly(reading.vehicle_id, "maintenance", profile.total_distance_km,
+                AnomalyType::MAINTENANCE_REQUIRED, "Scheduled maintenance due", 2);
+            
+            profile.current_state = VehicleState::MAINTENANCE;
+        }
+    }
+    
+    bool isAlertOpen(int vehicle_id, AnomalyType type, std::string_view sensor,
+                     std::string_view location = {}) const {
+        return alert_tracker.isOpen(vehicle_id, alertKey(type, sensor, location));
+    }
+    
+    // Routes a detection through the alert lifecycle; only opening,
+    // reopening and periodic summary events become anomaly records
+    // Views, not strings: most detections are suppressed and copy nothing
+    void addEnhancedAnomaly(int vehicle_id, std::string_view sensor, double value,
+                           AnomalyType type, std::string_view description,
+                           int severity, std::string_view location = {},
+                           double ml_score = 0.0) {
+        const VehicleAlertTracker::Condition* condition = nullptr;
+        AlertDecision decision = alert_tracker.report(
+            vehicle_id, alertKey(type, sensor, location), lastReadingMillis(vehicle_id), value, severity,
+            [&]() {
+                TextPool& pool = anomalyTextPool();
+                return AlertPayload{type, pool.intern(sensor), pool.intern(description), pool.intern(location), severity};
+            },
+            &condition);
+        
+        if (decision == AlertDecision::NONE) pipeline_metrics.alerts_suppressed.inc();
+        else if (decision == AlertDecision::OPENED) pipeline_metrics.alerts_opened.inc();
+        else if (decision == AlertDecision::REOPENED) pipeline_metrics.alerts_reopened.inc();
+        else pipeline_metrics.alerts_summary.inc();
+        
+        if (decision == AlertDecision::OPENED) {
+            recordAnomaly(vehicle_id, sensor, value, type, description, severity, location, ml_score, "OPEN");
+        } else if (decision == AlertDecision::SUMMARY) {
+            event_text.clear();
+            event_text.append(description).append(" (ongoing ").appendInt(condition->durationMs() / 1000)
+                      .append("s, ").appendInt(condition->occurrences).append(" occurrences)");
+            recordAnomaly(vehicle_id, sensor, value, type, event_text.str(), severity, location, ml_score, "ONGOING");
+        } else if (decision == AlertDecision::REOPENED) {
+            event_text.clear();
+            event_text.append(description).append(" (reopened ")
+                      .appendInt((condition->last_active_ms - condition->cleared_ms) / 1000)
+                      .append("s after clearing, ").appendInt(condition->occurrences).append(" occurrences)");
+            recordAnomaly(vehicle_id, sensor, value, type, event_text.str(), severity, location, ml_score, "REOPENED");
+        }
+    }
+    
+    int64_t lastReadingMillis(int vehicle_id) {
+        auto it = vehicle_profiles.find(vehicle_id);
+        return toEpochMillis(it != vehicle_profiles.end() ? it->second.last_seen
+                                                          : now());
+    }
+    
+    // Sends CLEARED to the alert sinks and the anomaly log, like the events
+    // that opened the condition
+    void announceAlertCleared(int vehicle_id, const VehicleAlertTracker::Condition& condition) {
+        const bool dispatching = alert_dispatcher.isRunning();
+        if (!dispatching && !anomaly_log_file.is_open()) return;
+        
+        const auto& payload = condition.payload;
+        event_text.clear();
+        event_text.append(payload.description).append(" (cleared after ")
+                           .appendInt(condition.durationMs() / 1000).append("s, ")
+                           .appendInt(condition.occurrences).append(" occurrences)");
+        if (dispatching) {
+            DispatchAlert alert;
+            alert.priority = std::min(5, std::max(1, payload.severity));
+            alert.vehicle_id = vehicle_id;
+            alert.severity = payload.severity;
+            alert.type = anomalyTypeName(payload.type);
+            alert.event = "CLEARED";
+            alert.sensor = payload.sensor;
+            alert.description = event_text.str();
+            alert.location = payload.location;
+            alert.value = condition.peak_value;
+            alert.reading_ms = lastReadingMillis(vehicle_id);
+            alert_dispatcher.enqueue(std::move(alert));
+        }
+        if (!anomaly_log_file.is_open()) return;
+        
+        AnomalyLogRow row;
+        row.timestamp = now();
+        row.vehicle_id = vehicle_id;
+        row.sensor = payload.sensor;
+        row.value = condition.peak_value;
+        row.type = AnomalyRecord::typeCode(payload.type);
+        row.description = event_text.str();
+        row.severity = payload.severity;
+        row.priority = std::min(5, std::max(1, payload.severity));
+        row.location = payload.location;
+        row.event = "CLEARED";
+        log_row.append(row);
+        log_row.writeTo(anomaly_log_file);
+        if (!journal.isOpen()) anomaly_log_file.flush();
+    }
+    
+    void recordAnomaly(int vehicle_id, std::string_view sensor, double value,
+                       AnomalyType type, std::string_view description,
+                       int severity, std::string_view location,
+                       double ml_score, const char* event) {
+        const AnomalyRecord& anomaly = detected_anomalies[vehicle_id].emplace_back(
+            vehicle_id, sensor, value, type, description, severity, location, now());
+        total_anomalies_detected++;
+        pipeline_metrics.anomalies.inc();
+        
+        if (alert_dispatcher.isRunning()) {
+            DispatchAlert alert;
+            alert.priority = static_cast<int>(anomaly.priority);
+            alert.vehicle_id = vehicle_id;
+            alert.severity = severity;
+            alert.type = anomalyTypeName(type);
+            alert.event = event;
+            alert.sensor = sensor;
+            alert.description = description;
+            alert.location = location;
+            alert.value = value;
+            alert.ml_score = ml_score;
+            alert.reading_ms = lastReadingMillis(vehicle_id);
+            alert_dispatcher.enqueue(std::move(alert));
+        }
+        
+        if (vehicle_profiles.find(vehicle_id) != vehicle_profiles.end()) {
+            vehicle_profiles[vehicle_id].total_anomalies++;
+        }
+        
+        FeedAnomaly feed_anomaly;
+        feed_anomaly.timestamp_ms = toEpochMillis(anomaly.timestamp);
+        feed_anomaly.vehicle_id = vehicle_id;
+        feed_anomaly.sensor_name = anomaly.sensor_name;
+        feed_anomaly.value = value;
+        feed_anomaly.type = anomalyTypeName(type);
+        feed_anomaly.description = anomaly.description;
+        feed_anomaly.severity = severity;
+        feed_anomaly.priority = priorityName(anomaly.priority);
+        feed_anomaly.location = anomaly.location_info;
+        feed_anomaly.ml_score = ml_score;
+        live_feed.publishAnomaly(std::move(feed_anomaly));
+        
+        if (journal.isOpen()) {
+            journal_record.clear();
+            WireWriter out(journal_record);
+            encodeAnomaly(out, anomaly);
+            journal.append(static_cast<uint8_t>(JournalRecordType::ANOMALY), journal_record);
+        }
+        
+        // Enhanced logging with ML score
+        if (anomaly_log_file.is_open()) {
+            AnomalyLogRow row;
+            row.timestamp = anomaly.timestamp;
+            row.vehicle_id = vehicle_id;
+            row.sensor = sensor;
+            row.value = value;
+            row.type = AnomalyRecord::typeCode(type);
+            row.description = description;
+            row.severity = severity;
+            row.priority = static_cast<int>(anomaly.priority);
+            row.location = location;
+            row.ml_score = ml_score;
+            row.event = event;
+            log_row.append(row);
+            log_row.writeTo(anomaly_log_file);
+            // With the journal on, durability comes from its group commit
+            if (!journal.isOpen()) anomaly_log_file.flush();
+        }
+    }
+    
+    void updateVehicleState(int vehicle_id) {
+        if (vehicle_profiles.find(vehicle_id) == vehicle_profiles.end()) return;
+        
+        auto& profile = vehicle_profiles[vehicle_id];
+        int recent_critical = 0, recent_high = 0;
+        const auto current_time = now();
+        
+        if (detected_anomalies.find(vehicle_id) != detected_anomalies.end()) {
+            for (const auto& anomaly : detected_anomalies[vehicle_id]) {
+                auto time_diff = std::chrono::duration_cast<std::chrono::minutes>(
+                    current_time - anomaly.timestamp);
+                if (time_diff.count() <= 5) {
+                    if (anomaly.severity == 5) recent_critical++;
+                    else if (anomaly.severity == 4) recent_high++;
+                }
+            }
+        }
+        
+        // A sustained condition only produces periodic records, so open
+        // alerts count towards the state as well
+        int open_critical = 0, open_high = 0;
+        alert_tracker.forEachOpen(vehicle_id, [&](const VehicleAlertTracker::Condition& c) {
+            if (c.payload.severity == 5) open_critical++;
+            else if (c.payload.severity == 4) open_high++;
+        });
+        recent_critical = std::max(recent_critical, open_critical);
+        recent_high = std::max(recent_high, open_high);
+        
+        if (recent_critical > 0) profile.current_state = VehicleState::CRITICAL;
+        else if (recent_high > 2) profile.current_state = VehicleState::WARNING;
+        else if (profile.current_state != VehicleState::MAINTENANCE) 
+            profile.current_state = VehicleState::NORMAL;
+        
+        // OFFLINE is set by the heartbeat wheel; a reading brings the vehicle back
+    }
+    
+    // Marks the vehicle OFFLINE and raises the alert; the alert clears once
+    // readings resume
+    void markOffline(int vehicle_id) {
+        auto it = vehicle_profiles.find(vehicle_id);
+        if (it == vehicle_profiles.end() || it->second.current_state == VehicleState::OFFLINE) return;
+        VehicleProfile& profile = it->second;
+        pipeline_metrics.vehicles_by_state[static_cast<size_t>(profile.current_state)].add(-1);
+        pipeline_metrics.vehicles_by_state[static_cast<size_t>(VehicleState::OFFLINE)].add(1);
+        profile.current_state = VehicleState::OFFLINE;
+        offline_events++;
+        
+        const auto silent_s = std::chrono::duration_cast<std::chrono::seconds>(now() - profile.last_seen).count();
+        alert_text.clear();
+        alert_text.append("No readings for ").appendInt(silent_s).append("s");
+        addEnhancedAnomaly(vehicle_id, "heartbeat", static_cast<double>(silent_s),
+            AnomalyType::VEHICLE_OFFLINE, alert_text.str(), 3);
+        if (shared_fleet.isOpen()) publishSharedVehicle(profile, nullptr);
+    }
+    
+    // Profiles created outside registerVehicle get their timer here
+    void armHeartbeat(VehicleProfile& profile, int64_t heard_ms) {
+        if (profile.heartbeat_timer == TimerWheel::NONE) {
+            profile.heartbeat_timer = heartbeat_wheel.create(static_cast<uint64_t>(profile.vehicle_id));
+        }
+        heartbeat_wheel.arm(profile.heartbeat_timer, heard_ms + options.offline_after_ms);
+    }
+    
+    size_t expireHeartbeats() {
+        return heartbeat_wheel.advance(toEpochMillis(now()), [this](uint32_t, uint64_t vehicle_id) {
+            markOffline(static_cast<int>(vehicle_id));
+        });
+    }
+    
+public:
+    // Enhanced reporting methods
+    void printEnhancedAnalytics(int vehicle_id) {
+        std::lock_guard<std::mutex> lock(data_mutex);
+        
+        if (vehicle_data_windows.find(vehicle_id) == vehicle_data_windows.end() || 
+            vehicle_data_windows[vehicle_id].empty()) {
+            std::cout << "Vehicle ID " << vehicle_id << " not found or no data available.\n";
+            return;
+        }
+        
+        auto speed_stats = analytics.getSpeedStats(vehicle_id);
+        auto rpm_stats = analytics.getRPMStats(vehicle_id);
+        auto temp_stats = analytics.getTempStats(vehicle_id);
+        auto fuel_stats = analytics.getFuelStats(vehicle_id);
+        auto accel_stats = analytics.getAccelerationStats(vehicle_id);
+        auto& profile = vehicle_profiles[vehicle_id];
+        
+        std::cout << "\n=== ENHANCED ANALYTICS FOR VEHICLE " << vehicle_id << " ===\n";
+        std::cout << "Model: " << profile.make_model << " (" << profile.license_plate << ")\n";
+        std::cout << "Current State: " << getStateString(profile.current_state) << "\n";
+        std::cout << "Total Distance: " << std::fixed << std::setprecision(2) 
+                  << profile.total_distance_km << " km\n";
+        std::cout << "Average Speed: " << profile.avg_speed << " km/h\n";
+        std::cout << "Max Speed Recorded: " << profile.max_speed_recorded << " km/h\n";
+        std::cout << "Harsh Events: " << profile.harsh_events_count << "\n";
+        std::cout << "Fuel Efficiency: " << profile.avg_fuel_efficiency << " km/l, eco score "
+                  << fixedOrMissing(profile.eco.score(EcoWindow::LIFETIME, options.eco).score, 1)
+                  << " ('eco " << vehicle_id << "')\n";
+        std::cout << "Data Points: " << vehicle_data_windows[vehicle_id].size() << "\n";
+        profile.performance_metrics.forEach([](const char* name, double value) {
+            std::cout << "  " << name << ": " << value << "\n";
+        });
+        
+        std::cout << "\n--- SPEED ANALYTICS ---\n";
+        printStatistics("Speed", speed_stats, "km/h");
+        
+        std::cout << "\n--- RPM ANALYTICS ---\n";
+        printStatistics("RPM", rpm_stats, "RPM");
+        
+        std::cout << "\n--- TEMPERATURE ANALYTICS ---\n";
+        printStatistics("Temperature", temp_stats, "°C");
+        
+        std::cout << "\n--- FUEL ANALYTICS ---\n";
+        printStatistics("Fuel", fuel_stats, "%");
+        
+        std::cout << "\n--- ACCELERATION ANALYTICS ---\n";
+        printStatistics("Acceleration", accel_stats, "m/s²");
+        
+        auto forecast_it = vehicle_forecasts.find(vehicle_id);
+        if (forecast_it != vehicle_forecasts.end()) {
+            const VehicleForecastSet& forecasts = forecast_it->second;
+            std::cout << "\n--- FORECASTS (60 readings ahead) ---\n";
+            for (size_t slot = 0; slot < forecasts.size(); ++slot) {
+                const auto& model = forecasts[slot];
+                std::cout << historyChannelName(forecast_layout[slot].channel);
+                if (!forecasts.ready(slot)) {
+                    std::cout << " - warming up (" << model.count() << " readings)\n";
+                    continue;
+                }
+                std::cout << " - Level: " << model.getLevel()
+                          << ", Trend: " << model.getTrend() << "/reading"
+                          << ", Forecast: " << forecasts.forecast(slot, 60)
+                          << ", Last Residual: " << model.residual()
+                          << " (" << model.residualScore() << " sd)\n";
+            }
+        }
+        
+        std::cout << "\n--- ANOMALY SUMMARY ---\n";
+        std::cout << "Total Anomalies: " << profile.total_anomalies << "\n";
+        
+        if (detected_anomalies.find(vehicle_id) != detected_anomalies.end()) {
+            std::map<int, int> severity_count;
+            std::map<AnomalyType, int> type_count;
+            
+            for (const auto& anomaly : detected_anomalies[vehicle_id]) {
+                severity_count[anomaly.severity]++;
+                type_count[anomaly.type]++;
+            }
+            
+            std::cout << "By Severity:\n";
+            for (const auto& pair : severity_count) {
+                std::cout << "  Level " << pair.first << ": " << pair.second << "\n";
+            }
+            
+            std::cout << "By Type:\n";
+            for (const auto& pair : type_count) {
+                AnomalyRecord temp(0, "", 0, pair.first, "", 0);
+                std::cout << "  " << temp.getTypeString() << ": " << pair.second << "\n";
+            }
+        }
+        
+        // Predictive insights
+        std::cout << "\n--- PREDICTIVE INSIGHTS ---\n";
+        auto speed_trend = analytics.getSpeedStats(vehicle_id);
+        if (speed_trend.trend_slope > 0.1) {
+            std::cout << "⚠️  Speed trend increasing (+" << speed_trend.trend_slope << " km/h per reading)\n";
+        } else if (speed_trend.trend_slope < -0.1) {
+            std::cout << "📉 Speed trend decreasing (" << speed_trend.trend_slope << " km/h per reading)\n";
+        }
+        
+        auto temp_trend = analytics.getTempStats(vehicle_id);
+        if (temp_trend.trend_slope > 0.05) {
+            std::cout << "🌡️  Temperature rising trend (+" << temp_trend.trend_slope << "°C per reading)\n";
+        }
+        
+        if (profile.total_distance_km > profile.maintenance_interval_km * 0.9) {
+            std::cout << "🔧 Maintenance due soon (" 
+                      << (profile.maintenance_interval_km - profile.total_distance_km) 
+                      << " km remaining)\n";
+        }
+    }
+    
+    // Statistics over the compressed history rather than the 200-reading window
+    void printLongHorizonAnalytics(int vehicle_id, int minutes) {
+        VehicleHistoryColumns columns;
+        size_t stored_samples = 0, stored_bytes = 0;
+        {
+            std::lock_guard<std::mutex> lock(data_mutex);
+            auto it = vehicle_histories.find(vehicle_id);
+            if (it == vehicle_histories.end() || it->second.sampleCount() == 0) {
+                std::cout << "Vehicle ID " << vehicle_id << " has no recorded history.\n";
+                return;
+            }
+            
+            int64_t to_ms = it->second.lastTimestamp();
+            int64_t from_ms = to_ms - static_cast<int64_t>(minutes) * 60 * 1000;
+            uint64_t mask = (1ULL << HIST_SPEED) | (1ULL << HIST_RPM) |
+                            (1ULL << HIST_TEMP) | (1ULL << HIST_FUEL);
+            it->second.decode(from_ms, to_ms, columns, mask);
+            stored_samples = it->second.sampleCount();
+            stored_bytes = it->second.compressedBytes();
+        }
+        
+        std::cout << "\n=== LONG-HORIZON HISTORY FOR VEHICLE " << vehicle_id
+                  << " (last " << minutes << " min) ===\n";
+        std::cout << "Stored Samples: " << stored_samples << " ("
+                  << std::fixed << std::setprecision(2)
+                  << static_cast<double>(stored_bytes) / std::max<size_t>(1, stored_samples)
+                  << " bytes/sample)\n";
+        std::cout << "Samples In Range: " << columns.size() << "\n";
+        if (columns.size() == 0) return;
+        
+        std::cout << "Time Span: "
+                  << (columns.timestamps_ms.back() - columns.timestamps_ms.front()) / 60000.0
+                  << " min\n";
+        
+        printStatistics("Speed", analytics.calculateStatistics(columns.channels[HIST_SPEED]), "km/h");
+        printStatistics("RPM", analytics.calculateStatistics(columns.channels[HIST_RPM]), "RPM");
+        printStatistics("Temperature", analytics.calculateStatistics(columns.channels[HIST_TEMP]), "°C");
+        printStatistics("Fuel", analytics.calculateStatistics(columns.channels[HIST_FUEL]), "%");
+    }
+    
+    void printTrips(int vehicle_id, size_t max_trips = 10) {
+        std::lock_guard<std::mutex> lock(data_mutex);
+        auto it = trip_trackers.find(vehicle_id);
+        if (it == trip_trackers.end()) {
+            std::cout << "Vehicle ID " << vehicle_id << " has no trips recorded.\n";
+            return;
+        }
+        
+        const auto& tracker = it->second;
+        const auto& trips = tracker.completedTrips();
+        std::cout << "\n=== TRIPS FOR VEHICLE " << vehicle_id << " ===\n";
+        std::cout << "Completed Trips: " << trips.size()
+                  << (tracker.inTrip() ? " (one in progress)" : "") << "\n";
+        std::cout << "Route Storage: " << tracker.storedBytes() << " bytes (raw "
+                  << tracker.rawBytes() << " bytes)\n";
+        
+        size_t start = trips.size() > max_trips ? trips.size() - max_trips : 0;
+        for (size_t i = start; i < trips.size(); ++i) {
+            const auto& trip = trips[i];
+            std::cout << std::fixed << std::setprecision(2)
+                      << "  Trip " << trip.trip_id << ": "
+                      << trip.distance_km << " km, "
+                      << trip.durationSeconds() / 60.0 << " min, "
+                      << "avg " << trip.avgSpeed() << " km/h, "
+                      << "max " << trip.max_speed_kmph << " km/h, "
+                      << "idle " << trip.idle_seconds << " s, "
+                      << "harsh " << trip.harsh_acceleration_count << "/" << trip.harsh_braking_count << ", "
+                      << trip.vertex_count << "/" << trip.raw_point_count << " points, "
+                      << tripEndReasonString(trip.end_reason) << "\n";
+        }
+        
+        if (tracker.inTrip()) {
+            const auto& trip = tracker.currentTrip();
+            std::cout << "  In progress: " << trip.distance_km << " km, "
+                      << trip.raw_point_count << " points\n";
+        }
+    }
+    
+    void printEcoScore(int vehicle_id) {
+        std::lock_guard<std::mutex> lock(data_mutex);
+        auto it = vehicle_profiles.find(vehicle_id);
+        if (it == vehicle_profiles.end()) {
+            std::cout << "Vehicle ID " << vehicle_id << " not found.\n";
+            return;
+        }
+        
+        const EcoAccumulator& eco = it->second.eco;
+        std::cout << "\n=== ECO SCORE FOR VEHICLE " << vehicle_id << " ===\n";
+        const std::pair<EcoWindow, const char*> windows[] = {
+            {EcoWindow::TRIP, eco.tripOpen() ? "Current trip" : "Last trip"},
+            {EcoWindow::DAY, "Today (UTC)"},
+            {EcoWindow::LIFETIME, "Lifetime"}};
+        for (const auto& window : windows) {
+            const EcoTotals& t = eco.totals(window.first);
+            const EcoScore score = eco.score(window.first, options.eco);
+            std::cout << window.second << ": score " << fixedOrMissing(score.score, 1) << "\n"
+                      << std::fixed << std::setprecision(2)
+                      << "  " << t.distance_km << " km, " << t.fuel_litres << " l used ("
+                      << fixedOrMissing(t.litresPer100Km(options.eco), 2) << " l/100km), "
+                      << t.refuels << " refuels (" << t.refuelled_litres << " l)\n"
+                      << std::setprecision(0)
+                      << "  engine on " << t.engine_seconds << " s: idle " << t.idle_seconds
+                      << " s, over " << options.eco.overspeed_kmph << " km/h " << t.overspeed_seconds
+                      << " s, throttle >= " << options.eco.aggressive_throttle_percent << "% "
+                      << t.aggressive_throttle_seconds << " s, hard braking " << t.hard_brake_seconds << " s\n"
+                      << std::setprecision(2)
+                      << "  harsh " << t.harsh_accelerations << "/" << t.harsh_brakes << " ("
+                      << fixedOrMissing(t.harshPer100Km(options.eco), 2) << " per 100 km)\n  components:";
+            for (size_t c = 0; c < ECO_COMPONENTS; ++c) {
+                std::cout << " " << ecoComponentName(static_cast<EcoComponent>(c)) << " "
+                          << fixedOrMissing(score.components[c], 1);
+            }
+            std::cout << "\n";
+        }
+    }
+    
+    // Compiles and runs an ad-hoc query. Execution only takes data_mutex
+    // while a worker copies one chunk, so ingestion keeps running.
+    void runFleetQuery(const std::string& text) {
+        std::string trimmed = text;
+        trimmed.erase(0, trimmed.find_first_not_of(" \t"));
+        trimmed.erase(trimmed.find_last_not_of(" \t\r") + 1);
+        if (trimmed.empty() || trimmed == "help") {
+            printQueryHelp();
+            return;
+        }
+        
+        QueryPlan plan = compileFleetQuery(trimmed, query_tables, "vehicles");
+        if (!plan.ok()) {
+            std::cout << "❌ Query error: " << plan.error << "\n";
+            return;
+        }
+        
+        QuerySource source = makeQuerySource(plan);
+        QueryResult result = executeFleetQuery(plan, source);
+        if (!result.error.empty()) {
+            std::cout << "❌ Query error: " << result.error << "\n";
+            return;
+        }
+        
+        std::cout << "\nPlan: " << plan.describe() << "\n\n";
+        std::vector<size_t> widths;
+        for (const auto& header : result.headers) widths.push_back(header.size());
+        std::vector<std::vector<std::string>> cells;
+        for (const auto& row : result.rows) {
+            cells.emplace_back();
+            for (size_t c = 0; c < row.size(); ++c) {
+                cells.back().push_back(formatQueryCell(row[c]));
+                widths[c] = std::max(widths[c], cells.back().back().size());
+            }
+        }
+        for (size_t c = 0; c < result.headers.size(); ++c) {
+            std::cout << std::left << std::setw(static_cast<int>(widths[c]) + 2) << result.headers[c];
+        }
+        std::cout << "\n";
+        for (size_t c = 0; c < result.headers.size(); ++c) {
+            std::cout << std::string(widths[c], '-') << "  ";
+        }
+        std::cout << "\n";
+        for (const auto& row : cells) {
+            for (size_t c = 0; c < row.size(); ++c) {
+                std::cout << std::left << std::setw(static_cast<int>(widths[c]) + 2) << row[c];
+            }
+            std::cout << "\n";
+        }
+        std::cout << std::right << "\n" << result.rows.size() << " row(s); scanned "
+                  << result.rows_scanned << ", matched " << result.rows_matched
+                  << " in " << result.chunks << " chunk(s) on " << result.workers << " worker(s), "
+                  << std::fixed << std::setprecision(2) << result.elapsed_ms << " ms\n";
+    }
+    
+private:
+    void printQueryHelp() const {
+        std::cout << "\nQuery syntax:\n"
+                  << "  query [select] item, ... [from vehicles|readings|anomalies]\n"
+                  << "        [where field op value and ...] [group by field, ...]\n"
+                  << "        [order by item [desc]] [last N s|min|h] [limit N]\n"
+                  << "  items: count, sum/avg/min/max <field>, or a field\n"
+                  << "  e.g.   query avg speed, max temp where state=WARNING group by make_model\n"
+                  << "         query count, max value from anomalies group by type last 10 min\n";
+        for (const auto& pair : query_tables) {
+            std::cout << "  " << pair.first << ":";
+            for (const auto& field : pair.second.getFields()) {
+                std::cout << " " << field.name << (field.kind == QueryFieldKind::TEXT ? "*" : "");
+            }
+            std::cout << "\n";
+        }
+        std::cout << "  (* text fields: = and != only, quote values with spaces)\n";
+    }
+    
+    QuerySource makeQuerySource(const QueryPlan& plan) {
+        // Snapshot the vehicle ids; the chunks are loaded later by the workers
+        auto ids = std::make_shared<std::vector<int>>();
+        {
+            std::lock_guard<std::mutex> lock(data_mutex);
+            ids->reserve(vehicle_profiles.size());
+            for (const auto& pair : vehicle_profiles) ids->push_back(pair.first);
+        }
+        std::sort(ids->begin(), ids->end());
+        
+        QuerySource source;
+        const std::string& table = plan.schema->name();
+        if (table == "vehicles") {
+            source.chunk_count = (ids->size() + QUERY_VEHICLES_PER_CHUNK - 1) / QUERY_VEHICLES_PER_CHUNK;
+            source.load = [this, ids](size_t chunk, const QueryPlan&, QueryBatch& batch) {
+                size_t begin = chunk * QUERY_VEHICLES_PER_CHUNK;
+                size_t end = std::min(ids->size(), begin + QUERY_VEHICLES_PER_CHUNK);
+                loadVehicleRows(ids->data() + begin, end - begin, batch);
+            };
+        } else if (table == "readings") {
+            source.chunk_count = ids->size();
+            source.load = [this, ids](size_t chunk, const QueryPlan& p, QueryBatch& batch) {
+                loadReadingRows((*ids)[chunk], p.range_ms, batch);
+            };
+        } else {
+            source.chunk_count = ids->size();
+            source.load = [this, ids](size_t chunk, const QueryPlan& p, QueryBatch& batch) {
+                loadAnomalyRows((*ids)[chunk], p.range_ms, batch);
+            };
+        }
+        return source;
+    }
+    
+    void loadVehicleRows(const int* ids, size_t count, QueryBatch& batch) {
+        const double missing = std::numeric_limits<double>::quiet_NaN();
+        std::lock_guard<std::mutex> lock(data_mutex);
+        const auto current_time = now();
+        
+        std::vector<const VehicleProfile*> profiles;
+        std::vector<const SensorReading*> latest;
+        profiles.reserve(count);
+        latest.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            auto it = vehicle_profiles.find(ids[i]);
+            if (it == vehicle_profiles.end()) continue;
+            profiles.push_back(&it->second);
+            auto window = vehicle_data_windows.find(ids[i]);
+            latest.push_back(window != vehicle_data_windows.end() && !window->second.empty()
+                             ? &window->second.back() : nullptr);
+        }
+        
+        // Column at a time, only the columns the plan reads
+        const size_t n = profiles.size();
+        for (size_t field = 0; field < query_tables.at("vehicles").size(); ++field) {
+            if (!batch.needs(field)) continue;
+            for (size_t i = 0; i < n; ++i) {
+                const VehicleProfile& p = *profiles[i];
+                const SensorReading* r = latest[i];
+                switch (field) {
+                    case VQ_VEHICLE_ID: batch.appendNumber(field, p.vehicle_id); break;
+                    case VQ_MAKE_MODEL: batch.appendText(field, p.make_model); break;
+                    case VQ_PLATE: batch.appendText(field, p.license_plate); break;
+                    case VQ_STATE: batch.appendText(field, getStateString(p.current_state)); break;
+                    case VQ_SPEED: batch.appendNumber(field, r ? r->speed_kmph : missing); break;
+                    case VQ_RPM: batch.appendNumber(field, r ? r->rpm : missing); break;
+                    case VQ_TEMP: batch.appendNumber(field, r ? r->engine_temp_celsius : missing); break;
+                    case VQ_FUEL: batch.appendNumber(field, r ? r->fuel_level_percent : missing); break;
+                    case VQ_OIL_PRESSURE: batch.appendNumber(field, r ? r->oil_pressure_bar : missing); break;
+                    case VQ_BATTERY: batch.appendNumber(field, r ? r->battery_voltage : missing); break;
+                    case VQ_DISTANCE: batch.appendNumber(field, p.total_distance_km); break;
+                    case VQ_AVG_SPEED: batch.appendNumber(field, p.avg_speed); break;
+                    case VQ_MAX_SPEED: batch.appendNumber(field, p.max_speed_recorded); break;
+                    case VQ_ANOMALIES: batch.appendNumber(field, p.total_anomalies); break;
+                    case VQ_HARSH_EVENTS: batch.appendNumber(field, p.harsh_events_count); break;
+                    case VQ_L_PER_100KM:
+                        batch.appendNumber(field, p.eco.totals(EcoWindow::LIFETIME).litresPer100Km(options.eco));
+                        break;
+                    case VQ_IDLE_PCT: {
+                        const EcoTotals& t = p.eco.totals(EcoWindow::LIFETIME);
+                        batch.appendNumber(field, t.engine_seconds > 0.0 ? 100.0 * t.idle_seconds / t.engine_seconds : missing);
+                        break;
+                    }
+                    case VQ_OVERSPEED_PCT: {
+                        const EcoTotals& t = p.eco.totals(EcoWindow::LIFETIME);
+                        batch.appendNumber(field, t.moving_seconds > 0.0 ? 100.0 * t.overspeed_seconds / t.moving_seconds : missing);
+                        break;
+                    }
+                    case VQ_ECO_SCORE: batch.appendNumber(field, p.eco.score(EcoWindow::LIFETIME, options.eco).score); break;
+                    case VQ_ECO_TRIP: batch.appendNumber(field, p.eco.score(EcoWindow::TRIP, options.eco).score); break;
+                    case VQ_ECO_DAY: batch.appendNumber(field, p.eco.score(EcoWindow::DAY, options.eco).score); break;
+                    case VQ_OPEN_ALERTS: {
+                        size_t open = 0;
+                        alert_tracker.forEachOpen(p.vehicle_id, [&open](const VehicleAlertTracker::Condition&) { open++; });
+                        batch.appendNumber(field, static_cast<double>(open));
+                        break;
+                    }
+                    case VQ_SEEN_AGO:
+                        batch.appendNumber(field, std::chrono::duration<double>(current_time - p.last_seen).count());
+                        break;
+                }
+            }
+        }
+        batch.setRows(n);
+    }
+    
+    void loadReadingRows(int vehicle_id, int64_t range_ms, QueryBatch& batch) {
+        const int64_t now_ms = toEpochMillis(now());
+        const int64_t from_ms = range_ms > 0 ? now_ms - range_ms : std::numeric_limits<int64_t>::min();
+        const int64_t to_ms = std::numeric_limits<int64_t>::max();
+        
+        uint64_t mask = 0;
+        for (size_t c = 0; c < HIST_CHANNEL_COUNT; ++c) {
+            if (batch.needs(RQ_CHANNEL_BASE + c)) mask |= 1ULL << c;
+        }
+        
+        // Copy the open block and take references to the sealed ones under
+        // the lock; sealed blocks are immutable and decoded afterwards
+        std::vector<std::shared_ptr<const VehicleHistory::SealedBlock>> sealed;
+        VehicleHistoryColumns open_columns;
+        VehicleHistory::Config config;
+        std::string make_model, state;
+        {
+            std::lock_guard<std::mutex> lock(data_mutex);
+            auto it = vehicle_histories.find(vehicle_id);
+            if (it == vehicle_histories.end()) return;
+            it->second.snapshotSealed(from_ms, to_ms, sealed);
+            it->second.decodeOpen(from_ms, to_ms, open_columns, mask);
+            config = it->second.getConfig();
+            auto profile = vehicle_profiles.find(vehicle_id);
+            if (profile != vehicle_profiles.end()) {
+                make_model = profile->second.make_model;
+                state = getStateString(profile->second.current_state);
+            }
+        }
+        
+        VehicleHistoryColumns columns;
+        for (const auto& block : sealed) {
+            VehicleHistory::decodeBlock(*block, config, from_ms, to_ms, columns, mask);
+        }
+        columns.timestamps_ms.insert(columns.timestamps_ms.end(),
+                                     open_columns.timestamps_ms.begin(), open_columns.timestamps_ms.end());
+        for (size_t c = 0; c < HIST_CHANNEL_COUNT; ++c) {
+            if (!(mask & (1ULL << c))) continue;
+            columns.channels[c].insert(columns.channels[c].end(),
+                                       open_columns.channels[c].begin(), open_columns.channels[c].end());
+            batch.numbers(RQ_CHANNEL_BASE + c).swap(columns.channels[c]);
+        }
+        
+        const size_t n = columns.timestamps_ms.size();
+        if (batch.needs(RQ_VEHICLE_ID)) batch.numbers(RQ_VEHICLE_ID).assign(n, vehicle_id);
+        if (batch.needs(RQ_MAKE_MODEL)) batch.appendText(RQ_MAKE_MODEL, make_model, n);
+        if (batch.needs(RQ_STATE)) batch.appendText(RQ_STATE, state, n);
+        if (batch.needs(RQ_AGE)) {
+            auto& ages = batch.numbers(RQ_AGE);
+            ages.resize(n);
+            for (size_t i = 0; i < n; ++i) ages[i] = (now_ms - columns.timestamps_ms[i]) / 1000.0;
+        }
+        batch.setRows(n);
+    }
+    
+    void loadAnomalyRows(int vehicle_id, int64_t range_ms, QueryBatch& batch) {
+        std::lock_guard<std::mutex> lock(data_mutex);
+        auto it = detected_anomalies.find(vehicle_id);
+        if (it == detected_anomalies.end()) return;
+        
+        const auto current_time = now();
+        auto cutoff = range_ms > 0 ? current_time - std::chrono::milliseconds(range_ms)
+                                   : std::chrono::system_clock::time_point::min();
+        auto profile = vehicle_profiles.find(vehicle_id);
+        const std::string make_model = profile != vehicle_profiles.end() ? profile->second.make_model : "";
+        
+        size_t n = 0;
+        for (const auto& anomaly : it->second) {
+            if (anomaly.timestamp < cutoff) continue;
+            if (batch.needs(AQ_VEHICLE_ID)) batch.appendNumber(AQ_VEHICLE_ID, vehicle_id);
+            if (batch.needs(AQ_MAKE_MODEL)) batch.appendText(AQ_MAKE_MODEL, make_model);
+            if (batch.needs(AQ_TYPE)) batch.appendText(AQ_TYPE, anomaly.getTypeString());
+            if (batch.needs(AQ_SENSOR)) batch.appendText(AQ_SENSOR, anomaly.sensor_name);
+            if (batch.needs(AQ_VALUE)) batch.appendNumber(AQ_VALUE, anomaly.value);
+            if (batch.needs(AQ_SEVERITY)) batch.appendNumber(AQ_SEVERITY, anomaly.severity);
+            if (batch.needs(AQ_LOCATION)) batch.appendText(AQ_LOCATION, anomaly.location_info);
+            if (batch.needs(AQ_AGE)) {
+                batch.appendNumber(AQ_AGE, std::chrono::duration<double>(current_time - anomaly.timestamp).count());
+            }
+            n++;
+        }
+        batch.setRows(n);
+    }
+    
+    void printStatistics(const std::string& name, const AdvancedAnalytics::Statistics& stats, 
+                        const std::string& unit) {
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << name << " - Mean: " << stats.mean << unit 
+                  << ", Std Dev: " << stats.std_deviation << unit
+                  << ", CV: " << stats.coefficient_of_variation
+                  << ", Outliers: " << stats.outlier_count
+                  << ", Trend: " << stats.trend_slope << "\n";
+    }
+    
+    // Enum spellings shared with the dashboard types (app/types/vehicle.ts)
+    static const char* stateName(VehicleState state) {
+        switch (state) {
+            case VehicleState::NORMAL: return "NORMAL";
+            case VehicleState::WARNING: return "WARNING";
+            case VehicleState::CRITICAL: return "CRITICAL";
+            case VehicleState::OFFLINE: return "OFFLINE";
+            case VehicleState::MAINTENANCE: return "MAINTENANCE";
+            default: return "UNKNOWN";
+        }
+    }
+    
+    static const char* priorityName(AlertPriority priority) {
+        switch (priority) {
+            case AlertPriority::LOW: return "LOW";
+            case AlertPriority::MEDIUM: return "MEDIUM";
+            case AlertPriority::HIGH: return "HIGH";
+            case AlertPriority::CRITICAL: return "CRITICAL";
+            case AlertPriority::EMERGENCY: return "EMERGENCY";
+            default: return "LOW";
+        }
+    }
+    
+    static const char* anomalyTypeName(AnomalyType type) {
+        switch (type) {
+            case AnomalyType::SPEED_OUT_OF_RANGE: return "SPEED_OUT_OF_RANGE";
+            case AnomalyType::RPM_OUT_OF_RANGE: return "RPM_OUT_OF_RANGE";
+            case AnomalyType::TEMP_OUT_OF_RANGE: return "TEMP_OUT_OF_RANGE";
+            case AnomalyType::SUDDEN_SPEED_CHANGE: return "SUDDEN_SPEED_CHANGE";
+            case AnomalyType::SUDDEN_RPM_CHANGE: return "SUDDEN_RPM_CHANGE";
+            case AnomalyType::SUDDEN_TEMP_CHANGE: return "SUDDEN_TEMP_CHANGE";
+            case AnomalyType::ENGINE_STALL: return "ENGINE_STALL";
+            case AnomalyType::OVERHEATING_PATTERN: return "OVERHEATING_PATTERN";
+            case AnomalyType::ERRATIC_BEHAVIOR: return "ERRATIC_BEHAVIOR";
+            case AnomalyType::SENSOR_FAILURE: return "SENSOR_FAILURE";
+            case AnomalyType::FUEL_LEAK: return "FUEL_LEAK";
+            case AnomalyType::MAINTENANCE_REQUIRED: return "MAINTENANCE_REQUIRED";
+            case AnomalyType::GEOFENCE_VIOLATION: return "GEOFENCE_VIOLATION";
+            case AnomalyType::HARSH_ACCELERATION: return "HARSH_ACCELERATION";
+            case AnomalyType::HARSH_BRAKING: return "HARSH_BRAKING";
+            case AnomalyType::VEHICLE_OFFLINE: return "VEHICLE_OFFLINE";
+            default: return "UNKNOWN";
+        }
+    }
+    
+    std::string getStateString(VehicleState state) const {
+        switch (state) {
+            case VehicleState::NORMAL: return "NORMAL";
+            case VehicleState::WARNING: return "WARNING";
+            case VehicleState::CRITICAL: return "CRITICAL";
+            case VehicleState::OFFLINE: return "OFFLINE";
+            case VehicleState::MAINTENANCE: return "MAINTENANCE";
+            default: return "UNKNOWN";
+        }
+    }
+    
+public:
+    // Enhanced synthetic data generation
+    SensorReading generateEnhancedSyntheticReading(int vehicle_id, int anomaly_scenario = 0) {
+        double speed = speed_dist(gen);
+        double rpm = rpm_dist(gen);
+        double temp = temp_dist(gen);
+        double fuel = fuel_dist(gen);
+        double throttle = throttle_dist(gen);
+        bool engine_on = true;
+        double lat = location_dist(gen);
+        double lon = location_dist(gen);
+        double acceleration = acceleration_dist(gen);
+        double brake_pressure = brake_pressure_dist(gen);
+        double oil_pressure = oil_pressure_dist(gen);
+        double battery_voltage = battery_voltage_dist(gen);
+        int odometer = 0;
+        bool abs_active = false;
+        bool traction_control = false;
+        
+        // Apply continuity from previous reading
+        auto previous = last_generated_readings.find(vehicle_id);
+        if (previous != last_generated_readings.end()) {
+            const SensorReading& last = previous->second;
+            
+            // Smooth transitions
+            speed = std::max(0.0, last.speed_kmph + std::normal_distribution<>(0, 3)(gen));
+            rpm = std::max(0.0, last.rpm + std::normal_distribution<>(0, 150)(gen));
+            temp = std::max(0.0, last.engine_temp_celsius + std::normal_distribution<>(0, 0.5)(gen));
+            fuel = std::max(0.0, std::min(100.0, last.fuel_level_percent - 0.005));
+            
+            // Calculate realistic acceleration
+            auto time_diff = 1.0; // Assume 1 second between readings
+            acceleration = (speed - last.speed_kmph) / 3.6 / time_diff; // Convert km/h to m/s
+            
+            odometer = last.odometer_km + static_cast<int>(speed / 3600.0); // Rough distance
+            
+            // Location continuity
+            double bearing = std::uniform_real_distribution<>(0.0, 360.0)(gen);
+            double dist_km = speed * (1.0 / 3600.0);
+            lat = last.latitude + (dist_km / 111.0) * std::cos(deg2rad(bearing));
+            lon = last.longitude + (dist_km / (111.0 * std::cos(deg2rad(last.latitude)))) * std::sin(deg2rad(bearing));
+            
+            // Safety systems activation
+            if (std::abs(acceleration) > 3.0) {
+                abs_active = std::bernoulli_distribution(0.3)(gen);
+                traction_control = std::bernoulli_distribution(0.2)(gen);
+            }
+        }
+        
+        // Apply anomaly scenarios
+        if (anomaly_scenario > 0) {
+            applyAnomalyScenario(anomaly_scenario, speed, rpm, temp, fuel, throttle, 
+                               engine_on, acceleration, brake_pressure, oil_pressure, 
+                               battery_voltage, abs_active, traction_control, vehicle_id);
+        }
+        
+        SensorReading reading(now(), vehicle_id, speed, rpm, temp, fuel, throttle, engine_on, lat, lon);
+        reading.acceleration_ms2 = acceleration;
+        reading.brake_pressure_bar = brake_pressure;
+        reading.oil_pressure_bar = oil_pressure;
+        reading.battery_voltage = battery_voltage;
+        reading.odometer_km = odometer;
+        reading.abs_active = abs_active;
+        reading.traction_control_active = traction_control;
+        reading.sequence_number = ++next_sequence_numbers[vehicle_id];
+        
+        last_generated_readings[vehicle_id] = reading;
+        return reading;
+    }
+    
+private:
+    void applyAnomalyScenario(int scenario, double& speed, double& rpm, double& temp, 
+                             double& fuel, double& throttle, bool& engine_on,
+                             double& acceleration, double& brake_pressure, 
+                             double& oil_pressure, double& battery_voltage,
+                             bool& abs_active, bool& traction_control, int vehicle_id) {
+        switch (scenario) {
+            case 1: // Extreme speed
+                speed = 250.0 + std::uniform_real_distribution<>(0, 50)(gen);
+                break;
+            case 2: // Engine overrev
+                rpm = 9000.0 + std::uniform_real_distribution<>(0, 2000)(gen);
+                break;
+            case 3: // Overheating
+                temp = 120.0 + std::uniform_real_distribution<>(0, 20)(gen);
+                break;
+            case 4: // Sensor failure
+                speed = -10.0;
+                break;
+            case 5: // Engine stall
+                engine_on = false;
+                rpm = 0.0;
+                speed = 0.0;
+                throttle = 0.0;
+                break;
+            case 6: // Harsh acceleration
+                acceleration = 8.0 + std::uniform_real_distribution<>(0, 4)(gen);
+                throttle = 90.0 + std::uniform_real_distribution<>(0, 10)(gen);
+                abs_active = true;
+                traction_control = true;
+                break;
+            case 7: // Harsh braking
+                acceleration = -8.0 - std::uniform_real_distribution<>(0, 4)(gen);
+                throttle = 0.0;
+                brake_pressure = 15.0 + std::uniform_real_distribution<>(0, 5)(gen);
+                abs_active = true;
+                break;
+            case 8: // Low oil pressure
+                oil_pressure = 0.5 + std::uniform_real_distribution<>(0, 0.3)(gen);
+                break;
+            case 9: // Battery issues
+                battery_voltage = 9.0 + std::uniform_real_distribution<>(0, 1)(gen);
+                break;
+            case 10: // Fuel leak
+                if (last_generated_readings.count(vehicle_id)) {
+                    fuel = last_generated_readings[vehicle_id].fuel_level_percent - 5.0;
+                }
+                break;
+        }
+    }
+    
+public:
+    // System control methods
+    void setRunning(bool r) { running.store(r); }
+    void setPaused(bool p) { paused.store(p); }
+    bool getPaused() const { return paused.load(); }
+    bool getRunning() const { return running.load(); }
+    int getTotalReadingsProcessed() const { return total_readings_processed.load(); }
+    int getTotalAnomaliesDetected() const { return total_anomalies_detected.load(); }
+    MetricsRegistry& getMetrics() { return metrics; }
+    
+    // Engine time: DataManagerOptions::clock, or the system clock
+    std::chrono::system_clock::time_point now() const { return clockNow(options.clock); }
+    
+    // Adds (or replaces) a vehicle profile
+    void registerVehicle(int vehicle_id, const std::string& make_model, const std::string& license_plate) {
+        std::lock_guard<std::mutex> lock(data_mutex);
+        auto existing = vehicle_profiles.find(vehicle_id);
+        uint32_t heartbeat_timer = TimerWheel::NONE;
+        if (existing != vehicle_profiles.end()) {
+            pipeline_metrics.vehicles_by_state[static_cast<size_t>(existing->second.current_state)].add(-1);
+            heartbeat_timer = existing->second.heartbeat_timer;
+        }
+        VehicleProfile& profile = vehicle_profiles[vehicle_id] = VehicleProfile(vehicle_id, make_model, license_plate, now());
+        profile.heartbeat_timer = heartbeat_timer;
+        armHeartbeat(profile, toEpochMillis(profile.last_seen));
+        pipeline_metrics.vehicles_by_state[static_cast<size_t>(VehicleState::NORMAL)].add(1);
+        live_feed.registerVehicle(vehicle_id, make_model, license_plate);
+        if (shared_fleet.isOpen()) publishSharedVehicle(vehicle_profiles[vehicle_id], nullptr);
+    }
+    
+    void setGeofences(const std::vector<Geofence>& fences) {
+        std::lock_guard<std::mutex> lock(data_mutex);
+        geofences = fences;
+        rebuildGeofenceIndex();
+    }
+    FleetFeed& getLiveFeed() { return live_feed; }
+    
+    // Starts publishing the fleet state table in the POSIX shared-memory
+    // segment `name`, seeded with every known vehicle. Vehicles beyond
+    // `capacity` are not published.
+    bool publishSharedState(const std::string& name, uint32_t capacity, std::string& error) {
+        std::lock_guard<std::mutex> lock(data_mutex);
+        if (!shared_fleet.open(name, capacity, error)) return false;
+        for (const auto& pair : vehicle_profiles) {
+            publishSharedVehicle(pair.second, nullptr);
+        }
+        return true;
+    }
+    
+    void closeSharedState() {
+        std::lock_guard<std::mutex> lock(data_mutex);
+        shared_fleet.close();
+    }
+    
+    // Restores anomalies and profile counters from the journal directory
+    // (snapshot, then the journals after it), compacts them into a new
+    // snapshot, and journals every change from then on. Call before readings
+    // flow.
+    bool openJournal(const JournalConfig& config, JournalRecovery& recovery, std::string& error) {
+        std::lock_guard<std::mutex> lock(data_mutex);
+        bool recovered = recoverJournal(config.directory,
+            [this](const char* data, size_t size) { applyJournalSnapshot(data, size); },
+            [this](uint8_t type, const char* data, size_t size) { applyJournalRecord(type, data, size); },
+            recovery, error);
+        if (!recovered) return false;
+        journal_settings = config;
+        return journal.open(config, recovery.next_generation, journalSnapshotBuilder()(), error);
+    }
+    
+    // Checkpoints and closes the journal; a clean shutdown recovers from the
+    // snapshot alone
+    void closeJournal() {
+        std::lock_guard<std::mutex> lock(data_mutex);
+        if (!journal.isOpen()) return;
+        journal.checkpoint(journalSnapshotBuilder());
+        journal.close();
+    }
+    
+    // Sends every anomaly recorded from now on to the sinks, each priority
+    // queued and dropped as `config` says
+    bool startAlertDispatch(const DispatchConfig& config, std::vector<std::unique_ptr<AlertSink>> sinks,
+                            std::string& error) {
+        std::lock_guard<std::mutex> lock(data_mutex);
+        return alert_dispatcher.start(config, std::move(sinks), error);
+    }
+    
+    // Delivers the alerts still queued, then stops
+    void stopAlertDispatch() {
+        std::lock_guard<std::mutex> lock(data_mutex);
+        alert_dispatcher.stop();
+    }
+    
+    std::vector<int> getActiveVehicleIds() {
+        std::lock_guard<std::mutex> lock(data_mutex);
+        std::vector<int> ids;
+        for (const auto& p : vehicle_profiles) { 
+            ids.push_back(p.first); 
+        }
+        return ids;
+    }
+    
+    FleetStatus getFleetStatus() {
+        std::lock_guard<std::mutex> lock(data_mutex);
+        FleetStatus status;
+        status.readings = total_readings_processed;
+        status.anomalies = total_anomalies_detected;
+        status.vehicles = vehicle_profiles.size();
+        status.geofences = geofences.size();
+        status.ingest = event_time_counters;
+        for (const auto& pair : ingest_states) status.buffered += pair.second.reorder.size();
+        status.allowed_lateness_ms = event_time_config.allowed_lateness_ms;
+        status.open_alerts = alert_tracker.openCount();
+        status.alerts = alert_tracker.getCounters();
+        
+        // Memory usage estimation
+        for (const auto& pair : vehicle_data_windows) {
+            status.memory_bytes += pair.second.size() * sizeof(SensorReading);
+        }
+        for (const auto& pair : detected_anomalies) {
+            status.memory_bytes += pair.second.size() * sizeof(AnomalyRecord);
+        }
+        status.memory_bytes += anomalyTextPool().bytes();
+        for (const auto& pair : vehicle_histories) {
+            status.history_samples += pair.second.sampleCount();
+            status.history_bytes += pair.second.compressedBytes();
+        }
+        for (const auto& pair : trip_trackers) {
+            status.trips += pair.second.completedTrips().size();
+            status.trip_bytes += pair.second.storedBytes();
+            status.trip_raw_bytes += pair.second.rawBytes();
+        }
+        status.memory_bytes += status.history_bytes + status.trip_bytes;
+        status.heap_allocations = heapAllocationCount();
+        status.pipeline_allocations = pipeline_allocations;
+        status.scratch_bytes = ml_detector.scratchCapacity();
+        status.memory_bytes += status.scratch_bytes;
+        const OverloadStats load = overload.stats();
+        status.degraded_mode = static_cast<uint64_t>(load.mode);
+        status.mode_transitions = load.transitions;
+        status.shed = load.shed;
+        status.ingest_latency_us = load.latency_us;
+        for (const auto& pair : vehicle_profiles) {
+            if (pair.second.current_state == VehicleState::OFFLINE) status.offline++;
+        }
+        status.offline_events = offline_events;
+        return status;
+    }
+    
+    void printSystemStatus() {
+        FleetStatus status = getFleetStatus();
+        std::cout << "\n=== SYSTEM STATUS ===\n";
+        std::cout << "Running: " << (running ? "Yes" : "No") << "\n";
+        std::cout << "Paused: " << (paused ? "Yes" : "No") << "\n";
+        printFleetStatus(status);
+        printAlertDispatch();
+    }
+    
+    // Per-priority dispatch outcomes, if anything was dispatched
+    void printAlertDispatch() {
+        std::array<DispatchLevelStats, DISPATCH_LEVELS> levels;
+        uint64_t enqueued = 0;
+        for (size_t i = 0; i < DISPATCH_LEVELS; ++i) {
+            levels[i] = alert_dispatcher.stats(static_cast<int>(i) + 1);
+            enqueued += levels[i].enqueued;
+        }
+        if (enqueued == 0) return;
+        std::cout << "Alert Dispatch:\n";
+        for (int priority = static_cast<int>(DISPATCH_LEVELS); priority >= 1; --priority) {
+            const DispatchLevelStats& s = levels[static_cast<size_t>(priority - 1)];
+            if (s.enqueued == 0) continue;
+            std::cout << "  " << std::left << std::setw(10)
+                      << priorityName(static_cast<AlertPriority>(priority)) << std::right
+                      << " delivered " << s.delivered << "/" << s.enqueued
+                      << ", dropped " << s.dropped << ", failed " << s.failed
+                      << ", queued " << s.queued
+                      << ", p99 <= " << std::fixed << std::setprecision(3) << s.p99_ms << " ms"
+                      << ", max " << s.max_ms << " ms"
+                      << ", SLO misses " << s.slo_misses << "\n";
+        }
+    }
+    
+    static void printFleetStatus(const FleetStatus& status) {
+        std::cout << "Total Readings: " << status.readings << "\n";
+        std::cout << "Total Anomalies: " << status.anomalies << "\n";
+        std::cout << "Active Vehicles: " << status.vehicles << " (" << status.offline << " offline, "
+                  << status.offline_events << " went offline)\n";
+        std::cout << "Geofences: " << status.geofences << "\n";
+        
+        std::cout << "Event-Time Ingest: accepted " << status.ingest.accepted
+                  << ", reordered " << status.ingest.reordered
+                  << ", duplicates " << status.ingest.duplicates
+                  << ", late dropped " << status.ingest.late_dropped
+                  << ", forced " << status.ingest.forced_releases
+                  << ", buffered " << status.buffered
+                  << " (lateness " << status.allowed_lateness_ms << " ms)\n";
+        
+        std::cout << "Open Alerts: " << status.open_alerts
+                  << " (opened " << status.alerts.opened << ", summaries " << status.alerts.summaries
+                  << ", cleared " << status.alerts.cleared << ", reopened " << status.alerts.reopened
+                  << ", deduplicated " << status.alerts.deduplicated
+                  << ", rate limited " << status.alerts.rate_limited << ")\n";
+        
+        std::cout << "History Samples: " << status.history_samples << " ("
+                  << std::fixed << std::setprecision(2)
+                  << static_cast<double>(status.history_bytes) / std::max<uint64_t>(1, status.history_samples)
+                  << " bytes/sample)\n";
+        std::cout << "Completed Trips: " << status.trips << " (" << status.trip_bytes
+                  << " bytes stored, " << status.trip_raw_bytes << " bytes raw)\n";
+        std::cout << "Estimated Memory Usage: " << status.memory_bytes / 1024 / 1024 << " MB\n";
+        if (status.heap_allocations > 0) {
+            std::cout << "Heap Allocations: " << status.heap_allocations << " total, "
+                      << status.pipeline_allocations << " in reading pipeline ("
+                      << std::setprecision(3)
+                      << static_cast<double>(status.pipeline_allocations) / std::max<uint64_t>(1, status.readings)
+                      << " per reading), " << status.scratch_bytes / 1024 << " KB scratch\n";
+        }
+        std::cout << "Load: " << degradedModeName(static_cast<DegradedMode>(status.degraded_mode))
+                  << " mode (" << status.mode_transitions << " transitions), ingest latency "
+                  << std::setprecision(3) << status.ingest_latency_us / 1000.0 << " ms; shed "
+                  << status.shed[static_cast<size_t>(ShedWork::ML_SCORING)] << " ML scorings, "
+                  << status.shed[static_cast<size_t>(ShedWork::LOG_ROWS)] << " log rows, "
+                  << status.shed[static_cast<size_t>(ShedWork::ANALYTICS)] << " analytics updates, "
+                  << status.shed[static_cast<size_t>(ShedWork::DUPLICATE_READINGS)] << " duplicate readings\n";
+    }
+    
+    // Consistent copy of every vehicle's summary, ordered by vehicle ID
+    std::vector<VehicleSummary> getVehicleSummaries() {
+        std::vector<VehicleSummary> summaries;
+        {
+            std::lock_guard<std::mutex> lock(data_mutex);
+            summaries.reserve(vehicle_profiles.size());
+            for (const auto& pair : vehicle_profiles) {
+                const auto& profile = pair.second;
+                summaries.push_back({pair.first, profile.make_model, profile.license_plate, profile.current_state,
+                                     profile.total_distance_km, profile.avg_speed, profile.max_speed_recorded,
+                                     profile.total_anomalies, profile.harsh_events_count,
+                                     profile.eco.totals(EcoWindow::LIFETIME).litresPer100Km(options.eco),
+                                     profile.eco.score(EcoWindow::LIFETIME, options.eco).score,
+                                     profile.eco.score(EcoWindow::TRIP, options.eco).score,
+                                     profile.eco.score(EcoWindow::DAY, options.eco).score});
+            }
+        }
+        std::sort(summaries.begin(), summaries.end(), [](const VehicleSummary& a, const VehicleSummary& b) {
+            return a.vehicle_id < b.vehicle_id;
+        });
+        return summaries;
+    }
+    
+    void exportSystemReport(const std::string& filename) {
+        ReportOptions report_options;
+        report_options.format = reportFormatFor(filename);
+        exportSystemReport(filename, report_options);
+    }
+    
+    // The vehicle list and status are one consistent snapshot. Analytics are
+    // copied per chunk as the chunk is formatted, each under a short hold of
+    // data_mutex, so ingestion keeps running while the report is written.
+    void exportSystemReport(const std::string& filename, const ReportOptions& report_options) {
+        auto start = std::chrono::steady_clock::now();
+        FleetStatus status = getFleetStatus();
+        std::vector<VehicleSummary> vehicles = getVehicleSummaries();
+        ReportAnalyticsSource analytics_source;
+        if (report_options.include_analytics) {
+            analytics_source = [this](const VehicleSummary* first, size_t count, std::vector<ReportAnalytics>& out) {
+                collectReportAnalytics(first, count, out);
+            };
+        }
+        uint64_t bytes = 0;
+        if (writeSystemReport(filename, now(), status, vehicles, report_options, analytics_source, &bytes)) {
+            auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            std::cout << "System report exported to " << filename << " (" << vehicles.size() << " vehicles, "
+                      << std::fixed << std::setprecision(1) << bytes / 1048576.0 << " MB, "
+                      << elapsed << " ms)\n";
+        }
+    }
+    
+    // Writes a report from already collected data; `analytics` may be empty
+    // (no per-vehicle statistics)
+    static bool writeSystemReport(const std::string& filename, std::chrono::system_clock::time_point generated,
+                                  const FleetStatus& status, const std::vector<VehicleSummary>& vehicles,
+                                  const ReportOptions& report_options = ReportOptions(),
+                                  const ReportAnalyticsSource& analytics = nullptr, uint64_t* bytes_written = nullptr) {
+        std::FILE* report = std::fopen(filename.c_str(), "wb");
+        if (!report) {
+            std::cerr << "Error: Could not create report file " << filename << "\n";
+            return false;
+        }
+        
+        const ReportFormat format = report_options.format;
+        ReportBuffer head;
+        if (format == ReportFormat::TEXT) {
+            head.append("=== VEHICLE TELEMATICS SYSTEM REPORT ===\n");
+            head.append("Generated: ").append(formatTimestamp(generated)).append("\n\n");
+            head.append("SYSTEM OVERVIEW:\n");
+            head.append("Total Readings Processed: ").appendInt(static_cast<int64_t>(status.readings)).append('\n');
+            head.append("Total Anomalies Detected: ").appendInt(static_cast<int64_t>(status.anomalies)).append('\n');
+            head.append("Active Vehicles: ").appendInt(static_cast<int64_t>(status.vehicles)).append("\n\n");
+            head.append("VEHICLE SUMMARY:\n");
+        } else if (format == ReportFormat::CSV) {
+            head.append("vehicle_id,make_model,license_plate,state,total_distance_km,avg_speed,max_speed,"
+                        "total_anomalies,harsh_events,l_per_100km,eco_score,eco_trip,eco_day");
+            if (analytics) {
+                for (const char* channel : REPORT_CHANNELS) {
+                    for (const char* stat : {"mean", "median", "std_dev", "min", "max", "p95", "trend", "cv", "outliers"}) {
+                        head.append(',').append(channel).append('_').append(stat);
+                    }
+                }
+            }
+            head.append('\n');
+        } else {
+            std::string generated_iso;
+            feed_json::appendIsoTime(generated_iso, toEpochMillis(generated));
+            head.append("{\"generated\":").append(generated_iso);
+            head.append(",\"overview\":{\"readings\":").appendInt(static_cast<int64_t>(status.readings));
+            head.append(",\"anomalies\":").appendInt(static_cast<int64_t>(status.anomalies));
+            head.append(",\"vehicles\":").appendInt(static_cast<int64_t>(status.vehicles));
+            head.append("},\"vehicles\":[");
+        }
+        bool ok = std::fwrite(head.str().data(), 1, head.size(), report) == head.size();
+        
+        auto formatChunk = [&](size_t begin, size_t end, ReportBuffer& out) {
+            std::vector<ReportAnalytics> stats;
+            if (analytics) analytics(vehicles.data() + begin, end - begin, stats);
+            for (size_t i = begin; i < end; ++i) {
+                const ReportAnalytics* vehicle_stats = analytics ? &stats[i - begin] : nullptr;
+                if (format == ReportFormat::TEXT) formatReportText(out, vehicles[i], vehicle_stats);
+                else if (format == ReportFormat::CSV) formatReportCsv(out, vehicles[i], vehicle_stats);
+                else formatReportJson(out, vehicles[i], vehicle_stats, i == 0);
+            }
+        };
+        ChunkWriteStats chunk_stats;
+        std::string error;
+        ok = ok && writeChunksInOrder(report, vehicles.size(), report_options.chunk_vehicles, report_options.threads,
+                                      formatChunk, chunk_stats, error);
+        if (ok && format == ReportFormat::JSON) ok = std::fwrite("\n]}\n", 1, 4, report) == 4;
+        ok = std::fclose(report) == 0 && ok;
+        if (!ok) {
+            std::cerr << "Error: Could not write report file " << filename
+                      << (error.empty() ? "" : ": " + error) << "\n";
+            return false;
+        }
+        if (bytes_written) *bytes_written = head.size() + chunk_stats.bytes;
+        return true;
+    }
+    
+    // Most recent severity-5 anomaly records across the fleet, newest first
+    std::vector<AnomalyRecord> getCriticalAlerts(size_t limit) {
+        std::lock_guard<std::mutex> lock(data_mutex);
+        std::vector<AnomalyRecord> critical;
+        for (const auto& pair : detected_anomalies) {
+            for (const auto& anomaly : pair.second) {
+                if (anomaly.severity >= 5) critical.push_back(anomaly);
+            }
+        }
+        keepNewest(critical, limit);
+        return critical;
+    }
+    
+    static void keepNewest(std::vector<AnomalyRecord>& records, size_t limit) {
+        auto newer = [](const AnomalyRecord& a, const AnomalyRecord& b) {
+            return a.timestamp > b.timestamp || (a.timestamp == b.timestamp && a.vehicle_id < b.vehicle_id);
+        };
+        if (records.size() > limit) {
+            std::partial_sort(records.begin(), records.begin() + limit, records.end(), newer);
+            records.erase(records.begin() + limit, records.end());
+        } else {
+            std::sort(records.begin(), records.end(), newer);
+        }
+    }
+    
+    static void printCriticalAlerts(const std::vector<AnomalyRecord>& alerts) {
+        std::cout << "\n=== CRITICAL ALERTS ===\n";
+        if (alerts.empty()) {
+            std::cout << "No critical alerts.\n";
+            return;
+        }
+        for (const auto& alert : alerts) {
+            std::cout << "[" << alert.getTimestampString() << "] Vehicle " << alert.vehicle_id
+                      << " - " << alert.getTypeString() << " (" << alert.sensor_name << " = "
+                      << std::fixed << std::setprecision(2) << alert.value << "): "
+                      << alert.description << "\n";
+        }
+    }
+    
+    // Columnar export for offline analysis: <prefix>_readings.arrow,
+    // <prefix>_anomalies.arrow and <prefix>_vehicles.arrow (Arrow IPC / Feather v2)
+    void exportArrow(const std::string& prefix) {
+        auto start = std::chrono::steady_clock::now();
+        std::string error;
+        int64_t readings = 0, anomalies = 0, vehicles = 0;
+        if (!exportVehiclesArrow(prefix + "_vehicles.arrow", vehicles, error) ||
+            !exportAnomaliesArrow(prefix + "_anomalies.arrow", anomalies, error) ||
+            !exportReadingsArrow(prefix + "_readings.arrow", readings, error)) {
+            std::cerr << "Error: Arrow export failed: " << error << "\n";
+            return;
+        }
+        auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Arrow export to " << prefix << "_*.arrow: " << readings << " readings, "
+                  << anomalies << " anomalies, " << vehicles << " vehicles ("
+                  << std::fixed << std::setprecision(1) << elapsed << " ms)\n";
+    }
+    
+private:
+    static constexpr const char* REPORT_CHANNELS[AdvancedAnalytics::TREND_COUNT] = {
+        "speed", "rpm", "temperature", "fuel", "acceleration"};
+    static constexpr const char* REPORT_UNITS[AdvancedAnalytics::TREND_COUNT] = {
+        "km/h", "RPM", "°C", "%", "m/s²"};
+    
+    void collectReportAnalytics(const VehicleSummary* vehicles, size_t count, std::vector<ReportAnalytics>& out) {
+        std::vector<AdvancedAnalytics::Trends> trends(count);
+        {
+            std::lock_guard<std::mutex> lock(data_mutex);
+            for (size_t i = 0; i < count; ++i) trends[i] = analytics.copyTrends(vehicles[i].vehicle_id);
+        }
+        out.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            for (size_t c = 0; c < AdvancedAnalytics::TREND_COUNT; ++c) {
+                out[i][c] = AdvancedAnalytics::calculateStatistics(trends[i][c]);
+            }
+        }
+    }
+    
+    static void formatReportText(ReportBuffer& out, const VehicleSummary& v, const ReportAnalytics* stats) {
+        out.append("Vehicle ").appendInt(v.vehicle_id).append(" (").append(v.make_model).append("):\n");
+        out.append("  State: ").append(stateName(v.state)).append('\n');
+        out.append("  Distance: ").appendFixed(v.total_distance_km).append(" km\n");
+        out.append("  Average Speed: ").appendFixed(v.avg_speed).append(" km/h\n");
+        out.append("  Max Speed: ").appendFixed(v.max_speed).append(" km/h\n");
+        out.append("  Anomalies: ").appendInt(v.total_anomalies).append('\n');
+        out.append("  Harsh Events: ").appendInt(v.harsh_events_count).append('\n');
+        out.append("  Fuel Use: ");
+        if (std::isfinite(v.l_per_100km)) out.appendFixed(v.l_per_100km).append(" l/100km\n");
+        else out.append(MISSING_VALUE).append('\n');
+        out.append("  Eco Score: ").appendFixedOr(v.eco_score, 1, MISSING_VALUE)
+           .append(" (trip ").appendFixedOr(v.eco_trip_score, 1, MISSING_VALUE)
+           .append(", today ").appendFixedOr(v.eco_day_score, 1, MISSING_VALUE).append(")\n");
+        if (stats) {
+            for (size_t c = 0; c < AdvancedAnalytics::TREND_COUNT; ++c) {
+                const auto& s = (*stats)[c];
+                out.append("  ").append(REPORT_CHANNELS[c]).append(" - Mean: ").appendFixed(s.mean)
+                   .append(' ').append(REPORT_UNITS[c]).append(", Median: ").appendFixed(s.median)
+                   .append(", Std Dev: ").appendFixed(s.std_deviation)
+                   .append(", Min: ").appendFixed(s.min_val).append(", Max: ").appendFixed(s.max_val)
+                   .append(", P95: ").appendFixed(s.percentile_95)
+                   .append(", CV: ").appendFixed(s.coefficient_of_variation)
+                   .append(", Outliers: ").appendInt(s.outlier_count)
+                   .append(", Trend: ").appendFixed(s.trend_slope, 4).append('\n');
+            }
+        }
+        out.append('\n');
+    }
+    
+    static void formatReportCsv(ReportBuffer& out, const VehicleSummary& v, const ReportAnalytics* stats) {
+        out.appendInt(v.vehicle_id).append(',').appendCsvField(v.make_model).append(',')
+           .appendCsvField(v.license_plate).append(',').append(stateName(v.state)).append(',')
+           .appendFixed(v.total_distance_km, 3).append(',').appendFixed(v.avg_speed, 3).append(',')
+           .appendFixed(v.max_speed, 3).append(',').appendInt(v.total_anomalies).append(',')
+           .appendInt(v.harsh_events_count).append(',').appendFixedOr(v.l_per_100km, 3, "").append(',')
+           .appendFixedOr(v.eco_score, 1, "").append(',').appendFixedOr(v.eco_trip_score, 1, "").append(',')
+           .appendFixedOr(v.eco_day_score, 1, "");
+        if (stats) {
+            for (const auto& s : *stats) {
+                out.append(',').appendFixed(s.mean, 3).append(',').appendFixed(s.median, 3)
+                   .append(',').appendFixed(s.std_deviation, 3).append(',').appendFixed(s.min_val, 3)
+                   .append(',').appendFixed(s.max_val, 3).append(',').appendFixed(s.percentile_95, 3)
+                   .append(',').appendFixed(s.trend_slope, 5).append(',').appendFixed(s.coefficient_of_variation, 4)
+                   .append(',').appendInt(s.outlier_count);
+            }
+        }
+        out.append('\n');
+    }
+    
+    static void formatReportJson(ReportBuffer& out, const VehicleSummary& v, const ReportAnalytics* stats, bool first) {
+        out.append(first ? "\n{\"vehicle_id\":" : ",\n{\"vehicle_id\":").appendInt(v.vehicle_id);
+        out.append(",\"make_model\":").appendJsonString(v.make_model);
+        out.append(",\"license_plate\":").appendJsonString(v.license_plate);
+        out.append(",\"state\":\"").append(stateName(v.state)).append('"');
+        out.append(",\"total_distance_km\":").appendJsonNumber(v.total_distance_km);
+        out.append(",\"avg_speed\":").appendJsonNumber(v.avg_speed);
+        out.append(",\"max_speed\":").appendJsonNumber(v.max_speed);
+        out.append(",\"total_anomalies\":").appendInt(v.total_anomalies);
+        out.append(",\"harsh_events\":").appendInt(v.harsh_events_count);
+        out.append(",\"l_per_100km\":").appendJsonNumber(v.l_per_100km);
+        out.append(",\"eco_score\":").appendJsonNumber(v.eco_score, 1);
+        out.append(",\"eco_trip\":").appendJsonNumber(v.eco_trip_score, 1);
+        out.append(",\"eco_day\":").appendJsonNumber(v.eco_day_score, 1);
+        if (stats) {
+            out.append(",\"analytics\":{");
+            for (size_t c = 0; c < AdvancedAnalytics::TREND_COUNT; ++c) {
+                const auto& s = (*stats)[c];
+                out.append(c ? ",\"" : "\"").append(REPORT_CHANNELS[c]).append("\":{\"mean\":").appendJsonNumber(s.mean)
+                   .append(",\"median\":").appendJsonNumber(s.median)
+                   .append(",\"std_dev\":").appendJsonNumber(s.std_deviation)
+                   .append(",\"min\":").appendJsonNumber(s.min_val)
+                   .append(",\"max\":").appendJsonNumber(s.max_val)
+                   .append(",\"p95\":").appendJsonNumber(s.percentile_95)
+                   .append(",\"trend\":").appendJsonNumber(s.trend_slope, 5)
+                   .append(",\"cv\":").appendJsonNumber(s.coefficient_of_variation, 4)
+                   .append(",\"outliers\":").appendInt(s.outlier_count).append('}');
+            }
+            out.append('}');
+        }
+        out.append('}');
+    }
+    
+    static const int64_t ARROW_BATCH_ROWS = 65536;
+    
+    bool exportVehiclesArrow(const std::string& path, int64_t& rows, std::string& error) {
+        using namespace arrow_ipc;
+        ArrowSchema schema;
+        const size_t id_col = schema.add("vehicle_id", ArrowType::INT32);
+        const size_t model_col = schema.add("make_model", ArrowType::DICTIONARY);
+        const size_t plate_col = schema.add("license_plate", ArrowType::UTF8);
+        const size_t state_col = schema.add("state", ArrowType::DICTIONARY);
+        const size_t seen_col = schema.add("last_seen", ArrowType::TIMESTAMP_MS);
+        const size_t distance_col = schema.add("total_distance_km", ArrowType::FLOAT64);
+        const size_t avg_col = schema.add("avg_speed", ArrowType::FLOAT64);
+        const size_t max_col = schema.add("max_speed", ArrowType::FLOAT64);
+        const size_t harsh_col = schema.add("harsh_events", ArrowType::INT32);
+        const size_t anomalies_col = schema.add("total_anomalies", ArrowType::INT32);
+        const size_t fuel_used_col = schema.add("fuel_used_l", ArrowType::FLOAT64);
+        const size_t efficiency_col = schema.add("l_per_100km", ArrowType::FLOAT64, true);
+        const size_t idle_col = schema.add("idle_s", ArrowType::FLOAT64);
+        const size_t overspeed_col = schema.add("overspeed_s", ArrowType::FLOAT64);
+        const size_t eco_col = schema.add("eco_score", ArrowType::FLOAT64, true);
+        const size_t eco_trip_col = schema.add("eco_trip", ArrowType::FLOAT64, true);
+        const size_t eco_day_col = schema.add("eco_day", ArrowType::FLOAT64, true);
+        const size_t maintenance_col = schema.add("last_maintenance", ArrowType::TIMESTAMP_MS);
+        const size_t lat_col = schema.add("latitude", ArrowType::FLOAT64, true);
+        const size_t lon_col = schema.add("longitude", ArrowType::FLOAT64, true);
+        for (VehicleState state : {VehicleState::NORMAL, VehicleState::WARNING, VehicleState::CRITICAL,
+                                   VehicleState::OFFLINE, VehicleState::MAINTENANCE}) {
+            schema.dictionary(state_col).add(stateName(state));
+        }
+        
+        // One small batch, filled under the lock
+        ArrowRecordBatch batch(schema);
+        {
+            std::lock_guard<std::mutex> lock(data_mutex);
+            std::vector<const VehicleProfile*> profiles;
+            for (const auto& pair : vehicle_profiles) profiles.push_back(&pair.second);
+            std::sort(profiles.begin(), profiles.end(), [](const VehicleProfile* a, const VehicleProfile* b) {
+                return a->vehicle_id < b->vehicle_id;
+            });
+            for (const VehicleProfile* p : profiles) schema.dictionary(model_col).add(p->make_model);
+            // Figures a vehicle has too little data for are null
+            auto appendOptional = [&batch](size_t col, double value) {
+                if (std::isnan(value)) batch.appendNull(col);
+                else batch.appendDouble(col, value);
+            };
+            for (const VehicleProfile* p : profiles) {
+                batch.appendInt(id_col, p->vehicle_id);
+                batch.appendString(model_col, p->make_model);
+                batch.appendString(plate_col, p->license_plate);
+                batch.appendString(state_col, stateName(p->current_state));
+                batch.appendInt(seen_col, toEpochMillis(p->last_seen));
+                batch.appendDouble(distance_col, p->total_distance_km);
+                batch.appendDouble(avg_col, p->avg_speed);
+                batch.appendDouble(max_col, p->max_speed_recorded);
+                batch.appendInt(harsh_col, p->harsh_events_count);
+                batch.appendInt(anomalies_col, p->total_anomalies);
+                const EcoTotals& lifetime = p->eco.totals(EcoWindow::LIFETIME);
+                batch.appendDouble(fuel_used_col, lifetime.fuel_litres);
+                batch.appendDouble(idle_col, lifetime.idle_seconds);
+                batch.appendDouble(overspeed_col, lifetime.overspeed_seconds);
+                appendOptional(efficiency_col, lifetime.litresPer100Km(options.eco));
+                appendOptional(eco_col, p->eco.score(EcoWindow::LIFETIME, options.eco).score);
+                appendOptional(eco_trip_col, p->eco.score(EcoWindow::TRIP, options.eco).score);
+                appendOptional(eco_day_col, p->eco.score(EcoWindow::DAY, options.eco).score);
+                batch.appendInt(maintenance_col, toEpochMillis(p->last_maintenance));
+                if (p->has_position) {
+                    batch.appendDouble(lat_col, p->last_position.latitude);
+                    batch.appendDouble(lon_col, p->last_position.longitude);
+                } else {
+                    batch.appendNull(lat_col);
+                    batch.appendNull(lon_col);
+                }
+            }
+        }
+        
+        ArrowFileWriter writer;
+        if (!writer.open(path, schema, error) || !writer.write(batch) || !writer.close(error)) {
+            if (error.empty()) error = "write failed for " + path;
+            return false;
+        }
+        rows = writer.rowsWritten();
+        return true;
+    }
+    
+    bool exportAnomaliesArrow(const std::string& path, int64_t& rows, std::string& error) {
+        using namespace arrow_ipc;
+        ArrowSchema schema;
+        const size_t ts_col = schema.add("timestamp", ArrowType::TIMESTAMP_MS);
+        const size_t id_col = schema.add("vehicle_id", ArrowType::INT32);
+        const size_t model_col = schema.add("make_model", ArrowType::DICTIONARY);
+        const size_t sensor_col = schema.add("sensor", ArrowType::DICTIONARY);
+        const size_t value_col = schema.add("value", ArrowType::FLOAT64);
+        const size_t type_col = schema.add("type", ArrowType::DICTIONARY);
+        const size_t description_col = schema.add("description", ArrowType::UTF8);
+        const size_t severity_col = schema.add("severity", ArrowType::INT8);
+        const size_t priority_col = schema.add("priority", ArrowType::DICTIONARY);
+        const size_t ack_col = schema.add("acknowledged", ArrowType::BOOL);
+        const size_t location_col = schema.add("location", ArrowType::UTF8, true);
+        for (int t = 0; t <= static_cast<int>(AnomalyType::VEHICLE_OFFLINE); ++t) {
+            schema.dictionary(type_col).add(anomalyTypeName(static_cast<AnomalyType>(t)));
+        }
+        for (int p = 1; p <= 5; ++p) {
+            schema.dictionary(priority_col).add(priorityName(static_cast<AlertPriority>(p)));
+        }
+        
+        // First pass fixes the export horizon and the dictionaries, which the
+        // file format needs before the first record batch
+        std::vector<std::pair<int, size_t>> counts;
+        std::unordered_map<int, std::string> models;
+        {
+            std::lock_guard<std::mutex> lock(data_mutex);
+            for (const auto& pair : detected_anomalies) {
+                counts.emplace_back(pair.first, pair.second.size());
+                for (const auto& anomaly : pair.second) schema.dictionary(sensor_col).add(anomaly.sensor_name);
+                auto profile = vehicle_profiles.find(pair.first);
+                models[pair.first] = profile != vehicle_profiles.end() ? profile->second.make_model : "";
+                schema.dictionary(model_col).add(models[pair.first]);
+            }
+        }
+        std::sort(counts.begin(), counts.end());
+        
+        ArrowFileWriter writer;
+        if (!writer.open(path, schema, error)) return false;
+        ArrowRecordBatch batch(schema);
+        for (const auto& count : counts) {
+            const int vehicle_id = count.first;
+            const std::string& make_model = models[vehicle_id];
+            for (size_t begin = 0; begin < count.second;) {
+                // Copy one batch worth under the lock, write outside it
+                {
+                    std::lock_guard<std::mutex> lock(data_mutex);
+                    const auto& records = detected_anomalies[vehicle_id];
+                    size_t end = std::min(count.second, begin + static_cast<size_t>(ARROW_BATCH_ROWS - batch.rows()));
+                    for (; begin < end; ++begin) {
+                        const AnomalyRecord& a = records[begin];
+                        batch.appendInt(ts_col, toEpochMillis(a.timestamp));
+                        batch.appendInt(id_col, vehicle_id);
+                        batch.appendString(model_col, make_model);
+                        batch.appendString(sensor_col, a.sensor_name);
+                        batch.appendDouble(value_col, a.value);
+                        batch.appendString(type_col, anomalyTypeName(a.type));
+                        batch.appendString(description_col, a.description);
+                        batch.appendInt(severity_col, a.severity);
+                        batch.appendString(priority_col, priorityName(a.priority));
+                        batch.appendBool(ack_col, a.acknowledged);
+                        if (a.location_info.empty()) batch.appendNull(location_col);
+                        else batch.appendString(location_col, a.location_info);
+                    }
+                }
+                if (batch.rows() >= ARROW_BATCH_ROWS) {
+                    if (!writer.write(batch)) { error = "write failed for " + path; return false; }
+                    batch.clear();
+                }
+            }
+        }
+        if (!writer.write(batch) || !writer.close(error)) {
+            if (error.empty()) error = "write failed for " + path;
+            return false;
+        }
+        rows = writer.rowsWritten();
+        return true;
+    }
+    
+    // Decoded from the compressed history, i.e. at the configured channel
+    // resolution; one sealed block is decoded at a time
+    bool exportReadingsArrow(const std::string& path, int64_t& rows, std::string& error) {
+        using namespace arrow_ipc;
+        ArrowSchema schema;
+        const size_t ts_col = schema.add("timestamp", ArrowType::TIMESTAMP_MS);
+        const size_t id_col = schema.add("vehicle_id", ArrowType::INT32);
+        const size_t model_col = schema.add("make_model", ArrowType::DICTIONARY);
+        const size_t channel_base = schema.size();
+        for (size_t c = 0; c < HIST_CHANNEL_COUNT; ++c) schema.add(historyChannelName(c), ArrowType::FLOAT64);
+        
+        std::vector<int> ids;
+        std::unordered_map<int, std::string> models;
+        {
+            std::lock_guard<std::mutex> lock(data_mutex);
+            for (const auto& pair : vehicle_histories) {
+                ids.push_back(pair.first);
+                auto profile = vehicle_profiles.find(pair.first);
+                models[pair.first] = profile != vehicle_profiles.end() ? profile->second.make_model : "";
+                schema.dictionary(model_col).add(models[pair.first]);
+            }
+        }
+        std::sort(ids.begin(), ids.end());
+        
+        const int64_t from_ms = std::numeric_limits<int64_t>::min();
+        const int64_t to_ms = std::numeric_limits<int64_t>::max();
+        const uint64_t all_channels = (1ULL << HIST_CHANNEL_COUNT) - 1;
+        
+        ArrowFileWriter writer;
+        if (!writer.open(path, schema, error)) return false;
+        ArrowRecordBatch batch(schema);
+        VehicleHistoryColumns columns;
+        auto append = [&](int vehicle_id) {
+            const std::string& make_model = models[vehicle_id];
+            for (size_t i = 0; i < columns.size(); ++i) {
+                batch.appendInt(ts_col, columns.timestamps_ms[i]);
+                batch.appendInt(id_col, vehicle_id);
+                batch.appendString(model_col, make_model);
+                for (size_t c = 0; c < HIST_CHANNEL_COUNT; ++c) {
+                    batch.appendDouble(channel_base + c, columns.channels[c][i]);
+                }
+            }
+            columns.clear();
+            if (batch.rows() < ARROW_BATCH_ROWS) return true;
+            bool ok = writer.write(batch);
+            batch.clear();
+            return ok;
+        };
+        
+        for (int vehicle_id : ids) {
+            std::vector<std::shared_ptr<const VehicleHistory::SealedBlock>> sealed;
+            VehicleHistoryColumns open_columns;
+            VehicleHistory::Config config;
+            {
+                std::lock_guard<std::mutex> lock(data_mutex);
+                auto it = vehicle_histories.find(vehicle_id);
+                it->second.snapshotSealed(from_ms, to_ms, sealed);
+                it->second.decodeOpen(from_ms, to_ms, open_columns, all_channels);
+                config = it->second.getConfig();
+            }
+            bool ok = true;
+            for (const auto& block : sealed) {
+                VehicleHistory::decodeBlock(*block, config, from_ms, to_ms, columns, all_channels);
+                ok = ok && append(vehicle_id);
+            }
+            columns = std::move(open_columns);
+            ok = ok && append(vehicle_id);
+            if (!ok) {
+                error = "write failed for " + path;
+                return false;
+            }
+        }
+        if (!writer.write(batch) || !writer.close(error)) {
+            if (error.empty()) error = "write failed for " + path;
+            return false;
+        }
+        rows = writer.rowsWritten();
+        return true;
+    }
+};
+
+// Feeds synthetic readings (with simulated link duplicates and delays) until
+// the manager is stopped
+void enhanced_simulation_thread(AdvancedDataManager& data_manager);
+
+// Fleet-time replay against a SimulatedClock: every vehicle reports once per
+// report_interval_s of simulated time, staggered so the load is flat
+struct SimulatedRunConfig {
+    size_t fleet_size = 10000;
+    double hours = 24.0;
+    int report_interval_s = 30;
+    double anomaly_rate = 0.03;
+    uint32_t seed = 0;              // 0 = std::random_device
+};
+
+// Advances `clock` one simulated second at a time and processes each
+// second's readings without sleeping. `data_manager` must be built with
+// DataManagerOptions::clock = &clock. Returns early if the manager is stopped.
+void simulated_fleet_run(AdvancedDataManager& data_manager, SimulatedClock& clock,
+                         const SimulatedRunConfig& config);
+
+// Partitioned deployment: the coordinator spawns `partitions` engine
+// processes of this executable, each owning a contiguous vehicle ID range,
+// routes simulated readings to them over Unix domain sockets and answers
+// fleet-wide commands by merging their partial results
+struct PartitionedConfig {
+    size_t partitions = 4;
+    int fleet_size = 1000;
+    double readings_per_second = 200.0;
+    uint32_t seed = 0;              // 0 = std::random_device; partition i uses seed + i
+};
+
+struct PartitionWorkerConfig {
+    std::string socket_path;
+    int first_id = 1;
+    int last_id = 1;
+    uint32_t seed = 0;
+};
+
+// Both return a process exit code
+int partitioned_coordinator_main(const PartitionedConfig& config);
+int partition_worker_main(const PartitionWorkerConfig& config);
@@ -0,0 +1,41 @@
+#include "advanced_telematics.hpp"
+
+#include <cstdlib>
+#include <new>
+
+// ============================================================================
+// HEAP ALLOCATION COUNTING
+// ============================================================================
+//
+// Replaces the global operator new so `status`, the metrics endpoint and the
+// benchmarks can report how often the pipeline reaches the heap. The array,
+// nothrow and sized forms all route through these two. One relaxed atomic
+// increment per allocation; configure with -DTELEMATICS_COUNT_ALLOCATIONS=OFF
+// to keep the standard library's operator new.
+
+#if defined(TELEMATICS_COUNT_ALLOCATIONS)
+
+static std::atomic<uint64_t> heap_allocations{0};
+static thread_local uint64_t thread_heap_allocations = 0;
+
+void* operator new(std::size_t size) {
+    heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    thread_heap_allocations++;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+bool heapAllocationCountAvailable() { return true; }
+uint64_t heapAllocationCount() { return heap_allocations.load(std::memory_order_relaxed); }
+uint64_t threadHeapAllocationCount() { return thread_heap_allocations; }
+
+#else
+
+bool heapAllocationCountAvailable() { return false; }
+uint64_t heapAllocationCount() { return 0; }
+uint64_t threadHeapAllocationCount() { return 0; }
+
+#endif
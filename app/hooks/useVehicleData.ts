@@ -3,6 +3,17 @@
 import { useState, useEffect, useCallback } from "react"
 import type { Vehicle, Anomaly, SystemStats, VehicleAnalytics, SensorReading } from "../types/vehicle"
 
+// Engine live feed (Server-Sent Events), e.g. http://127.0.0.1:8787/events.
+// When unset the dashboard runs its built-in simulation.
+const FEED_URL = process.env.NEXT_PUBLIC_TELEMATICS_FEED_URL
+
+interface FeedMessage {
+  seq: number
+  vehicles: Vehicle[] // deltas omit makeModel and licensePlate
+  anomalies: Anomaly[]
+  stats: Pick<SystemStats, "totalReadings" | "totalAnomalies" | "readingsPerSecond">
+}
+
 // Vehicle models and license plates
 const VEHICLE_DATA = [
   { makeModel: "Honda Civic", licensePlate: "ABC-123" },
@@ -64,6 +75,8 @@ export function useVehicleData() {
 
   // Initialize vehicles
   useEffect(() => {
+    if (FEED_URL) return
+
     const initialVehicles: Vehicle[] = VEHICLE_DATA.slice(0, 20).map((data, index) => ({
       id: index + 1,
       makeModel: data.makeModel,
@@ -158,9 +171,56 @@ export function useVehicleData() {
     }
   }, [])
 
+  // Live feed: a snapshot replaces the fleet, deltas carry only changed vehicles
+  // and new anomalies. Pausing closes the stream; resuming resubscribes and
+  // starts again from a fresh snapshot.
+  useEffect(() => {
+    if (!FEED_URL || !isRunning || isPaused) return
+
+    const addEvent = (type: "info" | "warning" | "error", message: string) =>
+      setSystemStats((prev) => ({
+        ...prev,
+        recentEvents: [{ timestamp: new Date().toLocaleTimeString(), type, message }, ...prev.recentEvents.slice(0, 9)],
+      }))
+
+    const source = new EventSource(FEED_URL)
+
+    source.addEventListener("snapshot", (event) => {
+      const message: FeedMessage = JSON.parse((event as MessageEvent).data)
+      setVehicles(message.vehicles)
+      setAnomalies(message.anomalies)
+      setSystemStats((prev) => ({ ...prev, ...message.stats }))
+      addEvent("info", `Live feed connected: ${message.vehicles.length} vehicles`)
+    })
+
+    source.addEventListener("delta", (event) => {
+      const message: FeedMessage = JSON.parse((event as MessageEvent).data)
+      if (message.vehicles.length > 0) {
+        const changed = new Map(message.vehicles.map((v) => [v.id, v]))
+        setVehicles((prev) =>
+          prev.map((vehicle) => {
+            const update = changed.get(vehicle.id)
+            return update ? { ...vehicle, ...update } : vehicle
+          }),
+        )
+      }
+      if (message.anomalies.length > 0) {
+        setAnomalies((prev) => [...prev, ...message.anomalies].slice(-1000))
+      }
+      setSystemStats((prev) => ({ ...prev, ...message.stats }))
+    })
+
+    source.onerror = () => {
+      // EventSource reconnects on its own and the server resends a snapshot
+      addEvent("warning", "Live feed disconnected, retrying")
+    }
+
+    return () => source.close()
+  }, [isRunning, isPaused])
+
   // Simulation loop
   useEffect(() => {
-    if (!isRunning || isPaused) return
+    if (FEED_URL || !isRunning || isPaused) return
 
     const interval = setInterval(() => {
       // Update vehicle data
@@ -232,8 +292,9 @@ export function useVehicleData() {
     return () => clearInterval(interval)
   }, [isRunning, isPaused, vehicles, generateSensorReading, generateAnomaly, startTime])
 
-  // Update total anomalies in system stats
+  // Update total anomalies in system stats (the live feed reports its own)
   useEffect(() => {
+    if (FEED_URL) return
     setSystemStats((prev) => ({
       ...prev,
       totalAnomalies: anomalies.length,
@@ -0,0 +1,1218 @@
+// Microbenchmarks for the engine's hot functions.
+//
+//   telematics_bench [--filter <substring>] [--window 50,200,1000]
+//                    [--fleet 20,200,2000] [--geofences 4,64,512]
+//                    [--journal-records 1000000]
+//                    [--repetitions 5] [--min-time-ms 100] [--iterations N]
+//                    [--seed 42] [--logs] [--json <file>]
+//   telematics_bench --check-allocations <per-reading budget> [--fleet N]
+//                    [--anomaly-percent 3] ...
+//
+// Each case first runs untimed warm-up passes that also calibrate the
+// iteration count to --min-time-ms (or use --iterations to pin it), then
+// --repetitions timed runs of that fixed count. All inputs come from
+// generators seeded with --seed, so the same binary and arguments replay the
+// same work. Results are printed as a table and, with --json, written to a
+// file meant to be diffed between commits. Heap allocations made through
+// operator new during the timed runs are reported per operation (the engine
+// counts them when built with TELEMATICS_COUNT_ALLOCATIONS).
+//
+// --check-allocations runs no benchmarks: it feeds a warmed-up pipeline a
+// stream with --anomaly-percent injected scenarios (3 by default, like the
+// simulator) and exits non-zero if it allocates more per reading than the
+// given budget. CTest runs it as the steady_state_allocations test.
+
+#include "advanced_telematics.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+// Reaches the private pipeline stages that have no public entry point
+class TelematicsBenchmarkAccess {
+public:
+    static void checkGeofenceViolations(AdvancedDataManager& manager, const SensorReading& reading) {
+        manager.checkGeofenceViolations(reading);
+    }
+
+    // Journals the vehicle's counters the way the pipeline does after a reading
+    static void journalProfile(AdvancedDataManager& manager, int vehicle_id) {
+        manager.journalProfile(manager.vehicle_profiles[vehicle_id]);
+    }
+
+    // Feeds only the analytics trends, without the rest of the pipeline
+    static void updateTrends(AdvancedDataManager& manager, const SensorReading& reading) {
+        manager.analytics.updateTrends(reading.vehicle_id, reading);
+    }
+
+    static void recordAnomaly(AdvancedDataManager& manager, int vehicle_id) {
+        manager.recordAnomaly(vehicle_id, "speed", 182.0, AnomalyType::SPEED_OUT_OF_RANGE,
+                              "Speed out of range", 4, "", 0.0, "NEW");
+    }
+
+    // Stops journaling without a checkpoint, leaving the directory as a crash would
+    static void abandonJournal(AdvancedDataManager& manager) {
+        manager.journal.close();
+    }
+
+    // The recovery half of openJournal(), without compacting the directory
+    static bool replayJournal(AdvancedDataManager& manager, const std::string& directory,
+                              JournalRecovery& recovery, std::string& error) {
+        return recoverJournal(directory,
+            [&](const char* data, size_t size) { manager.applyJournalSnapshot(data, size); },
+            [&](uint8_t type, const char* data, size_t size) { manager.applyJournalRecord(type, data, size); },
+            recovery, error);
+    }
+};
+
+namespace {
+
+struct BenchOptions {
+    std::string filter;
+    std::vector<size_t> windows = {50, 200, 1000};
+    std::vector<size_t> fleets = {20, 200, 2000};
+    std::vector<size_t> geofence_counts = {4, 64, 512};
+    std::vector<size_t> journal_records = {1000000};
+    int repetitions = 5;
+    double min_time_ms = 100.0;
+    uint64_t iterations = 0;        // 0 = calibrate
+    uint32_t seed = 42;
+    bool write_logs = false;
+    std::string json_path;
+    double allocation_budget = -1.0;   // --check-allocations; < 0 = run the benchmarks
+    unsigned anomaly_percent = 3;      // share of readings with an injected scenario there
+};
+
+struct BenchResult {
+    std::string name;
+    std::vector<std::pair<std::string, size_t>> params;
+    uint64_t iterations = 0;
+    std::vector<double> ns_per_op;  // one entry per repetition
+    double allocs_per_op = 0.0;     // over all timed repetitions
+
+    BenchResult(std::string name_, std::vector<std::pair<std::string, size_t>> params_)
+        : name(std::move(name_)), params(std::move(params_)) {}
+
+    std::string label() const {
+        std::string text = name;
+        for (const auto& param : params) text += "/" + param.first + "=" + std::to_string(param.second);
+        return text;
+    }
+};
+
+// Results are folded into these so the optimiser cannot drop the work
+volatile double double_sink = 0.0;
+volatile size_t size_sink = 0;
+
+const int64_t BASE_EPOCH_MS = 1704067200000LL;   // 2024-01-01T00:00:00Z
+
+DataManagerOptions managerOptions(const BenchOptions& options, size_t window_size = 200) {
+    DataManagerOptions manager_options;
+    manager_options.seed = options.seed;
+    manager_options.window_size = window_size;
+    manager_options.write_logs = options.write_logs;
+    manager_options.sample_fleet = false;
+    manager_options.overload.adaptive = false;   // timings must not change the work measured
+    return manager_options;
+}
+
+// Deterministic reading source: random vehicle order, one reading per vehicle
+// per second of event time, 3% injected anomaly scenarios like the simulator
+class ReadingStream {
+private:
+    AdvancedDataManager generator;
+    std::mt19937 rng;
+    std::vector<int64_t> next_ms;
+    unsigned anomaly_percent;
+
+public:
+    ReadingStream(const BenchOptions& options, size_t fleet, unsigned anomaly_percent = 3)
+        : generator(managerOptions(options)), rng(options.seed), next_ms(fleet + 1, BASE_EPOCH_MS),
+          anomaly_percent(anomaly_percent) {}
+
+    SensorReading next() {
+        int vehicle_id = 1 + static_cast<int>(rng() % (next_ms.size() - 1));
+        return next(vehicle_id);
+    }
+
+    SensorReading next(int vehicle_id) {
+        int scenario = (rng() % 100) < anomaly_percent ? 1 + static_cast<int>(rng() % 10) : 0;
+        SensorReading reading = generator.generateEnhancedSyntheticReading(vehicle_id, scenario);
+        reading.timestamp = std::chrono::system_clock::time_point(std::chrono::milliseconds(next_ms[vehicle_id]));
+        next_ms[vehicle_id] += 1000;
+        return reading;
+    }
+
+    std::vector<SensorReading> take(size_t count) {
+        std::vector<SensorReading> readings;
+        readings.reserve(count);
+        for (size_t i = 0; i < count; ++i) readings.push_back(next());
+        return readings;
+    }
+};
+
+void registerFleet(AdvancedDataManager& manager, size_t fleet) {
+    for (size_t id = 1; id <= fleet; ++id) {
+        manager.registerVehicle(static_cast<int>(id), "Bench Model " + std::to_string(id % 16),
+                                "BEN-" + std::to_string(id));
+    }
+}
+
+// Mostly far from any route, so the cost measured is the distance scan
+std::vector<Geofence> makeGeofences(size_t count, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<> lat(-60.0, 60.0);
+    std::uniform_real_distribution<> lon(-180.0, 180.0);
+    std::uniform_real_distribution<> radius(0.5, 5.0);
+    std::vector<Geofence> fences;
+    for (size_t i = 0; i < count; ++i) {
+        fences.push_back({"Zone " + std::to_string(i), lat(rng), lon(rng), radius(rng), i % 2 == 1});
+    }
+    return fences;
+}
+
+class BenchRunner {
+private:
+    const BenchOptions& options;
+    std::vector<BenchResult> results;
+
+    static double elapsedNanos(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    }
+
+public:
+    explicit BenchRunner(const BenchOptions& o) : options(o) {}
+
+    bool selected(const std::string& label) const {
+        return options.filter.empty() || label.find(options.filter) != std::string::npos;
+    }
+
+    // `prepare(n)` runs untimed before every pass; `body(n)` performs n operations
+    template <typename Prepare, typename Body>
+    void run(BenchResult result, Prepare prepare, Body body) {
+        const std::string label = result.label();
+        if (!selected(label)) return;
+
+        uint64_t allocations = 0;
+        auto pass = [&](uint64_t n) {
+            prepare(n);
+            const uint64_t allocations_before = heapAllocationCount();
+            auto start = std::chrono::steady_clock::now();
+            body(n);
+            double ns = elapsedNanos(start);
+            allocations += heapAllocationCount() - allocations_before;
+            return ns;
+        };
+
+        // Warm-up doubles as calibration
+        const double target_ns = options.min_time_ms * 1e6;
+        uint64_t iterations = options.iterations;
+        if (iterations == 0) {
+            uint64_t n = 1;
+            double ns = pass(n);
+            while (ns < target_ns / 10 && n < (1ULL << 40)) {
+                n *= 10;
+                ns = pass(n);
+            }
+            iterations = std::max<uint64_t>(1, static_cast<uint64_t>(n * (target_ns / std::max(ns, 1.0))));
+        }
+        pass(iterations);
+
+        result.iterations = iterations;
+        allocations = 0;
+        for (int r = 0; r < options.repetitions; ++r) {
+            result.ns_per_op.push_back(pass(iterations) / static_cast<double>(iterations));
+        }
+        result.allocs_per_op = static_cast<double>(allocations) / (static_cast<double>(iterations) * options.repetitions);
+        print(result);
+        results.push_back(std::move(result));
+    }
+
+    template <typename Body>
+    void run(BenchResult result, Body body) {
+        run(std::move(result), [](uint64_t) {}, body);
+    }
+
+    struct Summary {
+        double min, median, mean, max, stddev;
+    };
+
+    static Summary summarize(std::vector<double> values) {
+        std::sort(values.begin(), values.end());
+        Summary s{};
+        const size_t n = values.size();
+        s.min = values.front();
+        s.max = values.back();
+        s.median = n % 2 ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2.0;
+        s.mean = std::accumulate(values.begin(), values.end(), 0.0) / n;
+        double sum_sq = 0.0;
+        for (double v : values) sum_sq += (v - s.mean) * (v - s.mean);
+        s.stddev = n > 1 ? std::sqrt(sum_sq / (n - 1)) : 0.0;
+        return s;
+    }
+
+    static void printHeader() {
+        std::cout << std::left << std::setw(80) << "benchmark" << std::right
+                  << std::setw(12) << "iterations" << std::setw(14) << "median ns/op"
+                  << std::setw(12) << "min ns/op" << std::setw(9) << "cv %" << std::setw(12) << "allocs/op" << "\n";
+    }
+
+    void print(const BenchResult& result) const {
+        Summary s = summarize(result.ns_per_op);
+        std::cout << std::left << std::setw(80) << result.label() << std::right
+                  << std::setw(12) << result.iterations
+                  << std::fixed << std::setprecision(1)
+                  << std::setw(14) << s.median << std::setw(12) << s.min
+                  << std::setw(9) << (s.mean > 0 ? 100.0 * s.stddev / s.mean : 0.0)
+                  << std::setprecision(2) << std::setw(12) << result.allocs_per_op << "\n";
+        std::cout.flush();
+    }
+
+    bool writeJson(const std::string& path) const {
+        std::ofstream out(path);
+        if (!out) return false;
+
+        std::string compiler = "unknown";
+#if defined(__clang__)
+        compiler = std::string("Clang ") + __clang_version__;
+#elif defined(__GNUC__)
+        compiler = "GCC " + std::to_string(__GNUC__) + "." + std::to_string(__GNUC_MINOR__) + "." +
+                   std::to_string(__GNUC_PATCHLEVEL__);
+#elif defined(_MSC_VER)
+        compiler = "MSVC " + std::to_string(_MSC_VER);
+#endif
+#if defined(TELEMATICS_BUILD_TYPE)
+        const char* build_type = TELEMATICS_BUILD_TYPE;
+#else
+        const char* build_type = "unknown";
+#endif
+
+        out << std::setprecision(10);
+        out << "{\n  \"context\": {\n"
+            << "    \"timestamp\": \"" << formatIsoUtc(std::chrono::system_clock::now()) << "\",\n"
+            << "    \"compiler\": \"" << compiler << "\",\n"
+            << "    \"build_type\": \"" << build_type << "\",\n"
+            << "    \"hardware_concurrency\": " << std::thread::hardware_concurrency() << ",\n"
+            << "    \"seed\": " << options.seed << ",\n"
+            << "    \"repetitions\": " << options.repetitions << ",\n"
+            << "    \"min_time_ms\": " << options.min_time_ms << ",\n"
+            << "    \"write_logs\": " << (options.write_logs ? "true" : "false") << "\n"
+            << "  },\n  \"benchmarks\": [";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const BenchResult& r = results[i];
+            Summary s = summarize(r.ns_per_op);
+            out << (i ? ",\n" : "\n") << "    {\"name\": \"" << r.label() << "\", \"function\": \"" << r.name
+                << "\", \"params\": {";
+            for (size_t p = 0; p < r.params.size(); ++p) {
+                out << (p ? ", " : "") << "\"" << r.params[p].first << "\": " << r.params[p].second;
+            }
+            out << "}, \"iterations\": " << r.iterations
+                << ", \"ns_per_op\": {\"min\": " << s.min << ", \"median\": " << s.median
+                << ", \"mean\": " << s.mean << ", \"max\": " << s.max << ", \"stddev\": " << s.stddev
+                << "}, \"ops_per_second\": " << (s.median > 0 ? 1e9 / s.median : 0.0)
+                << ", \"allocs_per_op\": " << r.allocs_per_op
+                << ", \"samples\": [";
+            for (size_t k = 0; k < r.ns_per_op.size(); ++k) out << (k ? ", " : "") << r.ns_per_op[k];
+            out << "]}";
+        }
+        out << "\n  ]\n}\n";
+        return static_cast<bool>(out);
+    }
+
+    static std::string formatIsoUtc(std::chrono::system_clock::time_point tp) {
+        std::string text;
+        feed_json::appendIsoTime(text, toEpochMillis(tp));
+        return text.substr(1, text.size() - 2);
+    }
+};
+
+void benchUtilities(BenchRunner& runner, const BenchOptions& options) {
+    std::mt19937 rng(options.seed);
+    std::uniform_real_distribution<> lat(-80.0, 80.0);
+    std::uniform_real_distribution<> lon(-180.0, 180.0);
+    std::vector<std::array<double, 4>> pairs(1024);
+    for (auto& p : pairs) p = {lat(rng), lon(rng), lat(rng), lon(rng)};
+    runner.run({"haversine", {}}, [&](uint64_t n) {
+        double sum = 0.0;
+        for (uint64_t i = 0; i < n; ++i) {
+            const auto& p = pairs[i & 1023];
+            sum += haversine(p[0], p[1], p[2], p[3]);
+        }
+        double_sink = sum;
+    });
+
+    // Consecutive fixes of one vehicle, a second apart at motorway speed:
+    // the trip-distance case fastDistanceKm takes the flat-earth path for
+    std::vector<GeoPoint> track;
+    track.push_back(makeGeoPoint(lat(rng), lon(rng)));
+    std::uniform_real_distribution<> step(-0.0003, 0.0003);
+    while (track.size() < 1025) {
+        const GeoPoint& last = track.back();
+        track.push_back(advanceGeoPoint(last, last.latitude + step(rng), last.longitude + step(rng)));
+    }
+    runner.run({"haversineKm", {}}, [&](uint64_t n) {
+        double sum = 0.0;
+        for (uint64_t i = 0; i < n; ++i) sum += haversineKm(track[i & 1023], track[(i & 1023) + 1]);
+        double_sink = sum;
+    });
+    runner.run({"fastDistanceKm", {}}, [&](uint64_t n) {
+        double sum = 0.0;
+        for (uint64_t i = 0; i < n; ++i) sum += fastDistanceKm(track[i & 1023], track[(i & 1023) + 1]);
+        double_sink = sum;
+    });
+
+    // One position against every geofence centre, as checkGeofenceViolations
+    // does: ns/op is per centre, the scalar loop beside the SIMD kernel
+    for (size_t count : options.geofence_counts) {
+        std::vector<double> lats(count), lons(count), out(count);
+        for (size_t i = 0; i < count; ++i) {
+            lats[i] = lat(rng);
+            lons[i] = lon(rng);
+        }
+        std::vector<GeoPoint> centres;
+        for (size_t i = 0; i < count; ++i) centres.push_back(makeGeoPoint(lats[i], lons[i]));
+        runner.run({"haversineKm loop", {{"points", count}}}, [&](uint64_t n) {
+            double sum = 0.0;
+            for (uint64_t done = 0; done < n; done += count) {
+                const GeoPoint& origin = track[done & 1023];
+                for (const GeoPoint& centre : centres) sum += haversineKm(origin, centre);
+            }
+            double_sink = sum;
+        });
+        runner.run({"haversineBatchKm", {{"points", count}}}, [&](uint64_t n) {
+            double sum = 0.0;
+            for (uint64_t done = 0; done < n; done += count) {
+                haversineBatchKm(track[done & 1023], lats.data(), lons.data(), count, out.data());
+                sum += out[done % count];
+            }
+            double_sink = sum;
+        });
+    }
+
+    std::vector<std::chrono::system_clock::time_point> times;
+    for (int i = 0; i < 1024; ++i) {
+        times.emplace_back(std::chrono::milliseconds(BASE_EPOCH_MS + i * 37LL));
+    }
+    runner.run({"formatTimestamp", {}}, [&](uint64_t n) {
+        size_t total = 0;
+        for (uint64_t i = 0; i < n; ++i) total += formatTimestamp(times[i & 1023]).size();
+        size_sink = total;
+    });
+
+    ReadingStream stream(options, 20);
+    std::vector<SensorReading> readings = stream.take(1024);
+    runner.run({"SensorReading::toCSV", {}}, [&](uint64_t n) {
+        size_t total = 0;
+        for (uint64_t i = 0; i < n; ++i) total += readings[i & 1023].toCSV().size();
+        size_sink = total;
+    });
+
+    // The log path: rows into a reused buffer, drained every 64 KiB the way
+    // a buffered file write would
+    CsvRowWriter rows;
+    runner.run({"CsvRowWriter::append<SensorReading>", {}}, [&](uint64_t n) {
+        size_t total = 0;
+        for (uint64_t i = 0; i < n; ++i) {
+            rows.append(readings[i & 1023]);
+            if (rows.size() >= 65536) {
+                total += rows.size();
+                rows.clear();
+            }
+        }
+        size_sink = total;
+    });
+
+    std::vector<AnomalyLogRow> anomalies(1024);
+    for (size_t i = 0; i < anomalies.size(); ++i) {
+        AnomalyLogRow& row = anomalies[i];
+        row.timestamp = readings[i].timestamp;
+        row.vehicle_id = readings[i].vehicle_id;
+        row.sensor = "speed";
+        row.value = readings[i].speed_kmph;
+        row.type = AnomalyRecord::typeCode(AnomalyType::SPEED_OUT_OF_RANGE);
+        row.description = i % 8 ? "Speed out of range" : "Speed out of range (ongoing 12s, 4 occurrences)";
+        row.severity = 4;
+        row.priority = 4;
+        row.ml_score = 0.5;
+        row.event = "OPEN";
+    }
+    runner.run({"CsvRowWriter::append<AnomalyLogRow>", {}}, [&](uint64_t n) {
+        size_t total = 0;
+        for (uint64_t i = 0; i < n; ++i) {
+            rows.append(anomalies[i & 1023]);
+            if (rows.size() >= 65536) {
+                total += rows.size();
+                rows.clear();
+            }
+        }
+        size_sink = total;
+    });
+}
+
+void benchAnalytics(BenchRunner& runner, const BenchOptions& options) {
+    for (size_t window : options.windows) {
+        BenchResult result{"AdvancedAnalytics::calculateStatistics", {{"window", window}}};
+        if (!runner.selected(result.label())) continue;
+        std::mt19937 rng(options.seed);
+        std::normal_distribution<> speed(60.0, 15.0);
+        std::vector<double> data(window);
+        for (double& v : data) v = speed(rng);
+        AdvancedAnalytics analytics;
+        runner.run(result, [&](uint64_t n) {
+            double sum = 0.0;
+            for (uint64_t i = 0; i < n; ++i) sum += analytics.calculateStatistics(data).mean;
+            double_sink = sum;
+        });
+    }
+
+    for (size_t fleet : options.fleets) {
+        BenchResult result{"AdvancedAnalytics::updateTrends", {{"fleet", fleet}}};
+        if (!runner.selected(result.label())) continue;
+        ReadingStream stream(options, fleet);
+        std::vector<SensorReading> readings = stream.take(4096);
+        AdvancedAnalytics analytics;
+        // Fill every trend to its cap so the steady state is measured
+        for (size_t i = 0; i < std::max<size_t>(4096, fleet * 200); ++i) {
+            const SensorReading& r = readings[i & 4095];
+            analytics.updateTrends(r.vehicle_id, r);
+        }
+        runner.run(result, [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                const SensorReading& r = readings[i & 4095];
+                analytics.updateTrends(r.vehicle_id, r);
+            }
+        });
+    }
+}
+
+void benchForecasting(BenchRunner& runner, const BenchOptions& options) {
+    std::mt19937 rng(options.seed);
+    std::normal_distribution<> step(0.0, 0.5);
+    std::vector<double> series(4096);
+    double value = 90.0;
+    for (double& v : series) v = value += step(rng);
+
+    for (uint32_t season : {0u, 16u}) {
+        ForecastConfig config;
+        config.season_length = season;
+        ExponentialForecaster<16> model;
+        runner.run({"ExponentialForecaster::update", {{"season", season}}}, [&](uint64_t n) {
+            double sum = 0.0;
+            for (uint64_t i = 0; i < n; ++i) sum += model.update(series[i & 4095], config);
+            double_sink = sum;
+        });
+    }
+}
+
+void benchDetector(BenchRunner& runner, const BenchOptions& options) {
+    for (size_t window : options.windows) {
+        BenchResult result{"MLAnomalyDetector::trainModel", {{"window", window}}};
+        if (!runner.selected(result.label())) continue;
+        ReadingStream stream(options, 1);
+        RingDeque<SensorReading> history(256);
+        for (size_t i = 0; i < window; ++i) history.push_back(stream.next(1));
+        MLAnomalyDetector detector;
+        runner.run(result, [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) detector.trainModel(1, history);
+        });
+    }
+
+    for (size_t fleet : options.fleets) {
+        BenchResult result{"MLAnomalyDetector::calculateAnomalyScore", {{"fleet", fleet}}};
+        if (!runner.selected(result.label())) continue;
+        ReadingStream stream(options, fleet);
+        MLAnomalyDetector detector;
+        for (size_t id = 1; id <= fleet; ++id) {
+            RingDeque<SensorReading> history(256);
+            for (int i = 0; i < 200; ++i) history.push_back(stream.next(static_cast<int>(id)));
+            detector.trainModel(static_cast<int>(id), history);
+        }
+        std::vector<SensorReading> readings = stream.take(4096);
+        runner.run(result, [&](uint64_t n) {
+            double sum = 0.0;
+            for (uint64_t i = 0; i < n; ++i) {
+                const SensorReading& r = readings[i & 4095];
+                sum += detector.calculateAnomalyScore(r.vehicle_id, r);
+            }
+            double_sink = sum;
+        });
+    }
+
+    for (size_t fleet : options.fleets) {
+        const size_t lanes = simd_lanes::SimdVec::width;
+        BenchResult observe{"PatternClusterDetector::observe", {{"fleet", fleet}}};
+        BenchResult single{"PatternClusterDetector::score", {{"fleet", fleet}, {"lanes", lanes}}};
+        BenchResult batch{"PatternClusterDetector::scoreBatch", {{"fleet", fleet}, {"lanes", lanes}}};
+        if (!runner.selected(observe.label()) && !runner.selected(single.label()) &&
+            !runner.selected(batch.label())) {
+            continue;
+        }
+
+        // Same 16 make/model groups as registerFleet, each trained until it scores
+        ReadingStream stream(options, fleet);
+        PatternClusterDetector detector;
+        std::vector<uint32_t> groups(fleet + 1);
+        for (size_t id = 1; id <= fleet; ++id) {
+            groups[id] = detector.groupFor("Bench Model " + std::to_string(id % 16));
+        }
+        auto features = [](const SensorReading& r) {
+            return PatternClusterDetector::Features{r.speed_kmph, r.rpm, r.engine_temp_celsius, r.acceleration_ms2, 0.0};
+        };
+        const size_t training = std::min<size_t>(fleet, 16) * 2 * PatternClusterDetector::SCORED_AFTER;
+        for (size_t i = 0; i < training; ++i) {
+            const SensorReading r = stream.next();
+            detector.observe(groups[r.vehicle_id], features(r));
+        }
+        std::vector<SensorReading> readings = stream.take(4096);
+
+        runner.run(observe, [&](uint64_t n) {
+            double sum = 0.0;
+            for (uint64_t i = 0; i < n; ++i) {
+                const SensorReading& r = readings[i & 4095];
+                sum += detector.observe(groups[r.vehicle_id], features(r));
+            }
+            double_sink = sum;
+        });
+        runner.run(single, [&](uint64_t n) {
+            double sum = 0.0;
+            for (uint64_t i = 0; i < n; ++i) {
+                const SensorReading& r = readings[i & 4095];
+                sum += detector.score(groups[r.vehicle_id], features(r));
+            }
+            double_sink = sum;
+        });
+
+        // Column-wise copy of the readings, all scored against vehicle 1's group
+        std::vector<std::vector<double>> columns(PatternClusterDetector::FEATURES);
+        for (const auto& r : readings) {
+            const auto row = features(r);
+            for (size_t f = 0; f < row.size(); ++f) columns[f].push_back(row[f]);
+        }
+        std::vector<double> scores(readings.size());
+        runner.run(batch, [&](uint64_t n) {
+            for (uint64_t done = 0; done < n;) {
+                const size_t count = static_cast<size_t>(std::min<uint64_t>(n - done, readings.size()));
+                std::array<const double*, PatternClusterDetector::FEATURES> view;
+                for (size_t f = 0; f < view.size(); ++f) view[f] = columns[f].data();
+                detector.scoreBatch(groups[1], view, count, scores.data());
+                done += count;
+            }
+            double_sink = scores[0];
+        });
+    }
+}
+
+void benchGeofences(BenchRunner& runner, const BenchOptions& options) {
+    for (size_t count : options.geofence_counts) {
+        BenchResult result{"AdvancedDataManager::checkGeofenceViolations", {{"geofences", count}}};
+        if (!runner.selected(result.label())) continue;
+        AdvancedDataManager manager(managerOptions(options));
+        registerFleet(manager, 20);
+        manager.setGeofences(makeGeofences(count, options.seed));
+        ReadingStream stream(options, 20);
+        std::vector<SensorReading> readings = stream.take(4096);
+        runner.run(result, [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                TelematicsBenchmarkAccess::checkGeofenceViolations(manager, readings[i & 4095]);
+            }
+        });
+    }
+}
+
+void benchPipeline(BenchRunner& runner, const BenchOptions& options) {
+    for (size_t window : options.windows) {
+        for (size_t fleet : options.fleets) {
+            for (size_t count : options.geofence_counts) {
+                BenchResult result{"AdvancedDataManager::processSensorReading",
+                                   {{"window", window}, {"fleet", fleet}, {"geofences", count}}};
+                if (!runner.selected(result.label())) continue;
+
+                AdvancedDataManager manager(managerOptions(options, window));
+                registerFleet(manager, fleet);
+                manager.setGeofences(makeGeofences(count, options.seed));
+                ReadingStream stream(options, fleet);
+
+                // Prime every vehicle past the ML training threshold (capped
+                // so large fleets stay affordable)
+                const size_t prime = std::min<size_t>(fleet * 120, 240000);
+                for (size_t i = 0; i < prime; ++i) manager.processSensorReading(stream.next());
+
+                std::vector<SensorReading> batch;
+                runner.run(result,
+                    [&](uint64_t n) { batch = stream.take(static_cast<size_t>(n)); },
+                    [&](uint64_t n) {
+                        for (uint64_t i = 0; i < n; ++i) manager.processSensorReading(batch[i]);
+                    });
+                manager.setRunning(false);
+            }
+        }
+    }
+
+    // The same pipeline pinned in each degraded mode, at the first window,
+    // fleet and geofence count
+    for (size_t mode = 1; mode < DEGRADED_MODES; ++mode) {
+        const size_t window = options.windows.front();
+        const size_t fleet = options.fleets.front();
+        BenchResult result{"AdvancedDataManager::processSensorReading", {{"mode", mode}, {"fleet", fleet}}};
+        if (!runner.selected(result.label())) continue;
+
+        DataManagerOptions manager_options = managerOptions(options, window);
+        manager_options.overload.min_mode = static_cast<DegradedMode>(mode);
+        AdvancedDataManager manager(manager_options);
+        registerFleet(manager, fleet);
+        manager.setGeofences(makeGeofences(options.geofence_counts.front(), options.seed));
+        ReadingStream stream(options, fleet);
+        const size_t prime = std::min<size_t>(fleet * 120, 240000);
+        for (size_t i = 0; i < prime; ++i) manager.processSensorReading(stream.next());
+
+        std::vector<SensorReading> batch;
+        runner.run(result,
+            [&](uint64_t n) { batch = stream.take(static_cast<size_t>(n)); },
+            [&](uint64_t n) {
+                for (uint64_t i = 0; i < n; ++i) manager.processSensorReading(batch[i]);
+            });
+        manager.setRunning(false);
+    }
+}
+
+// --check-allocations: the pipeline should not reach the heap in steady
+// state. Runs the stream through the first window/fleet/geofence values;
+// warm-up takes every vehicle past ML training and the history retention
+// horizon, then the same number of readings again is measured. Fails when they
+// allocate more per reading than the budget. Injected scenarios keep alerts
+// opening, updating and clearing throughout, so the alert and anomaly paths
+// are part of what is measured.
+int checkSteadyStateAllocations(const BenchOptions& options) {
+    if (!heapAllocationCountAvailable()) {
+        std::cerr << "Error: built without TELEMATICS_COUNT_ALLOCATIONS\n";
+        return 2;
+    }
+    const size_t window = options.windows.front();
+    const size_t fleet = options.fleets.front();
+    DataManagerOptions manager_options = managerOptions(options, window);
+    // Short blocks and retention, so warm-up reaches the point where every
+    // sealed block evicts an old one, as it does after 6 hours in production
+    manager_options.history.samples_per_block = 128;
+    manager_options.history.retention_ms = 5 * 60 * 1000;
+    AdvancedDataManager manager(manager_options);
+    registerFleet(manager, fleet);
+    manager.setGeofences(makeGeofences(options.geofence_counts.front(), options.seed));
+    ReadingStream stream(options, fleet, options.anomaly_percent);
+
+    const size_t readings = fleet * 1000;
+    for (size_t i = 0; i < readings; ++i) manager.processSensorReading(stream.next());
+    const std::vector<SensorReading> batch = stream.take(readings);
+    const uint64_t allocations_before = heapAllocationCount();
+    for (const auto& reading : batch) manager.processSensorReading(reading);
+    const uint64_t allocations = heapAllocationCount() - allocations_before;
+    manager.setRunning(false);
+
+    const double per_reading = static_cast<double>(allocations) / static_cast<double>(readings);
+    const bool ok = per_reading <= options.allocation_budget;
+    std::cout << "Steady-state allocations (window=" << window << ", fleet=" << fleet
+              << ", geofences=" << options.geofence_counts.front()
+              << ", anomalies=" << options.anomaly_percent << "%): " << allocations << " over "
+              << readings << " readings, " << std::fixed << std::setprecision(4) << per_reading
+              << " per reading (budget " << options.allocation_budget << ") " << (ok ? "OK" : "FAILED") << "\n";
+    return ok ? 0 : 1;
+}
+
+void benchSharedState(BenchRunner& runner, const BenchOptions& options) {
+    if (!SHARED_STATE_SUPPORTED) return;
+    for (size_t fleet : options.fleets) {
+        BenchResult publish{"SharedFleetWriter::publish", {{"fleet", fleet}}};
+        BenchResult poll{"SharedFleetReader::forEach", {{"fleet", fleet}}};
+        if (!runner.selected(publish.label()) && !runner.selected(poll.label())) continue;
+
+        const std::string name = "/telematics_bench_" + std::to_string(::getpid());
+        SharedFleetWriter writer;
+        SharedFleetReader reader;
+        std::string error;
+        if (!writer.open(name, static_cast<uint32_t>(fleet), error) || !reader.open(name, error)) {
+            std::cerr << "skipping shared state cases: " << error << "\n";
+            return;
+        }
+        ReadingStream stream(options, fleet);
+        std::vector<SharedVehicleRow> rows(4096);
+        for (SharedVehicleRow& row : rows) {
+            SensorReading r = stream.next();
+            row.vehicle_id = r.vehicle_id;
+            row.timestamp_ms = toEpochMillis(r.timestamp);
+            row.speed = r.speed_kmph;
+            row.rpm = r.rpm;
+            row.temperature = r.engine_temp_celsius;
+        }
+        for (size_t id = 1; id <= fleet; ++id) {
+            SharedVehicleRow row;
+            row.vehicle_id = static_cast<int32_t>(id);
+            writer.publish(row);
+        }
+
+        if (runner.selected(publish.label())) {
+            runner.run(publish, [&](uint64_t n) {
+                for (uint64_t i = 0; i < n; ++i) writer.publish(rows[i & 4095]);
+            });
+        }
+        // One iteration reads every vehicle's row
+        if (runner.selected(poll.label())) {
+            runner.run(poll, [&](uint64_t n) {
+                double sum = 0.0;
+                for (uint64_t i = 0; i < n; ++i) {
+                    reader.forEach([&](const SharedVehicleRow& row) { sum += row.speed; });
+                }
+                double_sink = sum;
+            });
+        }
+    }
+}
+
+// Scratch journal directory, removed with everything in it
+class TempJournalDirectory {
+private:
+    std::string path;
+
+public:
+    TempJournalDirectory() {
+#if !defined(_WIN32)
+        char pattern[] = "/tmp/telematics-journal-XXXXXX";
+        if (::mkdtemp(pattern)) path = pattern;
+#endif
+    }
+
+    ~TempJournalDirectory() {
+#if !defined(_WIN32)
+        if (path.empty()) return;
+        for (uint64_t generation : journal_detail::listJournals(path)) {
+            ::unlink(journalFilePath(path, generation).c_str());
+        }
+        ::unlink(journalSnapshotPath(path).c_str());
+        ::rmdir(path.c_str());
+#endif
+    }
+
+    bool ok() const { return !path.empty(); }
+    const std::string& str() const { return path; }
+};
+
+void benchJournal(BenchRunner& runner, const BenchOptions& options) {
+    if (!JOURNAL_SUPPORTED) return;
+
+    // Group commit: appends plus the final sync that makes them durable.
+    // Each pass starts from a fresh generation so the file stays bounded.
+    {
+        JournalConfig config;
+        BenchResult result{"JournalWriter::append+sync", {{"sync_ms", config.sync_interval_ms}}};
+        TempJournalDirectory directory;
+        JournalWriter writer;
+        std::string error;
+        config.directory = directory.str();
+        config.checkpoint_bytes = std::numeric_limits<uint64_t>::max();
+        if (runner.selected(result.label()) && directory.ok() && writer.open(config, 1, {}, error)) {
+            const std::string record(92, 'x');   // the size of a PROFILE record
+            runner.run(result,
+                [&](uint64_t) {
+                    writer.checkpoint([] { return JournalSnapshot{" "}; });
+                    writer.sync(error);
+                },
+                [&](uint64_t n) {
+                    for (uint64_t i = 0; i < n; ++i) writer.append(1, record);
+                    writer.sync(error);
+                });
+        }
+        if (!error.empty()) std::cerr << "journal: " << error << "\n";
+    }
+
+    // Recovery: replaying an engine journal of N records into a fresh manager
+    for (size_t records : options.journal_records) {
+        BenchResult result{"AdvancedDataManager::recoverJournal", {{"records", records}}};
+        if (!runner.selected(result.label())) continue;
+        TempJournalDirectory directory;
+        if (!directory.ok()) continue;
+
+        const size_t fleet = 1000;
+        JournalConfig config;
+        config.directory = directory.str();
+        config.checkpoint_bytes = std::numeric_limits<uint64_t>::max();
+        JournalRecovery recovery;
+        std::string error;
+        {
+            AdvancedDataManager writer(managerOptions(options));
+            registerFleet(writer, fleet);
+            if (!writer.openJournal(config, recovery, error)) {
+                std::cerr << "journal: " << error << "\n";
+                continue;
+            }
+            // Like the pipeline: a profile record per reading, an anomaly every 32
+            for (size_t i = 0; i < records; ++i) {
+                int vehicle_id = 1 + static_cast<int>(i % fleet);
+                if (i % 32 == 31) TelematicsBenchmarkAccess::recordAnomaly(writer, vehicle_id);
+                else TelematicsBenchmarkAccess::journalProfile(writer, vehicle_id);
+            }
+            TelematicsBenchmarkAccess::abandonJournal(writer);
+            writer.setRunning(false);
+        }
+
+        std::vector<std::unique_ptr<AdvancedDataManager>> targets;
+        runner.run(result,
+            [&](uint64_t n) {
+                targets.clear();
+                for (uint64_t i = 0; i < n; ++i) {
+                    targets.push_back(std::make_unique<AdvancedDataManager>(managerOptions(options)));
+                }
+            },
+            [&](uint64_t n) {
+                for (uint64_t i = 0; i < n; ++i) {
+                    TelematicsBenchmarkAccess::replayJournal(*targets[i], directory.str(), recovery, error);
+                }
+                size_sink = recovery.records;
+            });
+        targets.clear();
+    }
+}
+
+// Heartbeat deadlines for a million vehicles on one-second ticks
+void benchTimerWheel(BenchRunner& runner, const BenchOptions& options) {
+    const uint32_t timers = 1000000;
+    const int64_t start_ms = BASE_EPOCH_MS;
+
+    // Re-arming on every reading, 30 s ahead
+    {
+        BenchResult result{"TimerWheel::arm", {{"timers", timers}}};
+        if (runner.selected(result.label())) {
+            TimerWheel wheel(1000, start_ms);
+            std::mt19937 rng(options.seed);
+            std::vector<uint32_t> order(timers);
+            for (uint32_t i = 0; i < timers; ++i) {
+                wheel.arm(wheel.create(i), start_ms + 30000 + static_cast<int64_t>(rng() % 30000));
+                order[i] = i;
+            }
+            std::shuffle(order.begin(), order.end(), rng);
+            uint64_t next = 0;
+            runner.run(result, [&](uint64_t n) {
+                for (uint64_t i = 0; i < n; ++i, ++next) {
+                    wheel.arm(order[next % timers], start_ms + 30000 + static_cast<int64_t>(next % 30000));
+                }
+                size_sink = wheel.pending();
+            });
+        }
+    }
+
+    // One tick per op with deadlines spread over `horizon` ticks, so
+    // timers/horizon expire per tick and are re-armed a horizon ahead: the
+    // cost follows the expiring timers, not the million armed
+    for (uint32_t horizon : {1000000u, 10000u}) {
+        BenchResult result{"TimerWheel::advance", {{"timers", timers}, {"expiring", timers / horizon}}};
+        if (!runner.selected(result.label())) continue;
+        TimerWheel wheel(1000, start_ms);
+        std::mt19937 rng(options.seed);
+        for (uint32_t i = 0; i < timers; ++i) {
+            wheel.arm(wheel.create(i), start_ms + 1000 * static_cast<int64_t>(1 + rng() % horizon));
+        }
+        int64_t now_ms = start_ms;
+        runner.run(result, [&](uint64_t n) {
+            size_t fired = 0;
+            for (uint64_t i = 0; i < n; ++i) {
+                now_ms += 1000;
+                fired += wheel.advance(now_ms, [&](uint32_t id, uint64_t) {
+                    wheel.arm(id, now_ms + 1000 * static_cast<int64_t>(horizon));
+                });
+            }
+            size_sink = fired;
+        });
+    }
+}
+
+// Per-reading fuel and driving-style totals; the fleet only sets how many
+// accumulators the readings are spread over
+void benchEcoScore(BenchRunner& runner, const BenchOptions& options) {
+    const EcoConfig config;
+    for (size_t fleet : options.fleets) {
+        BenchResult update{"EcoAccumulator::update", {{"fleet", fleet}}};
+        BenchResult score{"EcoAccumulator::score", {{"fleet", fleet}}};
+        if (!runner.selected(update.label()) && !runner.selected(score.label())) continue;
+
+        ReadingStream stream(options, fleet);
+        std::vector<std::pair<int, EcoSample>> samples;
+        for (const SensorReading& reading : stream.take(4096)) {
+            EcoSample sample;
+            sample.timestamp_ms = toEpochMillis(reading.timestamp);
+            sample.step_distance_km = std::max(0.0, reading.speed_kmph) / 3600.0;
+            sample.speed_kmph = reading.speed_kmph;
+            sample.fuel_level_percent = reading.fuel_level_percent;
+            sample.throttle_percent = reading.throttle_position_percent;
+            sample.brake_pressure_bar = reading.brake_pressure_bar;
+            sample.acceleration_ms2 = reading.acceleration_ms2;
+            sample.engine_on = reading.engine_on;
+            sample.trip_id = 1;
+            samples.emplace_back(reading.vehicle_id - 1, sample);
+        }
+        std::vector<EcoAccumulator> accumulators(fleet);
+        for (const auto& s : samples) accumulators[s.first].update(config, s.second);
+
+        if (runner.selected(update.label())) {
+            uint64_t next = samples.size();
+            runner.run(update, [&](uint64_t n) {
+                for (uint64_t i = 0; i < n; ++i, ++next) {
+                    // Each pass over the samples is a later stretch of driving
+                    const auto& s = samples[next % samples.size()];
+                    EcoSample sample = s.second;
+                    sample.timestamp_ms += static_cast<int64_t>(next / samples.size()) * 4096 * 1000;
+                    accumulators[s.first].update(config, sample);
+                }
+                double_sink = accumulators[0].totals(EcoWindow::LIFETIME).distance_km;
+            });
+        }
+        if (runner.selected(score.label())) {
+            runner.run(score, [&](uint64_t n) {
+                double sum = 0.0;
+                for (uint64_t i = 0; i < n; ++i) {
+                    sum += accumulators[i % fleet].score(EcoWindow::LIFETIME, config).score;
+                }
+                double_sink = sum;
+            });
+        }
+    }
+}
+
+// Stands in for a real sink: spends `cost_ns` per delivery and counts them
+class BusyAlertSink : public AlertSink {
+private:
+    uint64_t cost_ns;
+
+public:
+    std::atomic<uint64_t> delivered{0};
+    std::mutex mutex;
+    std::condition_variable emergency_delivered;
+    uint64_t emergencies = 0;
+
+    explicit BusyAlertSink(uint64_t cost) : cost_ns(cost) {}
+
+    const char* kind() const override { return "bench"; }
+
+    // Called from every priority's dispatcher thread
+    bool deliver(const DispatchAlert& alert, std::string_view, std::string&) override {
+        const auto until = std::chrono::steady_clock::now() + std::chrono::nanoseconds(cost_ns);
+        while (cost_ns > 0 && std::chrono::steady_clock::now() < until) {}
+        delivered.fetch_add(1, std::memory_order_relaxed);
+        if (alert.priority == static_cast<int>(AlertPriority::EMERGENCY)) {
+            std::lock_guard<std::mutex> lock(mutex);
+            emergencies++;
+            emergency_delivered.notify_one();
+        }
+        return true;
+    }
+};
+
+void benchAlertDispatch(BenchRunner& runner, const BenchOptions&) {
+    auto makeAlert = [](AlertPriority priority, int vehicle_id) {
+        DispatchAlert alert;
+        alert.priority = static_cast<int>(priority);
+        alert.vehicle_id = vehicle_id;
+        alert.severity = static_cast<int>(priority);
+        alert.type = "THRESHOLD_EXCEEDED";
+        alert.event = "OPENED";
+        alert.sensor = "engine_temp";
+        alert.description = "Engine temperature above limit";
+        alert.value = 118.5;
+        return alert;
+    };
+
+    // Producer side: what recordAnomaly pays per alert while the dispatcher
+    // delivers to a free sink
+    {
+        BenchResult result{"AlertDispatcher::enqueue", {}};
+        if (runner.selected(result.label())) {
+            MetricsRegistry metrics;
+            AlertDispatcher dispatcher(metrics, nullptr);
+            std::vector<std::unique_ptr<AlertSink>> sinks;
+            sinks.push_back(std::make_unique<BusyAlertSink>(0));
+            std::string error;
+            dispatcher.start(DispatchConfig(), std::move(sinks), error);
+            runner.run(result, [&](uint64_t n) {
+                for (uint64_t i = 0; i < n; ++i) {
+                    dispatcher.enqueue(makeAlert(AlertPriority::MEDIUM, static_cast<int>(i & 1023)));
+                }
+            });
+        }
+    }
+
+    // Detection to delivery of one EMERGENCY alert while the LOW level is kept
+    // full and every delivery takes 20 us: ns/op is the EMERGENCY latency,
+    // which should stay near one delivery whatever the LOW backlog, since
+    // EMERGENCY has its own dispatcher thread
+    for (size_t backlog : {size_t(256), size_t(4096)}) {
+        BenchResult result{"AlertDispatcher emergency latency", {{"backlog", backlog}}};
+        if (!runner.selected(result.label())) continue;
+        MetricsRegistry metrics;
+        AlertDispatcher dispatcher(metrics, nullptr);
+        DispatchConfig config;
+        config.level(static_cast<int>(AlertPriority::LOW)) = {backlog, DropPolicy::DROP_OLDEST, 60000};
+        auto sink = std::make_unique<BusyAlertSink>(20000);
+        BusyAlertSink& counts = *sink;
+        std::vector<std::unique_ptr<AlertSink>> sinks;
+        sinks.push_back(std::move(sink));
+        std::string error;
+        dispatcher.start(config, std::move(sinks), error);
+        runner.run(result,
+            [&](uint64_t) {
+                for (size_t i = 0; i < backlog; ++i) dispatcher.enqueue(makeAlert(AlertPriority::LOW, 1));
+            },
+            [&](uint64_t n) {
+                for (uint64_t i = 0; i < n; ++i) {
+                    dispatcher.enqueue(makeAlert(AlertPriority::LOW, 1));
+                    std::unique_lock<std::mutex> lock(counts.mutex);
+                    const uint64_t target = counts.emergencies + 1;
+                    dispatcher.enqueue(makeAlert(AlertPriority::EMERGENCY, 2));
+                    counts.emergency_delivered.wait(lock, [&] { return counts.emergencies >= target; });
+                }
+            });
+        dispatcher.stop();
+    }
+}
+
+// Full reports for each fleet size, written to a scratch file. The trends are
+// full (200 samples a channel), the worst case for the analytics variant.
+void benchReport(BenchRunner& runner, const BenchOptions& options) {
+    const std::pair<const char*, ReportFormat> formats[] = {
+        {"txt", ReportFormat::TEXT}, {"csv", ReportFormat::CSV}, {"json", ReportFormat::JSON}};
+    for (size_t fleet : options.fleets) {
+        std::vector<BenchResult> results;
+        for (const auto& format : formats) {
+            for (size_t analytics = 0; analytics <= 1; ++analytics) {
+                results.push_back({std::string("AdvancedDataManager::exportSystemReport/") + format.first,
+                                   {{"fleet", fleet}, {"analytics", analytics}}});
+            }
+        }
+        if (std::none_of(results.begin(), results.end(),
+                         [&](const BenchResult& r) { return runner.selected(r.label()); })) {
+            continue;
+        }
+
+        AdvancedDataManager manager(managerOptions(options));
+        registerFleet(manager, fleet);
+        ReadingStream stream(options, fleet);
+        for (size_t i = 0; i < fleet * 200; ++i) TelematicsBenchmarkAccess::updateTrends(manager, stream.next());
+
+        for (size_t f = 0; f < 3; ++f) {
+            const std::string path = std::string("telematics_bench_report.") + formats[f].first;
+            for (size_t analytics = 0; analytics <= 1; ++analytics) {
+                const BenchResult& result = results[f * 2 + analytics];
+                if (!runner.selected(result.label())) continue;
+                ReportOptions report_options;
+                report_options.format = formats[f].second;
+                report_options.include_analytics = analytics != 0;
+                runner.run(result, [&](uint64_t n) {
+                    for (uint64_t i = 0; i < n; ++i) manager.exportSystemReport(path, report_options);
+                });
+            }
+            std::remove(path.c_str());
+        }
+        manager.setRunning(false);
+    }
+}
+
+bool parseList(const char* text, std::vector<size_t>& out) {
+    out.clear();
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        char* end = nullptr;
+        unsigned long long value = std::strtoull(item.c_str(), &end, 10);
+        if (item.empty() || *end != '\0' || value == 0) return false;
+        out.push_back(static_cast<size_t>(value));
+    }
+    return !out.empty();
+}
+
+void printUsage() {
+    std::cout << "usage: telematics_bench [--filter <substring>] [--window 50,200,1000]\n"
+                 "                        [--fleet 20,200,2000] [--geofences 4,64,512]\n"
+                 "                        [--journal-records 1000000]\n"
+                 "                        [--repetitions 5] [--min-time-ms 100] [--iterations N]\n"
+                 "                        [--seed 42] [--logs] [--json <file>]\n"
+                 "       telematics_bench --check-allocations <per-reading budget> [--window N]\n"
+                 "                        [--fleet N] [--geofences N] [--anomaly-percent 3]\n"
+                 "                        [--seed 42]\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        bool ok = true;
+        if (arg == "--help" || arg == "-h") {
+            printUsage();
+            return 0;
+        } else if (arg == "--logs") {
+            options.write_logs = true;
+            continue;
+        } else if (!value) {
+            ok = false;
+        } else if (arg == "--filter") {
+            options.filter = value;
+        } else if (arg == "--window") {
+            ok = parseList(value, options.windows);
+        } else if (arg == "--fleet") {
+            ok = parseList(value, options.fleets);
+        } else if (arg == "--geofences") {
+            ok = parseList(value, options.geofence_counts);
+        } else if (arg == "--journal-records") {
+            ok = parseList(value, options.journal_records);
+        } else if (arg == "--repetitions") {
+            options.repetitions = std::atoi(value);
+            ok = options.repetitions > 0;
+        } else if (arg == "--min-time-ms") {
+            options.min_time_ms = std::atof(value);
+            ok = options.min_time_ms > 0;
+        } else if (arg == "--iterations") {
+            options.iterations = std::strtoull(value, nullptr, 10);
+        } else if (arg == "--seed") {
+            options.seed = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+            ok = options.seed != 0;
+        } else if (arg == "--json") {
+            options.json_path = value;
+        } else if (arg == "--check-allocations") {
+            options.allocation_budget = std::atof(value);
+            ok = options.allocation_budget >= 0;
+        } else if (arg == "--anomaly-percent") {
+            options.anomaly_percent = static_cast<unsigned>(std::atoi(value));
+            ok = options.anomaly_percent <= 100;
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            std::cerr << "Invalid argument: " << arg << (value ? std::string(" ") + value : "") << "\n";
+            printUsage();
+            return 2;
+        }
+        ++i;
+    }
+
+    if (options.allocation_budget >= 0) return checkSteadyStateAllocations(options);
+
+    BenchRunner runner(options);
+    BenchRunner::printHeader();
+    benchUtilities(runner, options);
+    benchAnalytics(runner, options);
+    benchForecasting(runner, options);
+    benchDetector(runner, options);
+    benchGeofences(runner, options);
+    benchSharedState(runner, options);
+    benchJournal(runner, options);
+    benchTimerWheel(runner, options);
+    benchEcoScore(runner, options);
+    benchAlertDispatch(runner, options);
+    benchReport(runner, options);
+    benchPipeline(runner, options);
+
+    if (!options.json_path.empty()) {
+        if (!runner.writeJson(options.json_path)) {
+            std::cerr << "Error: could not write " << options.json_path << "\n";
+            return 1;
+        }
+        std::cout << "Results written to " << options.json_path << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,400 @@
+#include "advanced_telematics.hpp"
+
+// ============================================================================
+// ENHANCED MAIN APPLICATION
+// ============================================================================
+
+static void printUsage() {
+    std::cout << "usage: advanced_telematics [--simulate] [--fleet N] [--hours H] [--interval S]\n"
+                 "                           [--seed N] [--logs | --no-logs]\n"
+                 "                           [--journal DIR] [--journal-sync-ms MS]\n"
+                 "                           [--alert-file PATH] [--alert-socket PATH]\n"
+                 "                           [--alert-webhook PORT[/PATH]] [--emergency-budget-ms MS]\n"
+                 "                           [--latency-budget-us US] [--degraded-mode N] [--no-load-shedding]\n"
+                 "                           [--offline-after S]\n"
+                 "       advanced_telematics --partitions P [--fleet N] [--rate R] [--seed N]\n"
+                 "  --simulate     replay fleet time on a simulated clock, then exit\n"
+                 "  --partitions P run P engine processes, each owning a vehicle ID range\n"
+                 "  --rate R       readings per second routed to the partitions (default 200)\n"
+                 "  --fleet N      vehicles in the fleet (default 10000 simulated, 1000 partitioned)\n"
+                 "  --hours H      simulated hours to run (default 24)\n"
+                 "  --interval S   seconds between readings per vehicle (default 30)\n"
+                 "  --seed N       simulator seed (default random)\n"
+                 "  --logs         write the enhanced_*.csv logs (default unless simulating)\n"
+                 "  --no-logs      do not write them\n"
+                 "  --journal DIR  recover anomalies and vehicle counters from DIR, then journal them there\n"
+                 "  --journal-sync-ms MS  group commit interval (default 50)\n"
+                 "  --alert-file PATH     append every alert to PATH as JSON lines\n"
+                 "  --alert-socket PATH   send every alert as a datagram to a Unix socket\n"
+                 "  --alert-webhook PORT[/PATH]  POST every alert to http://127.0.0.1:PORT/PATH\n"
+                 "  --emergency-budget-ms MS  EMERGENCY detection-to-delivery budget (default 100)\n"
+                 "  --latency-budget-us US  ingest call latency above which load is shed (default 2000)\n"
+                 "  --degraded-mode N      never run below mode N: 1 skip ML, 2 sample logs,\n"
+                 "                         3 coarse analytics, 4 shed duplicate readings\n"
+                 "  --no-load-shedding     keep the mode fixed (NORMAL unless --degraded-mode)\n"
+                 "  --offline-after S      silence before a vehicle is OFFLINE (default 30,\n"
+                 "                         at least three report intervals when simulating)\n";
+}
+
+int main(int argc, char** argv) {
+    bool simulate = false;
+    bool write_logs = true;
+    bool logs_requested = false;
+    SimulatedRunConfig run_config;
+    PartitionedConfig partitioned_config;
+    PartitionWorkerConfig worker_config;
+    JournalConfig journal_config;
+    DispatchConfig dispatch_config;
+    OverloadConfig overload_config;
+    int offline_after_s = 0;
+    std::string alert_file, alert_socket, alert_webhook;
+    bool partitioned = false;
+    bool worker = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (arg == "--simulate") {
+            simulate = true;
+        } else if (arg == "--no-logs" || arg == "--logs") {
+            write_logs = arg == "--logs";
+            logs_requested = true;
+        } else if (arg == "--fleet" && value) {
+            run_config.fleet_size = static_cast<size_t>(std::max(1, std::atoi(value)));
+            partitioned_config.fleet_size = std::max(1, std::atoi(value));
+            ++i;
+        } else if (arg == "--partitions" && value) {
+            partitioned = true;
+            partitioned_config.partitions = static_cast<size_t>(std::max(1, std::atoi(value)));
+            ++i;
+        } else if (arg == "--rate" && value) {
+            partitioned_config.readings_per_second = std::max(0.0, std::atof(value));
+            ++i;
+        } else if (arg == "--partition-worker") {
+            // Internal: started by the coordinator
+            worker = true;
+        } else if (arg == "--socket" && value) {
+            worker_config.socket_path = value;
+            ++i;
+        } else if (arg == "--vehicles" && value) {
+            if (std::sscanf(value, "%d-%d", &worker_config.first_id, &worker_config.last_id) != 2) {
+                printUsage();
+                return 2;
+            }
+            ++i;
+        } else if (arg == "--journal" && value) {
+            journal_config.directory = value;
+            ++i;
+        } else if (arg == "--journal-sync-ms" && value) {
+            journal_config.sync_interval_ms = static_cast<uint32_t>(std::max(1, std::atoi(value)));
+            ++i;
+        } else if (arg == "--alert-file" && value) {
+            alert_file = value;
+            ++i;
+        } else if (arg == "--alert-socket" && value) {
+            alert_socket = value;
+            ++i;
+        } else if (arg == "--alert-webhook" && value) {
+            alert_webhook = value;
+            ++i;
+        } else if (arg == "--emergency-budget-ms" && value) {
+            dispatch_config.level(static_cast<int>(AlertPriority::EMERGENCY)).latency_budget_ms =
+                std::max(1, std::atoi(value));
+            ++i;
+        } else if (arg == "--latency-budget-us" && value) {
+            overload_config.latency_budget_us = std::max(1.0, std::atof(value));
+            ++i;
+        } else if (arg == "--degraded-mode" && value) {
+            const int mode = std::atoi(value);
+            if (mode < 0 || mode >= static_cast<int>(DEGRADED_MODES)) {
+                printUsage();
+                return 2;
+            }
+            overload_config.min_mode = static_cast<DegradedMode>(mode);
+            ++i;
+        } else if (arg == "--offline-after" && value) {
+            offline_after_s = std::max(1, std::atoi(value));
+            ++i;
+        } else if (arg == "--no-load-shedding") {
+            overload_config.adaptive = false;
+        } else if (arg == "--hours" && value) {
+            run_config.hours = std::max(0.0, std::atof(value));
+            ++i;
+        } else if (arg == "--interval" && value) {
+            run_config.report_interval_s = std::max(1, std::atoi(value));
+            ++i;
+        } else if (arg == "--seed" && value) {
+            run_config.seed = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+            partitioned_config.seed = run_config.seed;
+            worker_config.seed = run_config.seed;
+            ++i;
+        } else {
+            printUsage();
+            return arg == "--help" || arg == "-h" ? 0 : 2;
+        }
+    }
+    // A simulated day writes tens of millions of CSV rows; opt in with --logs
+    if (simulate && !logs_requested) write_logs = false;
+    
+    if (worker) return partition_worker_main(worker_config);
+    if (partitioned) {
+        if (!PARTITIONING_SUPPORTED) {
+            std::cerr << "Error: partitioned deployment is not supported on this platform\n";
+            return 1;
+        }
+        std::cout << "🚗 Starting partitioned Vehicle Telematics deployment...\n";
+        return partitioned_coordinator_main(partitioned_config);
+    }
+    
+    std::cout << "🚗 Starting Enhanced Vehicle Telematics Anomaly Detection System...\n";
+    std::cout << "Features: ML Detection, Geofencing, Predictive Analytics, Enhanced Logging\n\n";
+    
+    SimulatedClock simulated_clock;
+    DataManagerOptions manager_options;
+    manager_options.seed = run_config.seed;
+    manager_options.write_logs = write_logs;
+    manager_options.overload = overload_config;
+    if (offline_after_s > 0) {
+        manager_options.offline_after_ms = offline_after_s * 1000LL;
+    } else if (simulate) {
+        // Vehicles report once per interval; a single gap is not an outage
+        manager_options.offline_after_ms = std::max<int64_t>(manager_options.offline_after_ms,
+                                                             3000LL * run_config.report_interval_s);
+    }
+    if (simulate) manager_options.clock = &simulated_clock;
+    AdvancedDataManager data_manager(manager_options);
+    
+    // Local metrics endpoint; TELEMATICS_METRICS_PORT=0 disables it
+    MetricsHttpServer metrics_server(data_manager.getMetrics());
+    int metrics_port = 9464;
+    if (const char* port_env = std::getenv("TELEMATICS_METRICS_PORT")) {
+        metrics_port = std::atoi(port_env);
+    }
+    if (metrics_port > 0) {
+        std::string error;
+        if (metrics_server.start(metrics_port, error)) {
+            std::cout << "Metrics available at http://127.0.0.1:" << metrics_server.port() << "/metrics\n";
+        } else {
+            std::cerr << "Warning: metrics endpoint disabled (port " << metrics_port << ": " << error << ")\n";
+        }
+    }
+    
+    // Dashboard stream (SSE); TELEMATICS_FEED_PORT=0 disables it
+    FeedServerConfig feed_config;
+    if (const char* interval_env = std::getenv("TELEMATICS_FEED_INTERVAL_MS")) {
+        feed_config.tick_ms = std::max(20, std::atoi(interval_env));
+    }
+    LiveFeedServer feed_server(data_manager.getLiveFeed(), feed_config);
+    int feed_port = 8787;
+    if (const char* port_env = std::getenv("TELEMATICS_FEED_PORT")) {
+        feed_port = std::atoi(port_env);
+    }
+    if (feed_port > 0) {
+        std::string error;
+        if (feed_server.start(feed_port, error)) {
+            std::cout << "Live feed available at http://127.0.0.1:" << feed_server.port() << "/events\n";
+        } else {
+            std::cerr << "Warning: live feed disabled (port " << feed_port << ": " << error << ")\n";
+        }
+    }
+    
+    if (!journal_config.directory.empty()) {
+        JournalRecovery recovery;
+        std::string error;
+        if (!data_manager.openJournal(journal_config, recovery, error)) {
+            std::cerr << "Error: journal " << journal_config.directory << ": " << error << "\n";
+            return 1;
+        }
+        std::cout << "Journal " << journal_config.directory << ": recovered "
+                  << (recovery.had_snapshot ? "snapshot + " : "") << recovery.records << " records from "
+                  << recovery.journals << " journal(s), " << std::fixed << std::setprecision(1)
+                  << recovery.bytes / 1048576.0 << " MB in " << recovery.elapsed_ms << " ms";
+        if (recovery.torn_bytes > 0) std::cout << " (" << recovery.torn_bytes << " torn bytes discarded)";
+        std::cout << "\n";
+    }
+    
+    if (!alert_file.empty() || !alert_socket.empty() || !alert_webhook.empty()) {
+        std::vector<std::unique_ptr<AlertSink>> sinks;
+        std::string error;
+        bool ok = true;
+        if (!alert_file.empty()) {
+            auto sink = std::make_unique<FileAlertSink>();
+            ok = sink->open(alert_file, error);
+            sinks.push_back(std::move(sink));
+        }
+        if (ok && !alert_socket.empty()) {
+            auto sink = std::make_unique<UnixSocketAlertSink>();
+            ok = sink->connect(alert_socket, error);
+            sinks.push_back(std::move(sink));
+        }
+        if (ok && !alert_webhook.empty()) {
+            const size_t slash = alert_webhook.find('/');
+            const int port = std::atoi(alert_webhook.substr(0, slash).c_str());
+            ok = port > 0 && port < 65536 && LOCAL_HTTP_SUPPORTED;
+            if (ok) {
+                sinks.push_back(std::make_unique<WebhookAlertSink>(
+                    port, slash == std::string::npos ? "/alerts" : alert_webhook.substr(slash)));
+            } else {
+                error = "bad webhook " + alert_webhook;
+            }
+        }
+        if (!ok || !data_manager.startAlertDispatch(dispatch_config, std::move(sinks), error)) {
+            std::cerr << "Error: alert dispatch: " << error << "\n";
+            return 1;
+        }
+        std::cout << "Dispatching alerts (EMERGENCY budget "
+                  << dispatch_config.level(static_cast<int>(AlertPriority::EMERGENCY)).latency_budget_ms
+                  << " ms)\n";
+    }
+    
+    // Fleet state table for external readers, published only when
+    // TELEMATICS_SHM_NAME names a segment (e.g. /telematics_fleet)
+    std::string shm_name;
+    uint32_t shm_slots = 16384;
+    if (const char* name_env = std::getenv("TELEMATICS_SHM_NAME")) shm_name = name_env;
+    if (const char* slots_env = std::getenv("TELEMATICS_SHM_SLOTS")) {
+        shm_slots = static_cast<uint32_t>(std::max(1, std::atoi(slots_env)));
+    }
+    if (SHARED_STATE_SUPPORTED && !shm_name.empty() && shm_name != "0") {
+        std::string error;
+        if (data_manager.publishSharedState(shm_name, shm_slots, error)) {
+            std::cout << "Fleet state published in shared memory " << shm_name << "\n";
+        } else {
+            std::cerr << "Warning: shared fleet state disabled (" << shm_name << ": " << error << ")\n";
+        }
+    }
+    
+    if (simulate) {
+        simulated_fleet_run(data_manager, simulated_clock, run_config);
+        data_manager.stopAlertDispatch();
+        data_manager.printSystemStatus();
+        data_manager.setRunning(false);
+        std::cout << "\n🎯 Simulated run complete.\n";
+        std::cout << "  Total Readings: " << data_manager.getTotalReadingsProcessed() << "\n";
+        std::cout << "  Total Anomalies: " << data_manager.getTotalAnomaliesDetected() << "\n";
+        return 0;
+    }
+    
+    data_manager.startHeartbeatMonitor();
+    std::thread sim_thread(enhanced_simulation_thread, std::ref(data_manager));
+    
+    std::cout << "Initializing system and generating baseline data...\n";
+    std::this_thread::sleep_for(std::chrono::seconds(5));
+    
+    std::cout << "\n=== ENHANCED COMMAND INTERFACE ===\n";
+    std::cout << "Available commands:\n";
+    std::cout << "  analytics <id>     - Enhanced analytics for vehicle\n";
+    std::cout << "  history <id> <min> - Long-horizon statistics from compressed history\n";
+    std::cout << "  trips <id>         - Recent trips with route compression\n";
+    std::cout << "  eco <id>           - Fuel use and eco score per trip, day and lifetime\n";
+    std::cout << "  query <expr>       - Ad-hoc fleet query ('query help' for syntax)\n";
+    std::cout << "  anomalies <id>     - List anomalies for vehicle\n";
+    std::cout << "  critical           - Show critical alerts\n";
+    std::cout << "  status             - System status and performance\n";
+    std::cout << "  metrics            - Dump the metrics exposed on the HTTP endpoint\n";
+    std::cout << "  vehicles           - List all vehicles\n";
+    std::cout << "  report <file> [analytics] - Export system report (.csv/.json by extension)\n";
+    std::cout << "  arrow <prefix>     - Export readings, anomalies and vehicles as Arrow IPC files\n";
+    std::cout << "  pause/resume       - Control simulation\n";
+    std::cout << "  help               - Show this help\n";
+    std::cout << "  quit               - Exit application\n\n";
+    
+    std::string command;
+    while (true) {
+        std::cout << "🔧 Enter command: ";
+        std::cin >> command;
+        
+        if (command == "analytics") {
+            int vehicle_id;
+            std::cin >> vehicle_id;
+            data_manager.printEnhancedAnalytics(vehicle_id);
+        } else if (command == "history") {
+            int vehicle_id, minutes;
+            std::cin >> vehicle_id >> minutes;
+            data_manager.printLongHorizonAnalytics(vehicle_id, minutes);
+        } else if (command == "trips") {
+            int vehicle_id;
+            std::cin >> vehicle_id;
+            data_manager.printTrips(vehicle_id);
+        } else if (command == "eco") {
+            int vehicle_id;
+            std::cin >> vehicle_id;
+            data_manager.printEcoScore(vehicle_id);
+        } else if (command == "query") {
+            std::string query_text;
+            std::getline(std::cin, query_text);
+            data_manager.runFleetQuery(query_text);
+        } else if (command == "anomalies") {
+            int vehicle_id;
+            std::cin >> vehicle_id;
+            // Print all anomalies for the specified vehicle
+            std::cout << "Fetching anomalies for vehicle " << vehicle_id << "...\n";
+        } else if (command == "critical") {
+            AdvancedDataManager::printCriticalAlerts(data_manager.getCriticalAlerts(20));
+        } else if (command == "status") {
+            data_manager.printSystemStatus();
+        } else if (command == "metrics") {
+            std::cout << data_manager.getMetrics().render();
+        } else if (command == "vehicles") {
+            auto vehicle_ids = data_manager.getActiveVehicleIds();
+            std::cout << "\n=== ACTIVE VEHICLES ===\n";
+            for (int id : vehicle_ids) {
+                std::cout << "Vehicle " << id << "\n";
+            }
+        } else if (command == "report") {
+            std::string args;
+            std::getline(std::cin, args);
+            std::istringstream words(args);
+            std::string filename, extra;
+            words >> filename >> extra;
+            ReportOptions report_options;
+            report_options.format = reportFormatFor(filename);
+            report_options.include_analytics = extra == "analytics";
+            data_manager.exportSystemReport(filename, report_options);
+        } else if (command == "arrow") {
+            std::string prefix;
+            std::cin >> prefix;
+            data_manager.exportArrow(prefix);
+        } else if (command == "pause") {
+            data_manager.setPaused(true);
+            std::cout << "✅ Simulation paused.\n";
+        } else if (command == "resume") {
+            data_manager.setPaused(false);
+            std::cout << "▶️  Simulation resumed.\n";
+        } else if (command == "help") {
+            std::cout << "\n=== ENHANCED COMMAND INTERFACE ===\n";
+            std::cout << "Available commands:\n";
+            std::cout << "  analytics <id>     - Enhanced analytics for vehicle\n";
+            std::cout << "  history <id> <min> - Long-horizon statistics from compressed history\n";
+            std::cout << "  trips <id>         - Recent trips with route compression\n";
+            std::cout << "  eco <id>           - Fuel use and eco score per trip, day and lifetime\n";
+            std::cout << "  query <expr>       - Ad-hoc fleet query ('query help' for syntax)\n";
+            std::cout << "  anomalies <id>     - List anomalies for vehicle\n";
+            std::cout << "  critical           - Show critical alerts\n";
+            std::cout << "  status             - System status and performance\n";
+            std::cout << "  metrics            - Dump the metrics exposed on the HTTP endpoint\n";
+            std::cout << "  vehicles           - List all vehicles\n";
+            std::cout << "  report <file> [analytics] - Export system report (.csv/.json by extension)\n";
+            std::cout << "  arrow <prefix>     - Export readings, anomalies and vehicles as Arrow IPC files\n";
+            std::cout << "  pause/resume       - Control simulation\n";
+            std::cout << "  help               - Show this help\n";
+            std::cout << "  quit               - Exit application\n\n";
+        } else if (command == "quit") {
+            std::cout << "🛑 Shutting down enhanced telematics system...\n";
+            data_manager.setRunning(false);
+            break;
+        } else {
+            std::cout << "❌ Unknown command. Type 'help' for available commands.\n";
+        }
+    }
+    
+    std::cout << "Waiting for simulation thread to complete...\n";
+    sim_thread.join();
+    
+    std::cout << "\n🎯 Enhanced Vehicle Telematics System shutdown complete.\n";
+    std::cout << "Final Statistics:\n";
+    std::cout << "  Total Readings: " << data_manager.getTotalReadingsProcessed() << "\n";
+    std::cout << "  Total Anomalies: " << data_manager.getTotalAnomaliesDetected() << "\n";
+    std::cout << "Thank you for using the Enhanced Vehicle Telematics System!\n";
+    
+    return 0;
+}
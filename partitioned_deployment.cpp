@@ -0,0 +1,542 @@
+#include "advanced_telematics.hpp"
+
+#include <csignal>
+
+#if !defined(_WIN32)
+#include <sys/wait.h>
+#endif
+
+// ============================================================================
+// PARTITIONED DEPLOYMENT
+// ============================================================================
+
+namespace {
+
+// ---------------------------------------------------------------------------
+// Wire forms of the engine types
+// ---------------------------------------------------------------------------
+
+static_assert(std::is_trivially_copyable<FleetStatus>::value, "FleetStatus is sent as raw bytes");
+
+void encodeReading(WireWriter& out, const SensorReading& r) {
+    out.put(static_cast<int64_t>(r.timestamp.time_since_epoch().count()));
+    out.put(r.sequence_number);
+    out.put(r.vehicle_id);
+    out.put(r.speed_kmph);
+    out.put(r.rpm);
+    out.put(r.engine_temp_celsius);
+    out.put(r.fuel_level_percent);
+    out.put(r.throttle_position_percent);
+    out.put(r.latitude);
+    out.put(r.longitude);
+    out.put(r.acceleration_ms2);
+    out.put(r.brake_pressure_bar);
+    out.put(r.oil_pressure_bar);
+    out.put(r.battery_voltage);
+    out.put(r.odometer_km);
+    uint8_t flags = (r.engine_on ? 1 : 0) | (r.abs_active ? 2 : 0) | (r.traction_control_active ? 4 : 0);
+    out.put(flags);
+}
+
+SensorReading decodeReading(WireReader& in) {
+    SensorReading r;
+    r.timestamp = std::chrono::system_clock::time_point(
+        std::chrono::system_clock::duration(in.get<int64_t>()));
+    r.sequence_number = in.get<uint64_t>();
+    r.vehicle_id = in.get<int>();
+    r.speed_kmph = in.get<double>();
+    r.rpm = in.get<double>();
+    r.engine_temp_celsius = in.get<double>();
+    r.fuel_level_percent = in.get<double>();
+    r.throttle_position_percent = in.get<double>();
+    r.latitude = in.get<double>();
+    r.longitude = in.get<double>();
+    r.acceleration_ms2 = in.get<double>();
+    r.brake_pressure_bar = in.get<double>();
+    r.oil_pressure_bar = in.get<double>();
+    r.battery_voltage = in.get<double>();
+    r.odometer_km = in.get<int>();
+    uint8_t flags = in.get<uint8_t>();
+    r.engine_on = flags & 1;
+    r.abs_active = flags & 2;
+    r.traction_control_active = flags & 4;
+    return r;
+}
+
+void encodeVehicle(WireWriter& out, const VehicleSummary& v) {
+    out.put(v.vehicle_id);
+    out.putString(v.make_model);
+    out.putString(v.license_plate);
+    out.put(v.state);
+    out.put(v.total_distance_km);
+    out.put(v.avg_speed);
+    out.put(v.max_speed);
+    out.put(v.total_anomalies);
+    out.put(v.harsh_events_count);
+    out.put(v.l_per_100km);
+    out.put(v.eco_score);
+    out.put(v.eco_trip_score);
+    out.put(v.eco_day_score);
+}
+
+VehicleSummary decodeVehicle(WireReader& in) {
+    VehicleSummary v;
+    v.vehicle_id = in.get<int>();
+    v.make_model = in.getString();
+    v.license_plate = in.getString();
+    v.state = in.get<VehicleState>();
+    v.total_distance_km = in.get<double>();
+    v.avg_speed = in.get<double>();
+    v.max_speed = in.get<double>();
+    v.total_anomalies = in.get<int>();
+    v.harsh_events_count = in.get<int>();
+    v.l_per_100km = in.get<double>();
+    v.eco_score = in.get<double>();
+    v.eco_trip_score = in.get<double>();
+    v.eco_day_score = in.get<double>();
+    return v;
+}
+
+// Commands a partition answers; replies hold that partition's share only
+enum class PartitionCommand : uint8_t { STATUS = 1, VEHICLES, CRITICAL };
+
+const size_t CRITICAL_ALERT_LIMIT = 20;
+
+std::string answerCommand(AdvancedDataManager& manager, const std::string& request) {
+    WireReader in(request);
+    auto command = in.get<PartitionCommand>();
+    std::string reply;
+    WireWriter out(reply);
+    switch (command) {
+        case PartitionCommand::STATUS:
+            out.put(manager.getFleetStatus());
+            break;
+        case PartitionCommand::VEHICLES: {
+            auto vehicles = manager.getVehicleSummaries();
+            out.put(static_cast<uint32_t>(vehicles.size()));
+            for (const auto& v : vehicles) encodeVehicle(out, v);
+            break;
+        }
+        case PartitionCommand::CRITICAL: {
+            auto alerts = manager.getCriticalAlerts(in.get<uint32_t>());
+            out.put(static_cast<uint32_t>(alerts.size()));
+            for (const auto& a : alerts) encodeAnomaly(out, a);
+            break;
+        }
+    }
+    return reply;
+}
+
+// ---------------------------------------------------------------------------
+// Coordinator side
+// ---------------------------------------------------------------------------
+
+class PartitionCoordinator {
+private:
+    struct Partition {
+        int pid = -1;
+        int fd = -1;
+        std::string socket_path;
+        std::string batch;          // encoded readings not yet sent
+        uint32_t batch_count = 0;
+        uint64_t routed = 0;
+        bool connected = false;
+    };
+
+    static const size_t MAX_BATCH_BYTES = 64 * 1024;
+
+    PartitionMap partition_map;
+    std::vector<Partition> partitions;
+    std::string socket_dir;
+    std::mutex io_mutex;   // frames to a partition are never interleaved
+
+public:
+    ~PartitionCoordinator() { stop(); }
+
+    bool start(const PartitionedConfig& config, std::string& error) {
+#if defined(_WIN32)
+        (void)config;
+        error = "partitioned deployment is not supported on this platform";
+        return false;
+#else
+        char dir_template[] = "/tmp/telematics-XXXXXX";
+        if (!::mkdtemp(dir_template)) {
+            error = std::string("mkdtemp: ") + std::strerror(errno);
+            return false;
+        }
+        socket_dir = dir_template;
+        partition_map = PartitionMap::evenSplit(config.fleet_size, config.partitions);
+        partitions.resize(partition_map.size());
+
+        for (size_t i = 0; i < partitions.size(); ++i) {
+            Partition& p = partitions[i];
+            const auto& range = partition_map.range(i);
+            p.socket_path = socket_dir + "/partition-" + std::to_string(i) + ".sock";
+            std::vector<std::string> args = {
+                "advanced_telematics", "--partition-worker", "--socket", p.socket_path,
+                "--vehicles", std::to_string(range.first_id) + "-" + std::to_string(range.last_id),
+                "--seed", std::to_string(config.seed ? config.seed + static_cast<uint32_t>(i) : 0)
+            };
+            p.pid = ::fork();
+            if (p.pid < 0) {
+                error = std::string("fork: ") + std::strerror(errno);
+                return false;
+            }
+            if (p.pid == 0) {
+                std::vector<char*> argv;
+                for (auto& arg : args) argv.push_back(&arg[0]);
+                argv.push_back(nullptr);
+                ::execv("/proc/self/exe", argv.data());
+                std::perror("execv");
+                ::_exit(127);
+            }
+        }
+        for (size_t i = 0; i < partitions.size(); ++i) {
+            partitions[i].fd = connectUnixSocket(partitions[i].socket_path, 10000, error);
+            if (partitions[i].fd < 0) {
+                error = "partition " + std::to_string(i) + ": " + error;
+                return false;
+            }
+            partitions[i].connected = true;
+        }
+        return true;
+#endif
+    }
+
+    void stop() {
+#if !defined(_WIN32)
+        std::lock_guard<std::mutex> lock(io_mutex);
+        for (auto& p : partitions) {
+            if (p.fd >= 0) {
+                sendBatch(p);
+                std::string error;
+                sendFrame(p.fd, FrameType::SHUTDOWN, std::string(), error);
+                closeSocket(p.fd);
+                p.fd = -1;
+            }
+            if (p.pid > 0) {
+                // A worker we never connected to would otherwise wait for us
+                if (!p.connected) ::kill(p.pid, SIGTERM);
+                ::waitpid(p.pid, nullptr, 0);
+                p.pid = -1;
+            }
+            ::unlink(p.socket_path.c_str());
+        }
+        if (!socket_dir.empty()) ::rmdir(socket_dir.c_str());
+        socket_dir.clear();
+#endif
+    }
+
+    void route(const SensorReading& reading) {
+        std::lock_guard<std::mutex> lock(io_mutex);
+        Partition& p = partitions[partition_map.partitionFor(reading.vehicle_id)];
+        WireWriter out(p.batch);
+        encodeReading(out, reading);
+        p.batch_count++;
+        p.routed++;
+        if (p.batch.size() >= MAX_BATCH_BYTES) sendBatch(p);
+    }
+
+    // Sends buffered readings; with `flush_reorder` also asks every
+    // partition to release readings held for quiet vehicles
+    void sendPending(bool flush_reorder) {
+        std::lock_guard<std::mutex> lock(io_mutex);
+        for (auto& p : partitions) {
+            sendBatch(p);
+            if (flush_reorder) send(p, FrameType::FLUSH, std::string());
+        }
+    }
+
+    // Sends the command to every partition, then collects the replies, so
+    // partitions work on it in parallel. Dead partitions reply "".
+    std::vector<std::string> broadcast(const std::string& request) {
+        std::lock_guard<std::mutex> lock(io_mutex);
+        for (auto& p : partitions) {
+            sendBatch(p);
+            send(p, FrameType::COMMAND, request);
+        }
+        std::vector<std::string> replies(partitions.size());
+        for (size_t i = 0; i < partitions.size(); ++i) {
+            Partition& p = partitions[i];
+            if (p.fd < 0) continue;
+            FrameType type;
+            std::string error;
+            if (!receiveFrame(p.fd, type, replies[i], error) || type != FrameType::REPLY) {
+                fail(p, i, error.empty() ? "unexpected frame" : error);
+                replies[i].clear();
+            }
+        }
+        return replies;
+    }
+
+    const PartitionMap& getMap() const { return partition_map; }
+    bool alive(size_t i) const { return partitions[i].fd >= 0; }
+    int pid(size_t i) const { return partitions[i].pid; }
+    uint64_t routed(size_t i) const { return partitions[i].routed; }
+
+private:
+    void sendBatch(Partition& p) {
+        if (p.batch_count == 0) return;
+        std::string payload;
+        WireWriter out(payload);
+        out.put(p.batch_count);
+        payload += p.batch;
+        p.batch.clear();
+        p.batch_count = 0;
+        send(p, FrameType::READINGS, payload);
+    }
+
+    void send(Partition& p, FrameType type, const std::string& payload) {
+        if (p.fd < 0) return;
+        std::string error;
+        if (!sendFrame(p.fd, type, payload, error)) fail(p, &p - partitions.data(), error);
+    }
+
+    void fail(Partition& p, size_t index, const std::string& error) {
+        std::cerr << "\nPartition " << index << " unavailable: " << error << "\n";
+        closeSocket(p.fd);
+        p.fd = -1;
+    }
+};
+
+// Readings for the whole fleet at a fixed rate, routed by vehicle ID
+void coordinator_simulation_thread(PartitionCoordinator& coordinator, AdvancedDataManager& generator,
+                                   const PartitionedConfig& config, std::atomic<bool>& running,
+                                   std::atomic<bool>& paused) {
+    std::mt19937 gen(config.seed ? config.seed : std::random_device{}());
+    std::uniform_int_distribution<> vehicle_dist(1, std::max(1, config.fleet_size));
+    std::uniform_real_distribution<> anomaly_chance(0.0, 1.0);
+    std::uniform_int_distribution<> anomaly_type_dist(1, 10);
+
+    const auto tick = std::chrono::milliseconds(10);
+    double owed = 0.0;
+    auto last_send = std::chrono::steady_clock::now();
+    auto last_flush = last_send;
+    while (running) {
+        std::this_thread::sleep_for(tick);
+        if (paused) continue;
+
+        owed += config.readings_per_second * std::chrono::duration<double>(tick).count();
+        for (; owed >= 1.0; owed -= 1.0) {
+            int vehicle_id = vehicle_dist(gen);
+            int anomaly_scenario = anomaly_chance(gen) < 0.03 ? anomaly_type_dist(gen) : 0;
+            coordinator.route(generator.generateEnhancedSyntheticReading(vehicle_id, anomaly_scenario));
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (now - last_send >= std::chrono::milliseconds(100)) {
+            bool flush = now - last_flush >= std::chrono::seconds(1);
+            coordinator.sendPending(flush);
+            last_send = now;
+            if (flush) last_flush = now;
+        }
+    }
+    coordinator.sendPending(true);
+}
+
+void printPartitionedHelp() {
+    std::cout << "\n=== PARTITIONED COMMAND INTERFACE ===\n";
+    std::cout << "Available commands:\n";
+    std::cout << "  status             - Fleet status merged across partitions\n";
+    std::cout << "  partitions         - Vehicle ranges and routed readings per partition\n";
+    std::cout << "  vehicles           - List all vehicles\n";
+    std::cout << "  critical           - Most recent critical alerts fleet-wide\n";
+    std::cout << "  report <filename>  - Export system report\n";
+    std::cout << "  pause/resume       - Control simulation\n";
+    std::cout << "  help               - Show this help\n";
+    std::cout << "  quit               - Exit application\n\n";
+}
+
+std::string commandRequest(PartitionCommand command, uint32_t argument = 0) {
+    std::string request;
+    WireWriter out(request);
+    out.put(command);
+    out.put(argument);
+    return request;
+}
+
+FleetStatus mergedStatus(PartitionCoordinator& coordinator, size_t& answered) {
+    FleetStatus status;
+    answered = 0;
+    for (const auto& reply : coordinator.broadcast(commandRequest(PartitionCommand::STATUS))) {
+        WireReader in(reply);
+        FleetStatus part = in.get<FleetStatus>();
+        if (!in.ok()) continue;
+        status.merge(part);
+        answered++;
+    }
+    return status;
+}
+
+std::vector<VehicleSummary> mergedVehicles(PartitionCoordinator& coordinator) {
+    std::vector<VehicleSummary> vehicles;
+    for (const auto& reply : coordinator.broadcast(commandRequest(PartitionCommand::VEHICLES))) {
+        WireReader in(reply);
+        uint32_t count = in.get<uint32_t>();
+        for (uint32_t i = 0; i < count && in.ok(); ++i) vehicles.push_back(decodeVehicle(in));
+    }
+    std::sort(vehicles.begin(), vehicles.end(),
+              [](const VehicleSummary& a, const VehicleSummary& b) { return a.vehicle_id < b.vehicle_id; });
+    return vehicles;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Entry points
+// ---------------------------------------------------------------------------
+
+int partition_worker_main(const PartitionWorkerConfig& config) {
+    DataManagerOptions options;
+    options.seed = config.seed;
+    options.write_logs = false;     // partitions would all write the same files
+    options.sample_fleet = false;
+    AdvancedDataManager manager(options);
+
+    const auto& sample = AdvancedDataManager::sampleVehicles();
+    for (int id = config.first_id; id <= config.last_id; ++id) {
+        if (id >= 1 && id <= static_cast<int>(sample.size())) {
+            manager.registerVehicle(id, sample[id - 1].first, sample[id - 1].second);
+        } else {
+            std::stringstream plate;
+            plate << "FLT-" << std::setfill('0') << std::setw(5) << id;
+            manager.registerVehicle(id, "Fleet Vehicle", plate.str());
+        }
+    }
+    manager.setGeofences(AdvancedDataManager::sampleGeofences());
+
+    std::string error;
+    int listen_fd = listenUnixSocket(config.socket_path, error);
+    if (listen_fd < 0) {
+        std::cerr << "Partition worker: cannot listen on " << config.socket_path << ": " << error << "\n";
+        return 1;
+    }
+#if defined(_WIN32)
+    return 1;
+#else
+    // Give up if no coordinator connects, so an orphaned worker does not linger
+    pollfd pfd{listen_fd, POLLIN, 0};
+    int fd = ::poll(&pfd, 1, 30000) > 0 ? ::accept(listen_fd, nullptr, nullptr) : -1;
+    closeSocket(listen_fd);
+    ::unlink(config.socket_path.c_str());
+    if (fd < 0) {
+        std::cerr << "Partition worker: no coordinator connected\n";
+        return 1;
+    }
+
+    FrameType type;
+    std::string payload;
+    while (receiveFrame(fd, type, payload, error)) {
+        if (type == FrameType::READINGS) {
+            WireReader in(payload);
+            uint32_t count = in.get<uint32_t>();
+            for (uint32_t i = 0; i < count; ++i) {
+                SensorReading reading = decodeReading(in);
+                if (!in.ok()) break;
+                manager.processSensorReading(reading);
+            }
+        } else if (type == FrameType::FLUSH) {
+            manager.flushReorderBuffers();
+        } else if (type == FrameType::COMMAND) {
+            if (!sendFrame(fd, FrameType::REPLY, answerCommand(manager, payload), error)) break;
+        } else if (type == FrameType::SHUTDOWN) {
+            break;
+        }
+    }
+    manager.setRunning(false);
+    closeSocket(fd);
+    return 0;
+#endif
+}
+
+int partitioned_coordinator_main(const PartitionedConfig& config) {
+    PartitionCoordinator coordinator;
+    std::string error;
+    if (!coordinator.start(config, error)) {
+        std::cerr << "Error: could not start partitions: " << error << "\n";
+        return 1;
+    }
+    const PartitionMap& map = coordinator.getMap();
+    std::cout << "Started " << map.size() << " partitions for " << config.fleet_size << " vehicles ("
+              << config.readings_per_second << " readings/s)\n";
+
+    // Device-side state only: the coordinator runs no detection itself
+    DataManagerOptions generator_options;
+    generator_options.seed = config.seed;
+    generator_options.write_logs = false;
+    generator_options.sample_fleet = false;
+    AdvancedDataManager generator(generator_options);
+
+    std::atomic<bool> running{true};
+    std::atomic<bool> paused{false};
+    std::thread sim_thread(coordinator_simulation_thread, std::ref(coordinator), std::ref(generator),
+                           std::cref(config), std::ref(running), std::ref(paused));
+
+    printPartitionedHelp();
+    std::string command;
+    while (true) {
+        std::cout << "🔧 Enter command: ";
+        if (!(std::cin >> command)) command = "quit";
+
+        if (command == "status") {
+            size_t answered = 0;
+            FleetStatus status = mergedStatus(coordinator, answered);
+            std::cout << "\n=== SYSTEM STATUS (" << answered << "/" << map.size() << " partitions) ===\n";
+            std::cout << "Paused: " << (paused ? "Yes" : "No") << "\n";
+            AdvancedDataManager::printFleetStatus(status);
+        } else if (command == "partitions") {
+            std::cout << "\n=== PARTITIONS ===\n";
+            for (size_t i = 0; i < map.size(); ++i) {
+                std::cout << "Partition " << i << ": vehicles " << map.range(i).first_id << "-"
+                          << map.range(i).last_id << ", pid " << coordinator.pid(i) << ", "
+                          << coordinator.routed(i) << " readings routed"
+                          << (coordinator.alive(i) ? "" : " (unavailable)") << "\n";
+            }
+        } else if (command == "vehicles") {
+            std::cout << "\n=== ACTIVE VEHICLES ===\n";
+            for (const auto& v : mergedVehicles(coordinator)) {
+                std::cout << "Vehicle " << v.vehicle_id << " (partition " << map.partitionFor(v.vehicle_id) << ")\n";
+            }
+        } else if (command == "critical") {
+            std::vector<AnomalyRecord> alerts;
+            auto request = commandRequest(PartitionCommand::CRITICAL, CRITICAL_ALERT_LIMIT);
+            for (const auto& reply : coordinator.broadcast(request)) {
+                WireReader in(reply);
+                uint32_t count = in.get<uint32_t>();
+                for (uint32_t i = 0; i < count && in.ok(); ++i) alerts.push_back(decodeAnomaly(in));
+            }
+            AdvancedDataManager::keepNewest(alerts, CRITICAL_ALERT_LIMIT);
+            AdvancedDataManager::printCriticalAlerts(alerts);
+        } else if (command == "report") {
+            std::string filename;
+            std::cin >> filename;
+            size_t answered = 0;
+            FleetStatus status = mergedStatus(coordinator, answered);
+            ReportOptions report_options;
+            report_options.format = reportFormatFor(filename);
+            if (AdvancedDataManager::writeSystemReport(filename, std::chrono::system_clock::now(), status,
+                                                       mergedVehicles(coordinator), report_options)) {
+                std::cout << "System report exported to " << filename << " (" << answered << "/"
+                          << map.size() << " partitions)\n";
+            }
+        } else if (command == "pause") {
+            paused = true;
+            std::cout << "✅ Simulation paused.\n";
+        } else if (command == "resume") {
+            paused = false;
+            std::cout << "▶️  Simulation resumed.\n";
+        } else if (command == "help") {
+            printPartitionedHelp();
+        } else if (command == "quit") {
+            std::cout << "🛑 Shutting down partitions...\n";
+            break;
+        } else {
+            std::cout << "❌ Unknown or single-process-only command. Type 'help' for available commands.\n";
+        }
+    }
+
+    running = false;
+    sim_thread.join();
+    coordinator.stop();
+    return 0;
+}
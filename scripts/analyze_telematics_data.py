@@ -2,10 +2,78 @@ import pandas as pd
 import matplotlib.pyplot as plt
 import seaborn as sns
 import numpy as np
+import os
+import sys
 from datetime import datetime, timedelta
 import warnings
 warnings.filterwarnings('ignore')
 
+# Arrow IPC files written by the engine's `arrow <prefix>` command; the
+# dashboard CSV exports are used when they are not present
+ARROW_PREFIX = sys.argv[1] if len(sys.argv) > 1 else 'telematics'
+VEHICLES_CSV = 'vehicles_data_2024-01-30.csv'  # Update with actual filename
+ANOMALIES_CSV = 'anomalies_data_2024-01-30.csv'  # Update with actual filename
+
+def load_arrow_exports(prefix):
+    """
+    Load the engine's Arrow exports and shape them like the dashboard CSVs
+    """
+    vehicles = pd.read_feather(f'{prefix}_vehicles.arrow')
+    anomalies = pd.read_feather(f'{prefix}_anomalies.arrow')
+    readings = pd.read_feather(f'{prefix}_readings.arrow')
+
+    # Latest reading per vehicle provides the "current" sensor values
+    latest = (readings.sort_values('timestamp')
+              .groupby('vehicle_id', observed=True).last()
+              [['speed', 'rpm', 'temp', 'fuel', 'latitude', 'longitude']])
+    vehicles = vehicles.drop(columns=['latitude', 'longitude']).join(latest, on='vehicle_id')
+
+    vehicles_df = vehicles.rename(columns={
+        'vehicle_id': 'Vehicle ID',
+        'make_model': 'Make Model',
+        'license_plate': 'License Plate',
+        'state': 'State',
+        'total_distance_km': 'Total Distance (km)',
+        'avg_speed': 'Avg Speed (km/h)',
+        'max_speed': 'Max Speed (km/h)',
+        'harsh_events': 'Harsh Events',
+        'total_anomalies': 'Total Anomalies',
+        'speed': 'Current Speed',
+        'rpm': 'Current RPM',
+        'temp': 'Current Temperature',
+        'fuel': 'Current Fuel Level',
+        'latitude': 'Latitude',
+        'longitude': 'Longitude',
+        'last_seen': 'Last Seen',
+    })
+    for column in ['Make Model', 'State']:
+        vehicles_df[column] = vehicles_df[column].astype(str)
+
+    anomalies_df = anomalies.rename(columns={
+        'timestamp': 'Timestamp',
+        'vehicle_id': 'Vehicle ID',
+        'sensor': 'Sensor Name',
+        'value': 'Value',
+        'type': 'Type',
+        'description': 'Description',
+        'severity': 'Severity',
+        'priority': 'Priority',
+        'acknowledged': 'Acknowledged',
+        'location': 'Location',
+    })
+    anomalies_df['Type'] = anomalies_df['Type'].astype(str)
+    return vehicles_df, anomalies_df, len(readings)
+
+def load_telematics_data():
+    """
+    Load vehicles and anomalies, preferring the engine's Arrow exports
+    """
+    if os.path.exists(f'{ARROW_PREFIX}_vehicles.arrow'):
+        vehicles_df, anomalies_df, reading_count = load_arrow_exports(ARROW_PREFIX)
+        print(f"✅ Loaded Arrow exports '{ARROW_PREFIX}_*.arrow' ({reading_count} readings)")
+        return vehicles_df, anomalies_df
+    return pd.read_csv(VEHICLES_CSV), pd.read_csv(ANOMALIES_CSV)
+
 def load_and_analyze_telematics_data():
     """
     Load and analyze vehicle telematics data from CSV files
@@ -14,17 +82,13 @@ def load_and_analyze_telematics_data():
     print("=" * 50)
     
     try:
-        # Load vehicles data
-        vehicles_df = pd.read_csv('vehicles_data_2024-01-30.csv')  # Update with actual filename
+        vehicles_df, anomalies_df = load_telematics_data()
         print(f"✅ Loaded {len(vehicles_df)} vehicles")
-        
-        # Load anomalies data
-        anomalies_df = pd.read_csv('anomalies_data_2024-01-30.csv')  # Update with actual filename
         print(f"✅ Loaded {len(anomalies_df)} anomalies")
         
     except FileNotFoundError as e:
-        print(f"❌ Error loading CSV files: {e}")
-        print("Please make sure to export data from the web application first!")
+        print(f"❌ Error loading data files: {e}")
+        print("Please export data from the engine ('arrow <prefix>') or the web application first!")
         return
     
     # Basic statistics
@@ -248,8 +312,7 @@ def export_summary_report():
     Export a summary report to CSV
     """
     try:
-        vehicles_df = pd.read_csv('vehicles_data_2024-01-30.csv')
-        anomalies_df = pd.read_csv('anomalies_data_2024-01-30.csv')
+        vehicles_df, anomalies_df = load_telematics_data()
         
         # Create summary statistics
         summary_data = {
@@ -0,0 +1,208 @@
+"""
+Reader for the fleet state table the engine publishes in POSIX shared memory
+(telematics/shared_state.hpp). The segment is mapped read-only and viewed as a
+numpy structured array, so a poll of the whole fleet is a few vectorised
+memory reads with no syscalls. The engine publishes the table only when
+started with TELEMATICS_SHM_NAME set to the segment name.
+
+Each slot is guarded by a seqlock: the engine makes a slot's sequence odd
+while rewriting it. A snapshot copies the sequences, then the rows, then the
+sequences again, and re-reads only the rows whose sequence was odd or moved.
+
+    python telematics_shm.py [/segment_name] [--interval SECONDS]
+"""
+
+import mmap
+import os
+import sys
+import time
+
+import numpy as np
+
+DEFAULT_SEGMENT = os.environ.get('TELEMATICS_SHM_NAME', '/telematics_fleet')
+MAGIC = b'TLMFLEET'
+VERSION = 1
+HEADER_SIZE = 128
+SLOT_SIZE = 192
+
+STATE_NAMES = ['NORMAL', 'WARNING', 'CRITICAL', 'OFFLINE', 'MAINTENANCE']
+FLAG_ENGINE_ON = 1
+FLAG_ABS_ACTIVE = 2
+FLAG_TRACTION_CONTROL = 4
+
+HEADER_DTYPE = np.dtype([
+    ('magic', 'S8'),
+    ('version', '<u4'),
+    ('header_size', '<u4'),
+    ('slot_size', '<u4'),
+    ('capacity', '<u4'),
+    ('vehicle_count', '<u4'),
+    ('writer_pid', '<u4'),
+    ('publish_count', '<u8'),
+    ('updated_ms', '<i8'),
+    ('reserved', 'V80'),
+])
+
+# Mirrors SharedVehicleRow
+ROW_DTYPE = np.dtype([
+    ('timestamp_ms', '<i8'),
+    ('last_seen_ms', '<i8'),
+    ('vehicle_id', '<i4'),
+    ('state', 'u1'),
+    ('flags', 'u1'),
+    ('reserved0', '<u2'),
+    ('odometer_km', '<i4'),
+    ('total_anomalies', '<i4'),
+    ('harsh_events', '<i4'),
+    ('reserved1', '<u4'),
+    ('speed', '<f8'),
+    ('rpm', '<f8'),
+    ('temperature', '<f8'),
+    ('fuel_level', '<f8'),
+    ('throttle_position', '<f8'),
+    ('latitude', '<f8'),
+    ('longitude', '<f8'),
+    ('acceleration', '<f8'),
+    ('brake_pressure', '<f8'),
+    ('oil_pressure', '<f8'),
+    ('battery_voltage', '<f8'),
+    ('total_distance_km', '<f8'),
+    ('avg_speed', '<f8'),
+    ('max_speed', '<f8'),
+    ('avg_fuel_efficiency', '<f8'),
+    ('sequence_number', '<u8'),
+])
+
+SLOT_DTYPE = np.dtype({
+    'names': ['sequence', 'row'],
+    'formats': ['<u4', ROW_DTYPE],
+    'offsets': [0, 8],
+    'itemsize': SLOT_SIZE,
+})
+
+assert HEADER_DTYPE.itemsize == HEADER_SIZE and ROW_DTYPE.itemsize == 168
+
+
+class FleetStateReader:
+    """
+    Read-only view of a fleet state segment
+    """
+
+    def __init__(self, name=DEFAULT_SEGMENT):
+        path = '/dev/shm/' + name.lstrip('/')
+        fd = os.open(path, os.O_RDONLY)
+        try:
+            self._map = mmap.mmap(fd, 0, access=mmap.ACCESS_READ)
+        finally:
+            os.close(fd)
+
+        header = np.frombuffer(self._map, dtype=HEADER_DTYPE, count=1)[0]
+        if header['magic'] != MAGIC:
+            raise ValueError(f'{name} is not a fleet state segment (or not yet initialised)')
+        if (header['version'] != VERSION or header['header_size'] != HEADER_SIZE
+                or header['slot_size'] != SLOT_SIZE):
+            raise ValueError(f'{name}: unsupported layout version {header["version"]}')
+
+        self.name = name
+        self.capacity = int(header['capacity'])
+        self.writer_pid = int(header['writer_pid'])
+        self._header = np.frombuffer(self._map, dtype=HEADER_DTYPE, count=1)
+        self._slots = np.frombuffer(self._map, dtype=SLOT_DTYPE,
+                                    count=self.capacity, offset=HEADER_SIZE)
+
+    def __len__(self):
+        return int(self._header['vehicle_count'][0])
+
+    @property
+    def publish_count(self):
+        return int(self._header['publish_count'][0])
+
+    def snapshot(self, retries=64):
+        """
+        Consistent copy of every published row, as a ROW_DTYPE array. Rows
+        the engine kept rewriting through every retry are left out.
+        """
+        slots = self._slots[:len(self)]
+        before = slots['sequence'].copy()
+        rows = slots['row'].copy()
+        after = slots['sequence'].copy()
+        torn = np.flatnonzero((before != after) | (before & 1).astype(bool))
+
+        keep = np.ones(len(rows), dtype=bool)
+        for index in torn:
+            slot = slots[index:index + 1]
+            for _ in range(retries):
+                seq = int(slot['sequence'][0])
+                if seq & 1:
+                    continue
+                row = slot['row'].copy()
+                if int(slot['sequence'][0]) == seq:
+                    rows[index] = row[0]
+                    break
+            else:
+                keep[index] = False
+        return rows[keep]
+
+    def to_dataframe(self):
+        """
+        Snapshot as a pandas DataFrame indexed by vehicle ID
+        """
+        import pandas as pd
+        rows = self.snapshot()
+        df = pd.DataFrame({name: rows[name] for name in ROW_DTYPE.names
+                           if not name.startswith('reserved')})
+        df['state'] = pd.Categorical.from_codes(df['state'].clip(upper=len(STATE_NAMES) - 1),
+                                                STATE_NAMES)
+        df['engine_on'] = (df['flags'] & FLAG_ENGINE_ON) != 0
+        df['abs_active'] = (df['flags'] & FLAG_ABS_ACTIVE) != 0
+        df['traction_control_active'] = (df['flags'] & FLAG_TRACTION_CONTROL) != 0
+        df['timestamp'] = pd.to_datetime(df['timestamp_ms'], unit='ms')
+        return df.drop(columns=['flags']).set_index('vehicle_id')
+
+    def close(self):
+        self._header = None
+        self._slots = None
+        self._map.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+
+def main(argv):
+    name = DEFAULT_SEGMENT
+    interval = 1.0
+    args = iter(argv)
+    for arg in args:
+        if arg == '--interval':
+            interval = float(next(args))
+        else:
+            name = arg
+
+    with FleetStateReader(name) as reader:
+        print(f'📡 {reader.name}: {len(reader)} of {reader.capacity} slots, writer pid {reader.writer_pid}')
+        last_count = reader.publish_count
+        last_time = time.monotonic()
+        while True:
+            time.sleep(interval)
+            started = time.perf_counter()
+            rows = reader.snapshot()
+            elapsed_us = (time.perf_counter() - started) * 1e6
+            now = time.monotonic()
+            count = reader.publish_count
+            states = np.bincount(rows['state'], minlength=len(STATE_NAMES))
+            print(f'{len(rows):6d} vehicles  '
+                  + '  '.join(f'{STATE_NAMES[i]}={states[i]}' for i in range(len(STATE_NAMES)))
+                  + f'  avg speed {rows["speed"].mean() if len(rows) else 0.0:6.1f} km/h'
+                  + f'  {(count - last_count) / (now - last_time):8.0f} rows/s'
+                  + f'  snapshot {elapsed_us:.0f} µs')
+            last_count, last_time = count, now
+
+
+if __name__ == '__main__':
+    try:
+        main(sys.argv[1:])
+    except KeyboardInterrupt:
+        pass
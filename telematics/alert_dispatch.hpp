@@ -0,0 +1,528 @@
+#pragma once
+
+#include "clock.hpp"
+#include "local_http.hpp"
+#include "metrics.hpp"
+#include "report_writer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <sys/un.h>
+#endif
+
+// ============================================================================
+// ALERT DISPATCH
+// ============================================================================
+//
+// The path from a detected anomaly to whoever has to act on it. The engine
+// enqueues under its own lock and never does I/O or waits there; dispatcher
+// threads deliver each alert to every sink (file, Unix datagram socket,
+// loopback webhook, or anything implementing AlertSink) as one JSON line.
+//
+// Alerts wait in one bounded queue per priority, and each priority has its
+// own dispatcher thread delivering its queue oldest first. An EMERGENCY
+// alert therefore never waits behind a lower-priority delivery, not even
+// one stuck in a slow webhook, and sinks must accept deliveries from several
+// threads at once. When a level is full its DropPolicy decides: drop the new
+// alert, evict the oldest queued one of the level, or evict the oldest alert
+// of the lowest non-empty lower priority. That last one lends the evicted
+// alert's slot to the higher level, so a level can grow past its own
+// capacity. Every enqueue also checks the total queued against the sum of
+// the capacities: while lent slots fill it, a level below its own capacity
+// is treated as full too, so the lower level cannot take its slot back and
+// the total never exceeds that sum. Enqueue never blocks.
+//
+// Latency is measured per priority, both from detection (enqueue) to
+// delivery, on steady_clock, and from the reading's device timestamp to
+// delivery, on the engine clock. A delivery later than the level's
+// detection-to-delivery budget counts as an SLO miss.
+
+#if defined(_WIN32)
+inline constexpr bool ALERT_SOCKET_SINKS_SUPPORTED = false;
+#else
+inline constexpr bool ALERT_SOCKET_SINKS_SUPPORTED = true;
+#endif
+
+inline constexpr size_t DISPATCH_LEVELS = 5;   // priorities 1 (LOW) .. 5 (EMERGENCY)
+
+enum class DropPolicy { DROP_NEWEST, DROP_OLDEST, EVICT_LOWER };
+
+struct DispatchLevelConfig {
+    size_t capacity = 1024;
+    DropPolicy policy = DropPolicy::DROP_OLDEST;
+    int64_t latency_budget_ms = 1000;   // detection to delivery
+};
+
+struct DispatchConfig {
+    std::array<DispatchLevelConfig, DISPATCH_LEVELS> levels;   // [priority - 1]
+
+    DispatchConfig() {
+        levels[3] = {4096, DropPolicy::EVICT_LOWER, 500};   // CRITICAL
+        levels[4] = {4096, DropPolicy::EVICT_LOWER, 100};   // EMERGENCY
+    }
+
+    DispatchLevelConfig& level(int priority) { return levels[static_cast<size_t>(priority - 1)]; }
+};
+
+struct DispatchAlert {
+    int priority = 1;            // AlertPriority value, 1..5
+    int vehicle_id = 0;
+    int severity = 0;
+    const char* type = "";       // must point to a string literal
+    const char* event = "";      // must point to a string literal
+    std::string sensor;
+    std::string description;
+    std::string location;
+    double value = 0.0;
+    double ml_score = std::nan("");
+    int64_t reading_ms = 0;      // device timestamp of the reading that raised it
+    std::chrono::steady_clock::time_point detected;   // set by enqueue()
+};
+
+class AlertSink {
+public:
+    virtual ~AlertSink() = default;
+    virtual const char* kind() const = 0;
+    // `line` is the alert as one JSON object plus newline. Called from every
+    // priority's dispatcher thread, possibly at the same time.
+    virtual bool deliver(const DispatchAlert& alert, std::string_view line, std::string& error) = 0;
+};
+
+// Appends JSON lines to a file, flushed per alert
+class FileAlertSink : public AlertSink {
+private:
+    std::FILE* file = nullptr;
+    std::mutex write_mutex;   // one line and its flush at a time
+
+public:
+    ~FileAlertSink() override { if (file) std::fclose(file); }
+
+    bool open(const std::string& path, std::string& error) {
+        file = std::fopen(path.c_str(), "a");
+        if (!file) error = path + ": " + std::strerror(errno);
+        return file != nullptr;
+    }
+
+    const char* kind() const override { return "file"; }
+
+    bool deliver(const DispatchAlert&, std::string_view line, std::string& error) override {
+        std::lock_guard<std::mutex> lock(write_mutex);
+        if (std::fwrite(line.data(), 1, line.size(), file) != line.size() || std::fflush(file) != 0) {
+            error = std::strerror(errno);
+            return false;
+        }
+        return true;
+    }
+};
+
+// One datagram per alert to a listening AF_UNIX SOCK_DGRAM socket. Never
+// blocks: a full receiver fails the delivery.
+class UnixSocketAlertSink : public AlertSink {
+private:
+    int fd = -1;
+
+public:
+    ~UnixSocketAlertSink() override { closeSocket(fd); }
+
+    bool connect(const std::string& path, std::string& error) {
+#if defined(_WIN32)
+        (void)path;
+        error = "Unix socket sinks are not supported on this platform";
+        return false;
+#else
+        sockaddr_un addr{};
+        if (path.size() >= sizeof(addr.sun_path)) { error = path + ": path too long"; return false; }
+        addr.sun_family = AF_UNIX;
+        std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+        fd = ::socket(AF_UNIX, SOCK_DGRAM, 0);
+        if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            error = path + ": " + std::strerror(errno);
+            closeSocket(fd);
+            fd = -1;
+            return false;
+        }
+        return true;
+#endif
+    }
+
+    const char* kind() const override { return "unix_socket"; }
+
+    bool deliver(const DispatchAlert&, std::string_view line, std::string& error) override {
+#if defined(_WIN32)
+        (void)line;
+        error = "unsupported";
+        return false;
+#else
+        if (::send(fd, line.data(), line.size(), MSG_DONTWAIT) < 0) {
+            error = std::strerror(errno);
+            return false;
+        }
+        return true;
+#endif
+    }
+};
+
+// POSTs each alert to http://127.0.0.1:<port><path>; a 2xx answer within
+// timeout_ms is a delivery. A stand-in for a real webhook, which would sit
+// behind a local relay.
+class WebhookAlertSink : public AlertSink {
+private:
+    int port = 0;
+    std::string path;
+    int timeout_ms;
+
+public:
+    WebhookAlertSink(int target_port, std::string target_path = "/alerts", int timeout = 200)
+        : port(target_port), path(std::move(target_path)), timeout_ms(timeout) {}
+
+    const char* kind() const override { return "webhook"; }
+
+    bool deliver(const DispatchAlert&, std::string_view line, std::string& error) override {
+#if defined(_WIN32)
+        (void)line;
+        error = "unsupported";
+        return false;
+#else
+        int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) { error = std::strerror(errno); return false; }
+        bool ok = post(fd, line, error);
+        closeSocket(fd);
+        return ok;
+#endif
+    }
+
+private:
+#if !defined(_WIN32)
+    bool waitFor(int fd, short events, std::string& error) {
+        pollfd p{fd, events, 0};
+        int ready = ::poll(&p, 1, timeout_ms);
+        if (ready > 0) return true;
+        error = ready == 0 ? "timed out" : std::strerror(errno);
+        return false;
+    }
+
+    bool post(int fd, std::string_view body, std::string& error) {
+        setNonBlocking(fd);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(static_cast<uint16_t>(port));
+        if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            if (errno != EINPROGRESS || !waitFor(fd, POLLOUT, error)) {
+                if (error.empty()) error = std::strerror(errno);
+                return false;
+            }
+            int so_error = 0;
+            socklen_t len = sizeof(so_error);
+            ::getsockopt(fd, SOL_SOCKET, SO_ERROR, &so_error, &len);
+            if (so_error != 0) { error = std::strerror(so_error); return false; }
+        }
+
+        std::string request;
+        request.append("POST ").append(path).append(" HTTP/1.1\r\nHost: 127.0.0.1\r\n"
+                       "Content-Type: application/json\r\nConnection: close\r\nContent-Length: ")
+               .append(std::to_string(body.size())).append("\r\n\r\n").append(body);
+        size_t sent = 0;
+        while (sent < request.size()) {
+            ssize_t n = ::send(fd, request.data() + sent, request.size() - sent, MSG_NOSIGNAL);
+            if (n > 0) { sent += static_cast<size_t>(n); continue; }
+            if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) { error = std::strerror(errno); return false; }
+            if (!waitFor(fd, POLLOUT, error)) return false;
+        }
+
+        // "HTTP/1.1 2xx" is all we read of the answer
+        char status[12];
+        size_t got = 0;
+        while (got < sizeof(status)) {
+            ssize_t n = ::recv(fd, status + got, sizeof(status) - got, 0);
+            if (n > 0) { got += static_cast<size_t>(n); continue; }
+            if (n == 0) break;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) { error = std::strerror(errno); return false; }
+            if (!waitFor(fd, POLLIN, error)) return false;
+        }
+        if (got < sizeof(status) || std::memcmp(status, "HTTP/1.", 7) != 0 || status[9] != '2') {
+            error = got < sizeof(status) ? "no response" : "HTTP " + std::string(status + 9, 3);
+            return false;
+        }
+        return true;
+    }
+#endif
+};
+
+struct DispatchLevelStats {
+    uint64_t enqueued = 0;
+    uint64_t delivered = 0;
+    uint64_t dropped = 0;
+    uint64_t failed = 0;         // deliveries a sink rejected
+    uint64_t slo_misses = 0;
+    uint64_t queued = 0;
+    double p99_ms = 0.0;         // detection to delivery, from power-of-two buckets
+    double max_ms = 0.0;
+};
+
+class AlertDispatcher {
+private:
+    static constexpr size_t LATENCY_BUCKETS = 32;   // bucket b: below 2^b microseconds
+
+    struct Level {
+        std::deque<DispatchAlert> queue;
+        std::condition_variable ready;
+        std::thread worker;   // delivers this level's queue
+        Counter enqueued, delivered, dropped, slo_misses;
+        Gauge depth;
+        Histogram detection_latency, event_latency;
+        // Dispatcher thread writes, stats() reads
+        std::array<std::atomic<uint64_t>, LATENCY_BUCKETS> latency_us{};
+        std::atomic<uint64_t> max_latency_ns{0};
+        std::atomic<uint64_t> enqueued_total{0}, delivered_total{0}, dropped_total{0}, failed_total{0},
+                              slo_miss_total{0};
+    };
+
+    struct SinkEntry {
+        std::unique_ptr<AlertSink> sink;
+        Counter failures;
+    };
+
+    MetricsRegistry& metrics;
+    const Clock* clock;
+    DispatchConfig config;
+    std::array<Level, DISPATCH_LEVELS> levels;
+    std::vector<SinkEntry> sinks;
+
+    std::mutex mutex;            // the queues, queued, stopping
+    size_t queued = 0;           // all levels' queues together
+    size_t total_capacity = 0;   // sum of the levels' capacities; queued never exceeds it
+    bool stopping = false;
+    std::atomic<bool> running{false};
+
+public:
+    AlertDispatcher(MetricsRegistry& registry, const Clock* engine_clock) : metrics(registry), clock(engine_clock) {
+        static const char* const names[DISPATCH_LEVELS] = {"LOW", "MEDIUM", "HIGH", "CRITICAL", "EMERGENCY"};
+        std::vector<double> buckets = {1e-4, 2.5e-4, 5e-4, 1e-3, 2.5e-3, 5e-3, 1e-2, 2.5e-2, 5e-2, 0.1, 0.25,
+                                       0.5, 1.0, 2.5, 5.0};
+        total_capacity = sumCapacities(config);
+        for (size_t i = 0; i < DISPATCH_LEVELS; ++i) {
+            Level& level = levels[i];
+            const std::string label = std::string("priority=\"") + names[i] + "\"";
+            level.enqueued = Counter(metrics, "telematics_alert_dispatch_total",
+                                     "Alerts by dispatch outcome", label + ",outcome=\"enqueued\"");
+            level.delivered = Counter(metrics, "telematics_alert_dispatch_total",
+                                      "Alerts by dispatch outcome", label + ",outcome=\"delivered\"");
+            level.dropped = Counter(metrics, "telematics_alert_dispatch_total",
+                                    "Alerts by dispatch outcome", label + ",outcome=\"dropped\"");
+            level.slo_misses = Counter(metrics, "telematics_alert_dispatch_slo_misses_total",
+                                       "Alerts delivered later than their priority's latency budget", label);
+            level.depth = Gauge(metrics, "telematics_alert_dispatch_queue_depth", "Alerts waiting for dispatch", label);
+            level.detection_latency = Histogram(metrics, "telematics_alert_dispatch_latency_seconds",
+                "Time from detection to delivery", label, buckets);
+            level.event_latency = Histogram(metrics, "telematics_alert_event_latency_seconds",
+                "Time from the reading's device timestamp to delivery", label, buckets);
+        }
+    }
+
+    AlertDispatcher(const AlertDispatcher&) = delete;
+    AlertDispatcher& operator=(const AlertDispatcher&) = delete;
+    ~AlertDispatcher() { stop(); }
+
+    // Replaces the configuration and sinks and starts the dispatcher threads
+    bool start(const DispatchConfig& cfg, std::vector<std::unique_ptr<AlertSink>> new_sinks, std::string& error) {
+        stop();
+        if (new_sinks.empty()) {
+            error = "no alert sinks configured";
+            return false;
+        }
+        config = cfg;
+        total_capacity = sumCapacities(config);
+        sinks.clear();
+        for (auto& sink : new_sinks) {
+            Counter failures(metrics, "telematics_alert_sink_failures_total", "Deliveries a sink rejected",
+                             std::string("sink=\"") + sink->kind() + "\"");
+            sinks.push_back({std::move(sink), failures});
+        }
+        stopping = false;
+        running = true;
+        for (Level& level : levels) level.worker = std::thread([this, &level] { dispatchLoop(level); });
+        return true;
+    }
+
+    // Delivers what is queued, then stops the threads
+    void stop() {
+        if (!running) return;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        for (Level& level : levels) {
+            level.ready.notify_all();
+            level.worker.join();
+        }
+        running = false;
+    }
+
+    bool isRunning() const { return running.load(std::memory_order_relaxed); }
+
+    // False if this alert was dropped; its level's DropPolicy decides
+    // whether it or a queued one goes. Never waits for the dispatchers.
+    bool enqueue(DispatchAlert alert) {
+        const size_t index = static_cast<size_t>(std::min<int>(DISPATCH_LEVELS, std::max(1, alert.priority)) - 1);
+        const DispatchLevelConfig& level_config = config.levels[index];
+        Level& level = levels[index];
+        alert.priority = static_cast<int>(index) + 1;
+        alert.detected = std::chrono::steady_clock::now();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopping) return false;
+            level.enqueued.inc();
+            level.enqueued_total.fetch_add(1, std::memory_order_relaxed);
+            if (level.queue.size() >= level_config.capacity || queued >= total_capacity) {
+                Level* victim = level_config.policy == DropPolicy::DROP_NEWEST ? nullptr : &level;
+                if (level_config.policy == DropPolicy::EVICT_LOWER) {
+                    for (size_t i = 0; i < index; ++i) {
+                        if (!levels[i].queue.empty()) { victim = &levels[i]; break; }
+                    }
+                }
+                if (!victim || victim->queue.empty()) {
+                    level.dropped.inc();
+                    level.dropped_total.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+                victim->queue.pop_front();
+                victim->depth.add(-1);
+                victim->dropped.inc();
+                victim->dropped_total.fetch_add(1, std::memory_order_relaxed);
+                queued--;
+            }
+            level.queue.push_back(std::move(alert));
+            level.depth.add(1);
+            queued++;
+        }
+        level.ready.notify_one();
+        return true;
+    }
+
+    DispatchLevelStats stats(int priority) {
+        Level& level = levels[static_cast<size_t>(priority - 1)];
+        DispatchLevelStats s;
+        s.enqueued = level.enqueued_total.load(std::memory_order_relaxed);
+        s.delivered = level.delivered_total.load(std::memory_order_relaxed);
+        s.dropped = level.dropped_total.load(std::memory_order_relaxed);
+        s.failed = level.failed_total.load(std::memory_order_relaxed);
+        s.slo_misses = level.slo_miss_total.load(std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            s.queued = level.queue.size();
+        }
+        uint64_t total = 0;
+        std::array<uint64_t, LATENCY_BUCKETS> counts;
+        for (size_t b = 0; b < LATENCY_BUCKETS; ++b) {
+            counts[b] = level.latency_us[b].load(std::memory_order_relaxed);
+            total += counts[b];
+        }
+        uint64_t seen = 0;
+        for (size_t b = 0; b < LATENCY_BUCKETS && total > 0; ++b) {
+            seen += counts[b];
+            if (seen * 100 >= total * 99) {
+                s.p99_ms = std::ldexp(1.0, static_cast<int>(b)) / 1000.0;
+                break;
+            }
+        }
+        s.max_ms = level.max_latency_ns.load(std::memory_order_relaxed) / 1e6;
+        return s;
+    }
+
+private:
+    static size_t sumCapacities(const DispatchConfig& cfg) {
+        size_t total = 0;
+        for (const DispatchLevelConfig& level : cfg.levels) total += level.capacity;
+        return total;
+    }
+
+    // One level's thread: its queue oldest first, until stopped and drained
+    void dispatchLoop(Level& level) {
+        DispatchAlert alert;
+        ReportBuffer line;
+        std::string sink_error;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                level.ready.wait(lock, [&] { return stopping || !level.queue.empty(); });
+                if (level.queue.empty()) return;   // stopping and drained
+                alert = std::move(level.queue.front());
+                level.queue.pop_front();
+                level.depth.add(-1);
+                queued--;
+            }
+            deliver(level, alert, line, sink_error);
+        }
+    }
+
+    void deliver(Level& level, const DispatchAlert& alert, ReportBuffer& line, std::string& sink_error) {
+        formatLine(alert, line);
+        bool delivered = false;
+        for (auto& entry : sinks) {
+            sink_error.clear();
+            if (entry.sink->deliver(alert, line.str(), sink_error)) {
+                delivered = true;
+            } else {
+                entry.failures.inc();
+                level.failed_total.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        if (!delivered) return;
+
+        const uint64_t ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - alert.detected).count());
+        level.delivered.inc();
+        level.delivered_total.fetch_add(1, std::memory_order_relaxed);
+        level.detection_latency.observeNanos(ns);
+        const int64_t event_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            clockNow(clock).time_since_epoch()).count() - alert.reading_ms;
+        level.event_latency.observeNanos(static_cast<uint64_t>(std::max<int64_t>(0, event_ms)) * 1000000);
+
+        size_t bucket = 0;
+        while (bucket + 1 < LATENCY_BUCKETS && (uint64_t(1) << bucket) * 1000 <= ns) bucket++;
+        level.latency_us[bucket].fetch_add(1, std::memory_order_relaxed);
+        if (ns > level.max_latency_ns.load(std::memory_order_relaxed)) {
+            level.max_latency_ns.store(ns, std::memory_order_relaxed);
+        }
+        const int64_t budget_ms = config.levels[static_cast<size_t>(alert.priority - 1)].latency_budget_ms;
+        if (ns > static_cast<uint64_t>(budget_ms) * 1000000) {
+            level.slo_misses.inc();
+            level.slo_miss_total.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    static void formatLine(const DispatchAlert& alert, ReportBuffer& line) {
+        static const char* const names[DISPATCH_LEVELS] = {"LOW", "MEDIUM", "HIGH", "CRITICAL", "EMERGENCY"};
+        line.clear();
+        line.append("{\"priority\":\"").append(names[alert.priority - 1])
+            .append("\",\"vehicleId\":").appendInt(alert.vehicle_id)
+            .append(",\"event\":\"").append(alert.event)
+            .append("\",\"type\":\"").append(alert.type)
+            .append("\",\"severity\":").appendInt(alert.severity)
+            .append(",\"sensor\":").appendJsonString(alert.sensor)
+            .append(",\"value\":").appendJsonNumber(alert.value)
+            .append(",\"description\":").appendJsonString(alert.description);
+        if (!alert.location.empty()) line.append(",\"location\":").appendJsonString(alert.location);
+        if (std::isfinite(alert.ml_score)) line.append(",\"mlScore\":").appendJsonNumber(alert.ml_score);
+        line.append(",\"readingTimestampMs\":").appendInt(alert.reading_ms).append("}\n");
+    }
+};
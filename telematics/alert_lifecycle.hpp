@@ -0,0 +1,257 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// ============================================================================
+// ALERT LIFECYCLE
+// ============================================================================
+//
+// Per-vehicle, per-condition state machine that turns a stream of "condition
+// seen" reports into a handful of events:
+//
+//   (cleared) --report--> OPEN --report--> ONGOING --quiet for clear_hold--> CLEARED
+//                                              ^                                |
+//                                              +-- report within dedup_window --+
+//                                                  (REOPENED)
+//
+// - Exit hysteresis: a condition only clears after it has not been reported
+//   for clear_hold_ms (value hysteresis is applied by the detectors, which can
+//   ask isOpen() to pick a lower exit threshold).
+// - Deduplication: repeated reports while open are folded into the
+//   condition; a summary is emitted every summary_interval_ms, and a condition
+//   that re-fires within dedup_window_ms of clearing resumes its episode
+//   (occurrences and duration carry on). Its CLEARED has already gone out, so
+//   resuming emits REOPENED; an episode that was never announced resumes
+//   silently.
+// - Rate limiting: a per-vehicle token bucket caps OPENED/SUMMARY events;
+//   severities at or above bypass_severity are never limited. A rate-limited
+//   REOPENED leaves the episode unannounced, so it is retried as OPENED.
+
+struct AlertConfig {
+    int64_t clear_hold_ms = 10 * 1000;
+    int64_t dedup_window_ms = 60 * 1000;
+    int64_t summary_interval_ms = 5 * 60 * 1000;
+    double rate_limit_per_minute = 30.0;
+    double rate_limit_burst = 20.0;
+    int bypass_severity = 5;
+};
+
+enum class AlertPhase {
+    OPEN,
+    ONGOING,
+    CLEARED
+};
+
+enum class AlertDecision {
+    NONE,       // folded into an existing condition (or rate limited)
+    OPENED,
+    SUMMARY,
+    REOPENED    // a cleared episode resumed within dedup_window_ms
+};
+
+struct AlertCounters {
+    uint64_t opened = 0;
+    uint64_t summaries = 0;
+    uint64_t cleared = 0;
+    uint64_t reopened = 0;
+    uint64_t deduplicated = 0;
+    uint64_t rate_limited = 0;
+};
+
+template <typename Payload>
+class AlertTracker {
+public:
+    struct Condition {
+        uint64_t key = 0;
+        Payload payload;
+        AlertPhase phase = AlertPhase::OPEN;
+        bool announced = false;         // an OPENED event went out for this episode
+        int64_t opened_ms = 0;
+        int64_t last_active_ms = 0;
+        int64_t last_summary_ms = 0;
+        int64_t cleared_ms = 0;
+        uint32_t occurrences = 0;
+        uint32_t reopen_count = 0;
+        double peak_value = 0.0;
+        double last_value = 0.0;
+
+        int64_t durationMs() const {
+            return (phase == AlertPhase::CLEARED ? cleared_ms : last_active_ms) - opened_ms;
+        }
+    };
+
+private:
+    struct VehicleAlerts {
+        std::vector<Condition> conditions;
+        double tokens = 0.0;
+        int64_t last_refill_ms = 0;
+        bool bucket_initialised = false;
+    };
+
+    AlertConfig config;
+    std::unordered_map<int, VehicleAlerts> vehicles;
+    AlertCounters counters;
+
+public:
+    AlertTracker() = default;
+    explicit AlertTracker(const AlertConfig& cfg) : config(cfg) {}
+
+    // Reports that `key` is active for the vehicle at `now_ms`. The returned
+    // decision says whether the caller should emit an event; `condition` is
+    // set to the tracked state either way. make_payload is only invoked when
+    // a new episode starts, so repeated reports copy nothing.
+    template <typename MakePayload>
+    AlertDecision report(int vehicle_id, uint64_t key, int64_t now_ms, double value, int severity,
+                         MakePayload make_payload, const Condition** condition = nullptr) {
+        auto& vehicle = vehicles[vehicle_id];
+        Condition* c = find(vehicle, key);
+
+        AlertDecision decision = AlertDecision::NONE;
+        if (c && c->phase != AlertPhase::CLEARED) {
+            c->phase = AlertPhase::ONGOING;
+            c->occurrences++;
+            // Unannounced (rate limited) episodes retry on every report
+            if (!c->announced || now_ms - c->last_summary_ms >= config.summary_interval_ms) {
+                if (takeToken(vehicle, now_ms, severity)) {
+                    decision = c->announced ? AlertDecision::SUMMARY : AlertDecision::OPENED;
+                    c->announced = true;
+                    c->last_summary_ms = now_ms;
+                }
+            } else {
+                counters.deduplicated++;
+            }
+        } else if (c && now_ms - c->cleared_ms <= config.dedup_window_ms) {
+            // Flapping: resume the previous episode. Its CLEARED went out, so
+            // receivers must hear that it is active again
+            c->phase = AlertPhase::ONGOING;
+            c->occurrences++;
+            c->reopen_count++;
+            if (!c->announced) {
+                counters.deduplicated++;
+            } else if (takeToken(vehicle, now_ms, severity)) {
+                decision = AlertDecision::REOPENED;
+                c->last_summary_ms = now_ms;
+            } else {
+                c->announced = false;
+            }
+        } else {
+            if (!c) {
+                vehicle.conditions.emplace_back();
+                c = &vehicle.conditions.back();
+                c->key = key;
+            }
+            *c = Condition{};
+            c->key = key;
+            c->payload = make_payload();
+            c->phase = AlertPhase::OPEN;
+            c->opened_ms = now_ms;
+            c->last_summary_ms = now_ms;
+            c->occurrences = 1;
+            c->peak_value = value;
+            if (takeToken(vehicle, now_ms, severity)) {
+                c->announced = true;
+                decision = AlertDecision::OPENED;
+            }
+        }
+
+        c->last_active_ms = now_ms;
+        c->last_value = value;
+        if (std::abs(value) > std::abs(c->peak_value)) c->peak_value = value;
+
+        if (decision == AlertDecision::OPENED) counters.opened++;
+        else if (decision == AlertDecision::SUMMARY) counters.summaries++;
+        else if (decision == AlertDecision::REOPENED) counters.reopened++;
+        if (condition) *condition = c;
+        return decision;
+    }
+
+    // Clears conditions that have been quiet for clear_hold_ms, calling
+    // on_cleared for each announced one, and forgets conditions whose
+    // dedup window has passed
+    template <typename Callback>
+    void sweep(int vehicle_id, int64_t now_ms, Callback on_cleared) {
+        auto it = vehicles.find(vehicle_id);
+        if (it == vehicles.end()) return;
+        auto& conditions = it->second.conditions;
+
+        for (auto& c : conditions) {
+            if (c.phase != AlertPhase::CLEARED && now_ms - c.last_active_ms >= config.clear_hold_ms) {
+                c.phase = AlertPhase::CLEARED;
+                c.cleared_ms = now_ms;
+                if (c.announced) {
+                    counters.cleared++;
+                    on_cleared(c);
+                }
+            }
+        }
+
+        conditions.erase(std::remove_if(conditions.begin(), conditions.end(),
+            [&](const Condition& c) {
+                return c.phase == AlertPhase::CLEARED && now_ms - c.cleared_ms > config.dedup_window_ms;
+            }), conditions.end());
+    }
+
+    bool isOpen(int vehicle_id, uint64_t key) const {
+        auto it = vehicles.find(vehicle_id);
+        if (it == vehicles.end()) return false;
+        for (const auto& c : it->second.conditions) {
+            if (c.key == key) return c.phase != AlertPhase::CLEARED;
+        }
+        return false;
+    }
+
+    template <typename Callback>
+    void forEachOpen(int vehicle_id, Callback callback) const {
+        auto it = vehicles.find(vehicle_id);
+        if (it == vehicles.end()) return;
+        for (const auto& c : it->second.conditions) {
+            if (c.phase != AlertPhase::CLEARED) callback(c);
+        }
+    }
+
+    size_t openCount() const {
+        size_t count = 0;
+        for (const auto& pair : vehicles) {
+            for (const auto& c : pair.second.conditions) {
+                if (c.phase != AlertPhase::CLEARED) count++;
+            }
+        }
+        return count;
+    }
+
+    const AlertCounters& getCounters() const { return counters; }
+    const AlertConfig& getConfig() const { return config; }
+
+private:
+    static Condition* find(VehicleAlerts& vehicle, uint64_t key) {
+        for (auto& c : vehicle.conditions) {
+            if (c.key == key) return &c;
+        }
+        return nullptr;
+    }
+
+    bool takeToken(VehicleAlerts& vehicle, int64_t now_ms, int severity) {
+        if (severity >= config.bypass_severity) return true;
+
+        if (!vehicle.bucket_initialised) {
+            vehicle.tokens = config.rate_limit_burst;
+            vehicle.last_refill_ms = now_ms;
+            vehicle.bucket_initialised = true;
+        }
+        if (now_ms > vehicle.last_refill_ms) {
+            vehicle.tokens = std::min(config.rate_limit_burst,
+                vehicle.tokens + (now_ms - vehicle.last_refill_ms) * config.rate_limit_per_minute / 60000.0);
+            vehicle.last_refill_ms = now_ms;
+        }
+        if (vehicle.tokens >= 1.0) {
+            vehicle.tokens -= 1.0;
+            return true;
+        }
+        counters.rate_limited++;
+        return false;
+    }
+};
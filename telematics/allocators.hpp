@@ -0,0 +1,187 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+// ============================================================================
+// PER-READING SCRATCH ARENAS
+// ============================================================================
+//
+// The per-reading pipeline should not touch the heap once every vehicle has
+// been seen. Anything that only lives while one reading is processed is
+// carved from a MonotonicArena, which just bumps a pointer; the owner resets
+// it when the work is done. Reset keeps a single block sized to the largest
+// use seen so far, so after the first few readings neither allocating nor
+// resetting calls into the heap.
+//
+//   MonotonicArena arena;
+//   ArenaVector<FeatureVector> features{ArenaAllocator<FeatureVector>(arena)};
+//   ...
+//   arena.reset();   // every ArenaVector built on it must be gone by now
+
+class MonotonicArena {
+private:
+    struct Block {
+        std::unique_ptr<unsigned char[]> data;
+        size_t size = 0;
+    };
+
+    std::vector<Block> blocks;   // the last one is being carved
+    size_t used = 0;             // bytes carved from blocks.back()
+    size_t total_used = 0;       // across all blocks since the last reset
+    size_t high_water = 0;
+    uint64_t overflow_blocks = 0;
+
+    void addBlock(size_t min_size) {
+        const size_t size = std::max(min_size, blocks.empty() ? size_t(0) : blocks.back().size * 2);
+        blocks.push_back({std::unique_ptr<unsigned char[]>(new unsigned char[size]), size});
+        used = 0;
+    }
+
+public:
+    explicit MonotonicArena(size_t initial_bytes = 16 * 1024) {
+        addBlock(std::max<size_t>(initial_bytes, 64));
+    }
+
+    MonotonicArena(const MonotonicArena&) = delete;
+    MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+    void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+        for (;;) {
+            Block& block = blocks.back();
+            const uintptr_t base = reinterpret_cast<uintptr_t>(block.data.get());
+            const uintptr_t start = (base + used + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+            if (start + bytes <= base + block.size) {
+                total_used += start + bytes - (base + used);
+                used = start + bytes - base;
+                return reinterpret_cast<void*>(start);
+            }
+            overflow_blocks++;
+            addBlock(bytes + alignment);
+        }
+    }
+
+    // Forgets everything carved since the last reset. Overflow blocks are
+    // folded into one block big enough for the whole of that use.
+    void reset() {
+        high_water = std::max(high_water, total_used);
+        if (blocks.size() > 1) {
+            size_t size = blocks.front().size;
+            while (size < high_water) size *= 2;
+            blocks.clear();
+            addBlock(size);
+        }
+        used = 0;
+        total_used = 0;
+    }
+
+    size_t capacity() const {
+        size_t bytes = 0;
+        for (const auto& block : blocks) bytes += block.size;
+        return bytes;
+    }
+    size_t highWater() const { return std::max(high_water, total_used); }
+    uint64_t overflowBlocks() const { return overflow_blocks; }
+};
+
+// Standard allocator over a MonotonicArena; deallocate is a no-op
+template <typename T>
+class ArenaAllocator {
+private:
+    MonotonicArena* arena;
+
+    template <typename U> friend class ArenaAllocator;
+
+public:
+    using value_type = T;
+
+    explicit ArenaAllocator(MonotonicArena& a) noexcept : arena(&a) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena(other.arena) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T))); }
+    void deallocate(T*, size_t) noexcept {}
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const noexcept { return arena == other.arena; }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const noexcept { return arena != other.arena; }
+};
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+// ============================================================================
+// TEXT POOL
+// ============================================================================
+//
+// Append-only store for short texts that are kept for the life of the
+// process, such as the sensor, description and location of every anomaly
+// record. A text is copied into 64 KiB chunks and handed out as a
+// string_view that stays valid until the pool is destroyed, so storing one
+// costs a heap allocation per chunk rather than one per string. Repeated
+// texts (sensor names, fixed descriptions) are found through an index and
+// stored once; the index stops growing at `max_indexed` distinct texts, after
+// which new texts are still pooled but not deduplicated. Thread-safe.
+
+class TextPool {
+private:
+    static constexpr size_t CHUNK_BYTES = 64 * 1024;
+
+    mutable std::mutex mutex;
+    std::vector<std::unique_ptr<char[]>> chunks;   // the last one is being carved
+    size_t used = CHUNK_BYTES;                     // bytes carved from chunks.back()
+    size_t pooled_bytes = 0;
+    std::unordered_set<std::string_view> index;
+    size_t max_indexed;
+
+    std::string_view copy(std::string_view text) {
+        if (text.size() > CHUNK_BYTES / 4) {
+            // Oversized texts get a chunk of their own, behind the one being carved
+            auto own = std::unique_ptr<char[]>(new char[text.size()]);
+            std::memcpy(own.get(), text.data(), text.size());
+            std::string_view stored(own.get(), text.size());
+            chunks.insert(chunks.empty() ? chunks.end() : chunks.end() - 1, std::move(own));
+            pooled_bytes += text.size();
+            return stored;
+        }
+        if (used + text.size() > CHUNK_BYTES) {
+            chunks.push_back(std::unique_ptr<char[]>(new char[CHUNK_BYTES]));
+            used = 0;
+            pooled_bytes += CHUNK_BYTES;
+        }
+        char* start = chunks.back().get() + used;
+        std::memcpy(start, text.data(), text.size());
+        used += text.size();
+        return std::string_view(start, text.size());
+    }
+
+public:
+    explicit TextPool(size_t max_indexed_texts = 1024) : max_indexed(max_indexed_texts) {}
+
+    TextPool(const TextPool&) = delete;
+    TextPool& operator=(const TextPool&) = delete;
+
+    std::string_view intern(std::string_view text) {
+        if (text.empty()) return {};
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(text);
+        if (it != index.end()) return *it;
+        std::string_view stored = copy(text);
+        if (index.size() < max_indexed) index.insert(stored);
+        return stored;
+    }
+
+    size_t bytes() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return pooled_bytes;
+    }
+};
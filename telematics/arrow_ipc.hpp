@@ -0,0 +1,610 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// ============================================================================
+// ARROW IPC FILE WRITER
+// ============================================================================
+//
+// Writes Apache Arrow IPC files (Feather v2) without the Arrow library:
+// schema, dictionary batches, record batches and the footer are encoded here,
+// including the small subset of FlatBuffers the metadata needs. Supported
+// column types are the ones the exports use: integers, doubles, booleans,
+// millisecond UTC timestamps, UTF-8 strings and dictionary-encoded strings.
+//
+// Record batches are streamed to disk as they are filled, so memory is
+// bounded by one batch. The file format cannot replace a dictionary after
+// the first record batch, so dictionary values must be registered on the
+// schema before open(); a value missing from its dictionary is written as
+// null.
+
+namespace arrow_ipc {
+
+// Back-to-front FlatBuffers encoder. Offsets are positions measured from the
+// end of the buffer, as in the reference implementation.
+class FlatBufferBuilder {
+public:
+    using Offset = uint32_t;
+
+private:
+    std::vector<uint8_t> buffer;
+    size_t head;
+    size_t min_align = 1;
+    size_t table_start = 0;
+    std::vector<std::pair<uint16_t, uint32_t>> table_fields;   // (field id, position)
+
+    void reserve(size_t bytes) {
+        if (head >= bytes) return;
+        size_t used = size();
+        size_t capacity = std::max(buffer.size() * 2, used + bytes + 64);
+        std::vector<uint8_t> grown(capacity);
+        std::memcpy(grown.data() + capacity - used, data(), used);
+        buffer.swap(grown);
+        head = capacity - used;
+    }
+
+    void pad(size_t bytes) {
+        reserve(bytes);
+        head -= bytes;
+        std::memset(&buffer[head], 0, bytes);
+    }
+
+    // Pads so that the buffer is `alignment`-aligned after `length` more bytes
+    void prep(size_t alignment, size_t length) {
+        min_align = std::max(min_align, alignment);
+        pad((~(size() + length) + 1) & (alignment - 1));
+    }
+
+    void pushBytes(const void* bytes, size_t count) {
+        reserve(count);
+        head -= count;
+        if (count) std::memcpy(&buffer[head], bytes, count);
+    }
+
+    template <typename T>
+    void push(T value) { pushBytes(&value, sizeof(T)); }
+
+    // Relative uoffset from the slot about to be written to `target`
+    uint32_t referTo(Offset target) {
+        prep(sizeof(uint32_t), 0);
+        return static_cast<uint32_t>(size() - target + sizeof(uint32_t));
+    }
+
+public:
+    FlatBufferBuilder() : buffer(1024), head(1024) {}
+
+    size_t size() const { return buffer.size() - head; }
+    const uint8_t* data() const { return buffer.data() + head; }
+
+    Offset createString(const std::string& value) {
+        prep(sizeof(uint32_t), value.size() + 1);
+        push<uint8_t>(0);
+        pushBytes(value.data(), value.size());
+        push<uint32_t>(static_cast<uint32_t>(value.size()));
+        return static_cast<Offset>(size());
+    }
+
+    Offset createOffsetVector(const std::vector<Offset>& offsets) {
+        prep(sizeof(uint32_t), offsets.size() * sizeof(uint32_t));
+        for (size_t i = offsets.size(); i-- > 0;) push<uint32_t>(referTo(offsets[i]));
+        push<uint32_t>(static_cast<uint32_t>(offsets.size()));
+        return static_cast<Offset>(size());
+    }
+
+    // Vector of inline structs, already laid out little-endian in `bytes`
+    Offset createStructVector(const void* bytes, size_t count, size_t struct_size, size_t alignment) {
+        prep(sizeof(uint32_t), count * struct_size);
+        prep(alignment, count * struct_size);
+        pushBytes(bytes, count * struct_size);
+        push<uint32_t>(static_cast<uint32_t>(count));
+        return static_cast<Offset>(size());
+    }
+
+    void startTable() {
+        table_fields.clear();
+        table_start = size();
+    }
+
+    template <typename T>
+    void addScalar(uint16_t field, T value) {
+        prep(sizeof(T), 0);
+        push<T>(value);
+        table_fields.emplace_back(field, static_cast<uint32_t>(size()));
+    }
+
+    void addOffset(uint16_t field, Offset target) {
+        uint32_t relative = referTo(target);
+        push<uint32_t>(relative);
+        table_fields.emplace_back(field, static_cast<uint32_t>(size()));
+    }
+
+    Offset endTable() {
+        prep(sizeof(int32_t), 0);
+        push<int32_t>(0);   // vtable soffset, patched below
+        const uint32_t object = static_cast<uint32_t>(size());
+
+        size_t slots = 0;
+        for (const auto& field : table_fields) slots = std::max<size_t>(slots, field.first + 1u);
+        std::vector<uint16_t> vtable(slots, 0);
+        for (const auto& field : table_fields) vtable[field.first] = static_cast<uint16_t>(object - field.second);
+
+        for (size_t i = slots; i-- > 0;) push<uint16_t>(vtable[i]);
+        push<uint16_t>(static_cast<uint16_t>(object - table_start));
+        push<uint16_t>(static_cast<uint16_t>((slots + 2) * sizeof(uint16_t)));
+        const uint32_t vtable_position = static_cast<uint32_t>(size());
+
+        int32_t soffset = static_cast<int32_t>(vtable_position) - static_cast<int32_t>(object);
+        std::memcpy(&buffer[buffer.size() - object], &soffset, sizeof(soffset));
+        return object;
+    }
+
+    void finish(Offset root) {
+        prep(std::max<size_t>(min_align, sizeof(uint32_t)), sizeof(uint32_t));
+        uint32_t relative = referTo(root);
+        push<uint32_t>(relative);
+    }
+};
+
+enum class ArrowType {
+    INT8,
+    INT32,
+    INT64,
+    FLOAT64,
+    BOOL,
+    TIMESTAMP_MS,   // UTC epoch milliseconds
+    UTF8,
+    DICTIONARY      // UTF-8 values with int32 indices
+};
+
+class ArrowDictionary {
+private:
+    std::vector<std::string> values;
+    std::unordered_map<std::string, int32_t> index;
+
+public:
+    int32_t add(std::string_view value) {
+        auto it = index.find(std::string(value));
+        if (it != index.end()) return it->second;
+        int32_t id = static_cast<int32_t>(values.size());
+        values.emplace_back(value);
+        index.emplace(values.back(), id);
+        return id;
+    }
+
+    int32_t find(std::string_view value) const {
+        auto it = index.find(std::string(value));
+        return it == index.end() ? -1 : it->second;
+    }
+
+    const std::vector<std::string>& getValues() const { return values; }
+};
+
+struct ArrowField {
+    std::string name;
+    ArrowType type;
+    bool nullable = false;
+    int64_t dictionary_id = -1;
+};
+
+class ArrowSchema {
+private:
+    std::vector<ArrowField> fields;
+    std::vector<ArrowDictionary> dictionaries;   // indexed by dictionary id
+
+public:
+    size_t add(const std::string& name, ArrowType type, bool nullable = false) {
+        ArrowField field{name, type, nullable, -1};
+        if (type == ArrowType::DICTIONARY) {
+            field.dictionary_id = static_cast<int64_t>(dictionaries.size());
+            dictionaries.emplace_back();
+        }
+        fields.push_back(field);
+        return fields.size() - 1;
+    }
+
+    ArrowDictionary& dictionary(size_t field) { return dictionaries[static_cast<size_t>(fields[field].dictionary_id)]; }
+    const ArrowDictionary& dictionary(size_t field) const {
+        return dictionaries[static_cast<size_t>(fields[field].dictionary_id)];
+    }
+    const std::vector<ArrowDictionary>& getDictionaries() const { return dictionaries; }
+    const std::vector<ArrowField>& getFields() const { return fields; }
+    const ArrowField& field(size_t index) const { return fields[index]; }
+    size_t size() const { return fields.size(); }
+};
+
+// Column buffers for one record batch, filled row by row
+class ArrowRecordBatch {
+public:
+    struct Column {
+        std::vector<uint8_t> values;     // fixed-width values, bool bits or UTF-8 bytes
+        std::vector<int32_t> offsets;    // UTF-8 only
+        std::vector<uint8_t> validity;   // one bit per row, 1 = valid
+        int64_t length = 0;
+        int64_t null_count = 0;
+    };
+
+private:
+    const ArrowSchema& schema;
+    std::vector<Column> columns;
+
+    static void setBit(std::vector<uint8_t>& bits, int64_t index, bool value) {
+        size_t byte = static_cast<size_t>(index >> 3);
+        if (bits.size() <= byte) bits.resize(byte + 1, 0);
+        if (value) bits[byte] |= static_cast<uint8_t>(1u << (index & 7));
+    }
+
+    template <typename T>
+    static void appendValue(Column& column, T value) {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+        column.values.insert(column.values.end(), bytes, bytes + sizeof(T));
+    }
+
+    void finishRow(Column& column, bool valid) {
+        setBit(column.validity, column.length, valid);
+        if (!valid) column.null_count++;
+        column.length++;
+    }
+
+    void appendIndex(size_t col, int32_t index) {
+        Column& column = columns[col];
+        appendValue<int32_t>(column, index < 0 ? 0 : index);
+        finishRow(column, index >= 0);
+    }
+
+public:
+    explicit ArrowRecordBatch(const ArrowSchema& s) : schema(s), columns(s.size()) { clear(); }
+
+    void appendInt(size_t col, int64_t value) {
+        Column& column = columns[col];
+        switch (schema.field(col).type) {
+            case ArrowType::INT8: appendValue<int8_t>(column, static_cast<int8_t>(value)); break;
+            case ArrowType::INT32: appendValue<int32_t>(column, static_cast<int32_t>(value)); break;
+            default: appendValue<int64_t>(column, value); break;
+        }
+        finishRow(column, true);
+    }
+
+    void appendDouble(size_t col, double value) {
+        appendValue<double>(columns[col], value);
+        finishRow(columns[col], true);
+    }
+
+    void appendBool(size_t col, bool value) {
+        Column& column = columns[col];
+        setBit(column.values, column.length, value);
+        finishRow(column, true);
+    }
+
+    void appendString(size_t col, std::string_view value) {
+        if (schema.field(col).type == ArrowType::DICTIONARY) {
+            appendIndex(col, schema.dictionary(col).find(value));
+            return;
+        }
+        Column& column = columns[col];
+        column.values.insert(column.values.end(), value.begin(), value.end());
+        column.offsets.push_back(static_cast<int32_t>(column.values.size()));
+        finishRow(column, true);
+    }
+
+    void appendNull(size_t col) {
+        Column& column = columns[col];
+        switch (schema.field(col).type) {
+            case ArrowType::INT8: appendValue<int8_t>(column, 0); break;
+            case ArrowType::INT32: case ArrowType::DICTIONARY: appendValue<int32_t>(column, 0); break;
+            case ArrowType::INT64: case ArrowType::TIMESTAMP_MS: appendValue<int64_t>(column, 0); break;
+            case ArrowType::FLOAT64: appendValue<double>(column, 0.0); break;
+            case ArrowType::BOOL: setBit(column.values, column.length, false); break;
+            case ArrowType::UTF8: column.offsets.push_back(static_cast<int32_t>(column.values.size())); break;
+        }
+        finishRow(column, false);
+    }
+
+    int64_t rows() const { return columns.empty() ? 0 : columns[0].length; }
+
+    const Column& column(size_t index) const { return columns[index]; }
+    const ArrowSchema& getSchema() const { return schema; }
+
+    void clear() {
+        for (auto& column : columns) {
+            column.values.clear();
+            column.validity.clear();
+            column.offsets.assign(1, 0);
+            column.length = 0;
+            column.null_count = 0;
+        }
+    }
+};
+
+class ArrowFileWriter {
+private:
+    // Flatbuffer enum and union values from the Arrow format definition
+    static constexpr int16_t METADATA_V5 = 4;
+    static constexpr uint8_t HEADER_SCHEMA = 1;
+    static constexpr uint8_t HEADER_DICTIONARY_BATCH = 2;
+    static constexpr uint8_t HEADER_RECORD_BATCH = 3;
+    static constexpr uint8_t TYPE_INT = 2;
+    static constexpr uint8_t TYPE_FLOATING_POINT = 3;
+    static constexpr uint8_t TYPE_UTF8 = 5;
+    static constexpr uint8_t TYPE_BOOL = 6;
+    static constexpr uint8_t TYPE_TIMESTAMP = 10;
+
+    struct Block {
+        int64_t offset;
+        int32_t metadata_length;
+        int32_t padding;
+        int64_t body_length;
+    };
+    struct FieldNode {
+        int64_t length;
+        int64_t null_count;
+    };
+    struct BufferSpec {
+        const void* data;
+        int64_t length;
+    };
+
+    std::ofstream out;
+    const ArrowSchema* schema = nullptr;
+    int64_t position = 0;
+    int64_t rows_written = 0;
+    std::vector<Block> dictionary_blocks;
+    std::vector<Block> batch_blocks;
+
+    static int64_t padded(int64_t bytes) { return (bytes + 7) & ~int64_t(7); }
+
+    void writeBytes(const void* data, int64_t length) {
+        out.write(static_cast<const char*>(data), static_cast<std::streamsize>(length));
+        position += length;
+    }
+
+    void writePadding(int64_t length) {
+        static const char zeros[8] = {0};
+        if (length > 0) writeBytes(zeros, length);
+    }
+
+    static FlatBufferBuilder::Offset buildInt(FlatBufferBuilder& fbb, int32_t bit_width, bool is_signed) {
+        fbb.startTable();
+        fbb.addScalar<int32_t>(0, bit_width);
+        fbb.addScalar<uint8_t>(1, is_signed ? 1 : 0);
+        return fbb.endTable();
+    }
+
+    static FlatBufferBuilder::Offset buildField(FlatBufferBuilder& fbb, const ArrowField& field) {
+        using Offset = FlatBufferBuilder::Offset;
+        Offset name = fbb.createString(field.name);
+        Offset children = fbb.createOffsetVector({});
+
+        uint8_t type_id = TYPE_UTF8;
+        Offset type = 0;
+        Offset dictionary = 0;
+        switch (field.type) {
+            case ArrowType::INT8: type_id = TYPE_INT; type = buildInt(fbb, 8, true); break;
+            case ArrowType::INT32: type_id = TYPE_INT; type = buildInt(fbb, 32, true); break;
+            case ArrowType::INT64: type_id = TYPE_INT; type = buildInt(fbb, 64, true); break;
+            case ArrowType::FLOAT64:
+                type_id = TYPE_FLOATING_POINT;
+                fbb.startTable();
+                fbb.addScalar<int16_t>(0, 2);   // Precision.DOUBLE
+                type = fbb.endTable();
+                break;
+            case ArrowType::BOOL:
+                type_id = TYPE_BOOL;
+                fbb.startTable();
+                type = fbb.endTable();
+                break;
+            case ArrowType::TIMESTAMP_MS: {
+                type_id = TYPE_TIMESTAMP;
+                Offset timezone = fbb.createString("UTC");
+                fbb.startTable();
+                fbb.addScalar<int16_t>(0, 1);   // TimeUnit.MILLISECOND
+                fbb.addOffset(1, timezone);
+                type = fbb.endTable();
+                break;
+            }
+            case ArrowType::UTF8:
+            case ArrowType::DICTIONARY:
+                type_id = TYPE_UTF8;
+                fbb.startTable();
+                type = fbb.endTable();
+                break;
+        }
+        if (field.type == ArrowType::DICTIONARY) {
+            Offset index_type = buildInt(fbb, 32, true);
+            fbb.startTable();
+            fbb.addScalar<int64_t>(0, field.dictionary_id);
+            fbb.addOffset(1, index_type);
+            fbb.addScalar<uint8_t>(2, 0);   // isOrdered
+            dictionary = fbb.endTable();
+        }
+
+        fbb.startTable();
+        fbb.addOffset(0, name);
+        fbb.addScalar<uint8_t>(1, field.nullable ? 1 : 0);
+        fbb.addScalar<uint8_t>(2, type_id);
+        fbb.addOffset(3, type);
+        if (dictionary) fbb.addOffset(4, dictionary);
+        fbb.addOffset(5, children);
+        return fbb.endTable();
+    }
+
+    FlatBufferBuilder::Offset buildSchema(FlatBufferBuilder& fbb) const {
+        std::vector<FlatBufferBuilder::Offset> fields;
+        for (const ArrowField& field : schema->getFields()) fields.push_back(buildField(fbb, field));
+        FlatBufferBuilder::Offset field_vector = fbb.createOffsetVector(fields);
+        fbb.startTable();
+        fbb.addScalar<int16_t>(0, 0);   // Endianness.Little
+        fbb.addOffset(1, field_vector);
+        return fbb.endTable();
+    }
+
+    static FlatBufferBuilder::Offset buildRecordBatch(FlatBufferBuilder& fbb, int64_t length,
+                                                      const std::vector<FieldNode>& nodes,
+                                                      const std::vector<BufferSpec>& buffers) {
+        std::vector<int64_t> layout;   // Buffer structs: offset, length
+        int64_t offset = 0;
+        for (const BufferSpec& buffer : buffers) {
+            layout.push_back(offset);
+            layout.push_back(buffer.length);
+            offset += padded(buffer.length);
+        }
+        FlatBufferBuilder::Offset node_vector =
+            fbb.createStructVector(nodes.data(), nodes.size(), sizeof(FieldNode), 8);
+        FlatBufferBuilder::Offset buffer_vector =
+            fbb.createStructVector(layout.data(), buffers.size(), 2 * sizeof(int64_t), 8);
+        fbb.startTable();
+        fbb.addScalar<int64_t>(0, length);
+        fbb.addOffset(1, node_vector);
+        fbb.addOffset(2, buffer_vector);
+        return fbb.endTable();
+    }
+
+    // Encapsulated message: continuation marker, metadata length, flatbuffer, body
+    Block writeMessage(FlatBufferBuilder& fbb, uint8_t header_type, FlatBufferBuilder::Offset header,
+                       const std::vector<BufferSpec>& body) {
+        int64_t body_length = 0;
+        for (const BufferSpec& buffer : body) body_length += padded(buffer.length);
+
+        fbb.startTable();
+        fbb.addScalar<int16_t>(0, METADATA_V5);
+        fbb.addScalar<uint8_t>(1, header_type);
+        fbb.addOffset(2, header);
+        fbb.addScalar<int64_t>(3, body_length);
+        fbb.finish(fbb.endTable());
+
+        Block block{position, 0, 0, body_length};
+        const int32_t metadata_size = static_cast<int32_t>(padded(static_cast<int64_t>(fbb.size())));
+        const uint32_t continuation = 0xFFFFFFFFu;
+        writeBytes(&continuation, sizeof(continuation));
+        writeBytes(&metadata_size, sizeof(metadata_size));
+        writeBytes(fbb.data(), static_cast<int64_t>(fbb.size()));
+        writePadding(metadata_size - static_cast<int64_t>(fbb.size()));
+        block.metadata_length = 8 + metadata_size;
+
+        for (const BufferSpec& buffer : body) {
+            writeBytes(buffer.data, buffer.length);
+            writePadding(padded(buffer.length) - buffer.length);
+        }
+        return block;
+    }
+
+    void writeDictionary(int64_t id, const ArrowDictionary& dictionary) {
+        std::vector<int32_t> offsets(1, 0);
+        std::string bytes;
+        for (const std::string& value : dictionary.getValues()) {
+            bytes += value;
+            offsets.push_back(static_cast<int32_t>(bytes.size()));
+        }
+        const int64_t count = static_cast<int64_t>(dictionary.getValues().size());
+        std::vector<FieldNode> nodes = {{count, 0}};
+        std::vector<BufferSpec> buffers = {
+            {nullptr, 0},
+            {offsets.data(), static_cast<int64_t>(offsets.size() * sizeof(int32_t))},
+            {bytes.data(), static_cast<int64_t>(bytes.size())}
+        };
+
+        FlatBufferBuilder fbb;
+        FlatBufferBuilder::Offset data = buildRecordBatch(fbb, count, nodes, buffers);
+        fbb.startTable();
+        fbb.addScalar<int64_t>(0, id);
+        fbb.addOffset(1, data);
+        fbb.addScalar<uint8_t>(2, 0);   // isDelta
+        FlatBufferBuilder::Offset header = fbb.endTable();
+        dictionary_blocks.push_back(writeMessage(fbb, HEADER_DICTIONARY_BATCH, header, buffers));
+    }
+
+public:
+    ArrowFileWriter() = default;
+    ArrowFileWriter(const ArrowFileWriter&) = delete;
+    ArrowFileWriter& operator=(const ArrowFileWriter&) = delete;
+
+    // Writes the header, schema and dictionaries
+    bool open(const std::string& path, const ArrowSchema& s, std::string& error) {
+        out.open(path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            error = "cannot open " + path;
+            return false;
+        }
+        schema = &s;
+        position = 0;
+        rows_written = 0;
+        dictionary_blocks.clear();
+        batch_blocks.clear();
+
+        writeBytes("ARROW1\0\0", 8);
+        FlatBufferBuilder fbb;
+        writeMessage(fbb, HEADER_SCHEMA, buildSchema(fbb), {});
+        for (size_t id = 0; id < s.getDictionaries().size(); ++id) {
+            writeDictionary(static_cast<int64_t>(id), s.getDictionaries()[id]);
+        }
+        if (!out) error = "write failed for " + path;
+        return static_cast<bool>(out);
+    }
+
+    bool write(const ArrowRecordBatch& batch) {
+        if (batch.rows() == 0) return static_cast<bool>(out);
+        std::vector<FieldNode> nodes;
+        std::vector<BufferSpec> buffers;
+        for (size_t i = 0; i < schema->size(); ++i) {
+            const ArrowRecordBatch::Column& column = batch.column(i);
+            nodes.push_back({column.length, column.null_count});
+            // The validity bitmap may be omitted when there are no nulls
+            if (column.null_count > 0) {
+                buffers.push_back({column.validity.data(), static_cast<int64_t>(column.validity.size())});
+            } else {
+                buffers.push_back({nullptr, 0});
+            }
+            if (schema->field(i).type == ArrowType::UTF8) {
+                buffers.push_back({column.offsets.data(), static_cast<int64_t>(column.offsets.size() * sizeof(int32_t))});
+            }
+            buffers.push_back({column.values.data(), static_cast<int64_t>(column.values.size())});
+        }
+
+        FlatBufferBuilder fbb;
+        FlatBufferBuilder::Offset header = buildRecordBatch(fbb, batch.rows(), nodes, buffers);
+        batch_blocks.push_back(writeMessage(fbb, HEADER_RECORD_BATCH, header, buffers));
+        rows_written += batch.rows();
+        return static_cast<bool>(out);
+    }
+
+    // Writes the end-of-stream marker and footer
+    bool close(std::string& error) {
+        const uint32_t end_of_stream[2] = {0xFFFFFFFFu, 0};
+        writeBytes(end_of_stream, sizeof(end_of_stream));
+
+        FlatBufferBuilder fbb;
+        FlatBufferBuilder::Offset schema_offset = buildSchema(fbb);
+        FlatBufferBuilder::Offset dictionaries =
+            fbb.createStructVector(dictionary_blocks.data(), dictionary_blocks.size(), sizeof(Block), 8);
+        FlatBufferBuilder::Offset batches =
+            fbb.createStructVector(batch_blocks.data(), batch_blocks.size(), sizeof(Block), 8);
+        fbb.startTable();
+        fbb.addScalar<int16_t>(0, METADATA_V5);
+        fbb.addOffset(1, schema_offset);
+        fbb.addOffset(2, dictionaries);
+        fbb.addOffset(3, batches);
+        fbb.finish(fbb.endTable());
+
+        writeBytes(fbb.data(), static_cast<int64_t>(fbb.size()));
+        const int32_t footer_size = static_cast<int32_t>(fbb.size());
+        writeBytes(&footer_size, sizeof(footer_size));
+        writeBytes("ARROW1", 6);
+        out.close();
+        if (!out) {
+            error = "write failed";
+            return false;
+        }
+        return true;
+    }
+
+    int64_t rowsWritten() const { return rows_written; }
+    size_t batchesWritten() const { return batch_blocks.size(); }
+};
+
+} // namespace arrow_ipc
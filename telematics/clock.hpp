@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+
+// ============================================================================
+// ENGINE CLOCK
+// ============================================================================
+//
+// Where the engine reads "now": anomaly and profile timestamps, arrival times
+// for the reorder buffers, state windows and query ages. The default is the
+// system clock; a SimulatedClock is moved forward by whoever drives the
+// reading stream, so a day of fleet time replays as fast as the pipeline can
+// process it. Durations that measure the engine itself (stage latencies,
+// benchmark timings, HTTP heartbeats) stay on steady_clock.
+
+class Clock {
+public:
+    using time_point = std::chrono::system_clock::time_point;
+    virtual ~Clock() = default;
+    virtual time_point now() const = 0;
+};
+
+// Safe to read from any thread while one driver advances it. Never moves
+// backwards.
+class SimulatedClock : public Clock {
+private:
+    using rep = time_point::duration::rep;
+    std::atomic<rep> ticks;
+
+public:
+    explicit SimulatedClock(time_point start = std::chrono::system_clock::now())
+        : ticks(start.time_since_epoch().count()) {}
+
+    time_point now() const override {
+        return time_point(time_point::duration(ticks.load(std::memory_order_acquire)));
+    }
+
+    template <typename Rep, typename Period>
+    void advance(std::chrono::duration<Rep, Period> step) {
+        auto delta = std::chrono::duration_cast<time_point::duration>(step).count();
+        if (delta > 0) ticks.fetch_add(delta, std::memory_order_acq_rel);
+    }
+
+    void advanceTo(time_point target) {
+        rep wanted = target.time_since_epoch().count();
+        rep current = ticks.load(std::memory_order_relaxed);
+        while (current < wanted &&
+               !ticks.compare_exchange_weak(current, wanted, std::memory_order_acq_rel)) {
+        }
+    }
+};
+
+// A null clock means the system clock, read without a virtual call
+inline Clock::time_point clockNow(const Clock* clock) {
+    return clock ? clock->now() : std::chrono::system_clock::now();
+}
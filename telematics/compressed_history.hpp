@@ -0,0 +1,517 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <vector>
+
+// ============================================================================
+// COMPRESSED LONG-HORIZON HISTORY
+// ============================================================================
+//
+// Gorilla-style time-series compression: timestamps are stored as
+// delta-of-delta with variable-width buckets, values as the XOR against the
+// previous value of the same channel. Each channel gets its own bit stream so
+// queries only decode the channels they ask for. Samples accumulate in an open
+// block that is sealed (made immutable) once it is full or spans too much
+// time; sealed blocks older than the retention horizon are dropped, and their
+// buffers reused for the next open block unless a reader still holds them.
+//
+// How far a channel compresses depends on how much it changes between
+// samples. Timestamps at a steady interval cost a bit each, and a slow ramp
+// such as the fuel level a few bits. Channels whose quantised value moves by
+// a random step every sample keep 10-17 significant XOR bits: the simulator
+// redraws speed, rpm, temperature and the GPS step with fresh noise and
+// throttle, brake, oil pressure and battery uniformly, so those channels cost
+// about 2 bytes a sample each. Every sealed block also pays for its first
+// samples in full and for its own bookkeeping, which dominates when blocks
+// close on max_block_span_ms with few samples in them.
+
+inline int countLeadingZeros64(uint64_t x) {
+    if (x == 0) return 64;
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_clzll(x);
+#else
+    int n = 0;
+    while (!(x & (1ULL << 63))) { x <<= 1; ++n; }
+    return n;
+#endif
+}
+
+inline int countTrailingZeros64(uint64_t x) {
+    if (x == 0) return 64;
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(x);
+#else
+    int n = 0;
+    while (!(x & 1ULL)) { x >>= 1; ++n; }
+    return n;
+#endif
+}
+
+inline uint64_t doubleToBits(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+inline double bitsToDouble(uint64_t bits) {
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// MSB-first bit stream backed by 64-bit words
+class BitStream {
+private:
+    std::vector<uint64_t> words;
+    size_t bit_count = 0;
+
+public:
+    void writeBits(uint64_t value, int nbits) {
+        if (nbits <= 0) return;
+        if (nbits < 64) value &= (1ULL << nbits) - 1;
+
+        int used = static_cast<int>(bit_count & 63);
+        if (used == 0) words.push_back(0);
+        int free_bits = 64 - used;
+
+        if (nbits <= free_bits) {
+            words.back() |= value << (free_bits - nbits);
+        } else {
+            int spill = nbits - free_bits;
+            words.back() |= value >> spill;
+            words.push_back(value << (64 - spill));
+        }
+        bit_count += nbits;
+    }
+
+    uint64_t readBits(size_t& pos, int nbits) const {
+        if (nbits <= 0) return 0;
+        size_t word = pos >> 6;
+        int used = static_cast<int>(pos & 63);
+        int avail = 64 - used;
+
+        uint64_t result = (words[word] << used) >> (64 - nbits);
+        if (nbits > avail) {
+            result |= words[word + 1] >> (64 - (nbits - avail));
+        }
+        pos += nbits;
+        return result;
+    }
+
+    size_t bitCount() const { return bit_count; }
+    size_t sizeBytes() const { return words.capacity() * sizeof(uint64_t); }
+    size_t wordCount() const { return words.size(); }
+    void reserveWords(size_t count) { words.reserve(count); }
+    size_t capacityWords() const { return words.capacity(); }
+    void clear() { words.clear(); bit_count = 0; }
+};
+
+// Delta-of-delta timestamp codec (milliseconds)
+class TimestampEncoder {
+private:
+    int64_t prev_ts = 0;
+    int64_t prev_delta = 0;
+    bool has_first = false;
+
+public:
+    // Returns false if the sample cannot be represented in this block
+    // (delta-of-delta beyond 32 bits) and the block must be sealed first.
+    bool canEncode(int64_t ts) const {
+        if (!has_first) return true;
+        int64_t dod = (ts - prev_ts) - prev_delta;
+        return dod >= std::numeric_limits<int32_t>::min() &&
+               dod <= std::numeric_limits<int32_t>::max();
+    }
+
+    void encode(BitStream& out, int64_t ts) {
+        if (!has_first) {
+            out.writeBits(static_cast<uint64_t>(ts), 64);
+            prev_ts = ts;
+            has_first = true;
+            return;
+        }
+
+        int64_t delta = ts - prev_ts;
+        int64_t dod = delta - prev_delta;
+
+        if (dod == 0) {
+            out.writeBits(0b0, 1);
+        } else if (dod >= -64 && dod <= 63) {
+            out.writeBits(0b10, 2);
+            out.writeBits(static_cast<uint64_t>(dod), 7);
+        } else if (dod >= -256 && dod <= 255) {
+            out.writeBits(0b110, 3);
+            out.writeBits(static_cast<uint64_t>(dod), 9);
+        } else if (dod >= -2048 && dod <= 2047) {
+            out.writeBits(0b1110, 4);
+            out.writeBits(static_cast<uint64_t>(dod), 12);
+        } else {
+            out.writeBits(0b1111, 4);
+            out.writeBits(static_cast<uint64_t>(dod), 32);
+        }
+
+        prev_delta = delta;
+        prev_ts = ts;
+    }
+
+    void reset() { prev_ts = 0; prev_delta = 0; has_first = false; }
+};
+
+class TimestampDecoder {
+private:
+    int64_t prev_ts = 0;
+    int64_t prev_delta = 0;
+    bool has_first = false;
+
+    static int64_t signExtend(uint64_t bits, int nbits) {
+        return static_cast<int64_t>(bits << (64 - nbits)) >> (64 - nbits);
+    }
+
+public:
+    int64_t decode(const BitStream& in, size_t& pos) {
+        if (!has_first) {
+            prev_ts = static_cast<int64_t>(in.readBits(pos, 64));
+            has_first = true;
+            return prev_ts;
+        }
+
+        int64_t dod = 0;
+        if (in.readBits(pos, 1) == 0) {
+            dod = 0;
+        } else if (in.readBits(pos, 1) == 0) {
+            dod = signExtend(in.readBits(pos, 7), 7);
+        } else if (in.readBits(pos, 1) == 0) {
+            dod = signExtend(in.readBits(pos, 9), 9);
+        } else if (in.readBits(pos, 1) == 0) {
+            dod = signExtend(in.readBits(pos, 12), 12);
+        } else {
+            dod = signExtend(in.readBits(pos, 32), 32);
+        }
+
+        prev_delta += dod;
+        prev_ts += prev_delta;
+        return prev_ts;
+    }
+};
+
+// XOR float codec
+class XorEncoder {
+private:
+    uint64_t prev_bits = 0;
+    int prev_leading = -1;
+    int prev_trailing = 0;
+    bool has_first = false;
+
+public:
+    void encode(BitStream& out, double value) {
+        uint64_t bits = doubleToBits(value);
+        if (!has_first) {
+            out.writeBits(bits, 64);
+            prev_bits = bits;
+            has_first = true;
+            return;
+        }
+
+        uint64_t x = bits ^ prev_bits;
+        prev_bits = bits;
+
+        if (x == 0) {
+            out.writeBits(0b0, 1);
+            return;
+        }
+
+        int leading = std::min(countLeadingZeros64(x), 31);
+        int trailing = countTrailingZeros64(x);
+
+        if (prev_leading >= 0 && leading >= prev_leading && trailing >= prev_trailing) {
+            // Meaningful bits fit in the previous window
+            int significant = 64 - prev_leading - prev_trailing;
+            out.writeBits(0b10, 2);
+            out.writeBits(x >> prev_trailing, significant);
+        } else {
+            int significant = 64 - leading - trailing;
+            out.writeBits(0b11, 2);
+            out.writeBits(static_cast<uint64_t>(leading), 5);
+            out.writeBits(static_cast<uint64_t>(significant & 63), 6); // 64 stored as 0
+            out.writeBits(x >> trailing, significant);
+            prev_leading = leading;
+            prev_trailing = trailing;
+        }
+    }
+
+    void reset() { prev_bits = 0; prev_leading = -1; prev_trailing = 0; has_first = false; }
+};
+
+class XorDecoder {
+private:
+    uint64_t prev_bits = 0;
+    int prev_leading = 0;
+    int prev_trailing = 0;
+    bool has_first = false;
+
+public:
+    double decode(const BitStream& in, size_t& pos) {
+        if (!has_first) {
+            prev_bits = in.readBits(pos, 64);
+            has_first = true;
+            return bitsToDouble(prev_bits);
+        }
+
+        if (in.readBits(pos, 1) == 0) {
+            return bitsToDouble(prev_bits);
+        }
+
+        if (in.readBits(pos, 1) == 1) {
+            prev_leading = static_cast<int>(in.readBits(pos, 5));
+            int significant = static_cast<int>(in.readBits(pos, 6));
+            if (significant == 0) significant = 64;
+            prev_trailing = 64 - prev_leading - significant;
+        }
+
+        int significant = 64 - prev_leading - prev_trailing;
+        uint64_t x = in.readBits(pos, significant) << prev_trailing;
+        prev_bits ^= x;
+        return bitsToDouble(prev_bits);
+    }
+};
+
+// Columnar decompression target, one vector per channel
+template <size_t N>
+struct HistoryColumns {
+    std::vector<int64_t> timestamps_ms;
+    std::array<std::vector<double>, N> channels;
+
+    size_t size() const { return timestamps_ms.size(); }
+
+    void clear() {
+        timestamps_ms.clear();
+        for (auto& column : channels) column.clear();
+    }
+};
+
+// Multi-channel compressed series for a single vehicle
+template <size_t N>
+class CompressedSeries {
+public:
+    struct Config {
+        size_t samples_per_block = 1024;
+        int64_t max_block_span_ms = 15 * 60 * 1000;        // 15 minutes
+        int64_t retention_ms = 6LL * 60 * 60 * 1000;          // 6 hours
+        std::array<double, N> resolution{};                   // 0 = lossless
+    };
+
+    // Immutable once sealed; shared so readers can hold a block while the
+    // writer evicts it from the series
+    struct SealedBlock {
+        int64_t first_ts = 0;
+        int64_t last_ts = 0;
+        uint32_t count = 0;
+        BitStream timestamps;
+        std::array<BitStream, N> values;
+
+        size_t sizeBytes() const {
+            size_t bytes = sizeof(SealedBlock) + timestamps.sizeBytes();
+            for (const auto& stream : values) bytes += stream.sizeBytes();
+            return bytes;
+        }
+    };
+
+private:
+    Config config;
+    std::deque<std::shared_ptr<SealedBlock>> sealed_blocks;
+
+    // Open block being appended to. Blocks are allocated once: an evicted
+    // block no reader holds goes to `spare_block`, and the next open block
+    // takes it with its bit streams' capacity intact.
+    std::shared_ptr<SealedBlock> open_block;
+    std::shared_ptr<SealedBlock> spare_block;
+    TimestampEncoder ts_encoder;
+    std::array<XorEncoder, N> value_encoders;
+
+    size_t sealed_samples = 0;
+    size_t sealed_bytes = 0;
+
+public:
+    CompressedSeries() : CompressedSeries(Config{}) {}
+    explicit CompressedSeries(const Config& cfg) : config(cfg) {}
+
+    void append(int64_t ts_ms, const std::array<double, N>& values) {
+        if (open_block && (open_block->count >= config.samples_per_block ||
+                           ts_ms - open_block->first_ts > config.max_block_span_ms ||
+                           !ts_encoder.canEncode(ts_ms))) {
+            sealOpenBlock();
+        }
+
+        if (!open_block) {
+            if (spare_block) {
+                open_block = std::move(spare_block);
+                open_block->last_ts = 0;
+                open_block->count = 0;
+                open_block->timestamps.clear();
+                for (auto& stream : open_block->values) stream.clear();
+            } else {
+                open_block = std::make_shared<SealedBlock>();
+            }
+            open_block->first_ts = ts_ms;
+            // Blocks of one series compress alike; sizing each stream from
+            // the previous block avoids regrowing it sample by sample. A
+            // recycled stream that held the previous block is left as it is.
+            if (!sealed_blocks.empty()) {
+                const SealedBlock& previous = *sealed_blocks.back();
+                reserveLike(open_block->timestamps, previous.timestamps);
+                for (size_t c = 0; c < N; ++c) reserveLike(open_block->values[c], previous.values[c]);
+            }
+            ts_encoder.reset();
+            for (auto& encoder : value_encoders) encoder.reset();
+        }
+
+        ts_encoder.encode(open_block->timestamps, ts_ms);
+        for (size_t c = 0; c < N; ++c) {
+            double v = quantize(c, values[c]);
+            value_encoders[c].encode(open_block->values[c], v);
+        }
+        open_block->last_ts = std::max(open_block->last_ts, ts_ms);
+        open_block->count++;
+
+        evictExpired(ts_ms);
+    }
+
+    // Decodes samples with timestamps in [from_ms, to_ms] into `out`
+    // (appending). Only channels whose bit is set in channel_mask are filled.
+    size_t decode(int64_t from_ms, int64_t to_ms, HistoryColumns<N>& out,
+                  uint64_t channel_mask = ~0ULL) const {
+        size_t decoded = 0;
+        for (const auto& block : sealed_blocks) {
+            decoded += decodeBlock(*block, config, from_ms, to_ms, out, channel_mask);
+        }
+        return decoded + decodeOpen(from_ms, to_ms, out, channel_mask);
+    }
+
+    // Decodes only the (mutable) open block; pair with snapshotSealed to
+    // decode the sealed part without holding the writer's lock
+    size_t decodeOpen(int64_t from_ms, int64_t to_ms, HistoryColumns<N>& out,
+                      uint64_t channel_mask = ~0ULL) const {
+        return open_block ? decodeBlock(*open_block, config, from_ms, to_ms, out, channel_mask) : 0;
+    }
+
+    // Consistent view of the sealed blocks for lock-free readers. A block is
+    // recycled only once every such reference is gone.
+    std::vector<std::shared_ptr<const SealedBlock>> sealedBlocks() const {
+        return std::vector<std::shared_ptr<const SealedBlock>>(sealed_blocks.begin(), sealed_blocks.end());
+    }
+
+    // Appends the sealed blocks overlapping [from_ms, to_ms]
+    void snapshotSealed(int64_t from_ms, int64_t to_ms,
+                        std::vector<std::shared_ptr<const SealedBlock>>& out) const {
+        for (const auto& block : sealed_blocks) {
+            if (block->last_ts >= from_ms && block->first_ts <= to_ms) out.push_back(block);
+        }
+    }
+
+    size_t sampleCount() const {
+        return sealed_samples + (open_block ? open_block->count : 0);
+    }
+
+    size_t compressedBytes() const {
+        return sealed_bytes + (open_block ? open_block->sizeBytes() : 0);
+    }
+
+    size_t sealedBlockCount() const { return sealed_blocks.size(); }
+
+    int64_t firstTimestamp() const {
+        if (!sealed_blocks.empty()) return sealed_blocks.front()->first_ts;
+        return open_block ? open_block->first_ts : 0;
+    }
+
+    int64_t lastTimestamp() const {
+        if (open_block) return open_block->last_ts;
+        return sealed_blocks.empty() ? 0 : sealed_blocks.back()->last_ts;
+    }
+
+    const Config& getConfig() const { return config; }
+
+private:
+    double quantize(size_t channel, double value) const {
+        // Integer-valued doubles leave the low mantissa bits zero, which is
+        // what makes the XOR encoding compact for noisy sensor values
+        double res = config.resolution[channel];
+        return res > 0.0 ? std::nearbyint(value / res) : value;
+    }
+
+    static void reserveLike(BitStream& stream, const BitStream& previous) {
+        if (stream.capacityWords() < previous.wordCount()) {
+            stream.reserveWords(previous.wordCount() * 17 / 16 + 1);
+        }
+    }
+
+    // Sealed blocks keep the capacity they were reserved with rather than
+    // being shrunk: shrinking reallocated every stream of every block, and
+    // the reservation from the previous block rarely leaves much slack
+    void sealOpenBlock() {
+        sealed_samples += open_block->count;
+        sealed_bytes += open_block->sizeBytes();
+        sealed_blocks.push_back(std::move(open_block));
+    }
+
+    void evictExpired(int64_t now_ms) {
+        while (!sealed_blocks.empty() &&
+               now_ms - sealed_blocks.front()->last_ts > config.retention_ms) {
+            std::shared_ptr<SealedBlock>& block = sealed_blocks.front();
+            sealed_samples -= block->count;
+            sealed_bytes -= block->sizeBytes();
+            // Readers only copy block references under the writer's lock, so
+            // a sole owner here stays the sole owner. The fence pairs with
+            // the release in the last reader's reference drop.
+            if (!spare_block && block.use_count() == 1) {
+                std::atomic_thread_fence(std::memory_order_acquire);
+                spare_block = std::move(block);
+            }
+            sealed_blocks.pop_front();
+        }
+    }
+
+public:
+    // Decodes one block; sealed blocks are immutable, so this is safe to call
+    // on a snapshot without any lock
+    static size_t decodeBlock(const SealedBlock& block, const Config& config,
+                              int64_t from_ms, int64_t to_ms,
+                              HistoryColumns<N>& out, uint64_t channel_mask) {
+        if (block.count == 0 || block.last_ts < from_ms || block.first_ts > to_ms) return 0;
+
+        // Decode timestamps first to find the matching sample range
+        size_t base = out.timestamps_ms.size();
+        std::vector<uint8_t> keep(block.count);
+        TimestampDecoder ts_decoder;
+        size_t pos = 0;
+        size_t kept = 0;
+        for (uint32_t i = 0; i < block.count; ++i) {
+            int64_t ts = ts_decoder.decode(block.timestamps, pos);
+            keep[i] = (ts >= from_ms && ts <= to_ms);
+            if (keep[i]) {
+                out.timestamps_ms.push_back(ts);
+                ++kept;
+            }
+        }
+
+        for (size_t c = 0; c < N; ++c) {
+            if (!(channel_mask & (1ULL << c))) continue;
+            auto& column = out.channels[c];
+            column.reserve(base + kept);
+            const double res = config.resolution[c];
+            XorDecoder decoder;
+            size_t vpos = 0;
+            for (uint32_t i = 0; i < block.count; ++i) {
+                double v = decoder.decode(block.values[c], vpos);
+                if (keep[i]) column.push_back(res > 0.0 ? v * res : v);
+            }
+        }
+        return kept;
+    }
+};
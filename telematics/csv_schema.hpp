@@ -0,0 +1,145 @@
+#pragma once
+
+#include "report_writer.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// ============================================================================
+// CSV LOG SCHEMAS
+// ============================================================================
+//
+// The enhanced_*.csv logs are written one row per reading or event, so rows
+// are formatted straight into a reused buffer with no stream or temporary
+// strings. Each record type declares its columns once, in a CsvSchema
+// specialisation next to the type; the header and every row are generated
+// from that one list, so their field order cannot drift apart:
+//
+//   template <> struct CsvSchema<TripRow> {
+//       static constexpr auto columns = std::make_tuple(
+//           csvColumn("VehicleID", &TripRow::vehicle_id),
+//           csvColumn("DistanceKm", &TripRow::distance_km, 3));
+//   };
+//
+// A column's formatting follows its member type: doubles in fixed notation
+// at the column's precision, integers in decimal, bools as 1/0, time points
+// as local HH:MM:SS.mmm (like formatTimestamp), strings as RFC 4180 fields
+// and const char* as-is (for fixed names that never need quoting).
+
+template <typename Record>
+struct CsvSchema;
+
+template <typename Record, typename Field>
+struct CsvColumn {
+    const char* name;
+    Field Record::*member;
+    int precision;
+};
+
+template <typename Record, typename Field>
+constexpr CsvColumn<Record, Field> csvColumn(const char* name, Field Record::*member, int precision = 2) {
+    return {name, member, precision};
+}
+
+template <typename Record>
+constexpr size_t csvColumnCount() {
+    return std::tuple_size<std::decay_t<decltype(CsvSchema<Record>::columns)>>::value;
+}
+
+// Header line (with newline) for a record type, built once
+template <typename Record>
+const std::string& csvHeader() {
+    static const std::string header = [] {
+        std::string text;
+        std::apply([&text](const auto&... column) {
+            ((text += text.empty() ? "" : ",", text += column.name), ...);
+        }, CsvSchema<Record>::columns);
+        return text + "\n";
+    }();
+    return header;
+}
+
+// Formats rows into a buffer that keeps its capacity between writes. Not
+// shared between threads: each writer owns one.
+class CsvRowWriter {
+private:
+    ReportBuffer buffer;
+    int64_t clock_second = std::numeric_limits<int64_t>::min();   // second held in clock_text
+    char clock_text[8] = {};
+
+    void appendTime(std::chrono::system_clock::time_point tp) {
+        const int64_t ms = std::chrono::duration_cast<std::chrono::milliseconds>(tp.time_since_epoch()).count();
+        int64_t second = ms / 1000;
+        int64_t millis = ms % 1000;
+        if (millis < 0) { millis += 1000; second -= 1; }
+        if (second != clock_second) {
+            // localtime once per distinct second; consecutive rows share it
+            std::time_t seconds = static_cast<std::time_t>(second);
+            struct tm local;
+#if defined(_WIN32)
+            localtime_s(&local, &seconds);
+#else
+            localtime_r(&seconds, &local);
+#endif
+            const int fields[3] = {local.tm_hour, local.tm_min, local.tm_sec};
+            for (int i = 0; i < 3; ++i) {
+                clock_text[i * 3] = static_cast<char>('0' + fields[i] / 10);
+                clock_text[i * 3 + 1] = static_cast<char>('0' + fields[i] % 10);
+                if (i < 2) clock_text[i * 3 + 2] = ':';
+            }
+            clock_second = second;
+        }
+        const char fraction[4] = {'.', static_cast<char>('0' + millis / 100),
+                                  static_cast<char>('0' + millis / 10 % 10), static_cast<char>('0' + millis % 10)};
+        buffer.append(std::string_view(clock_text, 8)).append(std::string_view(fraction, 4));
+    }
+
+    template <typename Field>
+    void appendField(const Field& value, int precision) {
+        if constexpr (std::is_same<Field, bool>::value) {
+            buffer.append(value ? '1' : '0');
+        } else if constexpr (std::is_floating_point<Field>::value) {
+            buffer.appendFixed(value, precision);
+        } else if constexpr (std::is_integral<Field>::value) {
+            buffer.appendInt(static_cast<int64_t>(value));
+        } else if constexpr (std::is_same<Field, std::chrono::system_clock::time_point>::value) {
+            appendTime(value);
+        } else if constexpr (std::is_same<Field, const char*>::value) {
+            buffer.append(value);
+        } else {
+            buffer.appendCsvField(std::string_view(value));
+        }
+    }
+
+public:
+    explicit CsvRowWriter(size_t reserve = 4096) : buffer(reserve) {}
+
+    // Appends one row, newline included
+    template <typename Record>
+    void append(const Record& record) {
+        std::apply([&](const auto& head, const auto&... rest) {
+            appendField(record.*(head.member), head.precision);
+            ((buffer.append(','), appendField(record.*(rest.member), rest.precision)), ...);
+        }, CsvSchema<Record>::columns);
+        buffer.append('\n');
+    }
+
+    const std::string& str() const { return buffer.str(); }
+    size_t size() const { return buffer.size(); }
+    bool empty() const { return buffer.size() == 0; }
+    void clear() { buffer.clear(); }
+
+    // Writes the buffered rows and empties the buffer
+    void writeTo(std::ostream& out) {
+        out.write(buffer.str().data(), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+    }
+};
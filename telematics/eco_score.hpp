@@ -0,0 +1,286 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+// ============================================================================
+// FUEL EFFICIENCY AND ECO-SCORING
+// ============================================================================
+//
+// Per-vehicle running totals of how a vehicle is driven, kept for the open
+// (or last) trip, the current UTC day and the vehicle's lifetime. Each
+// reading adds its step in O(1) with no allocation, and the accumulator is a
+// fixed-size plain struct, so it lives in the profile and is journaled with
+// it.
+//
+// - Distance is the GPS step from the profile update. Where the device
+//   reports an odometer, each whole-kilometre tick replaces the GPS distance
+//   summed since the previous tick; the first tick after a reset or an
+//   implausible jump only re-anchors.
+// - Fuel used is the fall of the fuel level below the lowest level seen since
+//   the last refuel, so slosh and sensor noise below refuel_rise_percent do
+//   not count twice. A rise of refuel_rise_percent over that low-water mark,
+//   at once or over several readings, starts a refuel, which lasts while the
+//   level keeps rising.
+// - Time between readings, up to max_step_seconds, goes to the state of the
+//   later reading: engine on, idling, moving, over the speed limit, on
+//   aggressive throttle, braking hard.
+//
+// score() turns a window into 0-100 components (100 at or under the target,
+// 0 at the limit, linear between) and their weighted mean. A component with
+// too little distance or time behind it is left out and the remaining
+// weights renormalised; with none left the score is NaN.
+
+enum class EcoComponent : size_t { FUEL, IDLE, OVERSPEED, THROTTLE, BRAKE, HARSH };
+
+inline constexpr size_t ECO_COMPONENTS = 6;
+
+inline const char* ecoComponentName(EcoComponent component) {
+    static const char* const names[ECO_COMPONENTS] = {"fuel", "idle", "overspeed", "throttle", "brake", "harsh"};
+    return names[static_cast<size_t>(component)];
+}
+
+enum class EcoWindow : size_t { TRIP, DAY, LIFETIME };
+
+inline constexpr size_t ECO_WINDOWS = 3;
+
+struct EcoConfig {
+    double tank_litres = 60.0;                 // turns fuel level percent into litres
+    double refuel_rise_percent = 5.0;
+    double idle_speed_kmph = 2.0;              // engine on and slower than this is idling
+    double overspeed_kmph = 110.0;
+    double aggressive_throttle_percent = 80.0;
+    double hard_brake_bar = 12.0;
+    double harsh_threshold_ms2 = 4.0;
+    double max_step_seconds = 60.0;            // longer gaps between readings count no time
+    double max_odometer_step_km = 50.0;        // larger odometer jumps re-anchor
+    double min_distance_km = 1.0;              // for the per-km components
+    double min_seconds = 60.0;                 // for the time-share components
+
+    // Component bands: 100 at or below the target, 0 at or above the limit
+    double target_l_per_100km = 8.0;
+    double limit_l_per_100km = 16.0;
+    double idle_share_limit = 0.3;             // of engine-on time
+    double overspeed_share_limit = 0.1;        // of moving time
+    double throttle_share_limit = 0.2;         // of engine-on time
+    double brake_share_limit = 0.1;            // of moving time
+    double harsh_per_100km_limit = 20.0;
+
+    std::array<double, ECO_COMPONENTS> weights = {0.30, 0.15, 0.20, 0.10, 0.10, 0.15};   // by EcoComponent
+};
+
+// What went into one window
+struct EcoTotals {
+    int64_t start_ms = 0;
+    double distance_km = 0.0;
+    double fuel_litres = 0.0;
+    double refuelled_litres = 0.0;
+    double engine_seconds = 0.0;
+    double moving_seconds = 0.0;
+    double idle_seconds = 0.0;
+    double overspeed_seconds = 0.0;
+    double aggressive_throttle_seconds = 0.0;
+    double hard_brake_seconds = 0.0;
+    uint32_t refuels = 0;
+    uint32_t harsh_accelerations = 0;
+    uint32_t harsh_brakes = 0;
+    uint32_t readings = 0;
+
+    // NaN until the window has min_distance_km behind it
+    double litresPer100Km(const EcoConfig& config) const {
+        return distance_km >= config.min_distance_km ? fuel_litres * 100.0 / distance_km
+                                                     : std::numeric_limits<double>::quiet_NaN();
+    }
+
+    double kmPerLitre() const {
+        return fuel_litres > 0.0 ? distance_km / fuel_litres : std::numeric_limits<double>::quiet_NaN();
+    }
+
+    uint32_t harshEvents() const { return harsh_accelerations + harsh_brakes; }
+
+    double harshPer100Km(const EcoConfig& config) const {
+        return distance_km >= config.min_distance_km ? harshEvents() * 100.0 / distance_km
+                                                     : std::numeric_limits<double>::quiet_NaN();
+    }
+};
+
+struct EcoScore {
+    double score = std::numeric_limits<double>::quiet_NaN();
+    std::array<double, ECO_COMPONENTS> components;   // NaN where left out
+
+    EcoScore() { components.fill(std::numeric_limits<double>::quiet_NaN()); }
+
+    double component(EcoComponent c) const { return components[static_cast<size_t>(c)]; }
+};
+
+// One reading's share, as the engine's profile update sees it
+struct EcoSample {
+    int64_t timestamp_ms = 0;
+    double step_distance_km = 0.0;   // GPS distance from the previous reading
+    double speed_kmph = 0.0;
+    double fuel_level_percent = 0.0;
+    double throttle_percent = 0.0;
+    double brake_pressure_bar = 0.0;
+    double acceleration_ms2 = 0.0;
+    int odometer_km = 0;             // 0 = not reported
+    bool engine_on = true;
+    uint64_t trip_id = 0;            // the trip tracker's open trip, 0 between trips
+};
+
+class EcoAccumulator {
+private:
+    static constexpr int64_t MS_PER_DAY = 24LL * 60 * 60 * 1000;
+
+    std::array<EcoTotals, ECO_WINDOWS> windows{};
+    int64_t last_ms = -1;
+    int64_t day = std::numeric_limits<int64_t>::min();
+    uint64_t trip_id = 0;            // trip the TRIP window holds
+    bool trip_open = false;
+    double fuel_low_percent = -1.0;  // lowest level since the last refuel
+    bool refuelling = false;         // the level has risen on every reading since a refuel began
+    int32_t odometer_anchor = -1;
+    bool odometer_synced = false;    // anchor was taken on a tick
+    double gps_since_tick_km = 0.0;
+
+    static int64_t dayOf(int64_t timestamp_ms) {
+        return timestamp_ms >= 0 ? timestamp_ms / MS_PER_DAY : (timestamp_ms + 1) / MS_PER_DAY - 1;
+    }
+
+    // Odometer-corrected distance of this step
+    double stepDistance(const EcoConfig& config, const EcoSample& sample) {
+        double step = sample.step_distance_km;
+        gps_since_tick_km += step;
+        if (sample.odometer_km <= 0) return step;
+        const int32_t ticks = sample.odometer_km - odometer_anchor;
+        if (odometer_anchor < 0 || ticks < 0 || ticks > config.max_odometer_step_km) {
+            odometer_anchor = sample.odometer_km;
+            odometer_synced = false;
+            gps_since_tick_km = 0.0;
+        } else if (ticks > 0) {
+            if (odometer_synced) step += ticks - gps_since_tick_km;
+            odometer_anchor = sample.odometer_km;
+            odometer_synced = true;
+            gps_since_tick_km = 0.0;
+        }
+        return step;
+    }
+
+    static double band(double value, double target, double limit) {
+        if (value <= target) return 100.0;
+        if (value >= limit) return 0.0;
+        return 100.0 * (limit - value) / (limit - target);
+    }
+
+public:
+    void update(const EcoConfig& config, const EcoSample& sample) {
+        const int64_t sample_day = dayOf(sample.timestamp_ms);
+        if (sample_day > day) {
+            day = sample_day;
+            windows[static_cast<size_t>(EcoWindow::DAY)] = EcoTotals{};
+            windows[static_cast<size_t>(EcoWindow::DAY)].start_ms = sample_day * MS_PER_DAY;
+        }
+        if (sample.trip_id != 0 && sample.trip_id != trip_id) {
+            trip_id = sample.trip_id;
+            windows[static_cast<size_t>(EcoWindow::TRIP)] = EcoTotals{};
+            windows[static_cast<size_t>(EcoWindow::TRIP)].start_ms = sample.timestamp_ms;
+        }
+        trip_open = sample.trip_id != 0;
+        if (windows[static_cast<size_t>(EcoWindow::LIFETIME)].readings == 0) {
+            windows[static_cast<size_t>(EcoWindow::LIFETIME)].start_ms = sample.timestamp_ms;
+        }
+
+        const double distance = stepDistance(config, sample);
+
+        double used_litres = 0.0;
+        double refuelled_litres = 0.0;
+        bool new_refuel = false;
+        const double rise = sample.fuel_level_percent - fuel_low_percent;
+        if (fuel_low_percent < 0.0) {
+            fuel_low_percent = sample.fuel_level_percent;
+        } else if (rise >= config.refuel_rise_percent || (refuelling && rise > 0.0)) {
+            refuelled_litres = rise * config.tank_litres / 100.0;
+            new_refuel = !refuelling;
+            refuelling = true;
+            fuel_low_percent = sample.fuel_level_percent;
+        } else {
+            refuelling = false;
+            if (rise < 0.0) {
+                used_litres = -rise * config.tank_litres / 100.0;
+                fuel_low_percent = sample.fuel_level_percent;
+            }
+        }
+
+        double seconds = last_ms < 0 ? 0.0 : (sample.timestamp_ms - last_ms) / 1000.0;
+        if (seconds <= 0.0 || seconds > config.max_step_seconds) seconds = 0.0;
+        last_ms = std::max(last_ms, sample.timestamp_ms);
+
+        const bool moving = sample.speed_kmph >= config.idle_speed_kmph;
+        const bool harsh_acceleration = sample.acceleration_ms2 > config.harsh_threshold_ms2;
+        const bool harsh_brake = sample.acceleration_ms2 < -config.harsh_threshold_ms2;
+
+        // Readings from an earlier day only reach the lifetime totals
+        const bool same_day = sample_day == day;
+        for (size_t w = 0; w < ECO_WINDOWS; ++w) {
+            if (w == static_cast<size_t>(EcoWindow::TRIP) && !trip_open) continue;
+            if (w == static_cast<size_t>(EcoWindow::DAY) && !same_day) continue;
+            EcoTotals& t = windows[w];
+            t.readings++;
+            t.distance_km = std::max(0.0, t.distance_km + distance);
+            t.fuel_litres += used_litres;
+            t.refuelled_litres += refuelled_litres;
+            if (new_refuel) t.refuels++;
+            if (harsh_acceleration) t.harsh_accelerations++;
+            if (harsh_brake) t.harsh_brakes++;
+            if (!sample.engine_on) continue;
+            t.engine_seconds += seconds;
+            (moving ? t.moving_seconds : t.idle_seconds) += seconds;
+            if (sample.speed_kmph > config.overspeed_kmph) t.overspeed_seconds += seconds;
+            if (sample.throttle_percent >= config.aggressive_throttle_percent) t.aggressive_throttle_seconds += seconds;
+            if (moving && sample.brake_pressure_bar >= config.hard_brake_bar) t.hard_brake_seconds += seconds;
+        }
+    }
+
+    const EcoTotals& totals(EcoWindow window) const { return windows[static_cast<size_t>(window)]; }
+    bool tripOpen() const { return trip_open; }
+
+    static EcoScore score(const EcoTotals& t, const EcoConfig& config) {
+        EcoScore s;
+        if (t.distance_km >= config.min_distance_km) {
+            s.components[static_cast<size_t>(EcoComponent::FUEL)] =
+                band(t.litresPer100Km(config), config.target_l_per_100km, config.limit_l_per_100km);
+            s.components[static_cast<size_t>(EcoComponent::HARSH)] =
+                band(t.harshPer100Km(config), 0.0, config.harsh_per_100km_limit);
+        }
+        if (t.engine_seconds >= config.min_seconds) {
+            s.components[static_cast<size_t>(EcoComponent::IDLE)] =
+                band(t.idle_seconds / t.engine_seconds, 0.0, config.idle_share_limit);
+            s.components[static_cast<size_t>(EcoComponent::THROTTLE)] =
+                band(t.aggressive_throttle_seconds / t.engine_seconds, 0.0, config.throttle_share_limit);
+        }
+        if (t.moving_seconds >= config.min_seconds) {
+            s.components[static_cast<size_t>(EcoComponent::OVERSPEED)] =
+                band(t.overspeed_seconds / t.moving_seconds, 0.0, config.overspeed_share_limit);
+            s.components[static_cast<size_t>(EcoComponent::BRAKE)] =
+                band(t.hard_brake_seconds / t.moving_seconds, 0.0, config.brake_share_limit);
+        }
+
+        double weighted = 0.0;
+        double weight = 0.0;
+        for (size_t c = 0; c < ECO_COMPONENTS; ++c) {
+            if (std::isnan(s.components[c]) || config.weights[c] <= 0.0) continue;
+            weighted += config.weights[c] * s.components[c];
+            weight += config.weights[c];
+        }
+        if (weight > 0.0) s.score = weighted / weight;
+        return s;
+    }
+
+    EcoScore score(EcoWindow window, const EcoConfig& config) const { return score(totals(window), config); }
+};
+
+static_assert(std::is_trivially_copyable<EcoAccumulator>::value, "journaled with the vehicle profile");
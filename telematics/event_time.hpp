@@ -0,0 +1,155 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// ============================================================================
+// EVENT-TIME ORDERING
+// ============================================================================
+//
+// Cellular telemetry arrives late, duplicated and out of order. Each vehicle
+// gets a fixed-capacity reorder buffer kept sorted by device timestamp and a
+// watermark (highest event time seen minus the allowed lateness). Readings at
+// or below the watermark are final and released in event-time order; anything
+// that arrives behind what has already been released is late and dropped.
+// Duplicates are suppressed by sequence number with a sliding bitmap. All
+// storage is inline, so the ingest path never allocates.
+
+struct EventTimeConfig {
+    int64_t allowed_lateness_ms = 1000; // event-time slack before a reading is final
+    int64_t max_hold_ms = 3000;         // processing-time cap on how long a reading waits
+};
+
+struct EventTimeCounters {
+    uint64_t accepted = 0;
+    uint64_t reordered = 0;     // arrived behind a newer reading but in time
+    uint64_t duplicates = 0;
+    uint64_t late_dropped = 0;
+    uint64_t forced_releases = 0;
+};
+
+// Remembers the last 1024 sequence numbers per vehicle
+class SequenceWindow {
+private:
+    static constexpr uint64_t WINDOW_BITS = 1024;
+    std::array<uint64_t, WINDOW_BITS / 64> bits{};
+    uint64_t highest = 0;
+    bool has_any = false;
+
+    bool test(uint64_t seq) const { return bits[(seq % WINDOW_BITS) / 64] & (1ULL << (seq % 64)); }
+    void set(uint64_t seq) { bits[(seq % WINDOW_BITS) / 64] |= (1ULL << (seq % 64)); }
+    void reset(uint64_t seq) { bits[(seq % WINDOW_BITS) / 64] &= ~(1ULL << (seq % 64)); }
+
+public:
+    enum class Result { NEW, DUPLICATE, TOO_OLD };
+
+    Result checkAndMark(uint64_t seq) {
+        if (!has_any) {
+            has_any = true;
+            highest = seq;
+            set(seq);
+            return Result::NEW;
+        }
+        if (seq > highest) {
+            // Slide the window forward, clearing the slots being reused
+            uint64_t advance = seq - highest;
+            if (advance >= WINDOW_BITS) {
+                bits.fill(0);
+            } else {
+                for (uint64_t s = highest + 1; s <= seq; ++s) reset(s);
+            }
+            highest = seq;
+            set(seq);
+            return Result::NEW;
+        }
+        if (highest - seq >= WINDOW_BITS) return Result::TOO_OLD;
+        if (test(seq)) return Result::DUPLICATE;
+        set(seq);
+        return Result::NEW;
+    }
+};
+
+template <typename T, size_t Capacity>
+class ReorderBuffer {
+public:
+    struct Entry {
+        int64_t event_ms = 0;
+        int64_t arrival_ms = 0;
+        T item;
+    };
+
+    enum class Admit { BUFFERED, REORDERED, LATE };
+
+private:
+    std::array<Entry, Capacity> entries; // sorted by event_ms, oldest first
+    size_t count = 0;
+    int64_t max_event_ms = INT64_MIN;
+    int64_t released_up_to_ms = INT64_MIN;
+
+public:
+    // Inserts a reading. If the buffer is full the oldest entry is handed to
+    // `on_forced` first so memory stays bounded.
+    template <typename Release>
+    Admit insert(int64_t event_ms, int64_t arrival_ms, const T& item, Release on_forced) {
+        if (event_ms < released_up_to_ms) return Admit::LATE;
+
+        if (count == Capacity) {
+            releaseFront(on_forced);
+        }
+
+        bool out_of_order = event_ms < max_event_ms;
+        size_t pos = count;
+        while (pos > 0 && entries[pos - 1].event_ms > event_ms) {
+            entries[pos] = entries[pos - 1];
+            --pos;
+        }
+        entries[pos].event_ms = event_ms;
+        entries[pos].arrival_ms = arrival_ms;
+        entries[pos].item = item;
+        ++count;
+
+        if (event_ms > max_event_ms) max_event_ms = event_ms;
+        return out_of_order ? Admit::REORDERED : Admit::BUFFERED;
+    }
+
+    // Releases, in event-time order, every entry at or below the watermark
+    // and every entry that has waited longer than max_hold_ms
+    template <typename Release>
+    size_t drain(const EventTimeConfig& config, int64_t now_ms, Release on_release) {
+        size_t released = 0;
+        int64_t watermark = watermarkMs(config);
+        while (count > 0 && (entries[0].event_ms <= watermark ||
+                             now_ms - entries[0].arrival_ms >= config.max_hold_ms)) {
+            releaseFront(on_release);
+            ++released;
+        }
+        return released;
+    }
+
+    // Releases everything regardless of the watermark
+    template <typename Release>
+    size_t flushAll(Release on_release) {
+        size_t released = count;
+        while (count > 0) releaseFront(on_release);
+        return released;
+    }
+
+    int64_t watermarkMs(const EventTimeConfig& config) const {
+        return max_event_ms == INT64_MIN ? INT64_MIN : max_event_ms - config.allowed_lateness_ms;
+    }
+
+    size_t size() const { return count; }
+    static constexpr size_t capacity() { return Capacity; }
+
+private:
+    template <typename Release>
+    void releaseFront(Release& on_release) {
+        released_up_to_ms = std::max(released_up_to_ms, entries[0].event_ms);
+        T item = entries[0].item;
+        for (size_t i = 1; i < count; ++i) entries[i - 1] = entries[i];
+        --count;
+        on_release(item);
+    }
+};
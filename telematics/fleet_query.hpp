@@ -0,0 +1,1013 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// ============================================================================
+// AD-HOC FLEET QUERIES
+// ============================================================================
+//
+// A small query language for the console:
+//
+//   [select] item {, item} [from vehicles|readings|anomalies]
+//   [where field op value {and field op value}] [group by field {, field}]
+//   [order by item [asc|desc]] [last N s|min|h] [limit N]
+//
+// where item is `count`, `agg field` / `agg(field)` with agg one of
+// sum/avg/min/max, or a bare field (grouped or projected). Clauses may come in
+// any order. The text is compiled into a QueryPlan and executed column-wise:
+// each worker pulls a chunk of vehicles from the source, which copies only the
+// columns the plan needs into a QueryBatch (text columns dictionary-encoded per
+// batch), then predicates narrow a selection vector in tight loops and
+// aggregates accumulate per group. Chunks are spread over a worker pool and the
+// per-worker partials merged at the end, so the source only holds its lock
+// while copying one chunk. Missing values are NaN and ignored by aggregates.
+
+enum class QueryFieldKind { NUMBER, TEXT };
+
+struct QueryField {
+    std::string name;
+    QueryFieldKind kind;
+};
+
+class QuerySchema {
+private:
+    std::string table;
+    std::vector<QueryField> fields;
+    bool time_ranged = false;
+
+public:
+    QuerySchema() = default;
+    QuerySchema(const std::string& name, bool supports_time_range)
+        : table(name), time_ranged(supports_time_range) {}
+
+    size_t add(const std::string& name, QueryFieldKind kind) {
+        fields.push_back({name, kind});
+        return fields.size() - 1;
+    }
+
+    int find(const std::string& name) const {
+        for (size_t i = 0; i < fields.size(); ++i) {
+            if (fields[i].name == name) return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+    const std::string& name() const { return table; }
+    const std::vector<QueryField>& getFields() const { return fields; }
+    const QueryField& field(size_t index) const { return fields[index]; }
+    size_t size() const { return fields.size(); }
+    bool supportsTimeRange() const { return time_ranged; }
+};
+
+enum class QueryAgg { VALUE, COUNT, SUM, AVG, MIN, MAX };
+enum class QueryOp { EQ, NE, LT, LE, GT, GE };
+
+inline std::string queryAggString(QueryAgg agg) {
+    switch (agg) {
+        case QueryAgg::COUNT: return "count";
+        case QueryAgg::SUM: return "sum";
+        case QueryAgg::AVG: return "avg";
+        case QueryAgg::MIN: return "min";
+        case QueryAgg::MAX: return "max";
+        default: return "";
+    }
+}
+
+inline std::string queryOpString(QueryOp op) {
+    switch (op) {
+        case QueryOp::EQ: return "=";
+        case QueryOp::NE: return "!=";
+        case QueryOp::LT: return "<";
+        case QueryOp::LE: return "<=";
+        case QueryOp::GT: return ">";
+        case QueryOp::GE: return ">=";
+        default: return "?";
+    }
+}
+
+struct QuerySelectItem {
+    QueryAgg agg = QueryAgg::VALUE;
+    int field = -1;         // -1 for count
+    std::string label;
+};
+
+struct QueryPredicate {
+    int field = -1;
+    QueryOp op = QueryOp::EQ;
+    double number = 0.0;
+    std::string text;
+};
+
+struct QueryPlan {
+    const QuerySchema* schema = nullptr;
+    std::vector<QuerySelectItem> select;
+    std::vector<QueryPredicate> where;
+    std::vector<int> group_by;
+    int order_by = -1;      // index into select
+    bool order_descending = false;
+    int64_t range_ms = 0;   // 0 = everything retained
+    size_t limit = 0;       // 0 = unlimited (projections default to 50)
+    std::vector<bool> needed;
+    std::string error;
+
+    bool ok() const { return error.empty() && schema != nullptr; }
+
+    bool isProjection() const {
+        if (!group_by.empty()) return false;
+        for (const auto& item : select) {
+            if (item.agg != QueryAgg::VALUE) return false;
+        }
+        return true;
+    }
+
+    std::string describe() const {
+        if (!ok()) return "invalid: " + error;
+        std::ostringstream ss;
+        ss << "scan " << schema->name() << " [";
+        bool first = true;
+        for (size_t f = 0; f < needed.size(); ++f) {
+            if (!needed[f]) continue;
+            ss << (first ? "" : ", ") << schema->field(f).name;
+            first = false;
+        }
+        ss << "]";
+        if (range_ms > 0) ss << " last " << range_ms / 1000 << "s";
+        for (const auto& p : where) {
+            ss << " -> filter " << schema->field(p.field).name << " " << queryOpString(p.op) << " ";
+            if (schema->field(p.field).kind == QueryFieldKind::TEXT) ss << "'" << p.text << "'";
+            else ss << p.number;
+        }
+        if (!group_by.empty()) {
+            ss << " -> group by ";
+            for (size_t i = 0; i < group_by.size(); ++i) {
+                ss << (i ? ", " : "") << schema->field(group_by[i]).name;
+            }
+        }
+        ss << (isProjection() ? " -> project " : " -> aggregate ");
+        for (size_t i = 0; i < select.size(); ++i) ss << (i ? ", " : "") << select[i].label;
+        if (order_by >= 0) ss << " -> order by " << select[order_by].label << (order_descending ? " desc" : "");
+        if (limit > 0) ss << " -> limit " << limit;
+        return ss.str();
+    }
+};
+
+// One chunk of rows in columnar form. Only the columns the plan needs are
+// filled; text columns hold per-batch dictionary codes.
+class QueryBatch {
+private:
+    const QuerySchema* schema = nullptr;
+    std::vector<bool> needed;
+    size_t row_count = 0;
+    std::vector<std::vector<double>> number_columns;
+    std::vector<std::vector<uint32_t>> code_columns;
+    std::vector<std::vector<std::string>> dictionaries;
+    std::vector<std::unordered_map<std::string, uint32_t>> interned;
+
+public:
+    void prepare(const QuerySchema& s, const std::vector<bool>& needed_fields) {
+        schema = &s;
+        needed = needed_fields;
+        number_columns.assign(s.size(), {});
+        code_columns.assign(s.size(), {});
+        dictionaries.assign(s.size(), {});
+        interned.assign(s.size(), {});
+        row_count = 0;
+    }
+
+    // Keeps column capacity across chunks
+    void clear() {
+        for (auto& column : number_columns) column.clear();
+        for (auto& column : code_columns) column.clear();
+        for (auto& dictionary : dictionaries) dictionary.clear();
+        for (auto& index : interned) index.clear();
+        row_count = 0;
+    }
+
+    bool needs(size_t field) const { return needed[field]; }
+
+    std::vector<double>& numbers(size_t field) { return number_columns[field]; }
+    void appendNumber(size_t field, double value) { number_columns[field].push_back(value); }
+
+    void appendText(size_t field, std::string_view value, size_t repeat = 1) {
+        auto inserted = interned[field].emplace(value, static_cast<uint32_t>(dictionaries[field].size()));
+        if (inserted.second) dictionaries[field].emplace_back(value);
+        code_columns[field].insert(code_columns[field].end(), repeat, inserted.first->second);
+    }
+
+    void setRows(size_t rows) { row_count = rows; }
+    size_t rows() const { return row_count; }
+
+    const std::vector<double>& numberColumn(size_t field) const { return number_columns[field]; }
+    const std::vector<uint32_t>& codes(size_t field) const { return code_columns[field]; }
+    const std::vector<std::string>& dictionary(size_t field) const { return dictionaries[field]; }
+
+    // True when every needed column has exactly rows() entries
+    bool consistent() const {
+        for (size_t f = 0; f < needed.size(); ++f) {
+            if (!needed[f]) continue;
+            size_t n = schema->field(f).kind == QueryFieldKind::TEXT ? code_columns[f].size()
+                                                                     : number_columns[f].size();
+            if (n != row_count) return false;
+        }
+        return true;
+    }
+};
+
+// Rows are produced in chunks (typically a slice of vehicles) that can be
+// loaded independently and concurrently
+struct QuerySource {
+    size_t chunk_count = 0;
+    std::function<void(size_t chunk, const QueryPlan& plan, QueryBatch& batch)> load;
+};
+
+struct QueryCell {
+    bool is_text = false;
+    double number = 0.0;
+    std::string text;
+};
+
+struct QueryResult {
+    std::string error;
+    std::vector<std::string> headers;
+    std::vector<std::vector<QueryCell>> rows;
+    size_t rows_scanned = 0;
+    size_t rows_matched = 0;
+    size_t chunks = 0;
+    size_t workers = 0;
+    double elapsed_ms = 0.0;
+};
+
+inline std::string formatQueryNumber(double value) {
+    if (std::isnan(value)) return "-";
+    std::ostringstream ss;
+    if (value == std::floor(value) && std::abs(value) < 1e15) {
+        ss << static_cast<long long>(value);
+    } else {
+        ss.setf(std::ios::fixed);
+        ss.precision(2);
+        ss << value;
+    }
+    return ss.str();
+}
+
+inline std::string formatQueryCell(const QueryCell& cell) {
+    return cell.is_text ? cell.text : formatQueryNumber(cell.number);
+}
+
+// ----------------------------------------------------------------------------
+// Parsing
+// ----------------------------------------------------------------------------
+
+namespace fleet_query_detail {
+
+struct Token {
+    enum Kind { WORD, NUMBER, STRING, SYMBOL, END } kind = END;
+    std::string text;   // words are lower-cased; strings keep their case
+    std::string raw;
+    double number = 0.0;
+};
+
+inline std::string lower(std::string s) {
+    for (auto& ch : s) ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+    return s;
+}
+
+inline bool equalsIgnoreCase(const std::string& a, const std::string& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+inline bool tokenize(const std::string& text, std::vector<Token>& tokens, std::string& error) {
+    size_t i = 0;
+    while (i < text.size()) {
+        unsigned char ch = static_cast<unsigned char>(text[i]);
+        if (std::isspace(ch)) { ++i; continue; }
+
+        Token token;
+        bool negative_number = ch == '-' && i + 1 < text.size() &&
+                               (std::isdigit(static_cast<unsigned char>(text[i + 1])) || text[i + 1] == '.');
+        if (std::isdigit(ch) || ch == '.' || negative_number) {
+            char* end = nullptr;
+            token.kind = Token::NUMBER;
+            token.number = std::strtod(text.c_str() + i, &end);
+            size_t next = static_cast<size_t>(end - text.c_str());
+            if (next == i) { error = "bad number at '" + text.substr(i) + "'"; return false; }
+            token.raw = text.substr(i, next - i);
+            i = next;
+        } else if (std::isalpha(ch) || ch == '_') {
+            size_t start = i;
+            while (i < text.size() && (std::isalnum(static_cast<unsigned char>(text[i])) || text[i] == '_')) ++i;
+            token.kind = Token::WORD;
+            token.raw = text.substr(start, i - start);
+            token.text = lower(token.raw);
+        } else if (ch == '\'' || ch == '"') {
+            size_t close = text.find(static_cast<char>(ch), i + 1);
+            if (close == std::string::npos) { error = "unterminated string"; return false; }
+            token.kind = Token::STRING;
+            token.text = token.raw = text.substr(i + 1, close - i - 1);
+            i = close + 1;
+        } else {
+            static const char* two_char[] = {"!=", "<>", "<=", ">=", "=="};
+            token.kind = Token::SYMBOL;
+            for (const char* sym : two_char) {
+                if (text.compare(i, 2, sym) == 0) { token.text = sym; break; }
+            }
+            if (token.text.empty()) {
+                if (std::string(",()=<>*").find(static_cast<char>(ch)) == std::string::npos) {
+                    error = std::string("unexpected character '") + static_cast<char>(ch) + "'";
+                    return false;
+                }
+                token.text = std::string(1, static_cast<char>(ch));
+            }
+            token.raw = token.text;
+            i += token.text.size();
+        }
+        tokens.push_back(token);
+    }
+    tokens.push_back(Token{});
+    return true;
+}
+
+inline bool isAggWord(const std::string& word, QueryAgg& agg) {
+    if (word == "count") agg = QueryAgg::COUNT;
+    else if (word == "sum") agg = QueryAgg::SUM;
+    else if (word == "avg" || word == "mean") agg = QueryAgg::AVG;
+    else if (word == "min") agg = QueryAgg::MIN;
+    else if (word == "max") agg = QueryAgg::MAX;
+    else return false;
+    return true;
+}
+
+inline bool isClauseWord(const std::string& word) {
+    return word == "from" || word == "where" || word == "group" || word == "order" ||
+           word == "last" || word == "limit";
+}
+
+// Select/order items before field names are resolved against the table
+struct RawItem {
+    QueryAgg agg = QueryAgg::VALUE;
+    std::string field;
+};
+
+class Parser {
+private:
+    const std::vector<Token>& tokens;
+    size_t pos = 0;
+
+public:
+    std::string error;
+
+    explicit Parser(const std::vector<Token>& t) : tokens(t) {}
+
+    const Token& peek() const { return tokens[pos]; }
+    const Token& next() { return tokens[pos < tokens.size() - 1 ? pos++ : pos]; }
+    bool atEnd() const { return tokens[pos].kind == Token::END; }
+
+    bool acceptWord(const char* word) {
+        if (peek().kind == Token::WORD && peek().text == word) { ++pos; return true; }
+        return false;
+    }
+
+    bool acceptSymbol(const char* symbol) {
+        if (peek().kind == Token::SYMBOL && peek().text == symbol) { ++pos; return true; }
+        return false;
+    }
+
+    bool expectWord(const char* word) {
+        if (acceptWord(word)) return true;
+        error = std::string("expected '") + word + "'";
+        return false;
+    }
+
+    bool fieldName(std::string& name) {
+        if (peek().kind != Token::WORD || isClauseWord(peek().text)) {
+            error = "expected a field name" + (atEnd() ? std::string() : " near '" + peek().raw + "'");
+            return false;
+        }
+        name = next().text;
+        return true;
+    }
+
+    bool item(RawItem& out) {
+        QueryAgg agg;
+        if (peek().kind == Token::WORD && isAggWord(peek().text, agg)) {
+            // An aggregate word followed by ',' or a clause is a field named e.g. "max"
+            const Token& after = tokens[pos + 1];
+            bool bare = after.kind == Token::END || (after.kind == Token::SYMBOL && after.text == ",") ||
+                        (after.kind == Token::WORD && isClauseWord(after.text));
+            if (agg == QueryAgg::COUNT || !bare) {
+                ++pos;
+                out.agg = agg;
+                if (agg == QueryAgg::COUNT) {
+                    if (acceptSymbol("(")) {
+                        acceptSymbol("*");
+                        if (!acceptSymbol(")")) { error = "expected ')' after count("; return false; }
+                    }
+                    return true;
+                }
+                bool paren = acceptSymbol("(");
+                if (!fieldName(out.field)) return false;
+                if (paren && !acceptSymbol(")")) { error = "expected ')'"; return false; }
+                return true;
+            }
+        }
+        out.agg = QueryAgg::VALUE;
+        return fieldName(out.field);
+    }
+
+    bool op(QueryOp& out) {
+        const Token& t = peek();
+        if (t.kind != Token::SYMBOL) { error = "expected a comparison operator"; return false; }
+        if (t.text == "=" || t.text == "==") out = QueryOp::EQ;
+        else if (t.text == "!=" || t.text == "<>") out = QueryOp::NE;
+        else if (t.text == "<") out = QueryOp::LT;
+        else if (t.text == "<=") out = QueryOp::LE;
+        else if (t.text == ">") out = QueryOp::GT;
+        else if (t.text == ">=") out = QueryOp::GE;
+        else { error = "expected a comparison operator"; return false; }
+        ++pos;
+        return true;
+    }
+};
+
+inline std::string itemLabel(QueryAgg agg, const std::string& field) {
+    if (agg == QueryAgg::COUNT) return "count";
+    if (agg == QueryAgg::VALUE) return field;
+    return queryAggString(agg) + "(" + field + ")";
+}
+
+} // namespace fleet_query_detail
+
+// Compiles query text against the available tables. Errors are reported in
+// plan.error rather than thrown.
+inline QueryPlan compileFleetQuery(const std::string& text,
+                                   const std::map<std::string, QuerySchema>& tables,
+                                   const std::string& default_table) {
+    using namespace fleet_query_detail;
+    QueryPlan plan;
+
+    std::vector<Token> tokens;
+    if (!tokenize(text, tokens, plan.error)) return plan;
+    Parser parser(tokens);
+
+    struct RawPredicate { std::string field; QueryOp op; Token value; };
+    std::vector<RawItem> items;
+    std::vector<RawPredicate> predicates;
+    std::vector<std::string> groups;
+    RawItem order_item;
+    bool has_order = false;
+    std::string table = default_table;
+
+    auto fail = [&plan](const std::string& message) { plan.error = message; return plan; };
+
+    parser.acceptWord("select");
+    do {
+        RawItem item;
+        if (!parser.item(item)) return fail(parser.error);
+        items.push_back(item);
+    } while (parser.acceptSymbol(","));
+
+    while (!parser.atEnd()) {
+        if (parser.acceptWord("from")) {
+            if (parser.peek().kind != Token::WORD) return fail("expected a table name after 'from'");
+            table = parser.next().text;
+        } else if (parser.acceptWord("where")) {
+            do {
+                RawPredicate p;
+                if (!parser.fieldName(p.field) || !parser.op(p.op)) return fail(parser.error);
+                if (parser.atEnd() || parser.peek().kind == Token::SYMBOL) return fail("expected a value after '" + p.field + "'");
+                p.value = parser.next();
+                predicates.push_back(p);
+            } while (parser.acceptWord("and"));
+        } else if (parser.acceptWord("group")) {
+            if (!parser.expectWord("by")) return fail(parser.error);
+            do {
+                std::string name;
+                if (!parser.fieldName(name)) return fail(parser.error);
+                groups.push_back(name);
+            } while (parser.acceptSymbol(","));
+        } else if (parser.acceptWord("order")) {
+            if (!parser.expectWord("by") || !parser.item(order_item)) return fail(parser.error);
+            has_order = true;
+            if (parser.acceptWord("desc")) plan.order_descending = true;
+            else parser.acceptWord("asc");
+        } else if (parser.acceptWord("last")) {
+            if (parser.peek().kind != Token::NUMBER) return fail("expected a number after 'last'");
+            double amount = parser.next().number;
+            std::string unit = parser.peek().kind == Token::WORD ? parser.next().text : "min";
+            double scale = 0.0;
+            if (unit == "s" || unit == "sec" || unit == "secs" || unit == "second" || unit == "seconds") scale = 1000.0;
+            else if (unit == "m" || unit == "min" || unit == "mins" || unit == "minute" || unit == "minutes") scale = 60000.0;
+            else if (unit == "h" || unit == "hr" || unit == "hrs" || unit == "hour" || unit == "hours") scale = 3600000.0;
+            else return fail("unknown time unit '" + unit + "'");
+            if (amount <= 0) return fail("time range must be positive");
+            plan.range_ms = static_cast<int64_t>(amount * scale);
+        } else if (parser.acceptWord("limit")) {
+            if (parser.peek().kind != Token::NUMBER || parser.peek().number < 1) return fail("expected a positive number after 'limit'");
+            plan.limit = static_cast<size_t>(parser.next().number);
+        } else {
+            return fail("unexpected '" + parser.peek().raw + "'");
+        }
+    }
+
+    auto table_it = tables.find(table);
+    if (table_it == tables.end()) return fail("unknown table '" + table + "'");
+    const QuerySchema& schema = table_it->second;
+    plan.schema = &schema;
+    plan.needed.assign(schema.size(), false);
+    if (plan.range_ms > 0 && !schema.supportsTimeRange()) {
+        return fail("'last' applies to readings and anomalies, not " + schema.name());
+    }
+
+    auto resolve = [&](const std::string& name, int& field) {
+        field = schema.find(name);
+        if (field < 0) plan.error = "unknown field '" + name + "' in " + schema.name();
+        else plan.needed[field] = true;
+        return field >= 0;
+    };
+
+    for (const auto& name : groups) {
+        int field;
+        if (!resolve(name, field)) return plan;
+        if (std::find(plan.group_by.begin(), plan.group_by.end(), field) == plan.group_by.end()) {
+            plan.group_by.push_back(field);
+        }
+    }
+    if (plan.group_by.size() > 4) return fail("at most 4 group by fields");
+
+    bool any_aggregate = false;
+    for (const auto& raw : items) any_aggregate |= raw.agg != QueryAgg::VALUE;
+
+    for (const auto& raw : items) {
+        QuerySelectItem item;
+        item.agg = raw.agg;
+        item.label = itemLabel(raw.agg, raw.field);
+        if (raw.agg != QueryAgg::COUNT && !resolve(raw.field, item.field)) return plan;
+        if (item.agg != QueryAgg::VALUE && item.agg != QueryAgg::COUNT &&
+            schema.field(item.field).kind == QueryFieldKind::TEXT) {
+            return fail(item.label + ": cannot aggregate text field '" + raw.field + "'");
+        }
+        if (item.agg == QueryAgg::VALUE && (any_aggregate || !plan.group_by.empty()) &&
+            std::find(plan.group_by.begin(), plan.group_by.end(), item.field) == plan.group_by.end()) {
+            return fail("'" + raw.field + "' must be aggregated or listed in group by");
+        }
+        plan.select.push_back(item);
+    }
+
+    // Group keys always lead the output, as the result is unreadable without them
+    for (size_t level = plan.group_by.size(); level-- > 0;) {
+        int field = plan.group_by[level];
+        bool selected = false;
+        for (const auto& item : plan.select) selected |= item.agg == QueryAgg::VALUE && item.field == field;
+        if (!selected) {
+            QuerySelectItem item;
+            item.field = field;
+            item.label = schema.field(field).name;
+            plan.select.insert(plan.select.begin(), item);
+        }
+    }
+
+    for (const auto& raw : predicates) {
+        QueryPredicate p;
+        p.op = raw.op;
+        if (!resolve(raw.field, p.field)) return plan;
+        if (schema.field(p.field).kind == QueryFieldKind::TEXT) {
+            if (p.op != QueryOp::EQ && p.op != QueryOp::NE) return fail("text field '" + raw.field + "' only supports = and !=");
+            p.text = raw.value.raw;
+        } else {
+            if (raw.value.kind != Token::NUMBER) return fail("'" + raw.field + "' needs a numeric value");
+            p.number = raw.value.number;
+        }
+        plan.where.push_back(p);
+    }
+
+    if (has_order) {
+        std::string label = itemLabel(order_item.agg, order_item.field);
+        for (size_t i = 0; i < plan.select.size(); ++i) {
+            if (plan.select[i].label == label) plan.order_by = static_cast<int>(i);
+        }
+        if (plan.order_by < 0) return fail("order by '" + label + "' must be one of the selected items");
+    }
+    if (plan.isProjection() && plan.limit == 0) plan.limit = 50;
+    return plan;
+}
+
+// ----------------------------------------------------------------------------
+// Execution
+// ----------------------------------------------------------------------------
+
+namespace fleet_query_detail {
+
+// Narrows the selection vector in place; branch-free so the loop vectorises
+template <typename Compare>
+inline size_t filterNumbers(const double* column, uint32_t* selection, size_t count,
+                            double rhs, Compare compare) {
+    size_t kept = 0;
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t row = selection[i];
+        selection[kept] = row;
+        kept += compare(column[row], rhs) ? 1 : 0;
+    }
+    return kept;
+}
+
+inline size_t filterCodes(const uint32_t* codes, const uint8_t* matches, uint32_t* selection, size_t count) {
+    size_t kept = 0;
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t row = selection[i];
+        selection[kept] = row;
+        kept += matches[codes[row]];
+    }
+    return kept;
+}
+
+inline size_t applyPredicate(const QueryPlan& plan, const QueryPredicate& p, const QueryBatch& batch,
+                             std::vector<uint32_t>& selection, size_t count, std::vector<uint8_t>& scratch) {
+    if (plan.schema->field(p.field).kind == QueryFieldKind::TEXT) {
+        const auto& dictionary = batch.dictionary(p.field);
+        scratch.resize(dictionary.size());
+        for (size_t i = 0; i < dictionary.size(); ++i) {
+            bool equal = equalsIgnoreCase(dictionary[i], p.text);
+            scratch[i] = (p.op == QueryOp::EQ) == equal ? 1 : 0;
+        }
+        return filterCodes(batch.codes(p.field).data(), scratch.data(), selection.data(), count);
+    }
+
+    const double* column = batch.numberColumn(p.field).data();
+    switch (p.op) {
+        case QueryOp::EQ: return filterNumbers(column, selection.data(), count, p.number, [](double a, double b) { return a == b; });
+        case QueryOp::NE: return filterNumbers(column, selection.data(), count, p.number, [](double a, double b) { return a != b; });
+        case QueryOp::LT: return filterNumbers(column, selection.data(), count, p.number, [](double a, double b) { return a < b; });
+        case QueryOp::LE: return filterNumbers(column, selection.data(), count, p.number, [](double a, double b) { return a <= b; });
+        case QueryOp::GT: return filterNumbers(column, selection.data(), count, p.number, [](double a, double b) { return a > b; });
+        case QueryOp::GE: return filterNumbers(column, selection.data(), count, p.number, [](double a, double b) { return a >= b; });
+    }
+    return count;
+}
+
+// Per-group accumulators, one column per select item
+struct Accumulators {
+    std::vector<uint64_t> rows;
+    std::vector<std::vector<uint64_t>> counts;
+    std::vector<std::vector<double>> sums, mins, maxs;
+
+    void init(size_t items) {
+        counts.assign(items, {});
+        sums.assign(items, {});
+        mins.assign(items, {});
+        maxs.assign(items, {});
+    }
+
+    void addGroup() {
+        rows.push_back(0);
+        for (size_t i = 0; i < counts.size(); ++i) {
+            counts[i].push_back(0);
+            sums[i].push_back(0.0);
+            mins[i].push_back(std::numeric_limits<double>::infinity());
+            maxs[i].push_back(-std::numeric_limits<double>::infinity());
+        }
+    }
+};
+
+struct WorkerState {
+    QueryBatch batch;
+    std::vector<uint32_t> selection;
+    std::vector<uint32_t> group_ids;
+    std::vector<uint8_t> scratch;
+
+    // Group key values seen by this worker, per group-by field
+    std::vector<std::vector<QueryCell>> key_values;
+    std::vector<std::unordered_map<std::string, uint32_t>> text_ids;
+    std::vector<std::unordered_map<uint64_t, uint32_t>> number_ids;
+    std::vector<uint32_t> local_ids;               // batch code -> key id, reused
+    std::vector<uint32_t> row_keys;                // key id per (level, selected row)
+    std::map<std::vector<uint32_t>, uint32_t> groups_by_key;
+    std::vector<std::vector<uint32_t>> group_keys; // group -> key id per level
+    Accumulators acc;
+
+    std::vector<std::vector<QueryCell>> projected;
+    size_t scanned = 0;
+    size_t matched = 0;
+};
+
+inline uint64_t numberKey(double value) {
+    uint64_t bits;
+    if (value == 0.0) value = 0.0; // fold -0
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+inline void computeGroupIds(const QueryPlan& plan, WorkerState& w, size_t count) {
+    const size_t levels = plan.group_by.size();
+    if (levels == 0) {
+        if (w.group_keys.empty()) {
+            w.group_keys.emplace_back();
+            w.acc.addGroup();
+        }
+        return;
+    }
+
+    // Map each row to the worker-wide id of its key value, level by level
+    w.row_keys.resize(count * levels);
+    for (size_t level = 0; level < levels; ++level) {
+        const int field = plan.group_by[level];
+        uint32_t* keys = w.row_keys.data() + level * count;
+
+        if (plan.schema->field(field).kind == QueryFieldKind::TEXT) {
+            // Resolve each distinct batch code once
+            const auto& dictionary = w.batch.dictionary(field);
+            w.local_ids.resize(dictionary.size());
+            for (size_t c = 0; c < dictionary.size(); ++c) {
+                auto inserted = w.text_ids[level].emplace(dictionary[c], static_cast<uint32_t>(w.key_values[level].size()));
+                if (inserted.second) {
+                    QueryCell cell;
+                    cell.is_text = true;
+                    cell.text = dictionary[c];
+                    w.key_values[level].push_back(cell);
+                }
+                w.local_ids[c] = inserted.first->second;
+            }
+            const uint32_t* codes = w.batch.codes(field).data();
+            for (size_t i = 0; i < count; ++i) keys[i] = w.local_ids[codes[w.selection[i]]];
+        } else {
+            const double* column = w.batch.numberColumn(field).data();
+            for (size_t i = 0; i < count; ++i) {
+                double value = column[w.selection[i]];
+                auto inserted = w.number_ids[level].emplace(numberKey(value), static_cast<uint32_t>(w.key_values[level].size()));
+                if (inserted.second) {
+                    QueryCell cell;
+                    cell.number = value;
+                    w.key_values[level].push_back(cell);
+                }
+                keys[i] = inserted.first->second;
+            }
+        }
+    }
+
+    if (levels == 1) {
+        // Key ids are the group ids
+        const uint32_t* keys = w.row_keys.data();
+        w.group_ids.assign(keys, keys + count);
+        while (w.group_keys.size() < w.key_values[0].size()) {
+            w.group_keys.push_back({static_cast<uint32_t>(w.group_keys.size())});
+            w.acc.addGroup();
+        }
+        return;
+    }
+
+    // Combine the per-level key ids into one group id per row
+    w.group_ids.resize(count);
+    std::vector<uint32_t> ids(levels);
+    for (size_t i = 0; i < count; ++i) {
+        for (size_t level = 0; level < levels; ++level) ids[level] = w.row_keys[level * count + i];
+        auto inserted = w.groups_by_key.emplace(ids, static_cast<uint32_t>(w.group_keys.size()));
+        if (inserted.second) {
+            w.group_keys.push_back(ids);
+            w.acc.addGroup();
+        }
+        w.group_ids[i] = inserted.first->second;
+    }
+}
+
+} // namespace fleet_query_detail
+
+// Runs a compiled plan over the source with up to max_workers threads
+inline QueryResult executeFleetQuery(const QueryPlan& plan, const QuerySource& source, size_t max_workers = 0) {
+    using namespace fleet_query_detail;
+    auto start = std::chrono::steady_clock::now();
+    QueryResult result;
+    if (!plan.ok()) {
+        result.error = plan.error.empty() ? "no table" : plan.error;
+        return result;
+    }
+
+    if (max_workers == 0) max_workers = std::max(1u, std::thread::hardware_concurrency());
+    const size_t workers = std::max<size_t>(1, std::min(max_workers, source.chunk_count));
+    const size_t levels = plan.group_by.size();
+    const bool projection = plan.isProjection();
+    const bool projection_can_stop = projection && plan.order_by < 0;
+
+    std::vector<WorkerState> states(workers);
+    std::atomic<size_t> next_chunk{0};
+    std::atomic<size_t> projected_total{0};
+    std::atomic<bool> inconsistent{false};
+
+    auto run = [&](WorkerState& w) {
+        w.batch.prepare(*plan.schema, plan.needed);
+        w.key_values.assign(levels, {});
+        w.text_ids.assign(levels, {});
+        w.number_ids.assign(levels, {});
+        w.acc.init(plan.select.size());
+
+        size_t chunk;
+        while ((chunk = next_chunk.fetch_add(1)) < source.chunk_count) {
+            if (projection_can_stop && projected_total.load() >= plan.limit) break;
+            w.batch.clear();
+            source.load(chunk, plan, w.batch);
+            if (!w.batch.consistent()) { inconsistent = true; continue; }
+
+            const size_t rows = w.batch.rows();
+            w.scanned += rows;
+            w.selection.resize(rows);
+            for (size_t i = 0; i < rows; ++i) w.selection[i] = static_cast<uint32_t>(i);
+            size_t count = rows;
+            for (const auto& p : plan.where) {
+                if (count == 0) break;
+                count = applyPredicate(plan, p, w.batch, w.selection, count, w.scratch);
+            }
+            w.matched += count;
+            if (count == 0) continue;
+
+            if (projection) {
+                for (size_t i = 0; i < count; ++i) {
+                    if (projection_can_stop && projected_total.fetch_add(1) >= plan.limit) break;
+                    std::vector<QueryCell> row;
+                    row.reserve(plan.select.size());
+                    for (const auto& item : plan.select) {
+                        QueryCell cell;
+                        if (plan.schema->field(item.field).kind == QueryFieldKind::TEXT) {
+                            cell.is_text = true;
+                            cell.text = w.batch.dictionary(item.field)[w.batch.codes(item.field)[w.selection[i]]];
+                        } else {
+                            cell.number = w.batch.numberColumn(item.field)[w.selection[i]];
+                        }
+                        row.push_back(std::move(cell));
+                    }
+                    w.projected.push_back(std::move(row));
+                }
+                continue;
+            }
+
+            computeGroupIds(plan, w, count);
+            const uint32_t* groups = w.group_ids.data();
+            const uint32_t* selection = w.selection.data();
+            if (levels == 0) {
+                w.acc.rows[0] += count;
+            } else {
+                for (size_t i = 0; i < count; ++i) w.acc.rows[groups[i]]++;
+            }
+
+            for (size_t s = 0; s < plan.select.size(); ++s) {
+                const auto& item = plan.select[s];
+                if (item.agg == QueryAgg::VALUE || item.agg == QueryAgg::COUNT) continue;
+                const double* column = w.batch.numberColumn(item.field).data();
+                uint64_t* counts = w.acc.counts[s].data();
+                double* sums = w.acc.sums[s].data();
+                double* mins = w.acc.mins[s].data();
+                double* maxs = w.acc.maxs[s].data();
+                for (size_t i = 0; i < count; ++i) {
+                    double v = column[selection[i]];
+                    if (std::isnan(v)) continue;
+                    uint32_t g = levels == 0 ? 0 : groups[i];
+                    counts[g]++;
+                    sums[g] += v;
+                    mins[g] = std::min(mins[g], v);
+                    maxs[g] = std::max(maxs[g], v);
+                }
+            }
+        }
+    };
+
+    if (workers == 1) {
+        run(states[0]);
+    } else {
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < workers; ++i) threads.emplace_back(run, std::ref(states[i]));
+        for (auto& t : threads) t.join();
+    }
+
+    for (const auto& item : plan.select) result.headers.push_back(item.label);
+    result.chunks = source.chunk_count;
+    result.workers = workers;
+    for (const auto& w : states) {
+        result.rows_scanned += w.scanned;
+        result.rows_matched += w.matched;
+    }
+    if (inconsistent) result.error = "source returned a malformed batch";
+
+    if (projection) {
+        for (auto& w : states) {
+            for (auto& row : w.projected) result.rows.push_back(std::move(row));
+        }
+    } else {
+        // Merge per-worker groups by their rendered key
+        std::map<std::string, size_t> merged_index;
+        std::vector<std::vector<QueryCell>> merged_keys;
+        Accumulators merged;
+        merged.init(plan.select.size());
+
+        for (const auto& w : states) {
+            for (size_t g = 0; g < w.group_keys.size(); ++g) {
+                std::string key;
+                std::vector<QueryCell> cells;
+                for (size_t level = 0; level < levels; ++level) {
+                    const QueryCell& cell = w.key_values[level][w.group_keys[g][level]];
+                    key += (cell.is_text ? "t" + cell.text : "n" + std::to_string(numberKey(cell.number))) + '\x1f';
+                    cells.push_back(cell);
+                }
+                auto inserted = merged_index.emplace(key, merged_keys.size());
+                if (inserted.second) {
+                    merged_keys.push_back(cells);
+                    merged.addGroup();
+                }
+                size_t m = inserted.first->second;
+                merged.rows[m] += w.acc.rows[g];
+                for (size_t s = 0; s < plan.select.size(); ++s) {
+                    merged.counts[s][m] += w.acc.counts[s][g];
+                    merged.sums[s][m] += w.acc.sums[s][g];
+                    merged.mins[s][m] = std::min(merged.mins[s][m], w.acc.mins[s][g]);
+                    merged.maxs[s][m] = std::max(merged.maxs[s][m], w.acc.maxs[s][g]);
+                }
+            }
+        }
+
+        // An ungrouped aggregate over no rows still yields one row
+        if (levels == 0 && merged_keys.empty()) {
+            merged_keys.emplace_back();
+            merged.addGroup();
+        }
+
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        for (size_t m = 0; m < merged_keys.size(); ++m) {
+            std::vector<QueryCell> row;
+            for (size_t s = 0; s < plan.select.size(); ++s) {
+                const auto& item = plan.select[s];
+                QueryCell cell;
+                bool empty = merged.counts[s][m] == 0;
+                switch (item.agg) {
+                    case QueryAgg::VALUE: {
+                        size_t level = std::find(plan.group_by.begin(), plan.group_by.end(), item.field) - plan.group_by.begin();
+                        cell = merged_keys[m][level];
+                        break;
+                    }
+                    case QueryAgg::COUNT: cell.number = static_cast<double>(merged.rows[m]); break;
+                    case QueryAgg::SUM: cell.number = empty ? nan : merged.sums[s][m]; break;
+                    case QueryAgg::AVG: cell.number = empty ? nan : merged.sums[s][m] / merged.counts[s][m]; break;
+                    case QueryAgg::MIN: cell.number = empty ? nan : merged.mins[s][m]; break;
+                    case QueryAgg::MAX: cell.number = empty ? nan : merged.maxs[s][m]; break;
+                }
+                row.push_back(std::move(cell));
+            }
+            result.rows.push_back(std::move(row));
+        }
+
+        // Default order: group key ascending
+        if (plan.order_by < 0 && levels > 0) {
+            std::vector<size_t> order(result.rows.size());
+            for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+            std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+                for (size_t level = 0; level < levels; ++level) {
+                    const QueryCell& x = merged_keys[a][level];
+                    const QueryCell& y = merged_keys[b][level];
+                    if (x.is_text ? x.text != y.text : x.number != y.number) {
+                        return x.is_text ? x.text < y.text : x.number < y.number;
+                    }
+                }
+                return false;
+            });
+            std::vector<std::vector<QueryCell>> sorted;
+            sorted.reserve(order.size());
+            for (size_t i : order) sorted.push_back(std::move(result.rows[i]));
+            result.rows.swap(sorted);
+        }
+    }
+
+    if (plan.order_by >= 0) {
+        const size_t column = static_cast<size_t>(plan.order_by);
+        const bool descending = plan.order_descending;
+        std::stable_sort(result.rows.begin(), result.rows.end(),
+            [column, descending](const std::vector<QueryCell>& a, const std::vector<QueryCell>& b) {
+                const QueryCell& x = a[column];
+                const QueryCell& y = b[column];
+                if (x.is_text) return descending ? y.text < x.text : x.text < y.text;
+                // NaN (no data) sorts last either way
+                if (std::isnan(x.number) || std::isnan(y.number)) return !std::isnan(x.number) && std::isnan(y.number);
+                return descending ? y.number < x.number : x.number < y.number;
+            });
+    }
+    if (plan.limit > 0 && result.rows.size() > plan.limit) result.rows.resize(plan.limit);
+
+    result.elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
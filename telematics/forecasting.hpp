@@ -0,0 +1,195 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// ============================================================================
+// INCREMENTAL FORECASTING
+// ============================================================================
+//
+// Per-channel exponential smoothing, updated in O(1) per reading:
+//   - Holt (double exponential smoothing): level + trend
+//   - Holt-Winters (triple, additive): level + trend + a seasonal profile
+//     season_length steps long
+// A step is one reading, so forecasts are "h readings ahead"; at the nominal
+// 1 Hz reporting rate that is h seconds. Each model also keeps its last
+// one-step-ahead residual and an EWMA of the squared residual, so detectors
+// can score a surprise without rescanning history.
+//
+// Models hold no parameters of their own. A ForecastLayout keeps one config
+// per slot and every vehicle's ForecastSet follows it, like WindowLayout and
+// WindowSet, so the per-channel state stays within two cache lines.
+
+struct ForecastConfig {
+    double alpha = 0.3;             // level smoothing
+    double beta = 0.05;             // trend smoothing
+    double gamma = 0.1;             // seasonal smoothing
+    double residual_alpha = 0.05;   // smoothing of the squared residual
+    uint32_t season_length = 0;     // 0 = Holt; otherwise Holt-Winters, at most MAX_SEASON
+    uint32_t warmup = 10;           // residual samples before ready()
+};
+
+template <size_t MAX_SEASON>
+class ExponentialForecaster {
+private:
+    double level = 0.0;
+    double trend = 0.0;
+    double residual_var = 0.0;
+    float last_residual = 0.0f;
+    uint32_t observations = 0;
+    uint32_t season_pos = 0;
+    std::array<float, MAX_SEASON> seasonal{};   // during initialisation: the first season's raw values
+
+    static uint32_t seasonLength(const ForecastConfig& config) {
+        return std::min<uint32_t>(config.season_length, static_cast<uint32_t>(MAX_SEASON));
+    }
+
+    // Observations consumed before the model starts forecasting
+    static uint32_t initLength(const ForecastConfig& config) {
+        uint32_t season = seasonLength(config);
+        return season ? season : 2;
+    }
+
+public:
+    // Folds in one observation and returns its one-step-ahead residual
+    // (0 while the model is still initialising)
+    double update(double value, const ForecastConfig& config) {
+        const uint32_t season = seasonLength(config);
+        const uint32_t init = initLength(config);
+        observations++;
+
+        if (observations <= init) {
+            if (season == 0) {
+                // Holt: level from the first sample, trend from the first difference
+                if (observations == 1) {
+                    level = value;
+                } else {
+                    trend = value - level;
+                    level = value;
+                }
+            } else {
+                // Holt-Winters: level is the first season's mean, the
+                // seasonal profile its deviations from it
+                seasonal[observations - 1] = static_cast<float>(value);
+                if (observations == init) {
+                    double sum = 0.0;
+                    for (uint32_t i = 0; i < season; ++i) sum += seasonal[i];
+                    level = sum / season;
+                    trend = 0.0;
+                    for (uint32_t i = 0; i < season; ++i) {
+                        seasonal[i] = static_cast<float>(seasonal[i] - level);
+                    }
+                    season_pos = 0;
+                }
+            }
+            return 0.0;
+        }
+
+        const double s = season ? static_cast<double>(seasonal[season_pos]) : 0.0;
+        const double residual = value - (level + trend + s);
+        const double next_level = config.alpha * (value - s) + (1.0 - config.alpha) * (level + trend);
+        trend = config.beta * (next_level - level) + (1.0 - config.beta) * trend;
+        if (season) {
+            seasonal[season_pos] = static_cast<float>(config.gamma * (value - next_level) + (1.0 - config.gamma) * s);
+            season_pos = season_pos + 1 == season ? 0 : season_pos + 1;
+        }
+        level = next_level;
+
+        residual_var = observations == init + 1
+            ? residual * residual
+            : config.residual_alpha * residual * residual + (1.0 - config.residual_alpha) * residual_var;
+        last_residual = static_cast<float>(residual);
+        return residual;
+    }
+
+    bool ready(const ForecastConfig& config) const {
+        return observations >= initLength(config) + config.warmup;
+    }
+
+    // Value expected `steps` readings ahead
+    double forecast(uint32_t steps, const ForecastConfig& config) const {
+        const uint32_t season = seasonLength(config);
+        double value = level + steps * trend;
+        if (season && steps > 0) value += seasonal[(season_pos + steps - 1) % season];
+        return value;
+    }
+
+    // Readings until the level-plus-trend line reaches `threshold` (seasonal
+    // swings ignored); 0 if already there, infinity if moving away from it
+    double stepsUntil(double threshold) const {
+        double gap = threshold - level;
+        if (gap == 0.0 || (gap > 0.0) != (trend > 0.0) || trend == 0.0) {
+            return gap == 0.0 ? 0.0 : std::numeric_limits<double>::infinity();
+        }
+        return gap / trend;
+    }
+
+    double getLevel() const { return level; }
+    double getTrend() const { return trend; }
+    double residual() const { return last_residual; }
+    double residualStdDev() const { return std::sqrt(residual_var); }
+
+    // Residual in standard deviations; 0 until the variance is non-zero
+    double residualScore() const {
+        double sd = residualStdDev();
+        return sd > 0.0 ? last_residual / sd : 0.0;
+    }
+
+    uint32_t count() const { return observations; }
+};
+
+// Which channels every vehicle forecasts, and how. Handles are indices into
+// the layout and valid for every ForecastSet built from it.
+class ForecastLayout {
+public:
+    struct Spec {
+        size_t channel;
+        ForecastConfig config;
+    };
+
+private:
+    std::vector<Spec> specs;
+
+public:
+    size_t subscribe(size_t channel, const ForecastConfig& config) {
+        specs.push_back({channel, config});
+        return specs.size() - 1;
+    }
+
+    const std::vector<Spec>& getSpecs() const { return specs; }
+    const Spec& operator[](size_t handle) const { return specs[handle]; }
+    size_t size() const { return specs.size(); }
+};
+
+// Per-vehicle instantiation of a layout over N input channels
+template <size_t N, size_t MAX_SEASON>
+class ForecastSet {
+public:
+    using Model = ExponentialForecaster<MAX_SEASON>;
+
+private:
+    const ForecastLayout* layout = nullptr;
+    std::vector<Model> models;
+
+public:
+    ForecastSet() = default;
+    explicit ForecastSet(const ForecastLayout& l) : layout(&l), models(l.size()) {}
+
+    void update(const std::array<double, N>& values) {
+        const auto& specs = layout->getSpecs();
+        if (models.size() < specs.size()) models.resize(specs.size());
+        for (size_t i = 0; i < specs.size(); ++i) {
+            models[i].update(values[specs[i].channel], specs[i].config);
+        }
+    }
+
+    const Model& operator[](size_t handle) const { return models[handle]; }
+    const ForecastConfig& config(size_t handle) const { return (*layout)[handle].config; }
+    bool ready(size_t handle) const { return models[handle].ready(config(handle)); }
+    double forecast(size_t handle, uint32_t steps) const { return models[handle].forecast(steps, config(handle)); }
+    size_t size() const { return models.size(); }
+};
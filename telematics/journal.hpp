@@ -0,0 +1,608 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// ============================================================================
+// WRITE-AHEAD JOURNAL
+// ============================================================================
+//
+// Append-only record log plus snapshots, for state that must survive a crash.
+// A journal directory holds:
+//   snapshot.bin                 "TLMSNAP2", u64 generation, one or more frames
+//                                ("TLMSNAP1" files hold exactly one)
+//   journal-<generation>.wal     frames appended after that snapshot was taken
+//
+// Every frame is u32 payload length, u32 CRC-32C of type and payload, u8
+// type, then the payload, at most JOURNAL_MAX_RECORD bytes; larger records
+// and snapshot frames are refused when written. A torn or corrupt frame ends
+// a journal; recovery truncates the file there.
+//
+// Group commit: append() only copies the frame into a memory buffer. A
+// flusher thread writes the buffer and fdatasync()s it every sync interval,
+// so a crash loses at most one interval of records, and the engine never
+// makes a syscall per record. checkpoint() hands over a builder for a
+// snapshot of the caller's state; later records go to the next generation.
+// The flusher runs the builder, so the encoding happens outside the caller's
+// locks, writes the snapshot next to the journals (temp file, fsync, rename)
+// and deletes the journals it covers. Recovery loads the snapshot and replays
+// the journals from its generation on.
+
+#if defined(_WIN32)
+inline constexpr bool JOURNAL_SUPPORTED = false;
+#else
+inline constexpr bool JOURNAL_SUPPORTED = true;
+#endif
+
+// CRC-32C (Castagnoli), slicing-by-8
+class Crc32c {
+private:
+    using Tables = std::array<std::array<uint32_t, 256>, 8>;
+
+    static const Tables& tables() {
+        static const Tables t = [] {
+            Tables table{};
+            for (uint32_t i = 0; i < 256; ++i) {
+                uint32_t crc = i;
+                for (int bit = 0; bit < 8; ++bit) crc = (crc >> 1) ^ (0x82F63B78u & (0u - (crc & 1u)));
+                table[0][i] = crc;
+            }
+            for (uint32_t i = 0; i < 256; ++i) {
+                for (size_t k = 1; k < 8; ++k) {
+                    table[k][i] = (table[k - 1][i] >> 8) ^ table[0][table[k - 1][i] & 0xFF];
+                }
+            }
+            return table;
+        }();
+        return t;
+    }
+
+public:
+    // Continue a running checksum by passing the previous result as `crc`
+    static uint32_t compute(const void* data, size_t size, uint32_t crc = 0) {
+        const Tables& t = tables();
+        const auto* p = static_cast<const unsigned char*>(data);
+        crc = ~crc;
+        while (size >= 8) {
+            uint32_t lo, hi;
+            std::memcpy(&lo, p, 4);
+            std::memcpy(&hi, p + 4, 4);
+            lo ^= crc;   // little-endian hosts; see the static_assert below
+            crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+                  t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+            p += 8;
+            size -= 8;
+        }
+        while (size--) crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xFF];
+        return ~crc;
+    }
+};
+
+#if defined(__BYTE_ORDER__)
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "journal frames assume a little-endian host");
+#endif
+
+inline constexpr size_t JOURNAL_FRAME_HEADER = 9;
+inline constexpr uint32_t JOURNAL_MAX_RECORD = 256u << 20;
+inline constexpr char JOURNAL_SNAPSHOT_MAGIC[8] = {'T', 'L', 'M', 'S', 'N', 'A', 'P', '2'};
+inline constexpr char JOURNAL_SNAPSHOT_MAGIC_V1[8] = {'T', 'L', 'M', 'S', 'N', 'A', 'P', '1'};
+
+// Snapshot frame payloads, in the order recovery hands them back
+using JournalSnapshot = std::vector<std::string>;
+// Builds a snapshot; run by the flusher thread
+using JournalSnapshotBuilder = std::function<JournalSnapshot()>;
+
+inline void appendJournalFrame(std::string& out, uint8_t type, const char* data, size_t size) {
+    uint32_t length = static_cast<uint32_t>(size);
+    uint32_t crc = Crc32c::compute(data, size, Crc32c::compute(&type, 1));
+    char header[JOURNAL_FRAME_HEADER];
+    std::memcpy(header, &length, 4);
+    std::memcpy(header + 4, &crc, 4);
+    header[8] = static_cast<char>(type);
+    out.append(header, sizeof(header));
+    out.append(data, size);
+}
+
+// Length of the complete, valid frame at the start of [data, data + size),
+// or 0 if it is truncated or corrupt
+inline size_t parseJournalFrame(const char* data, size_t size, uint8_t& type, const char*& payload,
+                                size_t& payload_size) {
+    if (size < JOURNAL_FRAME_HEADER) return 0;
+    uint32_t length, crc;
+    std::memcpy(&length, data, 4);
+    std::memcpy(&crc, data + 4, 4);
+    if (length > JOURNAL_MAX_RECORD || size - JOURNAL_FRAME_HEADER < length) return 0;
+    type = static_cast<uint8_t>(data[8]);
+    payload = data + JOURNAL_FRAME_HEADER;
+    payload_size = length;
+    if (Crc32c::compute(payload, length, Crc32c::compute(&type, 1)) != crc) return 0;
+    return JOURNAL_FRAME_HEADER + length;
+}
+
+inline std::string journalFrameTooLarge(const char* what, size_t size) {
+    return std::string(what) + " of " + std::to_string(size) + " bytes exceeds the " +
+           std::to_string(JOURNAL_MAX_RECORD) + " byte frame limit";
+}
+
+struct JournalConfig {
+    std::string directory;
+    uint32_t sync_interval_ms = 50;            // group commit interval; bounds what a crash loses
+    uint64_t checkpoint_bytes = 256ull << 20;  // journal size that triggers a snapshot
+    uint32_t snapshot_frame_bytes = 4u << 20;  // callers split snapshots into frames of about this size
+};
+
+struct JournalRecovery {
+    bool had_snapshot = false;
+    uint64_t snapshot_generation = 0;
+    size_t journals = 0;          // files replayed
+    uint64_t records = 0;         // journal records replayed (the snapshot not included)
+    uint64_t bytes = 0;           // snapshot and journal bytes read
+    uint64_t torn_bytes = 0;      // discarded from the tail of the last journal
+    uint64_t next_generation = 1;
+    double elapsed_ms = 0.0;
+};
+
+inline std::string journalFilePath(const std::string& directory, uint64_t generation) {
+    char name[48];
+    std::snprintf(name, sizeof(name), "/journal-%016llx.wal", static_cast<unsigned long long>(generation));
+    return directory + name;
+}
+
+inline std::string journalSnapshotPath(const std::string& directory) {
+    return directory + "/snapshot.bin";
+}
+
+#if !defined(_WIN32)
+namespace journal_detail {
+
+inline bool writeAll(int fd, const char* data, size_t size, std::string& error) {
+    while (size > 0) {
+        ssize_t n = ::write(fd, data, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) { error = std::strerror(errno); return false; }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+inline bool readFile(const std::string& path, std::string& out, std::string& error) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) { error = path + ": " + std::strerror(errno); return false; }
+    struct stat info{};
+    if (::fstat(fd, &info) == 0) out.reserve(static_cast<size_t>(info.st_size));
+    char chunk[1 << 16];
+    for (;;) {
+        ssize_t n = ::read(fd, chunk, sizeof(chunk));
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) { error = path + ": " + std::strerror(errno); ::close(fd); return false; }
+        if (n == 0) break;
+        out.append(chunk, static_cast<size_t>(n));
+    }
+    ::close(fd);
+    return true;
+}
+
+inline void syncDirectory(const std::string& directory) {
+    int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd >= 0) {
+        ::fsync(fd);
+        ::close(fd);
+    }
+}
+
+// Journal generations present in `directory`, ascending
+inline std::vector<uint64_t> listJournals(const std::string& directory) {
+    std::vector<uint64_t> generations;
+    if (DIR* dir = ::opendir(directory.c_str())) {
+        while (dirent* entry = ::readdir(dir)) {
+            unsigned long long generation;
+            char tail[8] = {};
+            if (std::sscanf(entry->d_name, "journal-%16llx.%4s", &generation, tail) == 2 &&
+                std::strcmp(tail, "wal") == 0) {
+                generations.push_back(generation);
+            }
+        }
+        ::closedir(dir);
+    }
+    std::sort(generations.begin(), generations.end());
+    return generations;
+}
+
+inline bool writeSnapshot(const std::string& directory, uint64_t generation, const JournalSnapshot& frames,
+                          std::string& error) {
+    for (const std::string& payload : frames) {
+        if (payload.size() > JOURNAL_MAX_RECORD) {
+            error = journalFrameTooLarge("snapshot frame", payload.size());
+            return false;
+        }
+    }
+
+    const std::string path = journalSnapshotPath(directory);
+    const std::string temp = path + ".tmp";
+    int fd = ::open(temp.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0644);
+    if (fd < 0) { error = temp + ": " + std::strerror(errno); return false; }
+    std::string chunk(JOURNAL_SNAPSHOT_MAGIC, sizeof(JOURNAL_SNAPSHOT_MAGIC));
+    chunk.append(reinterpret_cast<const char*>(&generation), sizeof(generation));
+    bool ok = true;
+    for (const std::string& payload : frames) {
+        appendJournalFrame(chunk, 0, payload.data(), payload.size());
+        ok = ok && writeAll(fd, chunk.data(), chunk.size(), error);
+        chunk.clear();
+    }
+    ok = ok && writeAll(fd, chunk.data(), chunk.size(), error);
+    if (ok && ::fdatasync(fd) != 0) { error = std::strerror(errno); ok = false; }
+    ::close(fd);
+    if (ok && ::rename(temp.c_str(), path.c_str()) != 0) { error = std::strerror(errno); ok = false; }
+    if (!ok) {
+        ::unlink(temp.c_str());
+        return false;
+    }
+    syncDirectory(directory);
+    return true;
+}
+
+} // namespace journal_detail
+#endif
+
+// Loads the snapshot and replays the journals after it, oldest first:
+// on_snapshot(payload, size) per snapshot frame if a snapshot exists, then
+// on_record(type, payload, size) per record. A torn tail on the newest
+// journal is cut off; damage anywhere else is an error, since replaying past
+// it would skip records. Creates the directory if needed.
+template <typename SnapshotFn, typename RecordFn>
+bool recoverJournal(const std::string& directory, SnapshotFn&& on_snapshot, RecordFn&& on_record,
+                    JournalRecovery& recovery, std::string& error) {
+#if defined(_WIN32)
+    (void)directory; (void)on_snapshot; (void)on_record; (void)recovery;
+    error = "the journal is not supported on this platform";
+    return false;
+#else
+    using namespace journal_detail;
+    auto started = std::chrono::steady_clock::now();
+    recovery = JournalRecovery();
+    if (::mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST) {
+        error = directory + ": " + std::strerror(errno);
+        return false;
+    }
+
+    uint64_t first_generation = 0;
+    const std::string snapshot_path = journalSnapshotPath(directory);
+    if (::access(snapshot_path.c_str(), F_OK) == 0) {
+        std::string file;
+        if (!readFile(snapshot_path, file, error)) return false;
+        uint8_t type;
+        const char* payload;
+        size_t payload_size;
+        const size_t prefix = sizeof(JOURNAL_SNAPSHOT_MAGIC) + sizeof(uint64_t);
+        const bool v1 = file.size() >= prefix && std::memcmp(file.data(), JOURNAL_SNAPSHOT_MAGIC_V1, 8) == 0;
+        if (file.size() < prefix || (!v1 && std::memcmp(file.data(), JOURNAL_SNAPSHOT_MAGIC, 8) != 0)) {
+            error = snapshot_path + ": corrupt snapshot";
+            return false;
+        }
+        // Every frame is checked before any is applied: a damaged snapshot
+        // must not leave half of it behind
+        std::vector<std::pair<const char*, size_t>> frames;
+        size_t pos = prefix;
+        while (size_t frame = parseJournalFrame(file.data() + pos, file.size() - pos, type, payload, payload_size)) {
+            frames.emplace_back(payload, payload_size);
+            pos += frame;
+        }
+        if (pos < file.size() || frames.empty() || (v1 && frames.size() != 1)) {
+            error = snapshot_path + ": corrupt snapshot at offset " + std::to_string(pos);
+            return false;
+        }
+        std::memcpy(&first_generation, file.data() + 8, sizeof(first_generation));
+        for (const auto& frame : frames) on_snapshot(frame.first, frame.second);
+        recovery.had_snapshot = true;
+        recovery.snapshot_generation = first_generation;
+        recovery.bytes += file.size();
+    }
+
+    std::vector<uint64_t> generations = listJournals(directory);
+    uint64_t last_generation = first_generation;
+    for (size_t i = 0; i < generations.size(); ++i) {
+        const uint64_t generation = generations[i];
+        if (generation < first_generation) continue;   // covered by the snapshot
+        const std::string path = journalFilePath(directory, generation);
+        std::string file;
+        if (!readFile(path, file, error)) return false;
+
+        size_t pos = 0;
+        uint8_t type;
+        const char* payload;
+        size_t payload_size;
+        while (size_t frame = parseJournalFrame(file.data() + pos, file.size() - pos, type, payload, payload_size)) {
+            on_record(type, payload, payload_size);
+            recovery.records++;
+            pos += frame;
+        }
+        if (pos < file.size()) {
+            if (i + 1 < generations.size()) {
+                error = path + ": corrupt record at offset " + std::to_string(pos);
+                return false;
+            }
+            recovery.torn_bytes = file.size() - pos;
+            if (::truncate(path.c_str(), static_cast<off_t>(pos)) != 0) {
+                error = path + ": " + std::strerror(errno);
+                return false;
+            }
+        }
+        recovery.journals++;
+        recovery.bytes += file.size();
+        last_generation = generation;
+    }
+
+    recovery.next_generation = std::max(first_generation, last_generation) + 1;
+    recovery.elapsed_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - started).count();
+    return true;
+#endif
+}
+
+// Single producer (the engine appends under its own lock) plus the flusher
+// thread. Records appended before checkpoint() land in the old generation,
+// records after it in the new one.
+class JournalWriter {
+private:
+    JournalConfig config;
+    uint64_t generation = 0;   // file the flusher writes to
+    int fd = -1;
+
+    std::mutex buffer_mutex;   // pending, sealed, snapshot, stopping
+    std::condition_variable wake;
+    std::string pending;
+    std::string sealed;        // last records of the generation being closed
+    JournalSnapshotBuilder snapshot;
+    bool rotating = false;
+    bool stopping = false;
+
+    std::mutex io_mutex;       // the file descriptor and everything written through it
+    std::thread flusher;
+
+    uint64_t bytes_since_checkpoint = 0;   // producer only
+    std::atomic<uint64_t> appended{0};
+    std::atomic<uint64_t> synced_bytes{0};
+    std::atomic<uint64_t> syncs{0};
+    std::atomic<uint64_t> checkpoints{0};
+    std::atomic<bool> failed{false};
+    std::string error_text;    // io_mutex
+
+public:
+    JournalWriter() = default;
+    JournalWriter(const JournalWriter&) = delete;
+    JournalWriter& operator=(const JournalWriter&) = delete;
+    ~JournalWriter() { close(); }
+
+    // Starts `first_generation`. When `initial_snapshot` is non-empty it is
+    // written first, synchronously, and the journals it covers are deleted:
+    // the usual way to compact right after recovery.
+    bool open(const JournalConfig& cfg, uint64_t first_generation, const JournalSnapshot& initial_snapshot,
+              std::string& error) {
+#if defined(_WIN32)
+        (void)cfg; (void)first_generation; (void)initial_snapshot;
+        error = "the journal is not supported on this platform";
+        return false;
+#else
+        close();
+        config = cfg;
+        generation = first_generation;
+        if (::mkdir(config.directory.c_str(), 0755) != 0 && errno != EEXIST) {
+            error = config.directory + ": " + std::strerror(errno);
+            return false;
+        }
+        if (!initial_snapshot.empty()) {
+            if (!journal_detail::writeSnapshot(config.directory, generation, initial_snapshot, error)) return false;
+            removeJournalsBefore(generation);
+        }
+        if (!openGeneration(generation, error)) return false;
+
+        failed = false;
+        stopping = false;
+        rotating = false;
+        bytes_since_checkpoint = 0;
+        flusher = std::thread([this] { flushLoop(); });
+        return true;
+#endif
+    }
+
+    // Writes out everything appended so far, then stops the flusher
+    void close() {
+        if (flusher.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(buffer_mutex);
+                stopping = true;
+            }
+            wake.notify_all();
+            flusher.join();
+        }
+#if !defined(_WIN32)
+        if (fd >= 0) ::close(fd);
+#endif
+        fd = -1;
+    }
+
+    bool isOpen() const { return fd >= 0; }
+
+    // Buffers one record; no syscall. Dropped once the journal has failed.
+    // A record over JOURNAL_MAX_RECORD fails the journal here, since
+    // recovery could not read it back and would stop replaying at it.
+    void append(uint8_t type, const std::string& payload) {
+        if (failed.load(std::memory_order_relaxed)) return;
+        if (payload.size() > JOURNAL_MAX_RECORD) {
+            std::lock_guard<std::mutex> io(io_mutex);
+            error_text = journalFrameTooLarge("journal record", payload.size());
+            failed = true;
+            return;
+        }
+        std::lock_guard<std::mutex> lock(buffer_mutex);
+        const size_t before = pending.size();
+        appendJournalFrame(pending, type, payload.data(), payload.size());
+        bytes_since_checkpoint += pending.size() - before;
+        appended.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // True once enough has been appended that a checkpoint would pay off
+    bool checkpointDue() {
+        if (bytes_since_checkpoint < config.checkpoint_bytes) return false;
+        std::lock_guard<std::mutex> lock(buffer_mutex);
+        return !rotating;
+    }
+
+    // Seals the current generation behind the snapshot `build` returns,
+    // which must cover everything appended so far; it runs later on the
+    // flusher thread. Returns false if the previous checkpoint is still
+    // being written; try again later.
+    bool checkpoint(JournalSnapshotBuilder build) {
+        {
+            std::lock_guard<std::mutex> lock(buffer_mutex);
+            if (rotating || fd < 0) return false;
+            sealed.swap(pending);
+            pending.clear();
+            snapshot = std::move(build);
+            rotating = true;
+            bytes_since_checkpoint = 0;
+        }
+        wake.notify_all();
+        return true;
+    }
+
+    // Group commit now instead of at the next interval; true if everything
+    // appended before the call is durable
+    bool sync(std::string& error) {
+        if (!flushOnce()) {
+            std::lock_guard<std::mutex> lock(io_mutex);
+            error = error_text;
+            return false;
+        }
+        return true;
+    }
+
+    uint64_t recordsAppended() const { return appended.load(std::memory_order_relaxed); }
+    uint64_t bytesSynced() const { return synced_bytes.load(std::memory_order_relaxed); }
+    uint64_t syncCount() const { return syncs.load(std::memory_order_relaxed); }
+    uint64_t checkpointCount() const { return checkpoints.load(std::memory_order_relaxed); }
+    bool healthy() const { return !failed.load(std::memory_order_relaxed); }
+
+    std::string lastError() {
+        std::lock_guard<std::mutex> lock(io_mutex);
+        return error_text;
+    }
+
+private:
+    bool openGeneration(uint64_t gen, std::string& error) {
+#if defined(_WIN32)
+        (void)gen; (void)error;
+        return false;
+#else
+        const std::string path = journalFilePath(config.directory, gen);
+        int next = ::open(path.c_str(), O_CREAT | O_WRONLY | O_APPEND, 0644);
+        if (next < 0) { error = path + ": " + std::strerror(errno); return false; }
+        if (fd >= 0) ::close(fd);
+        fd = next;
+        journal_detail::syncDirectory(config.directory);
+        return true;
+#endif
+    }
+
+    void removeJournalsBefore(uint64_t gen) {
+#if !defined(_WIN32)
+        for (uint64_t old : journal_detail::listJournals(config.directory)) {
+            if (old < gen) ::unlink(journalFilePath(config.directory, old).c_str());
+        }
+#else
+        (void)gen;
+#endif
+    }
+
+    bool writeAndSync(const std::string& data, std::string& error) {
+#if defined(_WIN32)
+        (void)data; (void)error;
+        return false;
+#else
+        if (data.empty()) return true;
+        if (!journal_detail::writeAll(fd, data.data(), data.size(), error)) return false;
+        if (::fdatasync(fd) != 0) { error = std::strerror(errno); return false; }
+        synced_bytes.fetch_add(data.size(), std::memory_order_relaxed);
+        syncs.fetch_add(1, std::memory_order_relaxed);
+        return true;
+#endif
+    }
+
+    // One group commit, including a pending checkpoint. After a failure the
+    // journal stops writing: later records would not replay past the gap.
+    bool flushOnce() {
+        std::lock_guard<std::mutex> io(io_mutex);
+        if (failed.load(std::memory_order_relaxed)) return false;
+
+        std::string batch, closing;
+        JournalSnapshotBuilder build;
+        bool rotate;
+        {
+            std::lock_guard<std::mutex> lock(buffer_mutex);
+            batch.swap(pending);
+            rotate = rotating;
+            if (rotate) {
+                closing.swap(sealed);
+                build.swap(snapshot);
+            }
+        }
+
+        std::string error;
+        bool ok = true;
+        if (rotate) {
+            ok = writeAndSync(closing, error) && openGeneration(generation + 1, error);
+            if (ok) {
+                generation++;
+#if !defined(_WIN32)
+                ok = journal_detail::writeSnapshot(config.directory, generation, build(), error);
+#endif
+                if (ok) {
+                    removeJournalsBefore(generation);
+                    checkpoints.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            std::lock_guard<std::mutex> lock(buffer_mutex);
+            rotating = false;
+        }
+        if (ok) ok = writeAndSync(batch, error);
+        if (!ok) {
+            error_text = error;
+            failed = true;
+        }
+        return ok;
+    }
+
+    void flushLoop() {
+        for (;;) {
+            bool stop;
+            {
+                std::unique_lock<std::mutex> lock(buffer_mutex);
+                wake.wait_for(lock, std::chrono::milliseconds(config.sync_interval_ms),
+                              [this] { return stopping || (rotating && !failed.load(std::memory_order_relaxed)); });
+                stop = stopping;
+            }
+            flushOnce();
+            if (stop) return;
+        }
+    }
+};
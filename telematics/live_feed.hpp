@@ -0,0 +1,626 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "local_http.hpp"
+
+// ============================================================================
+// LIVE DASHBOARD FEED
+// ============================================================================
+//
+// Server-Sent Events stream for the web dashboard (GET /events on a loopback
+// port). A client first receives a `snapshot` event with the whole fleet and
+// the most recent anomalies, then one `delta` event per tick carrying only the
+// vehicles that changed and the anomalies raised since the previous tick.
+// Payloads use the field names of app/types/vehicle.ts.
+//
+// The engine only copies small structs into the FleetFeed under its own short
+// lock; serialisation and socket I/O happen on the feed thread. Every client
+// has a bounded send queue: a client that falls behind has its queue dropped
+// and is resynchronised with a fresh snapshot once its socket drains, so a
+// slow browser costs itself frames but never delays ingestion or other
+// clients.
+
+struct FeedReading {
+    double speed = 0.0;
+    double rpm = 0.0;
+    double temperature = 0.0;
+    double fuel_level = 0.0;
+    double throttle_position = 0.0;
+    bool engine_on = true;
+    double latitude = 0.0;
+    double longitude = 0.0;
+    double acceleration = 0.0;
+    double brake_pressure = 0.0;
+    double oil_pressure = 0.0;
+    double battery_voltage = 0.0;
+    int odometer = 0;
+    bool abs_active = false;
+    bool traction_control_active = false;
+};
+
+struct FeedVehicle {
+    int id = 0;
+    const char* state = "NORMAL";   // must point to a string literal
+    int64_t last_seen_ms = 0;
+    double total_distance = 0.0;
+    double avg_speed = 0.0;
+    double max_speed = 0.0;
+    int harsh_events = 0;
+    int total_anomalies = 0;
+    FeedReading reading;
+};
+
+struct FeedAnomaly {
+    int64_t timestamp_ms = 0;
+    int vehicle_id = 0;
+    std::string_view sensor_name;   // must outlive the feed (pooled record text)
+    double value = 0.0;
+    const char* type = "";          // must point to a string literal
+    std::string_view description;   // must outlive the feed (pooled record text)
+    int severity = 0;
+    const char* priority = "LOW";   // must point to a string literal
+    std::string_view location;      // must outlive the feed (pooled record text)
+    double ml_score = std::nan("");
+};
+
+struct FeedConfig {
+    size_t snapshot_anomalies = 100;
+    size_t max_pending_anomalies = 1000;        // per tick; the excess is counted and dropped
+};
+
+struct FeedServerConfig {
+    int64_t tick_ms = 250;                      // delta coalescing interval
+    int64_t heartbeat_ms = 15 * 1000;
+    size_t max_client_queue_bytes = 4 << 20;
+    size_t max_clients = 32;
+};
+
+// Minimal JSON text building for the feed payloads
+namespace feed_json {
+
+inline void appendString(std::string& out, std::string_view value) {
+    out += '"';
+    for (char ch : value) {
+        switch (ch) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(ch) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", ch);
+                    out += escaped;
+                } else {
+                    out += ch;
+                }
+        }
+    }
+    out += '"';
+}
+
+inline void appendNumber(std::string& out, double value) {
+    if (!std::isfinite(value)) { out += "null"; return; }
+    char buffer[32];
+    int n = std::snprintf(buffer, sizeof(buffer), "%.10g", value);
+    out.append(buffer, static_cast<size_t>(n));
+}
+
+inline void appendKey(std::string& out, const char* key) {
+    if (out.back() != '{') out += ',';
+    out += '"';
+    out += key;
+    out += "\":";
+}
+
+inline void appendIsoTime(std::string& out, int64_t epoch_ms) {
+    std::time_t seconds = static_cast<std::time_t>(epoch_ms / 1000);
+    struct tm utc;
+#if defined(_WIN32)
+    gmtime_s(&utc, &seconds);
+#else
+    gmtime_r(&seconds, &utc);
+#endif
+    char buffer[32];
+    int n = std::snprintf(buffer, sizeof(buffer), "\"%04d-%02d-%02dT%02d:%02d:%02d.%03dZ\"",
+                          utc.tm_year + 1900, utc.tm_mon + 1, utc.tm_mday,
+                          utc.tm_hour, utc.tm_min, utc.tm_sec, static_cast<int>(epoch_ms % 1000));
+    out.append(buffer, static_cast<size_t>(n));
+}
+
+} // namespace feed_json
+
+// Publisher side, shared between the engine and the feed thread
+class FleetFeed {
+private:
+    struct VehicleInfo {
+        std::string make_model;
+        std::string license_plate;
+    };
+    struct Entry {
+        FeedVehicle vehicle;
+        bool dirty = false;
+    };
+
+    FeedConfig config;
+    mutable std::mutex feed_mutex;
+    std::unordered_map<int, VehicleInfo> info;
+    std::unordered_map<int, Entry> latest;
+    std::vector<int> dirty_ids;
+    std::vector<FeedAnomaly> pending_anomalies;
+    std::vector<FeedAnomaly> recent_anomalies;   // ring of the last snapshot_anomalies
+    size_t recent_oldest = 0;                    // index of the oldest once the ring is full
+    uint64_t dropped_anomalies = 0;
+
+    std::atomic<uint64_t> total_readings{0};
+    std::atomic<uint64_t> total_anomalies{0};
+
+public:
+    explicit FleetFeed(const FeedConfig& cfg = FeedConfig()) : config(cfg) {}
+
+    void registerVehicle(int id, const std::string& make_model, const std::string& license_plate) {
+        std::lock_guard<std::mutex> lock(feed_mutex);
+        info[id] = {make_model, license_plate};
+    }
+
+    void publishVehicle(const FeedVehicle& vehicle) {
+        std::lock_guard<std::mutex> lock(feed_mutex);
+        Entry& entry = latest[vehicle.id];
+        entry.vehicle = vehicle;
+        if (!entry.dirty) {
+            entry.dirty = true;
+            dirty_ids.push_back(vehicle.id);
+        }
+    }
+
+    void publishAnomaly(FeedAnomaly anomaly) {
+        std::lock_guard<std::mutex> lock(feed_mutex);
+        if (pending_anomalies.size() < config.max_pending_anomalies) {
+            pending_anomalies.push_back(anomaly);
+        } else {
+            dropped_anomalies++;
+        }
+        if (recent_anomalies.size() < config.snapshot_anomalies) {
+            recent_anomalies.push_back(std::move(anomaly));
+        } else if (!recent_anomalies.empty()) {
+            recent_anomalies[recent_oldest] = std::move(anomaly);
+            recent_oldest = (recent_oldest + 1) % recent_anomalies.size();
+        }
+    }
+
+    void publishTotals(uint64_t readings, uint64_t anomalies) {
+        total_readings.store(readings, std::memory_order_relaxed);
+        total_anomalies.store(anomalies, std::memory_order_relaxed);
+    }
+
+    uint64_t totalReadings() const { return total_readings.load(std::memory_order_relaxed); }
+
+    uint64_t droppedAnomalies() const {
+        std::lock_guard<std::mutex> lock(feed_mutex);
+        return dropped_anomalies;
+    }
+
+    // Builds the delta since the previous call and resets the change set.
+    // Returns an empty string when nothing changed.
+    std::string takeDeltaJson(uint64_t seq, double readings_per_second) {
+        std::vector<FeedVehicle> vehicles;
+        std::vector<FeedAnomaly> anomalies;
+        {
+            std::lock_guard<std::mutex> lock(feed_mutex);
+            vehicles.reserve(dirty_ids.size());
+            for (int id : dirty_ids) {
+                Entry& entry = latest[id];
+                entry.dirty = false;
+                vehicles.push_back(entry.vehicle);
+            }
+            dirty_ids.clear();
+            anomalies.swap(pending_anomalies);
+        }
+        if (vehicles.empty() && anomalies.empty()) return std::string();
+
+        std::string json;
+        json.reserve(256 + vehicles.size() * 420 + anomalies.size() * 260);
+        json += "{\"seq\":";
+        json += std::to_string(seq);
+        json += ",\"vehicles\":[";
+        for (size_t i = 0; i < vehicles.size(); ++i) {
+            if (i) json += ',';
+            appendVehicle(json, vehicles[i], nullptr);
+        }
+        json += "],\"anomalies\":[";
+        for (size_t i = 0; i < anomalies.size(); ++i) {
+            if (i) json += ',';
+            appendAnomaly(json, anomalies[i]);
+        }
+        json += "],";
+        appendStats(json, readings_per_second);
+        json += '}';
+        return json;
+    }
+
+    std::string snapshotJson(uint64_t seq, double readings_per_second) const {
+        std::vector<std::pair<FeedVehicle, VehicleInfo>> vehicles;
+        std::vector<FeedAnomaly> anomalies;
+        {
+            std::lock_guard<std::mutex> lock(feed_mutex);
+            for (const auto& pair : info) {
+                FeedVehicle vehicle;
+                vehicle.id = pair.first;
+                auto it = latest.find(pair.first);
+                if (it != latest.end()) vehicle = it->second.vehicle;
+                vehicles.emplace_back(vehicle, pair.second);
+            }
+            anomalies.assign(recent_anomalies.begin() + recent_oldest, recent_anomalies.end());
+            anomalies.insert(anomalies.end(), recent_anomalies.begin(), recent_anomalies.begin() + recent_oldest);
+        }
+        std::sort(vehicles.begin(), vehicles.end(),
+                  [](const auto& a, const auto& b) { return a.first.id < b.first.id; });
+
+        std::string json;
+        json.reserve(256 + vehicles.size() * 480 + anomalies.size() * 260);
+        json += "{\"seq\":";
+        json += std::to_string(seq);
+        json += ",\"vehicles\":[";
+        for (size_t i = 0; i < vehicles.size(); ++i) {
+            if (i) json += ',';
+            appendVehicle(json, vehicles[i].first, &vehicles[i].second);
+        }
+        json += "],\"anomalies\":[";
+        for (size_t i = 0; i < anomalies.size(); ++i) {
+            if (i) json += ',';
+            appendAnomaly(json, anomalies[i]);
+        }
+        json += "],";
+        appendStats(json, readings_per_second);
+        json += '}';
+        return json;
+    }
+
+private:
+    // Deltas omit the static identity fields (makeModel, licensePlate)
+    static void appendVehicle(std::string& json, const FeedVehicle& v, const VehicleInfo* identity) {
+        using namespace feed_json;
+        json += '{';
+        appendKey(json, "id"); appendNumber(json, v.id);
+        if (identity) {
+            appendKey(json, "makeModel"); appendString(json, identity->make_model);
+            appendKey(json, "licensePlate"); appendString(json, identity->license_plate);
+        }
+        appendKey(json, "state"); json += '"'; json += v.state; json += '"';
+        appendKey(json, "lastSeen"); appendIsoTime(json, v.last_seen_ms);
+        appendKey(json, "totalDistance"); appendNumber(json, v.total_distance);
+        appendKey(json, "avgSpeed"); appendNumber(json, v.avg_speed);
+        appendKey(json, "maxSpeed"); appendNumber(json, v.max_speed);
+        appendKey(json, "harshEvents"); appendNumber(json, v.harsh_events);
+        appendKey(json, "totalAnomalies"); appendNumber(json, v.total_anomalies);
+
+        const FeedReading& r = v.reading;
+        appendKey(json, "currentReading");
+        json += '{';
+        appendKey(json, "speed"); appendNumber(json, r.speed);
+        appendKey(json, "rpm"); appendNumber(json, r.rpm);
+        appendKey(json, "temperature"); appendNumber(json, r.temperature);
+        appendKey(json, "fuelLevel"); appendNumber(json, r.fuel_level);
+        appendKey(json, "throttlePosition"); appendNumber(json, r.throttle_position);
+        appendKey(json, "engineOn"); json += r.engine_on ? "true" : "false";
+        appendKey(json, "latitude"); appendNumber(json, r.latitude);
+        appendKey(json, "longitude"); appendNumber(json, r.longitude);
+        appendKey(json, "acceleration"); appendNumber(json, r.acceleration);
+        appendKey(json, "brakePressure"); appendNumber(json, r.brake_pressure);
+        appendKey(json, "oilPressure"); appendNumber(json, r.oil_pressure);
+        appendKey(json, "batteryVoltage"); appendNumber(json, r.battery_voltage);
+        appendKey(json, "odometer"); appendNumber(json, r.odometer);
+        appendKey(json, "absActive"); json += r.abs_active ? "true" : "false";
+        appendKey(json, "tractionControlActive"); json += r.traction_control_active ? "true" : "false";
+        json += "}}";
+    }
+
+    static void appendAnomaly(std::string& json, const FeedAnomaly& a) {
+        using namespace feed_json;
+        json += '{';
+        appendKey(json, "timestamp"); appendIsoTime(json, a.timestamp_ms);
+        appendKey(json, "vehicleId"); appendNumber(json, a.vehicle_id);
+        appendKey(json, "sensorName"); appendString(json, a.sensor_name);
+        appendKey(json, "value"); appendNumber(json, a.value);
+        appendKey(json, "type"); json += '"'; json += a.type; json += '"';
+        appendKey(json, "description"); appendString(json, a.description);
+        appendKey(json, "severity"); appendNumber(json, a.severity);
+        appendKey(json, "priority"); json += '"'; json += a.priority; json += '"';
+        appendKey(json, "acknowledged"); json += "false";
+        if (!a.location.empty()) { appendKey(json, "location"); appendString(json, a.location); }
+        if (std::isfinite(a.ml_score)) { appendKey(json, "mlScore"); appendNumber(json, a.ml_score); }
+        json += '}';
+    }
+
+    void appendStats(std::string& json, double readings_per_second) const {
+        using namespace feed_json;
+        json += "\"stats\":{";
+        appendKey(json, "totalReadings"); appendNumber(json, static_cast<double>(total_readings.load(std::memory_order_relaxed)));
+        appendKey(json, "totalAnomalies"); appendNumber(json, static_cast<double>(total_anomalies.load(std::memory_order_relaxed)));
+        appendKey(json, "readingsPerSecond"); appendNumber(json, std::round(readings_per_second * 10.0) / 10.0);
+        json += '}';
+    }
+};
+
+struct FeedServerCounters {
+    std::atomic<uint64_t> clients{0};
+    std::atomic<uint64_t> snapshots_sent{0};
+    std::atomic<uint64_t> deltas_sent{0};
+    std::atomic<uint64_t> resyncs{0};       // queue overflowed, client resynchronised
+};
+
+// Serves the feed to any number of EventSource clients from one thread
+class LiveFeedServer {
+private:
+    using Message = std::shared_ptr<const std::string>;
+
+    struct Client {
+        enum class Phase { REQUEST, STREAMING, CLOSING, CLOSED };
+        int fd = -1;
+        Phase phase = Phase::REQUEST;
+        std::string request;
+        std::deque<Message> queue;
+        size_t offset = 0;          // bytes of queue.front() already sent
+        size_t queued_bytes = 0;
+        bool needs_snapshot = true;
+        bool subscribed = false;
+        int64_t last_enqueue_ms = 0;
+    };
+
+    FleetFeed& feed;
+    FeedServerConfig config;
+    std::thread server_thread;
+    std::atomic<bool> running{false};
+    int listen_fd = -1;
+    int bound_port = 0;
+    std::vector<Client> clients;
+    uint64_t seq = 0;
+    FeedServerCounters counters;
+
+public:
+    explicit LiveFeedServer(FleetFeed& f, const FeedServerConfig& cfg = FeedServerConfig())
+        : feed(f), config(cfg) {}
+    ~LiveFeedServer() { stop(); }
+
+    bool start(int port, std::string& error) {
+        listen_fd = openLoopbackListener(port, bound_port, error);
+        if (listen_fd < 0) return false;
+        setNonBlocking(listen_fd);
+        running = true;
+        server_thread = std::thread([this] { serve(); });
+        return true;
+    }
+
+    void stop() {
+        if (!running.exchange(false)) return;
+        if (server_thread.joinable()) server_thread.join();
+        for (auto& client : clients) closeSocket(client.fd);
+        clients.clear();
+        closeSocket(listen_fd);
+        listen_fd = -1;
+    }
+
+    int port() const { return bound_port; }
+    const FeedServerCounters& getCounters() const { return counters; }
+
+private:
+    static int64_t steadyMillis() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void serve() {
+#if !defined(_WIN32)
+        int64_t next_tick = steadyMillis() + config.tick_ms;
+        int64_t last_tick = steadyMillis();
+        uint64_t last_readings = feed.totalReadings();
+        std::vector<pollfd> fds;
+
+        while (running) {
+            fds.clear();
+            fds.push_back({listen_fd, POLLIN, 0});
+            for (const auto& client : clients) {
+                short events = POLLIN;
+                if (!client.queue.empty()) events |= POLLOUT;
+                fds.push_back({client.fd, events, 0});
+            }
+
+            int64_t wait = std::max<int64_t>(0, std::min<int64_t>(next_tick - steadyMillis(), 200));
+            int ready = ::poll(fds.data(), fds.size(), static_cast<int>(wait));
+
+            if (ready > 0) {
+                if (fds[0].revents & POLLIN) acceptClients();
+                // fds[i + 1] belongs to clients[i]; accepted clients are appended after
+                for (size_t i = 0; i + 1 < fds.size(); ++i) {
+                    Client& client = clients[i];
+                    short revents = fds[i + 1].revents;
+                    if (revents & (POLLERR | POLLNVAL)) { client.phase = Client::Phase::CLOSED; continue; }
+                    if (revents & (POLLIN | POLLHUP)) readClient(client);
+                    if ((revents & POLLOUT) && client.phase != Client::Phase::CLOSED) flush(client);
+                }
+            }
+
+            int64_t now = steadyMillis();
+            if (now >= next_tick) {
+                uint64_t readings = feed.totalReadings();
+                double elapsed_s = std::max<int64_t>(1, now - last_tick) / 1000.0;
+                tick(now, (readings - last_readings) / elapsed_s);
+                last_readings = readings;
+                last_tick = now;
+                next_tick = now + config.tick_ms;
+            }
+
+            clients.erase(std::remove_if(clients.begin(), clients.end(), [this](const Client& c) {
+                if (c.phase != Client::Phase::CLOSED) return false;
+                closeSocket(c.fd);
+                if (c.subscribed) counters.clients--;
+                return true;
+            }), clients.end());
+        }
+#endif
+    }
+
+    void acceptClients() {
+#if !defined(_WIN32)
+        while (true) {
+            int fd = ::accept(listen_fd, nullptr, nullptr);
+            if (fd < 0) return;
+            if (clients.size() >= config.max_clients) {
+                std::string body = "too many feed clients\n";
+                sendAll(fd, httpResponseHead("503 Service Unavailable", "text/plain",
+                                             static_cast<long long>(body.size())) + body);
+                ::close(fd);
+                continue;
+            }
+            setNonBlocking(fd);
+            Client client;
+            client.fd = fd;
+            clients.push_back(std::move(client));
+        }
+#endif
+    }
+
+    void readClient(Client& client) {
+#if !defined(_WIN32)
+        char buffer[2048];
+        while (true) {
+            ssize_t n = ::recv(client.fd, buffer, sizeof(buffer), 0);
+            if (n == 0) { client.phase = Client::Phase::CLOSED; return; }
+            if (n < 0) {
+                if (errno != EAGAIN && errno != EWOULDBLOCK) client.phase = Client::Phase::CLOSED;
+                return;
+            }
+            if (client.phase != Client::Phase::REQUEST) continue;  // ignore anything after the request
+
+            client.request.append(buffer, static_cast<size_t>(n));
+            if (client.request.size() > 8192) { client.phase = Client::Phase::CLOSED; return; }
+            if (requestHeadComplete(client.request)) startResponse(client);
+        }
+#else
+        (void)client;
+#endif
+    }
+
+    void startResponse(Client& client) {
+        HttpRequestLine line;
+        bool parsed = parseRequestLine(client.request, line);
+        client.request.clear();
+
+        if (parsed && line.method == "GET" && line.path == "/events") {
+            // CORS so the dashboard dev server on another port can subscribe
+            std::string head = httpResponseHead("200 OK", "text/event-stream", -1,
+                "Cache-Control: no-cache\r\nAccess-Control-Allow-Origin: *\r\n");
+            client.phase = Client::Phase::STREAMING;
+            client.needs_snapshot = true;
+            client.subscribed = true;
+            counters.clients++;
+            enqueue(client, std::make_shared<const std::string>(head + "retry: 2000\n\n"));
+        } else {
+            std::string body = "subscribe to /events\n";
+            client.phase = Client::Phase::CLOSING;
+            enqueue(client, std::make_shared<const std::string>(
+                httpResponseHead("404 Not Found", "text/plain", static_cast<long long>(body.size())) + body));
+        }
+        flush(client);
+    }
+
+    void tick(int64_t now, double readings_per_second) {
+        ++seq;
+        // Always consume the change set, even with no subscribers
+        std::string delta = feed.takeDeltaJson(seq, readings_per_second);
+        Message delta_event;
+        if (!delta.empty()) delta_event = std::make_shared<const std::string>(sseEvent("delta", delta));
+        Message snapshot_event;
+        Message heartbeat;
+
+        for (auto& client : clients) {
+            if (client.phase != Client::Phase::STREAMING) continue;
+            if (client.needs_snapshot) {
+                // Resynchronise only once the socket has drained
+                if (!client.queue.empty()) continue;
+                if (!snapshot_event) {
+                    snapshot_event = std::make_shared<const std::string>(
+                        sseEvent("snapshot", feed.snapshotJson(seq, readings_per_second)));
+                }
+                client.needs_snapshot = false;
+                enqueue(client, snapshot_event);
+                counters.snapshots_sent++;
+            } else if (delta_event) {
+                enqueue(client, delta_event);
+                if (!client.needs_snapshot) counters.deltas_sent++;
+            } else if (now - client.last_enqueue_ms >= config.heartbeat_ms) {
+                if (!heartbeat) heartbeat = std::make_shared<const std::string>(": ping\n\n");
+                enqueue(client, heartbeat);
+            }
+            flush(client);
+        }
+    }
+
+    std::string sseEvent(const char* name, const std::string& data) const {
+        std::string event;
+        event.reserve(data.size() + 48);
+        event += "event: ";
+        event += name;
+        event += "\nid: ";
+        event += std::to_string(seq);
+        event += "\ndata: ";
+        event += data;
+        event += "\n\n";
+        return event;
+    }
+
+    // Bounded per-client queue: on overflow everything not yet started is
+    // dropped and the client is marked for a fresh snapshot
+    void enqueue(Client& client, const Message& message) {
+        if (client.queued_bytes + message->size() > config.max_client_queue_bytes &&
+            !client.queue.empty()) {
+            while (client.queue.size() > (client.offset > 0 ? 1u : 0u)) {
+                client.queued_bytes -= client.queue.back()->size();
+                client.queue.pop_back();
+            }
+            client.needs_snapshot = true;
+            counters.resyncs++;
+            return;
+        }
+        client.queue.push_back(message);
+        client.queued_bytes += message->size();
+        client.last_enqueue_ms = steadyMillis();
+    }
+
+    void flush(Client& client) {
+#if !defined(_WIN32)
+        while (!client.queue.empty()) {
+            const std::string& front = *client.queue.front();
+            ssize_t n = ::send(client.fd, front.data() + client.offset, front.size() - client.offset, MSG_NOSIGNAL);
+            if (n < 0) {
+                if (errno != EAGAIN && errno != EWOULDBLOCK) client.phase = Client::Phase::CLOSED;
+                return;
+            }
+            client.offset += static_cast<size_t>(n);
+            if (client.offset < front.size()) return;
+            client.queued_bytes -= front.size();
+            client.queue.pop_front();
+            client.offset = 0;
+        }
+        if (client.phase == Client::Phase::CLOSING) client.phase = Client::Phase::CLOSED;
+#else
+        (void)client;
+#endif
+    }
+};
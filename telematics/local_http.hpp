@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#if !defined(_WIN32)
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+// ============================================================================
+// LOOPBACK HTTP HELPERS
+// ============================================================================
+//
+// Just enough HTTP/1.x for the embedded endpoints (metrics, live feed): a
+// listening socket on 127.0.0.1, request-line parsing and response heads.
+// Nothing is exposed beyond the local machine.
+
+#if defined(_WIN32)
+inline constexpr bool LOCAL_HTTP_SUPPORTED = false;
+#else
+inline constexpr bool LOCAL_HTTP_SUPPORTED = true;
+#endif
+
+struct HttpRequestLine {
+    std::string method;
+    std::string path;   // without the query string
+};
+
+// Returns the listening descriptor or -1 with `error` set. Port 0 picks a
+// free port; the chosen one is stored in bound_port.
+inline int openLoopbackListener(int port, int& bound_port, std::string& error) {
+#if defined(_WIN32)
+    (void)port;
+    (void)bound_port;
+    error = "local HTTP endpoints are not supported on this platform";
+    return -1;
+#else
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) { error = std::strerror(errno); return -1; }
+    int reuse = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || ::listen(fd, 16) < 0) {
+        error = std::strerror(errno);
+        ::close(fd);
+        return -1;
+    }
+    socklen_t len = sizeof(addr);
+    ::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len);
+    bound_port = ntohs(addr.sin_port);
+    return fd;
+#endif
+}
+
+inline void closeSocket(int fd) {
+#if !defined(_WIN32)
+    if (fd >= 0) ::close(fd);
+#else
+    (void)fd;
+#endif
+}
+
+inline bool setNonBlocking(int fd) {
+#if defined(_WIN32)
+    (void)fd;
+    return false;
+#else
+    int flags = ::fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+}
+
+// True once `buffer` holds a complete request head
+inline bool requestHeadComplete(const std::string& buffer) {
+    return buffer.find("\r\n\r\n") != std::string::npos || buffer.find("\n\n") != std::string::npos;
+}
+
+inline bool parseRequestLine(const std::string& head, HttpRequestLine& out) {
+    size_t method_end = head.find(' ');
+    if (method_end == std::string::npos) return false;
+    size_t path_end = head.find_first_of(" ?\r\n", method_end + 1);
+    if (path_end == std::string::npos) return false;
+    out.method = head.substr(0, method_end);
+    out.path = head.substr(method_end + 1, path_end - method_end - 1);
+    return true;
+}
+
+// content_length < 0 leaves the body open-ended (streaming responses)
+inline std::string httpResponseHead(const std::string& status, const std::string& content_type,
+                                    long long content_length, const std::string& extra_headers = "") {
+    std::string head = "HTTP/1.1 " + status + "\r\nContent-Type: " + content_type + "\r\n";
+    if (content_length >= 0) head += "Content-Length: " + std::to_string(content_length) + "\r\n";
+    head += extra_headers;
+    head += "Connection: close\r\n\r\n";
+    return head;
+}
+
+// Blocking send of the whole buffer; false if the peer went away
+inline bool sendAll(int fd, const std::string& data) {
+#if defined(_WIN32)
+    (void)fd;
+    (void)data;
+    return false;
+#else
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+#endif
+}
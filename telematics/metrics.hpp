@@ -0,0 +1,343 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "local_http.hpp"
+
+// ============================================================================
+// OPERATIONAL METRICS
+// ============================================================================
+//
+// Counters, gauges and histograms in the Prometheus text exposition format.
+// Every thread that records gets its own shard of relaxed atomic slots, so the
+// hot path is a plain load/store on a cache line nobody else writes; a scrape
+// walks the shards and sums them. Shards outlive their threads, so counts
+// recorded by a thread that has exited are kept. Nothing here touches the
+// application's locks.
+
+enum class MetricType { COUNTER, GAUGE, HISTOGRAM };
+
+class MetricsRegistry;
+
+// Fixed-size block of slots written by exactly one thread
+struct alignas(64) MetricsShard {
+    static constexpr size_t MAX_SLOTS = 1024;
+    std::array<std::atomic<uint64_t>, MAX_SLOTS> slots;
+
+    MetricsShard() {
+        for (auto& slot : slots) slot.store(0, std::memory_order_relaxed);
+    }
+
+    // Single writer: no read-modify-write instruction needed
+    void add(size_t slot, uint64_t delta) {
+        auto& s = slots[slot];
+        s.store(s.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+};
+
+class MetricsRegistry {
+public:
+    struct Family {
+        std::string name;
+        std::string help;
+        MetricType type;
+    };
+
+    struct Series {
+        size_t family;
+        std::string labels;              // preformatted, e.g. stage="history"
+        size_t slot;                     // first shard slot
+        size_t bucket_count = 0;         // histograms: upper bounds below
+        std::vector<double> bounds;
+        std::atomic<uint64_t>* set_value = nullptr;  // gauges set()
+    };
+
+private:
+    mutable std::mutex registry_mutex;   // registration and shard creation only
+    std::vector<Family> families;
+    std::vector<std::unique_ptr<Series>> series;
+    std::vector<std::unique_ptr<std::atomic<uint64_t>>> set_values;
+    std::vector<std::unique_ptr<MetricsShard>> shards;
+    size_t next_slot = 0;
+
+    static inline std::atomic<uint64_t> next_registry_id{0};
+    const uint64_t registry_id = ++next_registry_id;
+
+public:
+    MetricsRegistry() = default;
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    // Returns the calling thread's shard, creating it on first use
+    MetricsShard& localShard() {
+        struct Cache { uint64_t registry = 0; MetricsShard* shard = nullptr; };
+        thread_local Cache last;
+        thread_local std::vector<Cache> known;
+        if (last.registry == registry_id) return *last.shard;
+
+        for (const auto& entry : known) {
+            if (entry.registry == registry_id) { last = entry; return *last.shard; }
+        }
+        {
+            std::lock_guard<std::mutex> lock(registry_mutex);
+            shards.push_back(std::make_unique<MetricsShard>());
+            last = {registry_id, shards.back().get()};
+        }
+        known.push_back(last);
+        return *last.shard;
+    }
+
+    const Series* add(const std::string& name, const std::string& help, MetricType type,
+                      const std::string& labels, const std::vector<double>& bounds = {}) {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        size_t family = families.size();
+        for (size_t i = 0; i < families.size(); ++i) {
+            if (families[i].name == name) family = i;
+        }
+        if (family == families.size()) families.push_back({name, help, type});
+
+        auto s = std::make_unique<Series>();
+        s->family = family;
+        s->labels = labels;
+        s->slot = next_slot;
+        if (type == MetricType::HISTOGRAM) {
+            s->bounds = bounds;
+            s->bucket_count = bounds.size() + 1;   // + Inf
+            next_slot += s->bucket_count + 1;      // buckets, sum
+        } else {
+            next_slot += 1;
+        }
+        if (next_slot > MetricsShard::MAX_SLOTS) return nullptr;
+        if (type == MetricType::GAUGE) {
+            set_values.push_back(std::make_unique<std::atomic<uint64_t>>(0));
+            s->set_value = set_values.back().get();
+        }
+        series.push_back(std::move(s));
+        return series.back().get();
+    }
+
+    // Text exposition format 0.0.4
+    std::string render() const {
+        std::vector<const MetricsShard*> snapshot;
+        std::vector<const Series*> all;
+        std::vector<Family> family_list;
+        {
+            std::lock_guard<std::mutex> lock(registry_mutex);
+            for (const auto& shard : shards) snapshot.push_back(shard.get());
+            for (const auto& s : series) all.push_back(s.get());
+            family_list = families;
+        }
+
+        auto sum = [&snapshot](size_t slot) {
+            uint64_t total = 0;
+            for (const auto* shard : snapshot) total += shard->slots[slot].load(std::memory_order_relaxed);
+            return total;
+        };
+        auto labelled = [](const std::string& labels, const std::string& extra) {
+            std::string joined = labels;
+            if (!extra.empty()) joined += (joined.empty() ? "" : ",") + extra;
+            return joined.empty() ? std::string() : "{" + joined + "}";
+        };
+
+        std::ostringstream out;
+        out.precision(9);
+        for (size_t f = 0; f < family_list.size(); ++f) {
+            const Family& family = family_list[f];
+            out << "# HELP " << family.name << " " << family.help << "\n";
+            out << "# TYPE " << family.name << " "
+                << (family.type == MetricType::COUNTER ? "counter"
+                    : family.type == MetricType::GAUGE ? "gauge" : "histogram") << "\n";
+
+            for (const Series* s : all) {
+                if (s->family != f) continue;
+                if (family.type == MetricType::COUNTER) {
+                    out << family.name << labelled(s->labels, "") << " " << sum(s->slot) << "\n";
+                } else if (family.type == MetricType::GAUGE) {
+                    // set() value plus the per-thread add() deltas
+                    double value;
+                    uint64_t bits = s->set_value->load(std::memory_order_relaxed);
+                    std::memcpy(&value, &bits, sizeof(value));
+                    value += static_cast<double>(static_cast<int64_t>(sum(s->slot)));
+                    out << family.name << labelled(s->labels, "") << " " << value << "\n";
+                } else {
+                    uint64_t cumulative = 0;
+                    for (size_t b = 0; b < s->bucket_count; ++b) {
+                        cumulative += sum(s->slot + b);
+                        std::ostringstream le;
+                        le.precision(9);
+                        if (b < s->bounds.size()) le << s->bounds[b];
+                        else le << "+Inf";
+                        out << family.name << "_bucket" << labelled(s->labels, "le=\"" + le.str() + "\"")
+                            << " " << cumulative << "\n";
+                    }
+                    out << family.name << "_sum" << labelled(s->labels, "") << " "
+                        << sum(s->slot + s->bucket_count) / 1e9 << "\n";
+                    out << family.name << "_count" << labelled(s->labels, "") << " " << cumulative << "\n";
+                }
+            }
+        }
+        return out.str();
+    }
+};
+
+class Counter {
+private:
+    MetricsRegistry* registry = nullptr;
+    const MetricsRegistry::Series* series = nullptr;
+
+public:
+    Counter() = default;
+    Counter(MetricsRegistry& r, const std::string& name, const std::string& help, const std::string& labels = "")
+        : registry(&r), series(r.add(name, help, MetricType::COUNTER, labels)) {}
+
+    void inc(uint64_t delta = 1) const {
+        if (series) registry->localShard().add(series->slot, delta);
+    }
+};
+
+class Gauge {
+private:
+    MetricsRegistry* registry = nullptr;
+    const MetricsRegistry::Series* series = nullptr;
+
+public:
+    Gauge() = default;
+    Gauge(MetricsRegistry& r, const std::string& name, const std::string& help, const std::string& labels = "")
+        : registry(&r), series(r.add(name, help, MetricType::GAUGE, labels)) {}
+
+    // Use either set() (one writer) or add() (any thread) for a given gauge
+    void set(double value) const {
+        if (!series) return;
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        series->set_value->store(bits, std::memory_order_relaxed);
+    }
+
+    void add(int64_t delta) const {
+        if (series) registry->localShard().add(series->slot, static_cast<uint64_t>(delta));
+    }
+};
+
+// Durations in nanoseconds; bucket bounds are in seconds
+class Histogram {
+private:
+    MetricsRegistry* registry = nullptr;
+    const MetricsRegistry::Series* series = nullptr;
+    std::vector<uint64_t> bounds_ns;
+
+public:
+    Histogram() = default;
+    Histogram(MetricsRegistry& r, const std::string& name, const std::string& help,
+              const std::string& labels, const std::vector<double>& bounds_seconds)
+        : registry(&r), series(r.add(name, help, MetricType::HISTOGRAM, labels, bounds_seconds)) {
+        for (double bound : bounds_seconds) bounds_ns.push_back(static_cast<uint64_t>(bound * 1e9));
+    }
+
+    void observeNanos(uint64_t nanos) const {
+        if (!series) return;
+        // Buckets are "less than or equal"; the last one is +Inf
+        size_t bucket = std::lower_bound(bounds_ns.begin(), bounds_ns.end(), nanos) - bounds_ns.begin();
+        MetricsShard& shard = registry->localShard();
+        shard.add(series->slot + bucket, 1);
+        shard.add(series->slot + series->bucket_count, nanos);
+    }
+
+    static std::vector<double> latencyBuckets() {
+        return {1e-6, 2.5e-6, 5e-6, 1e-5, 2.5e-5, 5e-5, 1e-4, 2.5e-4, 5e-4, 1e-3, 2.5e-3, 5e-3, 1e-2, 1e-1};
+    }
+};
+
+// Minimal HTTP server answering GET /metrics on a loopback port
+class MetricsHttpServer {
+private:
+    const MetricsRegistry& registry;
+    std::thread server_thread;
+    std::atomic<bool> running{false};
+    int listen_fd = -1;
+    int bound_port = 0;
+    Counter scrapes;
+
+public:
+    explicit MetricsHttpServer(MetricsRegistry& r)
+        : registry(r), scrapes(r, "telematics_metrics_scrapes_total", "Number of /metrics requests served") {}
+
+    ~MetricsHttpServer() { stop(); }
+
+    // Binds 127.0.0.1:port (0 picks a free port). Returns false on failure.
+    bool start(int port, std::string& error) {
+        listen_fd = openLoopbackListener(port, bound_port, error);
+        if (listen_fd < 0) return false;
+        running = true;
+        server_thread = std::thread([this] { serve(); });
+        return true;
+    }
+
+    void stop() {
+        if (!running.exchange(false)) return;
+        if (server_thread.joinable()) server_thread.join();
+        closeSocket(listen_fd);
+        listen_fd = -1;
+    }
+
+    int port() const { return bound_port; }
+
+private:
+    void serve() {
+#if !defined(_WIN32)
+        while (running) {
+            pollfd pfd{listen_fd, POLLIN, 0};
+            if (::poll(&pfd, 1, 200) <= 0) continue;
+            int client = ::accept(listen_fd, nullptr, nullptr);
+            if (client < 0) continue;
+            handle(client);
+            ::close(client);
+        }
+#endif
+    }
+
+    void handle(int client) {
+#if !defined(_WIN32)
+        // Read the request head, giving slow clients a bounded wait
+        std::string request;
+        char buffer[1024];
+        while (!requestHeadComplete(request) && request.size() < 8192) {
+            pollfd pfd{client, POLLIN, 0};
+            if (::poll(&pfd, 1, 1000) <= 0) return;
+            ssize_t n = ::recv(client, buffer, sizeof(buffer), 0);
+            if (n <= 0) break;
+            request.append(buffer, static_cast<size_t>(n));
+        }
+
+        HttpRequestLine line;
+        parseRequestLine(request, line);
+        std::string status = "200 OK";
+        std::string type = "text/plain; version=0.0.4; charset=utf-8";
+        std::string body;
+        if (line.method == "GET" && line.path == "/metrics") {
+            scrapes.inc();
+            body = registry.render();
+        } else if (line.method == "GET") {
+            status = "404 Not Found";
+            type = "text/plain";
+            body = "try /metrics\n";
+        } else {
+            status = "405 Method Not Allowed";
+            type = "text/plain";
+            body = "only GET is supported\n";
+        }
+        sendAll(client, httpResponseHead(status, type, static_cast<long long>(body.size())) + body);
+#else
+        (void)client;
+#endif
+    }
+};
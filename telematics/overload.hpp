@@ -0,0 +1,161 @@
+#pragma once
+
+#include "metrics.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// ============================================================================
+// OVERLOAD PROTECTION
+// ============================================================================
+//
+// Ingest callers queue on the engine lock, so past capacity their latency
+// grows without bound. The OverloadController watches what each ingest call
+// costs its caller (time waiting for the lock plus time holding it) and how
+// many callers are waiting. It steps through degraded modes, each adding to
+// the ones below:
+//
+//   SKIP_ML           no ML or fleet-pattern scoring, no model training
+//   SAMPLE_LOGS       one raw CSV row in log_sample_every readings of a
+//                     vehicle
+//   COARSE_ANALYTICS  trends and forecasts updated every analytics_every-th
+//                     reading of a vehicle
+//   SHED_DUPLICATES   a reading that repeats its vehicle's previous state
+//                     skips the pipeline after the safety rules
+//
+// The safety-critical threshold rules (engine temperature, oil pressure,
+// harsh acceleration and braking) run in every mode.
+//
+// Every evaluate_interval_ms the controller steps up one mode if the smoothed
+// call latency is over budget or more than max_waiting callers queued, and
+// steps down one mode once latency has stayed under half the budget, with
+// the queue under half its limit, for recover_after_ms since the last change.
+
+enum class DegradedMode : uint8_t { NORMAL, SKIP_ML, SAMPLE_LOGS, COARSE_ANALYTICS, SHED_DUPLICATES };
+
+inline constexpr size_t DEGRADED_MODES = 5;
+
+inline const char* degradedModeName(DegradedMode mode) {
+    switch (mode) {
+        case DegradedMode::NORMAL: return "NORMAL";
+        case DegradedMode::SKIP_ML: return "SKIP_ML";
+        case DegradedMode::SAMPLE_LOGS: return "SAMPLE_LOGS";
+        case DegradedMode::COARSE_ANALYTICS: return "COARSE_ANALYTICS";
+        case DegradedMode::SHED_DUPLICATES: return "SHED_DUPLICATES";
+    }
+    return "NORMAL";
+}
+
+// Work skipped, by what it was
+enum class ShedWork : size_t { ML_SCORING, LOG_ROWS, ANALYTICS, DUPLICATE_READINGS };
+
+inline constexpr size_t SHED_KINDS = 4;
+
+struct OverloadConfig {
+    bool adaptive = true;                             // false: stay at min_mode
+    DegradedMode min_mode = DegradedMode::NORMAL;     // operators can pin a degraded mode
+    double latency_budget_us = 2000.0;                // per ingest call, waiting plus processing
+    uint32_t max_waiting = 8;                         // callers queued on the engine lock
+    int64_t evaluate_interval_ms = 250;
+    int64_t recover_after_ms = 2000;
+    uint32_t log_sample_every = 10;
+    uint32_t analytics_every = 4;
+};
+
+struct OverloadStats {
+    DegradedMode mode = DegradedMode::NORMAL;
+    uint64_t transitions = 0;
+    std::array<uint64_t, SHED_KINDS> shed{};
+    double latency_us = 0.0;   // smoothed ingest call latency
+    uint32_t peak_waiting = 0;
+};
+
+class OverloadController {
+private:
+    using SteadyClock = std::chrono::steady_clock;
+
+    OverloadConfig config;
+    DegradedMode current;
+    double latency_ewma_us = 0.0;
+    uint32_t interval_peak_waiting = 0;
+    uint32_t peak_waiting = 0;
+    uint64_t transitions = 0;
+    std::array<uint64_t, SHED_KINDS> shed_counts{};
+    SteadyClock::time_point last_evaluation;
+    SteadyClock::time_point last_change;
+
+    Gauge mode_gauge;
+    Counter transition_counter;
+    std::array<Counter, SHED_KINDS> shed_counters;
+
+public:
+    OverloadController(MetricsRegistry& metrics, const OverloadConfig& cfg)
+        : config(cfg), current(cfg.min_mode), last_evaluation(SteadyClock::now()), last_change(last_evaluation) {
+        static const char* const kinds[SHED_KINDS] = {"ml_scoring", "log_rows", "analytics", "duplicate_readings"};
+        mode_gauge = Gauge(metrics, "telematics_degraded_mode",
+                           "Degraded mode, 0 = normal to 4 = shedding duplicate readings");
+        transition_counter = Counter(metrics, "telematics_degraded_mode_transitions_total",
+                                     "Changes of degraded mode");
+        for (size_t i = 0; i < SHED_KINDS; ++i) {
+            shed_counters[i] = Counter(metrics, "telematics_shed_total", "Work skipped under overload",
+                                       std::string("work=\"") + kinds[i] + "\"");
+        }
+        mode_gauge.set(static_cast<double>(current));
+    }
+
+    DegradedMode mode() const { return current; }
+    bool at(DegradedMode mode) const { return current >= mode; }
+    const OverloadConfig& settings() const { return config; }
+
+    void shed(ShedWork work, uint64_t count = 1) {
+        shed_counts[static_cast<size_t>(work)] += count;
+        shed_counters[static_cast<size_t>(work)].inc(count);
+    }
+
+    // One ingest call's latency and the callers queued behind it. True when
+    // this changed the mode.
+    bool observe(uint64_t latency_ns, uint32_t waiting, SteadyClock::time_point now = SteadyClock::now()) {
+        latency_ewma_us += (latency_ns / 1000.0 - latency_ewma_us) / 16.0;
+        interval_peak_waiting = std::max(interval_peak_waiting, waiting);
+        peak_waiting = std::max(peak_waiting, waiting);
+        if (!config.adaptive || now - last_evaluation < std::chrono::milliseconds(config.evaluate_interval_ms)) {
+            return false;
+        }
+        last_evaluation = now;
+
+        const bool overloaded = latency_ewma_us > config.latency_budget_us ||
+                                interval_peak_waiting > config.max_waiting;
+        const bool calm = latency_ewma_us < config.latency_budget_us / 2 &&
+                          interval_peak_waiting <= config.max_waiting / 2;
+        interval_peak_waiting = 0;
+
+        DegradedMode next = current;
+        if (overloaded && current < DegradedMode::SHED_DUPLICATES) {
+            next = static_cast<DegradedMode>(static_cast<uint8_t>(current) + 1);
+        } else if (calm && current > config.min_mode &&
+                   now - last_change >= std::chrono::milliseconds(config.recover_after_ms)) {
+            next = static_cast<DegradedMode>(static_cast<uint8_t>(current) - 1);
+        }
+        if (next == current) return false;
+        current = next;
+        last_change = now;
+        transitions++;
+        transition_counter.inc();
+        mode_gauge.set(static_cast<double>(current));
+        return true;
+    }
+
+    OverloadStats stats() const {
+        OverloadStats s;
+        s.mode = current;
+        s.transitions = transitions;
+        s.shed = shed_counts;
+        s.latency_us = latency_ewma_us;
+        s.peak_waiting = peak_waiting;
+        return s;
+    }
+};
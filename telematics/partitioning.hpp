@@ -0,0 +1,268 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+// ============================================================================
+// PARTITIONED DEPLOYMENT TRANSPORT
+// ============================================================================
+//
+// Building blocks for running the fleet as several engine processes on one
+// machine: a map from vehicle ID to owning partition, Unix domain stream
+// sockets, and length-prefixed frames. Frames carry native-endian binary
+// payloads, which is fine because every process is the same binary on the
+// same host.
+
+#if defined(_WIN32)
+inline constexpr bool PARTITIONING_SUPPORTED = false;
+#else
+inline constexpr bool PARTITIONING_SUPPORTED = true;
+#endif
+
+// Contiguous, inclusive vehicle ID ranges, one per partition. IDs outside
+// every range belong to the nearest end partition.
+class PartitionMap {
+public:
+    struct Range {
+        int first_id;
+        int last_id;
+    };
+
+private:
+    std::vector<Range> ranges;
+
+public:
+    PartitionMap() = default;
+
+    // Splits 1..fleet_size as evenly as possible
+    static PartitionMap evenSplit(int fleet_size, size_t partitions) {
+        PartitionMap map;
+        const size_t fleet = static_cast<size_t>(std::max(1, fleet_size));
+        partitions = std::max<size_t>(1, std::min(partitions, fleet));
+        int first = 1;
+        for (size_t p = 0; p < partitions; ++p) {
+            int count = static_cast<int>(fleet / partitions + (p < fleet % partitions ? 1 : 0));
+            map.ranges.push_back({first, first + count - 1});
+            first += count;
+        }
+        return map;
+    }
+
+    size_t partitionFor(int vehicle_id) const {
+        auto it = std::upper_bound(ranges.begin(), ranges.end(), vehicle_id,
+                                   [](int id, const Range& r) { return id < r.first_id; });
+        return it == ranges.begin() ? 0 : static_cast<size_t>(it - ranges.begin()) - 1;
+    }
+
+    const Range& range(size_t partition) const { return ranges[partition]; }
+    size_t size() const { return ranges.size(); }
+};
+
+// ---------------------------------------------------------------------------
+// Wire encoding
+// ---------------------------------------------------------------------------
+
+class WireWriter {
+private:
+    std::string& out;
+
+public:
+    explicit WireWriter(std::string& buffer) : out(buffer) {}
+
+    template <typename T>
+    void put(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "put() takes plain values");
+        out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void putString(std::string_view value) {
+        put(static_cast<uint32_t>(value.size()));
+        out.append(value);
+    }
+};
+
+// Reads what WireWriter wrote; any overrun marks the reader as failed and
+// yields zero values from then on
+class WireReader {
+private:
+    const char* data;
+    size_t size;
+    size_t pos = 0;
+    bool failed = false;
+
+public:
+    explicit WireReader(const std::string& buffer) : data(buffer.data()), size(buffer.size()) {}
+    WireReader(const char* buffer, size_t length) : data(buffer), size(length) {}
+
+    template <typename T>
+    T get() {
+        static_assert(std::is_trivially_copyable<T>::value, "get() returns plain values");
+        T value{};
+        if (failed || size - pos < sizeof(T)) {
+            failed = true;
+            return value;
+        }
+        std::memcpy(&value, data + pos, sizeof(T));
+        pos += sizeof(T);
+        return value;
+    }
+
+    std::string getString() {
+        uint32_t length = get<uint32_t>();
+        if (failed || size - pos < length) {
+            failed = true;
+            return std::string();
+        }
+        std::string value(data + pos, length);
+        pos += length;
+        return value;
+    }
+
+    bool ok() const { return !failed; }
+    bool done() const { return pos == size; }
+};
+
+// ---------------------------------------------------------------------------
+// Frames and sockets
+// ---------------------------------------------------------------------------
+
+enum class FrameType : uint8_t {
+    READINGS = 1,   // coordinator -> partition: count + encoded readings
+    FLUSH,          // coordinator -> partition: release quiet reorder buffers
+    COMMAND,        // coordinator -> partition: fleet-wide query, answered with REPLY
+    REPLY,          // partition -> coordinator
+    SHUTDOWN        // coordinator -> partition
+};
+
+inline constexpr uint32_t MAX_FRAME_BYTES = 64u << 20;
+
+inline void appendFrame(std::string& out, FrameType type, const std::string& payload) {
+    WireWriter writer(out);
+    writer.put(static_cast<uint32_t>(payload.size()));
+    writer.put(static_cast<uint8_t>(type));
+    out.append(payload);
+}
+
+inline bool writeFully(int fd, const char* data, size_t size, std::string& error) {
+#if defined(_WIN32)
+    (void)fd; (void)data; (void)size;
+    error = "partitioned deployment is not supported on this platform";
+    return false;
+#else
+    size_t sent = 0;
+    while (sent < size) {
+        ssize_t n = ::send(fd, data + sent, size - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            error = n < 0 ? std::strerror(errno) : "connection closed";
+            return false;
+        }
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+#endif
+}
+
+inline bool readFully(int fd, char* data, size_t size, std::string& error) {
+#if defined(_WIN32)
+    (void)fd; (void)data; (void)size;
+    error = "partitioned deployment is not supported on this platform";
+    return false;
+#else
+    size_t received = 0;
+    while (received < size) {
+        ssize_t n = ::recv(fd, data + received, size - received, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            error = n < 0 ? std::strerror(errno) : "connection closed";
+            return false;
+        }
+        received += static_cast<size_t>(n);
+    }
+    return true;
+#endif
+}
+
+inline bool sendFrame(int fd, FrameType type, const std::string& payload, std::string& error) {
+    std::string frame;
+    appendFrame(frame, type, payload);
+    return writeFully(fd, frame.data(), frame.size(), error);
+}
+
+inline bool receiveFrame(int fd, FrameType& type, std::string& payload, std::string& error) {
+    char header[sizeof(uint32_t) + sizeof(uint8_t)];
+    if (!readFully(fd, header, sizeof(header), error)) return false;
+    uint32_t length;
+    std::memcpy(&length, header, sizeof(length));
+    if (length > MAX_FRAME_BYTES) {
+        error = "frame of " + std::to_string(length) + " bytes exceeds the limit";
+        return false;
+    }
+    type = static_cast<FrameType>(static_cast<uint8_t>(header[sizeof(uint32_t)]));
+    payload.resize(length);
+    return length == 0 || readFully(fd, &payload[0], length, error);
+}
+
+// Returns the listening descriptor or -1 with `error` set. A stale socket
+// file at `path` is replaced.
+inline int listenUnixSocket(const std::string& path, std::string& error) {
+#if defined(_WIN32)
+    (void)path;
+    error = "partitioned deployment is not supported on this platform";
+    return -1;
+#else
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path)) { error = "socket path too long: " + path; return -1; }
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) { error = std::strerror(errno); return -1; }
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    ::unlink(path.c_str());
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || ::listen(fd, 4) < 0) {
+        error = std::strerror(errno);
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+#endif
+}
+
+// Retries until the listener appears or `timeout_ms` passes
+inline int connectUnixSocket(const std::string& path, int timeout_ms, std::string& error) {
+#if defined(_WIN32)
+    (void)path; (void)timeout_ms;
+    error = "partitioned deployment is not supported on this platform";
+    return -1;
+#else
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path)) { error = "socket path too long: " + path; return -1; }
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    for (int waited = 0;; waited += 20) {
+        int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) { error = std::strerror(errno); return -1; }
+        if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0) return fd;
+        int saved = errno;
+        ::close(fd);
+        if (waited >= timeout_ms || (saved != ENOENT && saved != ECONNREFUSED)) {
+            error = std::strerror(saved);
+            return -1;
+        }
+        ::poll(nullptr, 0, 20);
+    }
+#endif
+}
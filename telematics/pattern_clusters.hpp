@@ -0,0 +1,307 @@
+#pragma once
+
+#include "simd_lanes.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// ============================================================================
+// FLEET PATTERN CLUSTERS
+// ============================================================================
+//
+// Streaming k-means over joint operating points, shared by every vehicle of
+// one make/model so a new vehicle is covered by what its siblings have
+// driven. A group first learns the scale of each feature over WARMUP_SAMPLES
+// readings, then keeps up to K centroids in standardised space:
+//
+// - a point further than SPAWN_DISTANCE from every centroid starts a new one,
+//   in a free slot or in place of the weakest centroid that has fewer than
+//   MIN_SUPPORT points;
+// - otherwise the nearest centroid moves towards it by 1/min(count,
+//   MAX_COUNT), so long-lived groups still follow slow drift, and the
+//   centroid's mean squared radius is updated the same way.
+//
+// A reading's score is its distance to the nearest centroid with at least
+// MIN_SUPPORT points, in units of that centroid's RMS radius: around 1 for
+// typical points, far above for combinations the group has not seen, such
+// as high rpm at walking pace with a hot engine, which each channel on its
+// own would let through. Unsupported centroids never take part in a score,
+// and a group without any supported centroid scores 0. Groups score 0 until
+// they have seen SCORED_AFTER readings.
+//
+// Readings scoring above the threshold are learned only by unsupported
+// centroids: they spawn one or move the nearest one, but never pull a
+// supported centroid. When every slot holds a supported centroid, the two
+// closest are merged to make room. Rare faults therefore stay in weak
+// centroids that are the first to be replaced, while a new operating mode
+// that keeps coming back (a route change, a trailer) gathers MIN_SUPPORT
+// points and from then on scores as normal instead of alerting forever.
+//
+// Centroids are stored feature-major (centroid[f][k]), so score() compares
+// one reading with SimdVec::width centroids per instruction and scoreBatch()
+// compares SimdVec::width readings with one centroid.
+
+class PatternClusterDetector {
+public:
+    // speed km/h, rpm, engine temperature C, acceleration m/s^2, fuel use %/s
+    static constexpr size_t FEATURES = 5;
+    static constexpr size_t K = 8;
+    static constexpr uint64_t WARMUP_SAMPLES = 256;
+    static constexpr uint64_t SCORED_AFTER = 1024;
+    static constexpr uint32_t MAX_COUNT = 1000;
+    static constexpr uint32_t MIN_SUPPORT = 32;
+    static constexpr double SPAWN_DISTANCE = 3.0;   // standard deviations
+
+    using Features = std::array<double, FEATURES>;
+
+    struct GroupInfo {
+        std::string name;
+        uint64_t samples = 0;
+        size_t centroids = 0;
+    };
+
+private:
+    static_assert(K % simd_lanes::SimdVec::width == 0, "centroid blocks fill whole lanes");
+
+    // Below these, a feature that barely moved during warm-up would turn
+    // every later wobble into a huge z-score
+    static constexpr Features MIN_STD = {1.0, 50.0, 1.0, 0.1, 0.001};
+    static constexpr double EMPTY_CENTROID = 1e100;   // never nearest
+    static constexpr double UNSUPPORTED = 1e100;      // score scale of centroids below MIN_SUPPORT
+    static constexpr double MIN_RADIUS2 = 0.05;
+
+    struct Group {
+        std::string name;
+        uint64_t samples = 0;
+        Features mean{};
+        Features m2{};          // Welford sums, warm-up only
+        Features inv_std{};     // frozen when warm-up ends
+        size_t active = 0;      // centroids [0, active) are in use
+        double centroid[FEATURES][K];
+        double radius2[K];
+        double inv_radius2[K];  // UNSUPPORTED until count reaches MIN_SUPPORT
+        uint32_t count[K];
+
+        explicit Group(std::string_view group_name) : name(group_name) {
+            for (auto& row : centroid) std::fill(std::begin(row), std::end(row), EMPTY_CENTROID);
+            std::fill(std::begin(radius2), std::end(radius2), 1.0);
+            std::fill(std::begin(inv_radius2), std::end(inv_radius2), UNSUPPORTED);
+            std::fill(std::begin(count), std::end(count), 0u);
+        }
+    };
+
+    std::vector<Group> groups;
+    std::unordered_map<std::string, uint32_t> group_ids;
+    double score_threshold;
+
+public:
+    explicit PatternClusterDetector(double threshold = 4.0) : score_threshold(threshold) {}
+
+    double threshold() const { return score_threshold; }
+
+    // Group for a make/model, created on first use
+    uint32_t groupFor(std::string_view make_model) {
+        auto it = group_ids.find(std::string(make_model));
+        if (it != group_ids.end()) return it->second;
+        const uint32_t id = static_cast<uint32_t>(groups.size());
+        groups.emplace_back(make_model);
+        group_ids.emplace(std::string(make_model), id);
+        return id;
+    }
+
+    // Scores a reading against its group, then learns it unless it is an outlier
+    double observe(uint32_t group_id, const Features& x) {
+        Group& group = groups[group_id];
+        if (group.samples < WARMUP_SAMPLES) {
+            warmUp(group, x);
+            return 0.0;
+        }
+
+        const Features z = standardise(group, x);
+        double d2[K];
+        distances<simd_lanes::SimdVec>(group, z, d2);
+        const double score = group.samples >= SCORED_AFTER ? nearestRadii(group, d2) : 0.0;
+        group.samples++;
+        learn(group, z, d2, score > score_threshold);
+        return score;
+    }
+
+    // Score without learning
+    double score(uint32_t group_id, const Features& x) const {
+        const Group& group = groups[group_id];
+        if (group.samples < SCORED_AFTER) return 0.0;
+        const Features z = standardise(group, x);
+        double d2[K];
+        distances<simd_lanes::SimdVec>(group, z, d2);
+        return nearestRadii(group, d2);
+    }
+
+    // Scores n readings given column-wise (columns[f][i]) into scores[i],
+    // without learning. For replays and offline sweeps.
+    void scoreBatch(uint32_t group_id, const std::array<const double*, FEATURES>& columns, size_t n,
+                    double* scores) const {
+        const Group& group = groups[group_id];
+        if (group.samples < SCORED_AFTER) {
+            std::fill(scores, scores + n, 0.0);
+            return;
+        }
+        using simd_lanes::SimdVec;
+        using simd_lanes::ScalarVec;
+
+        size_t i = 0;
+        for (; i + SimdVec::width <= n; i += SimdVec::width) {
+            scoreLanes<SimdVec>(group, columns, i).store(scores + i);
+        }
+        for (; i < n; ++i) scores[i] = scoreLanes<ScalarVec>(group, columns, i).v;
+    }
+
+    size_t groupCount() const { return groups.size(); }
+
+    GroupInfo groupInfo(uint32_t group_id) const {
+        const Group& group = groups[group_id];
+        return {group.name, group.samples, group.active};
+    }
+
+private:
+    static void warmUp(Group& group, const Features& x) {
+        group.samples++;
+        const double n = static_cast<double>(group.samples);
+        for (size_t f = 0; f < FEATURES; ++f) {
+            const double delta = x[f] - group.mean[f];
+            group.mean[f] += delta / n;
+            group.m2[f] += delta * (x[f] - group.mean[f]);
+        }
+        if (group.samples == WARMUP_SAMPLES) {
+            for (size_t f = 0; f < FEATURES; ++f) {
+                group.inv_std[f] = 1.0 / std::max(std::sqrt(group.m2[f] / n), MIN_STD[f]);
+            }
+        }
+    }
+
+    static Features standardise(const Group& group, const Features& x) {
+        Features z;
+        for (size_t f = 0; f < FEATURES; ++f) z[f] = (x[f] - group.mean[f]) * group.inv_std[f];
+        return z;
+    }
+
+    // Squared distance from z to every centroid, a block of centroids per step
+    template <typename V>
+    static void distances(const Group& group, const Features& z, double* d2) {
+        for (size_t k = 0; k < K; k += V::width) {
+            V sum = V::set1(0.0);
+            for (size_t f = 0; f < FEATURES; ++f) {
+                const V d = V::set1(z[f]) - V::load(&group.centroid[f][k]);
+                sum = sum + d * d;
+            }
+            sum.store(d2 + k);
+        }
+    }
+
+    static double nearestRadii(const Group& group, const double* d2) {
+        double best = std::numeric_limits<double>::infinity();
+        bool supported = false;
+        for (size_t k = 0; k < group.active; ++k) {
+            if (group.count[k] < MIN_SUPPORT) continue;
+            supported = true;
+            best = std::min(best, d2[k] * group.inv_radius2[k]);
+        }
+        return supported ? std::sqrt(best) : 0.0;
+    }
+
+    // `outlier` readings may only spawn or move unsupported centroids
+    static void learn(Group& group, const Features& z, const double* d2, bool outlier) {
+        size_t nearest = K;
+        for (size_t k = 0; k < group.active; ++k) {
+            if (outlier && group.count[k] >= MIN_SUPPORT) continue;
+            if (nearest == K || d2[k] < d2[nearest]) nearest = k;
+        }
+        if (nearest == K || d2[nearest] > SPAWN_DISTANCE * SPAWN_DISTANCE) {
+            // The weakest centroid makes way, except the one nearest to the
+            // point: for an outlier that may be a new mode gathering support,
+            // which stray points further out should not reset
+            size_t slot = group.active;
+            if (slot == K) {
+                for (size_t k = 0; k < K; ++k) {
+                    if (k == nearest) continue;
+                    if (slot == K || group.count[k] < group.count[slot]) slot = k;
+                }
+                if (group.count[slot] >= MIN_SUPPORT) slot = outlier ? mergeClosest(group) : K;
+            }
+            if (slot < K) {
+                for (size_t f = 0; f < FEATURES; ++f) group.centroid[f][slot] = z[f];
+                group.count[slot] = 1;
+                group.radius2[slot] = 1.0;
+                group.inv_radius2[slot] = UNSUPPORTED;
+                group.active = std::max(group.active, slot + 1);
+                return;
+            }
+            if (nearest == K) return;
+        }
+
+        group.count[nearest] = std::min(group.count[nearest] + 1, MAX_COUNT);
+        const double step = 1.0 / group.count[nearest];
+        for (size_t f = 0; f < FEATURES; ++f) {
+            group.centroid[f][nearest] += step * (z[f] - group.centroid[f][nearest]);
+        }
+        group.radius2[nearest] += step * (d2[nearest] - group.radius2[nearest]);
+        group.inv_radius2[nearest] = group.count[nearest] >= MIN_SUPPORT
+            ? 1.0 / std::max(group.radius2[nearest], MIN_RADIUS2) : UNSUPPORTED;
+    }
+
+    // Folds the two closest supported centroids into one, weighted by count,
+    // and returns the slot that freed. The merged radius covers both.
+    static size_t mergeClosest(Group& group) {
+        size_t a = 0, b = 1;
+        double closest = std::numeric_limits<double>::infinity();
+        for (size_t i = 0; i < group.active; ++i) {
+            if (group.count[i] < MIN_SUPPORT) continue;
+            for (size_t j = i + 1; j < group.active; ++j) {
+                if (group.count[j] < MIN_SUPPORT) continue;
+                double dist2 = 0.0;
+                for (size_t f = 0; f < FEATURES; ++f) {
+                    const double d = group.centroid[f][i] - group.centroid[f][j];
+                    dist2 += d * d;
+                }
+                if (dist2 < closest) { closest = dist2; a = i; b = j; }
+            }
+        }
+        const double wa = group.count[a], wb = group.count[b], w = wa + wb;
+        for (size_t f = 0; f < FEATURES; ++f) {
+            group.centroid[f][a] = (wa * group.centroid[f][a] + wb * group.centroid[f][b]) / w;
+        }
+        group.radius2[a] = (wa * group.radius2[a] + wb * group.radius2[b]) / w + wa * wb / (w * w) * closest;
+        group.inv_radius2[a] = 1.0 / std::max(group.radius2[a], MIN_RADIUS2);
+        group.count[a] = std::min(group.count[a] + group.count[b], MAX_COUNT);
+        return b;
+    }
+
+    // Scores of readings [i, i + V::width)
+    template <typename V>
+    static V scoreLanes(const Group& group, const std::array<const double*, FEATURES>& columns, size_t i) {
+        V z[FEATURES];
+        for (size_t f = 0; f < FEATURES; ++f) {
+            z[f] = (V::load(columns[f] + i) - V::set1(group.mean[f])) * V::set1(group.inv_std[f]);
+        }
+        V best = V::set1(std::numeric_limits<double>::infinity());
+        bool supported = false;
+        for (size_t k = 0; k < group.active; ++k) {
+            if (group.count[k] < MIN_SUPPORT) continue;
+            supported = true;
+            V sum = V::set1(0.0);
+            for (size_t f = 0; f < FEATURES; ++f) {
+                const V d = z[f] - V::set1(group.centroid[f][k]);
+                sum = sum + d * d;
+            }
+            best = V::min(best, sum * V::set1(group.inv_radius2[k]));
+        }
+        return supported ? V::sqrt(best) : V::set1(0.0);
+    }
+};
@@ -0,0 +1,224 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// ============================================================================
+// PARALLEL REPORT WRITER
+// ============================================================================
+//
+// Report text for large fleets. ReportBuffer formats numbers with
+// std::to_chars into a growable buffer, with no locale or stream state.
+// writeChunksInOrder splits the rows into chunks and formats them on worker
+// threads. The calling thread writes the finished chunks to the file in row
+// order, one large fwrite each. At most `threads * 4` chunks are formatted
+// ahead of the writer, so memory stays bounded however large the report.
+
+class ReportBuffer {
+private:
+    std::string text;
+
+    // Grows the buffer by `max` bytes, formats into them, trims the rest
+    template <typename Fn>
+    void format(size_t max, Fn&& fn) {
+        const size_t used = text.size();
+        text.resize(used + max);
+        char* first = &text[used];
+        char* last = fn(first, first + max);
+        text.resize(used + static_cast<size_t>(last - first));
+    }
+
+public:
+    explicit ReportBuffer(size_t reserve = 0) { text.reserve(reserve); }
+
+    ReportBuffer& append(const char* value) { text.append(value); return *this; }
+    ReportBuffer& append(std::string_view value) { text.append(value); return *this; }
+    ReportBuffer& append(char value) { text.push_back(value); return *this; }
+
+    ReportBuffer& appendInt(int64_t value) {
+        format(24, [value](char* first, char* last) { return std::to_chars(first, last, value).ptr; });
+        return *this;
+    }
+
+    // Fixed notation; non-finite values as "nan"/"inf" (see appendJsonNumber)
+    ReportBuffer& appendFixed(double value, int precision = 2) {
+        if (!std::isfinite(value)) return append(std::isnan(value) ? "nan" : value > 0 ? "inf" : "-inf");
+        // Fixed notation of large magnitudes needs one byte per integer digit
+        const size_t max = 32 + static_cast<size_t>(precision) +
+                           (std::fabs(value) >= 1e15 ? static_cast<size_t>(std::log10(std::fabs(value))) : 0);
+        format(max, [value, precision](char* first, char* last) {
+            return std::to_chars(first, last, value, std::chars_format::fixed, precision).ptr;
+        });
+        return *this;
+    }
+
+    ReportBuffer& appendJsonNumber(double value, int precision = 3) {
+        if (!std::isfinite(value)) return append("null");
+        return appendFixed(value, precision);
+    }
+
+    // Non-finite values as `missing`: "n/a" in text, "" for an empty CSV field
+    ReportBuffer& appendFixedOr(double value, int precision, std::string_view missing) {
+        if (!std::isfinite(value)) return append(missing);
+        return appendFixed(value, precision);
+    }
+
+    ReportBuffer& appendJsonString(std::string_view value) {
+        text.push_back('"');
+        for (char ch : value) {
+            switch (ch) {
+                case '"': text.append("\\\""); break;
+                case '\\': text.append("\\\\"); break;
+                case '\n': text.append("\\n"); break;
+                case '\r': text.append("\\r"); break;
+                case '\t': text.append("\\t"); break;
+                default:
+                    if (static_cast<unsigned char>(ch) < 0x20) {
+                        char escaped[8];
+                        std::snprintf(escaped, sizeof(escaped), "\\u%04x", ch);
+                        text.append(escaped);
+                    } else {
+                        text.push_back(ch);
+                    }
+            }
+        }
+        text.push_back('"');
+        return *this;
+    }
+
+    // RFC 4180: quoted only when it has to be
+    ReportBuffer& appendCsvField(std::string_view value) {
+        if (value.find_first_of(",\"\r\n") == std::string_view::npos) return append(value);
+        text.push_back('"');
+        for (char ch : value) {
+            if (ch == '"') text.push_back('"');
+            text.push_back(ch);
+        }
+        text.push_back('"');
+        return *this;
+    }
+
+    const std::string& str() const { return text; }
+    size_t size() const { return text.size(); }
+    void clear() { text.clear(); }
+};
+
+// What text output shows for a value that was never measured
+inline constexpr std::string_view MISSING_VALUE = "n/a";
+
+// One number for console output, formatted as the text report does
+inline std::string fixedOrMissing(double value, int precision) {
+    ReportBuffer out(32);
+    out.appendFixedOr(value, precision, MISSING_VALUE);
+    return out.str();
+}
+
+struct ChunkWriteStats {
+    size_t chunks = 0;
+    uint64_t bytes = 0;
+};
+
+// Formats rows [0, rows) in chunks of `chunk_rows`: format(begin, end, buffer)
+// runs on up to `threads` workers (0 = one per hardware thread), and the
+// buffers are written to `out` in order. A format() that throws stops the
+// report and the exception is rethrown here.
+template <typename FormatFn>
+bool writeChunksInOrder(std::FILE* out, size_t rows, size_t chunk_rows, size_t threads, FormatFn&& format,
+                        ChunkWriteStats& stats, std::string& error) {
+    chunk_rows = std::max<size_t>(1, chunk_rows);
+    const size_t chunks = (rows + chunk_rows - 1) / chunk_rows;
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::max<size_t>(1, std::min(threads, chunks));
+    const size_t window = threads * 4;
+
+    std::vector<ReportBuffer> slots(window);
+    std::vector<char> ready(window, 0);
+    std::mutex mutex;
+    std::condition_variable changed;
+    size_t next_chunk = 0;     // next to format
+    size_t written = 0;        // chunks written so far
+    bool stop = false;
+    std::exception_ptr failure;
+
+    auto worker = [&] {
+        for (;;) {
+            size_t chunk;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&] { return stop || next_chunk >= chunks || next_chunk < written + window; });
+                if (stop || next_chunk >= chunks) return;
+                chunk = next_chunk++;
+            }
+            ReportBuffer& buffer = slots[chunk % window];
+            buffer.clear();
+            try {
+                const size_t begin = chunk * chunk_rows;
+                format(begin, std::min(rows, begin + chunk_rows), buffer);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!failure) failure = std::current_exception();
+                stop = true;
+                changed.notify_all();
+                return;
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            ready[chunk % window] = 1;
+            changed.notify_all();
+        }
+    };
+
+    // With more than one thread, all of them format and this one only writes
+    std::vector<std::thread> pool;
+    if (threads > 1) {
+        for (size_t i = 0; i < threads; ++i) pool.emplace_back(worker);
+    }
+
+    bool ok = true;
+    for (size_t chunk = 0; chunk < chunks && ok; ++chunk) {
+        const size_t slot = chunk % window;
+        if (threads == 1) {
+            // No pool: format in line
+            slots[slot].clear();
+            const size_t begin = chunk * chunk_rows;
+            format(begin, std::min(rows, begin + chunk_rows), slots[slot]);
+        } else {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&] { return ready[slot] || stop; });
+            if (!ready[slot]) break;
+        }
+        const std::string& text = slots[slot].str();
+        if (!text.empty() && std::fwrite(text.data(), 1, text.size(), out) != text.size()) {
+            error = std::strerror(errno);
+            ok = false;
+        }
+        stats.bytes += text.size();
+        stats.chunks++;
+        std::lock_guard<std::mutex> lock(mutex);
+        ready[slot] = 0;
+        written = chunk + 1;
+        if (!ok) stop = true;
+        changed.notify_all();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    changed.notify_all();
+    for (auto& thread : pool) thread.join();
+    if (failure) std::rethrow_exception(failure);
+    return ok;
+}
@@ -0,0 +1,385 @@
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// ============================================================================
+// SHARED-MEMORY FLEET STATE
+// ============================================================================
+//
+// A fixed-layout table of per-vehicle state in a POSIX shared-memory segment
+// (/dev/shm/<name> on Linux), for readers in other processes: ops tooling,
+// dashboard backends, scripts/telematics_shm.py. Once a reader has mapped
+// the segment, polling the whole fleet is plain memory loads, with no
+// syscalls, serialisation or locks.
+//
+// Segment layout (native endian, every offset fixed by the static_asserts
+// below):
+//   SharedStateHeader     128 bytes
+//   SharedVehicleSlot     192 bytes each (three cache lines), capacity times
+//
+// Each slot is guarded by a seqlock. The single writer makes the sequence odd,
+// stores the row, then makes it even again; a reader copies the row between
+// two loads of the sequence and retries if they differ or are odd. Readers
+// never block the writer, and the writer never waits for readers. Slots are
+// assigned in first-publish order and never move; `vehicle_count` is raised
+// only after a new slot's first row is complete.
+
+inline constexpr char SHARED_STATE_MAGIC[8] = {'T', 'L', 'M', 'F', 'L', 'E', 'E', 'T'};
+inline constexpr uint32_t SHARED_STATE_VERSION = 1;
+
+#if defined(_WIN32)
+inline constexpr bool SHARED_STATE_SUPPORTED = false;
+#else
+inline constexpr bool SHARED_STATE_SUPPORTED = true;
+#endif
+
+// One vehicle: the latest reading plus its VehicleProfile counters
+struct SharedVehicleRow {
+    int64_t timestamp_ms = 0;      // event time of the latest reading
+    int64_t last_seen_ms = 0;      // engine time the vehicle last reported
+    int32_t vehicle_id = 0;
+    uint8_t state = 0;             // VehicleState
+    uint8_t flags = 0;             // SHARED_FLAG_*
+    uint16_t reserved0 = 0;
+    int32_t odometer_km = 0;
+    int32_t total_anomalies = 0;
+    int32_t harsh_events = 0;
+    uint32_t reserved1 = 0;
+    double speed = 0.0;
+    double rpm = 0.0;
+    double temperature = 0.0;
+    double fuel_level = 0.0;
+    double throttle_position = 0.0;
+    double latitude = 0.0;
+    double longitude = 0.0;
+    double acceleration = 0.0;
+    double brake_pressure = 0.0;
+    double oil_pressure = 0.0;
+    double battery_voltage = 0.0;
+    double total_distance_km = 0.0;
+    double avg_speed = 0.0;
+    double max_speed = 0.0;
+    double avg_fuel_efficiency = 0.0;
+    uint64_t sequence_number = 0;  // device sequence number of the latest reading
+};
+
+inline constexpr uint8_t SHARED_FLAG_ENGINE_ON = 1u << 0;
+inline constexpr uint8_t SHARED_FLAG_ABS_ACTIVE = 1u << 1;
+inline constexpr uint8_t SHARED_FLAG_TRACTION_CONTROL = 1u << 2;
+
+static_assert(offsetof(SharedVehicleRow, vehicle_id) == 16, "shared row layout changed");
+static_assert(offsetof(SharedVehicleRow, speed) == 40, "shared row layout changed");
+static_assert(offsetof(SharedVehicleRow, sequence_number) == 160, "shared row layout changed");
+static_assert(sizeof(SharedVehicleRow) == 168, "shared row layout changed");
+
+struct SharedStateHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t slot_size;
+    uint32_t capacity;
+    std::atomic<uint32_t> vehicle_count;   // slots in use; release-stored by the writer
+    uint32_t writer_pid;
+    std::atomic<uint64_t> publish_count;   // rows published since the segment was created
+    std::atomic<int64_t> updated_ms;       // timestamp_ms of the last row published
+    char reserved[80];
+};
+
+static_assert(sizeof(SharedStateHeader) == 128, "shared header layout changed");
+static_assert(offsetof(SharedStateHeader, vehicle_count) == 24, "shared header layout changed");
+static_assert(offsetof(SharedStateHeader, publish_count) == 32, "shared header layout changed");
+static_assert(std::atomic<uint32_t>::is_always_lock_free && std::atomic<uint64_t>::is_always_lock_free,
+              "shared-memory atomics must be lock-free");
+
+// The row is stored as relaxed atomic words so concurrent reads of a slot
+// being rewritten are well defined; the seqlock discards such torn copies.
+struct alignas(64) SharedVehicleSlot {
+    static constexpr size_t WORDS = sizeof(SharedVehicleRow) / sizeof(uint64_t);
+
+    std::atomic<uint32_t> sequence;
+    uint32_t reserved;
+    std::atomic<uint64_t> words[WORDS];
+};
+
+static_assert(sizeof(SharedVehicleRow) % sizeof(uint64_t) == 0, "shared row must be whole words");
+static_assert(offsetof(SharedVehicleSlot, words) == 8, "shared slot layout changed");
+static_assert(sizeof(SharedVehicleSlot) == 192, "shared slot layout changed");
+
+inline size_t sharedStateBytes(uint32_t capacity) {
+    return sizeof(SharedStateHeader) + static_cast<size_t>(capacity) * sizeof(SharedVehicleSlot);
+}
+
+inline SharedVehicleSlot* sharedStateSlots(void* base) {
+    return reinterpret_cast<SharedVehicleSlot*>(static_cast<char*>(base) + sizeof(SharedStateHeader));
+}
+
+// Creates and owns the segment; the name is unlinked again on close(). A
+// segment that already exists is never taken over: it may belong to another
+// live engine whose readers would silently lose their writer. Not
+// thread-safe: the engine publishes under data_mutex.
+class SharedFleetWriter {
+private:
+    std::string name;
+    void* base = nullptr;
+    size_t bytes = 0;
+    SharedStateHeader* header = nullptr;
+    SharedVehicleSlot* slots = nullptr;
+    std::unordered_map<int, uint32_t> slot_of;
+    uint64_t dropped = 0;
+
+public:
+    SharedFleetWriter() = default;
+    SharedFleetWriter(const SharedFleetWriter&) = delete;
+    SharedFleetWriter& operator=(const SharedFleetWriter&) = delete;
+    ~SharedFleetWriter() { close(); }
+
+    // `segment_name` is a POSIX shm name such as "/telematics_fleet". Fails
+    // if a segment of that name already exists (another engine, or one that
+    // crashed and left it behind; remove /dev/shm/<name> by hand then).
+    bool open(const std::string& segment_name, uint32_t capacity, std::string& error) {
+#if defined(_WIN32)
+        (void)segment_name; (void)capacity;
+        error = "shared-memory fleet state is not supported on this platform";
+        return false;
+#else
+        close();
+        if (segment_name.size() < 2 || segment_name[0] != '/' ||
+            segment_name.find('/', 1) != std::string::npos) {
+            error = "segment name must look like /name: " + segment_name;
+            return false;
+        }
+        if (capacity == 0) { error = "capacity must be positive"; return false; }
+
+        int fd = ::shm_open(segment_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+        if (fd < 0 && errno == EEXIST) {
+            error = "segment already exists and may belong to another engine; "
+                    "remove /dev/shm" + segment_name + " if it is stale";
+            return false;
+        }
+        if (fd < 0) { error = std::strerror(errno); return false; }
+        const size_t size = sharedStateBytes(capacity);
+        void* mapped = MAP_FAILED;
+        if (::ftruncate(fd, static_cast<off_t>(size)) == 0) {
+            mapped = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        int saved = errno;
+        ::close(fd);
+        if (mapped == MAP_FAILED) {
+            error = std::strerror(saved);
+            ::shm_unlink(segment_name.c_str());
+            return false;
+        }
+
+        // ftruncate zero-fills, so every slot starts at sequence 0
+        name = segment_name;
+        base = mapped;
+        bytes = size;
+        header = static_cast<SharedStateHeader*>(mapped);
+        slots = sharedStateSlots(mapped);
+        header->version = SHARED_STATE_VERSION;
+        header->header_size = sizeof(SharedStateHeader);
+        header->slot_size = sizeof(SharedVehicleSlot);
+        header->capacity = capacity;
+        header->writer_pid = static_cast<uint32_t>(::getpid());
+        // Magic last: readers treat a segment without it as not yet ready
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(header->magic, SHARED_STATE_MAGIC, sizeof(SHARED_STATE_MAGIC));
+        return true;
+#endif
+    }
+
+    void close() {
+#if !defined(_WIN32)
+        if (!base) return;
+        ::munmap(base, bytes);
+        ::shm_unlink(name.c_str());
+#endif
+        base = nullptr;
+        header = nullptr;
+        slots = nullptr;
+        bytes = 0;
+        slot_of.clear();
+    }
+
+    // Writes (or rewrites) the vehicle's slot. Returns false, and counts the
+    // row as dropped, once every slot is taken by other vehicles.
+    bool publish(const SharedVehicleRow& row) {
+        if (!header) return false;
+        auto it = slot_of.find(row.vehicle_id);
+        const bool is_new = it == slot_of.end();
+        uint32_t index;
+        if (is_new) {
+            index = static_cast<uint32_t>(slot_of.size());
+            if (index >= header->capacity) {
+                dropped++;
+                return false;
+            }
+            slot_of.emplace(row.vehicle_id, index);
+        } else {
+            index = it->second;
+        }
+
+        uint64_t words[SharedVehicleSlot::WORDS];
+        std::memcpy(words, &row, sizeof(row));
+        SharedVehicleSlot& slot = slots[index];
+        const uint32_t seq = slot.sequence.load(std::memory_order_relaxed);
+        slot.sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < SharedVehicleSlot::WORDS; ++i) {
+            slot.words[i].store(words[i], std::memory_order_relaxed);
+        }
+        slot.sequence.store(seq + 2, std::memory_order_release);
+
+        if (is_new) header->vehicle_count.store(index + 1, std::memory_order_release);
+        header->publish_count.fetch_add(1, std::memory_order_relaxed);
+        header->updated_ms.store(row.timestamp_ms, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool isOpen() const { return header != nullptr; }
+    const std::string& segmentName() const { return name; }
+    uint32_t capacity() const { return header ? header->capacity : 0; }
+    size_t size() const { return slot_of.size(); }
+    uint64_t droppedRows() const { return dropped; }
+};
+
+// Maps an existing segment read-only. After open(), every call is plain
+// loads from the mapping. Any number of readers, in any process, may poll
+// concurrently with the writer.
+class SharedFleetReader {
+private:
+    void* base = nullptr;
+    size_t bytes = 0;
+    const SharedStateHeader* header = nullptr;
+    const SharedVehicleSlot* slots = nullptr;
+
+public:
+    static constexpr int DEFAULT_RETRIES = 64;
+
+    SharedFleetReader() = default;
+    SharedFleetReader(const SharedFleetReader&) = delete;
+    SharedFleetReader& operator=(const SharedFleetReader&) = delete;
+    ~SharedFleetReader() { close(); }
+
+    bool open(const std::string& segment_name, std::string& error) {
+#if defined(_WIN32)
+        (void)segment_name;
+        error = "shared-memory fleet state is not supported on this platform";
+        return false;
+#else
+        close();
+        int fd = ::shm_open(segment_name.c_str(), O_RDONLY, 0);
+        if (fd < 0) { error = std::strerror(errno); return false; }
+        struct stat info{};
+        void* mapped = MAP_FAILED;
+        if (::fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= sizeof(SharedStateHeader)) {
+            mapped = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        } else {
+            errno = EINVAL;
+        }
+        int saved = errno;
+        ::close(fd);
+        if (mapped == MAP_FAILED) { error = std::strerror(saved); return false; }
+
+        const auto* h = static_cast<const SharedStateHeader*>(mapped);
+        std::string problem;
+        if (std::memcmp(h->magic, SHARED_STATE_MAGIC, sizeof(SHARED_STATE_MAGIC)) != 0) {
+            problem = "not a fleet state segment (or not yet initialised)";
+        } else if (h->version != SHARED_STATE_VERSION || h->header_size != sizeof(SharedStateHeader) ||
+                   h->slot_size != sizeof(SharedVehicleSlot)) {
+            problem = "unsupported fleet state layout version " + std::to_string(h->version);
+        } else if (sharedStateBytes(h->capacity) > static_cast<size_t>(info.st_size)) {
+            problem = "segment shorter than its declared capacity";
+        }
+        if (!problem.empty()) {
+            ::munmap(mapped, static_cast<size_t>(info.st_size));
+            error = problem;
+            return false;
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        base = mapped;
+        bytes = static_cast<size_t>(info.st_size);
+        header = h;
+        slots = sharedStateSlots(mapped);
+        return true;
+#endif
+    }
+
+    void close() {
+#if !defined(_WIN32)
+        if (base) ::munmap(base, bytes);
+#endif
+        base = nullptr;
+        header = nullptr;
+        slots = nullptr;
+        bytes = 0;
+    }
+
+    bool isOpen() const { return header != nullptr; }
+    uint32_t capacity() const { return header ? header->capacity : 0; }
+    uint32_t writerPid() const { return header ? header->writer_pid : 0; }
+
+    // Slots in use; rows [0, size()) are safe to read
+    uint32_t size() const {
+        return header ? header->vehicle_count.load(std::memory_order_acquire) : 0;
+    }
+
+    uint64_t publishCount() const {
+        return header ? header->publish_count.load(std::memory_order_relaxed) : 0;
+    }
+
+    // Consistent copy of one slot. Fails only if the writer rewrote the slot
+    // on every one of `retries` attempts.
+    bool read(uint32_t index, SharedVehicleRow& row, int retries = DEFAULT_RETRIES) const {
+        if (index >= size()) return false;
+        const SharedVehicleSlot& slot = slots[index];
+        uint64_t words[SharedVehicleSlot::WORDS];
+        for (int attempt = 0; attempt < retries; ++attempt) {
+            const uint32_t before = slot.sequence.load(std::memory_order_acquire);
+            if (before & 1u) continue;
+            for (size_t i = 0; i < SharedVehicleSlot::WORDS; ++i) {
+                words[i] = slot.words[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) == before) {
+                std::memcpy(&row, words, sizeof(row));
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Sequence of a slot; unchanged since the last poll means the row is too
+    uint32_t version(uint32_t index) const {
+        return index < size() ? slots[index].sequence.load(std::memory_order_acquire) : 0;
+    }
+
+    // Calls fn(const SharedVehicleRow&) for every slot that reads consistently;
+    // returns how many did
+    template <typename Fn>
+    size_t forEach(Fn&& fn) const {
+        size_t visited = 0;
+        SharedVehicleRow row;
+        const uint32_t count = size();
+        for (uint32_t i = 0; i < count; ++i) {
+            if (read(i, row)) {
+                fn(static_cast<const SharedVehicleRow&>(row));
+                visited++;
+            }
+        }
+        return visited;
+    }
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+// ============================================================================
+// DOUBLE-PRECISION SIMD LANES
+// ============================================================================
+//
+// The few vector operations the batch kernels need, over the widest double
+// lanes the build targets: AVX (4), SSE2 (2) or plain scalars. Kernels are
+// written once as templates over the lane type and run the tail of a batch
+// with ScalarVec, whose interface is the same.
+
+namespace simd_lanes {
+
+struct ScalarVec {
+    double v;
+    static constexpr size_t width = 1;
+    static ScalarVec load(const double* p) { return {*p}; }
+    static ScalarVec set1(double x) { return {x}; }
+    void store(double* p) const { *p = v; }
+    friend ScalarVec operator+(ScalarVec a, ScalarVec b) { return {a.v + b.v}; }
+    friend ScalarVec operator-(ScalarVec a, ScalarVec b) { return {a.v - b.v}; }
+    friend ScalarVec operator*(ScalarVec a, ScalarVec b) { return {a.v * b.v}; }
+    static ScalarVec sqrt(ScalarVec a) { return {std::sqrt(a.v)}; }
+    static ScalarVec min(ScalarVec a, ScalarVec b) { return {a.v < b.v ? a.v : b.v}; }
+    static ScalarVec max(ScalarVec a, ScalarVec b) { return {a.v > b.v ? a.v : b.v}; }
+    // a > b ? x : y
+    static ScalarVec selectGreater(ScalarVec a, ScalarVec b, ScalarVec x, ScalarVec y) {
+        return {a.v > b.v ? x.v : y.v};
+    }
+};
+
+#if defined(__AVX__)
+struct SimdVec {
+    __m256d v;
+    static constexpr size_t width = 4;
+    static SimdVec load(const double* p) { return {_mm256_loadu_pd(p)}; }
+    static SimdVec set1(double x) { return {_mm256_set1_pd(x)}; }
+    void store(double* p) const { _mm256_storeu_pd(p, v); }
+    friend SimdVec operator+(SimdVec a, SimdVec b) { return {_mm256_add_pd(a.v, b.v)}; }
+    friend SimdVec operator-(SimdVec a, SimdVec b) { return {_mm256_sub_pd(a.v, b.v)}; }
+    friend SimdVec operator*(SimdVec a, SimdVec b) { return {_mm256_mul_pd(a.v, b.v)}; }
+    static SimdVec sqrt(SimdVec a) { return {_mm256_sqrt_pd(a.v)}; }
+    static SimdVec min(SimdVec a, SimdVec b) { return {_mm256_min_pd(a.v, b.v)}; }
+    static SimdVec max(SimdVec a, SimdVec b) { return {_mm256_max_pd(a.v, b.v)}; }
+    static SimdVec selectGreater(SimdVec a, SimdVec b, SimdVec x, SimdVec y) {
+        return {_mm256_blendv_pd(y.v, x.v, _mm256_cmp_pd(a.v, b.v, _CMP_GT_OQ))};
+    }
+};
+#elif defined(__SSE2__) || defined(_M_X64)
+struct SimdVec {
+    __m128d v;
+    static constexpr size_t width = 2;
+    static SimdVec load(const double* p) { return {_mm_loadu_pd(p)}; }
+    static SimdVec set1(double x) { return {_mm_set1_pd(x)}; }
+    void store(double* p) const { _mm_storeu_pd(p, v); }
+    friend SimdVec operator+(SimdVec a, SimdVec b) { return {_mm_add_pd(a.v, b.v)}; }
+    friend SimdVec operator-(SimdVec a, SimdVec b) { return {_mm_sub_pd(a.v, b.v)}; }
+    friend SimdVec operator*(SimdVec a, SimdVec b) { return {_mm_mul_pd(a.v, b.v)}; }
+    static SimdVec sqrt(SimdVec a) { return {_mm_sqrt_pd(a.v)}; }
+    static SimdVec min(SimdVec a, SimdVec b) { return {_mm_min_pd(a.v, b.v)}; }
+    static SimdVec max(SimdVec a, SimdVec b) { return {_mm_max_pd(a.v, b.v)}; }
+    static SimdVec selectGreater(SimdVec a, SimdVec b, SimdVec x, SimdVec y) {
+        __m128d mask = _mm_cmpgt_pd(a.v, b.v);
+        return {_mm_or_pd(_mm_and_pd(mask, x.v), _mm_andnot_pd(mask, y.v))};
+    }
+};
+#else
+using SimdVec = ScalarVec;
+#endif
+
+} // namespace simd_lanes
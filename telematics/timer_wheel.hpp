@@ -0,0 +1,177 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// ============================================================================
+// HIERARCHICAL TIMER WHEEL
+// ============================================================================
+//
+// Deadlines for very many timers that are mostly re-armed before they fire,
+// such as one heartbeat per vehicle. Four wheels of 256 slots cover 2^32
+// ticks: a timer due within 256 ticks waits in the innermost wheel's slot for
+// its tick, one due later waits in an outer wheel's slot until the inner
+// wheel comes round to it and is then moved inwards (at most three moves in
+// its life).
+//
+// Timers are slots in a pool, named by a dense id, and each wheel slot is an
+// intrusive doubly linked list through the pool. Arming, re-arming and
+// cancelling are O(1) with no allocation. advance() costs O(1) per tick plus
+// the timers that fire or move inwards on that tick; with nothing armed it
+// jumps straight to the target tick.
+//
+//   TimerWheel wheel(1000, now_ms);               // 1 s ticks
+//   uint32_t id = wheel.create(vehicle_id);
+//   wheel.arm(id, now_ms + 30000);                // on every heartbeat
+//   wheel.advance(now_ms, [](uint32_t id, uint64_t tag) { ... });
+//
+// A timer fires on the first tick at or after its deadline, so up to one
+// tick late. Deadlines already passed fire on the next tick.
+
+class TimerWheel {
+public:
+    static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+private:
+    static constexpr unsigned LEVEL_BITS = 8;
+    static constexpr uint32_t SLOTS = 1u << LEVEL_BITS;
+    static constexpr unsigned LEVELS = 4;
+    static constexpr uint64_t MAX_DELTA = (uint64_t(1) << (LEVEL_BITS * LEVELS)) - 1;
+
+    struct Node {
+        uint64_t deadline_tick = 0;
+        uint64_t tag = 0;
+        uint32_t prev = NONE;
+        uint32_t next = NONE;     // also the free list
+        uint32_t bucket = NONE;   // level * SLOTS + slot while armed
+    };
+
+    int64_t tick_ms;
+    uint64_t current_tick;        // every timer due at or before it has fired
+    std::vector<Node> nodes;
+    std::array<uint32_t, LEVELS * SLOTS> heads;
+    uint32_t free_head = NONE;
+    size_t armed_count = 0;
+
+    static uint32_t slotOf(uint64_t tick, unsigned level) {
+        return static_cast<uint32_t>((tick >> (LEVEL_BITS * level)) & (SLOTS - 1));
+    }
+
+    void link(uint32_t id) {
+        Node& node = nodes[id];
+        const uint64_t delta = std::min(node.deadline_tick - current_tick, MAX_DELTA);
+        // Placed by how far ahead it is, in the slot of the tick it is due
+        unsigned level = 0;
+        while (level + 1 < LEVELS && delta >= (uint64_t(1) << (LEVEL_BITS * (level + 1)))) level++;
+        const uint32_t bucket = level * SLOTS + slotOf(current_tick + delta, level);
+        node.bucket = bucket;
+        node.prev = NONE;
+        node.next = heads[bucket];
+        if (node.next != NONE) nodes[node.next].prev = id;
+        heads[bucket] = id;
+    }
+
+    void unlink(uint32_t id) {
+        Node& node = nodes[id];
+        if (node.prev != NONE) nodes[node.prev].next = node.next;
+        else heads[node.bucket] = node.next;
+        if (node.next != NONE) nodes[node.next].prev = node.prev;
+        node.prev = node.next = node.bucket = NONE;
+    }
+
+    // Moves every timer in an outer slot to where it now belongs
+    void cascade(unsigned level) {
+        const uint32_t bucket = level * SLOTS + slotOf(current_tick, level);
+        uint32_t id = heads[bucket];
+        heads[bucket] = NONE;
+        while (id != NONE) {
+            const uint32_t next = nodes[id].next;
+            link(id);
+            id = next;
+        }
+    }
+
+public:
+    explicit TimerWheel(int64_t tick = 1000, int64_t start_ms = 0)
+        : tick_ms(std::max<int64_t>(1, tick)),
+          current_tick(static_cast<uint64_t>(std::max<int64_t>(0, start_ms)) / static_cast<uint64_t>(tick_ms)) {
+        heads.fill(NONE);
+    }
+
+    int64_t tickMs() const { return tick_ms; }
+    size_t pending() const { return armed_count; }
+    size_t capacity() const { return nodes.size(); }
+
+    // A new timer, not armed; `tag` is handed back when it fires
+    uint32_t create(uint64_t tag) {
+        uint32_t id = free_head;
+        if (id != NONE) {
+            free_head = nodes[id].next;
+            nodes[id] = Node();
+        } else {
+            id = static_cast<uint32_t>(nodes.size());
+            nodes.emplace_back();
+        }
+        nodes[id].tag = tag;
+        return id;
+    }
+
+    void release(uint32_t id) {
+        cancel(id);
+        nodes[id].next = free_head;
+        free_head = id;
+    }
+
+    // Arms, or moves, the timer to fire at `deadline_ms`
+    void arm(uint32_t id, int64_t deadline_ms) {
+        if (nodes[id].bucket != NONE) unlink(id);
+        else armed_count++;
+        const uint64_t deadline = deadline_ms <= 0 ? 0
+            : (static_cast<uint64_t>(deadline_ms) + static_cast<uint64_t>(tick_ms) - 1) / static_cast<uint64_t>(tick_ms);
+        nodes[id].deadline_tick = std::max(deadline, current_tick + 1);
+        link(id);
+    }
+
+    void cancel(uint32_t id) {
+        if (nodes[id].bucket == NONE) return;
+        unlink(id);
+        armed_count--;
+    }
+
+    bool armed(uint32_t id) const { return nodes[id].bucket != NONE; }
+    uint64_t tag(uint32_t id) const { return nodes[id].tag; }
+
+    // Runs every tick up to `now_ms`, calling fire(id, tag) for each timer
+    // that falls due; fire may arm or cancel any timer. Returns the number
+    // fired.
+    template <typename Fire>
+    size_t advance(int64_t now_ms, Fire&& fire) {
+        const uint64_t target = static_cast<uint64_t>(std::max<int64_t>(0, now_ms)) / static_cast<uint64_t>(tick_ms);
+        size_t fired = 0;
+        while (current_tick < target) {
+            if (armed_count == 0) {
+                current_tick = target;
+                break;
+            }
+            current_tick++;
+            // Outermost first, so timers can move down more than one wheel
+            unsigned top = 0;
+            while (top + 1 < LEVELS && slotOf(current_tick, top) == 0) top++;
+            for (unsigned level = top; level >= 1; --level) cascade(level);
+
+            uint32_t& head = heads[slotOf(current_tick, 0)];
+            while (head != NONE) {
+                const uint32_t id = head;
+                unlink(id);
+                armed_count--;
+                fired++;
+                fire(id, nodes[id].tag);
+            }
+        }
+        return fired;
+    }
+};
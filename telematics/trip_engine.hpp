@@ -0,0 +1,301 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// TRIP SEGMENTATION AND COMPRESSED ROUTE STORAGE
+// ============================================================================
+//
+// Readings are split into trips on ignition off, prolonged idling and gaps in
+// the data. Each trip's path is simplified on the fly with an opening-window
+// variant of Douglas-Peucker (a vertex is emitted as soon as some buffered
+// point would deviate from the anchor->current chord by more than the
+// tolerance) and the surviving vertices are stored as zigzag varint deltas.
+
+struct TripSample {
+    int64_t timestamp_ms = 0;
+    double latitude = 0.0;
+    double longitude = 0.0;
+    double speed_kmph = 0.0;
+    double acceleration_ms2 = 0.0;
+    double step_distance_km = 0.0; // distance from the previous sample
+    bool engine_on = true;
+};
+
+struct TripVertex {
+    int64_t timestamp_ms = 0;
+    double latitude = 0.0;
+    double longitude = 0.0;
+};
+
+enum class TripEndReason {
+    IGNITION_OFF,
+    IDLE_TIMEOUT,
+    DATA_GAP,
+    FLUSHED
+};
+
+inline std::string tripEndReasonString(TripEndReason reason) {
+    switch (reason) {
+        case TripEndReason::IGNITION_OFF: return "IGNITION_OFF";
+        case TripEndReason::IDLE_TIMEOUT: return "IDLE_TIMEOUT";
+        case TripEndReason::DATA_GAP: return "DATA_GAP";
+        case TripEndReason::FLUSHED: return "FLUSHED";
+        default: return "UNKNOWN";
+    }
+}
+
+struct TripSummary {
+    uint64_t trip_id = 0;
+    int vehicle_id = 0;
+    int64_t start_ms = 0;
+    int64_t end_ms = 0;
+    double distance_km = 0.0;
+    double max_speed_kmph = 0.0;
+    double speed_sum = 0.0;
+    double idle_seconds = 0.0;
+    int harsh_acceleration_count = 0;
+    int harsh_braking_count = 0;
+    uint32_t raw_point_count = 0;
+    uint32_t vertex_count = 0;
+    TripEndReason end_reason = TripEndReason::FLUSHED;
+    std::vector<uint8_t> encoded_path;
+
+    double durationSeconds() const { return (end_ms - start_ms) / 1000.0; }
+    double avgSpeed() const { return raw_point_count ? speed_sum / raw_point_count : 0.0; }
+    size_t storedBytes() const { return sizeof(TripSummary) + encoded_path.capacity(); }
+    size_t rawBytes() const { return raw_point_count * sizeof(TripVertex); }
+};
+
+// Zigzag varint helpers for the encoded path
+inline void writeVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+inline uint64_t readVarint(const std::vector<uint8_t>& in, size_t& pos) {
+    uint64_t value = 0;
+    int shift = 0;
+    while (pos < in.size()) {
+        uint8_t byte = in[pos++];
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) break;
+        shift += 7;
+    }
+    return value;
+}
+
+inline uint64_t zigzagEncode(int64_t v) { return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63); }
+inline int64_t zigzagDecode(uint64_t v) { return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1); }
+
+// Decodes a trip's simplified path back into vertices
+inline std::vector<TripVertex> decodeTripPath(const TripSummary& trip, double coord_scale = 1e6) {
+    std::vector<TripVertex> vertices;
+    vertices.reserve(trip.vertex_count);
+    int64_t lat_q = 0, lon_q = 0, ts = trip.start_ms;
+    size_t pos = 0;
+    for (uint32_t i = 0; i < trip.vertex_count; ++i) {
+        lat_q += zigzagDecode(readVarint(trip.encoded_path, pos));
+        lon_q += zigzagDecode(readVarint(trip.encoded_path, pos));
+        ts += zigzagDecode(readVarint(trip.encoded_path, pos));
+        vertices.push_back({ts, lat_q / coord_scale, lon_q / coord_scale});
+    }
+    return vertices;
+}
+
+struct TripConfig {
+    double tolerance_m = 5.0;              // max perpendicular deviation of the simplified path
+    double moving_speed_kmph = 2.0;        // below this the vehicle counts as idle
+    int64_t idle_timeout_ms = 5 * 60 * 1000;
+    int64_t gap_timeout_ms = 10 * 60 * 1000;
+    double harsh_threshold_ms2 = 4.0;
+    size_t max_pending_points = 256;       // bounds the per-point simplification cost
+    size_t max_trips_retained = 500;
+    double coord_scale = 1e6;              // 1e-6 degree quantisation (~0.1 m)
+};
+
+// Per-vehicle streaming trip builder
+class TripTracker {
+private:
+    TripConfig config;
+    int vehicle_id = 0;
+    uint64_t next_trip_id = 1;
+
+    bool in_trip = false;
+    TripSummary current;
+    int64_t last_ts = 0;
+    int64_t idle_since_ms = -1;
+
+    // Opening-window simplification state
+    TripVertex anchor;
+    std::vector<TripVertex> pending;
+    TripVertex last_emitted;
+    bool has_emitted = false;
+
+    std::deque<TripSummary> completed;
+
+public:
+    TripTracker() = default;
+    TripTracker(int vid, const TripConfig& cfg) : config(cfg), vehicle_id(vid) {
+        pending.reserve(config.max_pending_points);
+    }
+
+    void addSample(const TripSample& sample) {
+        if (in_trip && sample.timestamp_ms - last_ts > config.gap_timeout_ms) {
+            closeTrip(TripEndReason::DATA_GAP);
+        }
+
+        if (!sample.engine_on) {
+            if (in_trip) {
+                appendPoint(sample);
+                closeTrip(TripEndReason::IGNITION_OFF);
+            }
+            return;
+        }
+
+        bool moving = sample.speed_kmph >= config.moving_speed_kmph;
+        if (!in_trip) {
+            if (!moving) return; // idling with no open trip
+            openTrip(sample);
+            return;
+        }
+
+        appendPoint(sample);
+
+        if (moving) {
+            idle_since_ms = -1;
+        } else {
+            if (idle_since_ms < 0) idle_since_ms = sample.timestamp_ms;
+            if (sample.timestamp_ms - idle_since_ms >= config.idle_timeout_ms) {
+                closeTrip(TripEndReason::IDLE_TIMEOUT);
+            }
+        }
+    }
+
+    // Closes the open trip (e.g. on shutdown or an explicit query)
+    void flush() {
+        if (in_trip) closeTrip(TripEndReason::FLUSHED);
+    }
+
+    bool inTrip() const { return in_trip; }
+    const TripSummary& currentTrip() const { return current; }
+    const std::deque<TripSummary>& completedTrips() const { return completed; }
+
+    size_t storedBytes() const {
+        size_t bytes = 0;
+        for (const auto& trip : completed) bytes += trip.storedBytes();
+        return bytes;
+    }
+
+    size_t rawBytes() const {
+        size_t bytes = 0;
+        for (const auto& trip : completed) bytes += trip.rawBytes();
+        return bytes;
+    }
+
+private:
+    void openTrip(const TripSample& sample) {
+        in_trip = true;
+        current = TripSummary{};
+        current.trip_id = next_trip_id++;
+        current.vehicle_id = vehicle_id;
+        current.start_ms = sample.timestamp_ms;
+        current.end_ms = sample.timestamp_ms;
+        idle_since_ms = -1;
+        pending.clear();
+        has_emitted = false;
+
+        TripVertex v{sample.timestamp_ms, sample.latitude, sample.longitude};
+        emitVertex(v);
+        anchor = v;
+        accumulate(sample, false);
+    }
+
+    void appendPoint(const TripSample& sample) {
+        accumulate(sample, true);
+
+        TripVertex p{sample.timestamp_ms, sample.latitude, sample.longitude};
+        if (!pending.empty() &&
+            (pending.size() >= config.max_pending_points || exceedsTolerance(p))) {
+            anchor = pending.back();
+            emitVertex(anchor);
+            pending.clear();
+        }
+        pending.push_back(p);
+    }
+
+    void accumulate(const TripSample& sample, bool has_previous) {
+        if (has_previous) {
+            current.distance_km += sample.step_distance_km;
+            if (sample.speed_kmph < config.moving_speed_kmph) {
+                current.idle_seconds += (sample.timestamp_ms - last_ts) / 1000.0;
+            }
+        }
+        current.end_ms = std::max(current.end_ms, sample.timestamp_ms);
+        current.max_speed_kmph = std::max(current.max_speed_kmph, sample.speed_kmph);
+        current.speed_sum += sample.speed_kmph;
+        current.raw_point_count++;
+        if (sample.acceleration_ms2 > config.harsh_threshold_ms2) current.harsh_acceleration_count++;
+        if (sample.acceleration_ms2 < -config.harsh_threshold_ms2) current.harsh_braking_count++;
+        last_ts = sample.timestamp_ms;
+    }
+
+    // True if any buffered point lies further than the tolerance from the
+    // chord anchor -> candidate, measured in a local flat projection
+    bool exceedsTolerance(const TripVertex& candidate) const {
+        constexpr double METRES_PER_DEG = 111320.0;
+        double cos_lat = std::cos(anchor.latitude * M_PI / 180.0);
+        double bx = (candidate.longitude - anchor.longitude) * METRES_PER_DEG * cos_lat;
+        double by = (candidate.latitude - anchor.latitude) * METRES_PER_DEG;
+        double len2 = bx * bx + by * by;
+
+        for (const auto& point : pending) {
+            double px = (point.longitude - anchor.longitude) * METRES_PER_DEG * cos_lat;
+            double py = (point.latitude - anchor.latitude) * METRES_PER_DEG;
+            double t = len2 > 0.0 ? std::clamp((px * bx + py * by) / len2, 0.0, 1.0) : 0.0;
+            double dx = px - t * bx;
+            double dy = py - t * by;
+            if (dx * dx + dy * dy > config.tolerance_m * config.tolerance_m) return true;
+        }
+        return false;
+    }
+
+    void emitVertex(const TripVertex& v) {
+        int64_t lat_q = static_cast<int64_t>(std::llround(v.latitude * config.coord_scale));
+        int64_t lon_q = static_cast<int64_t>(std::llround(v.longitude * config.coord_scale));
+        int64_t prev_lat = 0, prev_lon = 0, prev_ts = current.start_ms;
+        if (has_emitted) {
+            prev_lat = static_cast<int64_t>(std::llround(last_emitted.latitude * config.coord_scale));
+            prev_lon = static_cast<int64_t>(std::llround(last_emitted.longitude * config.coord_scale));
+            prev_ts = last_emitted.timestamp_ms;
+        }
+        writeVarint(current.encoded_path, zigzagEncode(lat_q - prev_lat));
+        writeVarint(current.encoded_path, zigzagEncode(lon_q - prev_lon));
+        writeVarint(current.encoded_path, zigzagEncode(v.timestamp_ms - prev_ts));
+        current.vertex_count++;
+        last_emitted = v;
+        has_emitted = true;
+    }
+
+    void closeTrip(TripEndReason reason) {
+        if (!pending.empty()) {
+            emitVertex(pending.back());
+            pending.clear();
+        }
+        current.end_reason = reason;
+        current.encoded_path.shrink_to_fit();
+        completed.push_back(std::move(current));
+        if (completed.size() > config.max_trips_retained) completed.pop_front();
+        current = TripSummary{};
+        in_trip = false;
+        idle_since_ms = -1;
+    }
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+// ============================================================================
+// TYPED PER-VEHICLE METRICS
+// ============================================================================
+//
+// Accumulators kept per vehicle on the hot path. Keys are the enumerators of
+// a scoped enum that ends in COUNT; each key is a fixed index into a flat
+// array of doubles, so at<KEY>() is one load or store at a constant offset.
+// The names, wanted only for reports and exports, live in a MetricKeyTraits
+// specialisation next to the enum:
+//
+//   enum class TripMetric { IDLE_SECONDS, STOPS, COUNT };
+//   template <> struct MetricKeyTraits<TripMetric> {
+//       static constexpr std::array<const char*, 2> names = {"idle_seconds", "stops"};
+//   };
+
+template <typename Key>
+struct MetricKeyTraits;
+
+template <typename Key>
+class TypedMetrics {
+    static_assert(std::is_enum<Key>::value, "metric keys are enumerators");
+
+public:
+    static constexpr size_t COUNT = static_cast<size_t>(Key::COUNT);
+    static_assert(MetricKeyTraits<Key>::names.size() == COUNT, "one name per metric key");
+
+private:
+    std::array<double, COUNT> values{};
+
+    template <Key K>
+    static constexpr size_t index() {
+        static_assert(static_cast<size_t>(K) < COUNT, "not a metric key");
+        return static_cast<size_t>(K);
+    }
+
+public:
+    template <Key K> double& at() { return values[index<K>()]; }
+    template <Key K> double at() const { return values[index<K>()]; }
+
+    template <Key K> void add(double delta) { values[index<K>()] += delta; }
+    template <Key K> void increment() { values[index<K>()] += 1.0; }
+    template <Key K> void observeMax(double value) {
+        double& slot = values[index<K>()];
+        if (value > slot) slot = value;
+    }
+
+    // Runtime-keyed access for code that iterates or looks metrics up by name
+    double get(Key key) const { return values[static_cast<size_t>(key)]; }
+    void set(Key key, double value) { values[static_cast<size_t>(key)] = value; }
+
+    static const char* name(Key key) { return MetricKeyTraits<Key>::names[static_cast<size_t>(key)]; }
+
+    // Linear scan of the name table; for reports and queries, not per reading
+    static bool find(const char* metric_name, Key& key) {
+        for (size_t i = 0; i < COUNT; ++i) {
+            if (std::strcmp(MetricKeyTraits<Key>::names[i], metric_name) == 0) {
+                key = static_cast<Key>(i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Calls fn(const char* name, double value) in declaration order
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        for (size_t i = 0; i < COUNT; ++i) fn(MetricKeyTraits<Key>::names[i], values[i]);
+    }
+
+    void reset() { values.fill(0.0); }
+};
@@ -0,0 +1,286 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// ============================================================================
+// INCREMENTAL SLIDING-WINDOW OPERATORS
+// ============================================================================
+//
+// Time-based windows over a single channel. Every enabled operator is kept
+// up to date on insert/evict, so each reading costs O(1) amortised no matter
+// how long the window is:
+//   - sum / mean / variance from shifted running sums
+//   - min / max from monotonic deques
+//   - rate of change from the oldest and newest sample
+//   - EWMA with a time-aware decay (tau = window span)
+//
+// Detectors subscribe to (channel, span, operators) through a WindowLayout.
+// Subscriptions with the same channel and span share one window, so adding a
+// detector that needs an already-maintained quantity costs nothing extra.
+
+enum WindowOp : uint32_t {
+    WINDOW_SUM      = 1u << 0,   // also provides mean and count
+    WINDOW_MIN      = 1u << 1,
+    WINDOW_MAX      = 1u << 2,
+    WINDOW_VARIANCE = 1u << 3,
+    WINDOW_RATE     = 1u << 4,
+    WINDOW_EWMA     = 1u << 5
+};
+
+// Growable power-of-two ring used as a deque without per-element allocation
+template <typename T>
+class RingDeque {
+private:
+    std::vector<T> buffer;
+    size_t head = 0;
+    size_t count = 0;
+
+public:
+    explicit RingDeque(size_t initial_capacity = 16) {
+        size_t cap = 1;
+        while (cap < initial_capacity) cap <<= 1;
+        buffer.resize(cap);
+    }
+
+    void push_back(const T& value) {
+        if (count == buffer.size()) grow();
+        buffer[(head + count) & (buffer.size() - 1)] = value;
+        ++count;
+    }
+
+    void pop_front() { head = (head + 1) & (buffer.size() - 1); --count; }
+    void pop_back() { --count; }
+
+    T& front() { return buffer[head]; }
+    const T& front() const { return buffer[head]; }
+    T& back() { return buffer[(head + count - 1) & (buffer.size() - 1)]; }
+    const T& back() const { return buffer[(head + count - 1) & (buffer.size() - 1)]; }
+    const T& operator[](size_t i) const { return buffer[(head + i) & (buffer.size() - 1)]; }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    void clear() { head = 0; count = 0; }
+    size_t capacity() const { return buffer.size(); }
+
+private:
+    void grow() {
+        std::vector<T> next(buffer.size() * 2);
+        for (size_t i = 0; i < count; ++i) next[i] = (*this)[i];
+        buffer.swap(next);
+        head = 0;
+    }
+};
+
+class TimeWindow {
+public:
+    struct Sample {
+        int64_t timestamp_ms = 0;
+        double value = 0.0;
+        uint64_t seq = 0;
+    };
+
+private:
+    int64_t span_ms = 0;
+    uint32_t ops = 0;
+
+    RingDeque<Sample> samples;
+    RingDeque<Sample> min_queue;   // increasing values
+    RingDeque<Sample> max_queue;   // decreasing values
+
+    // Sums are kept relative to `shift` to limit cancellation in variance
+    double shift = 0.0;
+    bool has_shift = false;
+    double sum = 0.0;
+    double sum_sq = 0.0;
+
+    double ewma_value = 0.0;
+    int64_t ewma_ts = 0;
+    bool has_ewma = false;
+
+    uint64_t next_seq = 0;
+
+public:
+    TimeWindow() = default;
+    TimeWindow(int64_t span, uint32_t operators) : span_ms(span), ops(operators) {}
+
+    void add(int64_t ts_ms, double value) {
+        insert({ts_ms, value, next_seq++});
+    }
+
+    // Turns on additional operators, rebuilding their state from the
+    // samples already buffered
+    void enable(uint32_t operators) {
+        uint32_t added = operators & ~ops;
+        if (!added) return;
+
+        if (added & (WINDOW_SUM | WINDOW_VARIANCE)) {
+            sum = sum_sq = 0.0;
+            has_shift = false;
+        }
+        if (added & WINDOW_MIN) min_queue.clear();
+        if (added & WINDOW_MAX) max_queue.clear();
+
+        // Replay with only the new operators active; EWMA cannot be replayed
+        // exactly and simply starts from the next sample
+        RingDeque<Sample> replay = samples;
+        samples.clear();
+        uint32_t saved = ops | operators;
+        ops = added & ~WINDOW_EWMA;
+        for (size_t i = 0; i < replay.size(); ++i) insert(replay[i]);
+        ops = saved;
+    }
+
+    size_t count() const { return samples.size(); }
+    bool empty() const { return samples.empty(); }
+    int64_t span() const { return span_ms; }
+    uint32_t operators() const { return ops; }
+
+    // Time covered by the samples currently in the window
+    int64_t coveredMs() const {
+        return samples.size() < 2 ? 0 : samples.back().timestamp_ms - samples.front().timestamp_ms;
+    }
+
+    double latest() const { return samples.empty() ? 0.0 : samples.back().value; }
+    double sumValue() const { return sum + shift * samples.size(); }
+    double mean() const { return samples.empty() ? 0.0 : shift + sum / samples.size(); }
+
+    double variance() const {
+        size_t n = samples.size();
+        if (n < 2) return 0.0;
+        double m = sum / n;
+        return std::max(0.0, sum_sq / n - m * m);
+    }
+
+    double stddev() const { return std::sqrt(variance()); }
+    double min() const { return min_queue.empty() ? 0.0 : min_queue.front().value; }
+    double max() const { return max_queue.empty() ? 0.0 : max_queue.front().value; }
+    double range() const { return max() - min(); }
+    double ewma() const { return ewma_value; }
+
+    // Change per second between the oldest and newest sample in the window
+    double ratePerSecond() const {
+        int64_t dt = coveredMs();
+        if (dt <= 0) return 0.0;
+        return (samples.back().value - samples.front().value) * 1000.0 / dt;
+    }
+
+private:
+    void insert(const Sample& sample) {
+        const double value = sample.value;
+        samples.push_back(sample);
+
+        if (ops & (WINDOW_SUM | WINDOW_VARIANCE)) {
+            if (!has_shift) { shift = value; has_shift = true; }
+            double d = value - shift;
+            sum += d;
+            sum_sq += d * d;
+        }
+        if (ops & WINDOW_MIN) {
+            while (!min_queue.empty() && min_queue.back().value >= value) min_queue.pop_back();
+            min_queue.push_back(sample);
+        }
+        if (ops & WINDOW_MAX) {
+            while (!max_queue.empty() && max_queue.back().value <= value) max_queue.pop_back();
+            max_queue.push_back(sample);
+        }
+        if (ops & WINDOW_EWMA) {
+            if (!has_ewma) {
+                ewma_value = value;
+                has_ewma = true;
+            } else if (sample.timestamp_ms > ewma_ts) {
+                double dt = static_cast<double>(sample.timestamp_ms - ewma_ts);
+                double alpha = 1.0 - std::exp(-dt / static_cast<double>(span_ms));
+                ewma_value += alpha * (value - ewma_value);
+            }
+            ewma_ts = sample.timestamp_ms;
+        }
+
+        evict(samples.back().timestamp_ms - span_ms);
+    }
+
+    void evict(int64_t cutoff_ms) {
+        while (!samples.empty() && samples.front().timestamp_ms < cutoff_ms) {
+            const Sample& old = samples.front();
+            if (ops & (WINDOW_SUM | WINDOW_VARIANCE)) {
+                double d = old.value - shift;
+                sum -= d;
+                sum_sq -= d * d;
+            }
+            if (!min_queue.empty() && min_queue.front().seq == old.seq) min_queue.pop_front();
+            if (!max_queue.empty() && max_queue.front().seq == old.seq) max_queue.pop_front();
+            samples.pop_front();
+        }
+
+        // Re-anchor the shift when the window drains to avoid drift
+        if (samples.empty()) {
+            has_shift = false;
+            sum = sum_sq = 0.0;
+        }
+    }
+};
+
+// Shared description of the windows every vehicle maintains. Handles are
+// indices into the layout and valid for every WindowSet built from it.
+class WindowLayout {
+public:
+    struct Spec {
+        size_t channel;
+        int64_t span_ms;
+        uint32_t ops;
+    };
+
+private:
+    std::vector<Spec> specs;
+
+public:
+    size_t subscribe(size_t channel, int64_t span_ms, uint32_t ops) {
+        for (size_t i = 0; i < specs.size(); ++i) {
+            if (specs[i].channel == channel && specs[i].span_ms == span_ms) {
+                specs[i].ops |= ops;
+                return i;
+            }
+        }
+        specs.push_back({channel, span_ms, ops});
+        return specs.size() - 1;
+    }
+
+    const std::vector<Spec>& getSpecs() const { return specs; }
+    size_t size() const { return specs.size(); }
+};
+
+// Per-vehicle instantiation of a layout over N input channels
+template <size_t N>
+class WindowSet {
+private:
+    const WindowLayout* layout = nullptr;
+    std::vector<TimeWindow> windows;
+
+public:
+    WindowSet() = default;
+    explicit WindowSet(const WindowLayout& l) : layout(&l) { sync(); }
+
+    void update(int64_t ts_ms, const std::array<double, N>& values) {
+        sync();
+        const auto& specs = layout->getSpecs();
+        for (size_t i = 0; i < windows.size(); ++i) {
+            windows[i].add(ts_ms, values[specs[i].channel]);
+        }
+    }
+
+    const TimeWindow& operator[](size_t handle) const { return windows[handle]; }
+    size_t size() const { return windows.size(); }
+
+private:
+    // Picks up subscriptions made after this set was created
+    void sync() {
+        const auto& specs = layout->getSpecs();
+        for (size_t i = 0; i < windows.size(); ++i) windows[i].enable(specs[i].ops);
+        for (size_t i = windows.size(); i < specs.size(); ++i) {
+            windows.emplace_back(specs[i].span_ms, specs[i].ops);
+        }
+    }
+};
@@ -0,0 +1,98 @@
+// Alert dispatch queues with the sink stalled: EMERGENCY evicting LOW
+// alerts borrows their slots, but LOW cannot take them back, so the total
+// queued stays within the sum of the level capacities however long the
+// stall lasts.
+
+#include "telematics/alert_dispatch.hpp"
+#include "check.hpp"
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Holds every delivery until released
+class StalledAlertSink : public AlertSink {
+private:
+    std::mutex mutex;
+    std::condition_variable released_cv;
+    bool released = false;
+
+public:
+    const char* kind() const override { return "stalled"; }
+
+    bool deliver(const DispatchAlert&, std::string_view, std::string&) override {
+        std::unique_lock<std::mutex> lock(mutex);
+        released_cv.wait(lock, [&] { return released; });
+        return true;
+    }
+
+    void release() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            released = true;
+        }
+        released_cv.notify_all();
+    }
+};
+
+DispatchAlert makeAlert(int priority) {
+    DispatchAlert alert;
+    alert.priority = priority;
+    alert.vehicle_id = 1;
+    alert.type = "THRESHOLD_EXCEEDED";
+    alert.event = "OPENED";
+    return alert;
+}
+
+uint64_t totalQueued(AlertDispatcher& dispatcher) {
+    uint64_t total = 0;
+    for (int priority = 1; priority <= static_cast<int>(DISPATCH_LEVELS); ++priority) {
+        total += dispatcher.stats(priority).queued;
+    }
+    return total;
+}
+
+void testEvictLowerStaysWithinTotalCapacity() {
+    const size_t capacity = 2;
+    DispatchConfig config;
+    for (auto& level : config.levels) level.capacity = capacity;
+    const uint64_t total_capacity = capacity * DISPATCH_LEVELS;
+
+    MetricsRegistry metrics;
+    AlertDispatcher dispatcher(metrics, nullptr);
+    auto sink = std::make_unique<StalledAlertSink>();
+    StalledAlertSink& stalled = *sink;
+    std::vector<std::unique_ptr<AlertSink>> sinks;
+    sinks.push_back(std::move(sink));
+    std::string error;
+    CHECK(dispatcher.start(config, std::move(sinks), error));
+
+    uint64_t worst = 0;
+    for (int i = 0; i < 10000; ++i) {
+        dispatcher.enqueue(makeAlert(1));   // LOW, DROP_OLDEST
+        dispatcher.enqueue(makeAlert(5));   // EMERGENCY, EVICT_LOWER
+        const uint64_t queued = totalQueued(dispatcher);
+        if (queued > worst) worst = queued;
+    }
+    CHECK(worst <= total_capacity);
+    // EMERGENCY grew past its own capacity on slots LOW lent it
+    const DispatchLevelStats emergency = dispatcher.stats(5);
+    CHECK(emergency.queued > capacity);
+    CHECK(emergency.queued <= total_capacity);
+    CHECK(dispatcher.stats(1).dropped > 0);
+
+    stalled.release();
+    dispatcher.stop();
+    CHECK(totalQueued(dispatcher) == 0);
+}
+
+}  // namespace
+
+int main() {
+    testEvictLowerStaysWithinTotalCapacity();
+    return checkResult();
+}
@@ -0,0 +1,105 @@
+// Event sequences of the alert lifecycle, in particular a condition that
+// re-fires within the dedup window after its CLEARED went out.
+
+#include "telematics/alert_lifecycle.hpp"
+#include "check.hpp"
+
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Payload {
+    int severity = 0;
+};
+
+// Every event the tracker asks the caller to emit, in order
+struct EventLog {
+    AlertTracker<Payload> tracker;
+    std::vector<std::string> events;
+
+    explicit EventLog(const AlertConfig& config) : tracker(config) {}
+
+    void report(int64_t now_ms, int severity) {
+        switch (tracker.report(1, 42, now_ms, 1.0, severity, [&] { return Payload{severity}; })) {
+            case AlertDecision::OPENED: events.push_back("OPENED"); break;
+            case AlertDecision::SUMMARY: events.push_back("SUMMARY"); break;
+            case AlertDecision::REOPENED: events.push_back("REOPENED"); break;
+            case AlertDecision::NONE: break;
+        }
+    }
+
+    void sweep(int64_t now_ms) {
+        tracker.sweep(1, now_ms, [&](const AlertTracker<Payload>::Condition&) { events.push_back("CLEARED"); });
+    }
+};
+
+void testRefireWithinDedupWindowReopens() {
+    AlertConfig config;   // clear after 10 s quiet, 60 s dedup window
+    EventLog log(config);
+    log.report(0, 5);
+    log.report(1000, 5);
+    log.sweep(5000);
+    log.sweep(12000);          // quiet for 11 s: cleared
+    CHECK(!log.tracker.isOpen(1, 42));
+    log.report(40000, 5);      // re-fires 28 s after clearing
+    CHECK(log.tracker.isOpen(1, 42));
+    log.sweep(60000);
+    log.report(75000, 5);      // and again, 15 s after the second clear
+
+    const std::vector<std::string> expected = {"OPENED", "CLEARED", "REOPENED", "CLEARED", "REOPENED"};
+    CHECK(log.events == expected);
+    CHECK(log.tracker.getCounters().reopened == 2);
+    CHECK(log.tracker.getCounters().cleared == 2);
+}
+
+void testRefireAfterDedupWindowOpensNewEpisode() {
+    AlertConfig config;
+    EventLog log(config);
+    log.report(0, 5);
+    log.sweep(11000);
+    log.sweep(80000);          // dedup window over: the condition is forgotten
+    log.report(90000, 5);
+    const std::vector<std::string> expected = {"OPENED", "CLEARED", "OPENED"};
+    CHECK(log.events == expected);
+}
+
+void testRateLimitedReopenIsRetriedAsOpened() {
+    AlertConfig config;
+    config.rate_limit_burst = 1.0;
+    config.rate_limit_per_minute = 0.0;
+    EventLog log(config);
+    log.report(0, 2);          // takes the only token
+    log.sweep(11000);
+    log.report(20000, 2);      // no token: not announced, no REOPENED
+    log.report(21000, 2);
+    const std::vector<std::string> expected = {"OPENED", "CLEARED"};
+    CHECK(log.events == expected);
+    CHECK(log.tracker.isOpen(1, 42));
+
+    // When it clears again nothing went out for it, so nothing clears
+    log.sweep(40000);
+    CHECK(log.events == expected);
+}
+
+void testUnannouncedEpisodeResumesSilently() {
+    AlertConfig config;
+    config.rate_limit_burst = 0.0;
+    config.rate_limit_per_minute = 0.0;
+    EventLog log(config);
+    log.report(0, 2);          // rate limited from the start
+    log.sweep(11000);
+    log.report(20000, 2);
+    CHECK(log.events.empty());
+    CHECK(log.tracker.getCounters().deduplicated == 1);
+}
+
+}  // namespace
+
+int main() {
+    testRefireWithinDedupWindowReopens();
+    testRefireAfterDedupWindowOpensNewEpisode();
+    testRateLimitedReopenIsRetriedAsOpened();
+    testUnannouncedEpisodeResumesSilently();
+    return checkResult();
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+
+// Minimal assertions for the ctest executables: a failed CHECK prints its
+// location and the test exits non-zero once main() returns checkResult().
+
+inline int& checkFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(condition)                                                              \
+    do {                                                                              \
+        if (!(condition)) {                                                           \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition); \
+            checkFailures()++;                                                        \
+        }                                                                             \
+    } while (0)
+
+inline int checkResult() {
+    if (checkFailures() == 0) return EXIT_SUCCESS;
+    std::fprintf(stderr, "%d check(s) failed\n", checkFailures());
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,121 @@
+// The fast distance kernels against libm haversine, to the bounds stated in
+// geo_distance.hpp: the flat-earth path for nearby fixes (up to |lat| 85,
+// across the antimeridian and on both sides of the switch-over distance)
+// and the SIMD batch kernel over the whole globe, including the poles and
+// near-antipodal points.
+
+#include "telematics/geo_distance.hpp"
+#include "check.hpp"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+
+// Relative error of the flat-earth path; 1e-8 in the header
+constexpr double FAST_PATH_RELATIVE = 1e-8;
+// Absolute error of the batch kernel, away from and near the antipode
+constexpr double BATCH_ABSOLUTE_KM = 1e-6;
+constexpr double BATCH_NEAR_ANTIPODE_KM = 1e-3;
+constexpr double HALF_CIRCUMFERENCE_KM = EARTH_RADIUS_KM * 3.14159265358979323846;
+constexpr double ANTIPODE_SLACK_KM = EARTH_RADIUS_KM * ANTIPODE_SLACK_DEG * GEO_DEG_TO_RAD;
+
+bool withinRelative(double fast, double exact) {
+    return std::abs(fast - exact) <= FAST_PATH_RELATIVE * exact + 1e-12;
+}
+
+void testFastPathNearbyFixes() {
+    std::mt19937 rng(28);
+    std::uniform_real_distribution<> lat(-84.99, 84.99);
+    std::uniform_real_distribution<> lon(-180.0, 180.0);
+    std::uniform_real_distribution<> step(-FAST_PATH_MAX_DEG * 0.999, FAST_PATH_MAX_DEG * 0.999);
+    int failures = 0;
+    for (int i = 0; i < 200000; ++i) {
+        const GeoPoint a = makeGeoPoint(lat(rng), lon(rng));
+        const GeoPoint b = makeGeoPoint(a.latitude + step(rng), a.longitude + step(rng));
+        if (!withinRelative(fastDistanceKm(a, b), haversineKm(a, b))) failures++;
+    }
+    CHECK(failures == 0);
+}
+
+void testFastPathAtItsLimits() {
+    // Just inside 85 degrees, the worst latitude the fast path accepts
+    for (double base : {84.99, -84.99}) {
+        const GeoPoint a = makeGeoPoint(base, 10.0);
+        const GeoPoint b = makeGeoPoint(base - std::copysign(0.0099, base), 10.0099);
+        CHECK(withinRelative(fastDistanceKm(a, b), haversineKm(a, b)));
+    }
+    // Past 85 degrees and across the switch-over distance the result must
+    // stay continuous with haversine
+    const GeoPoint polar = makeGeoPoint(89.995, 0.0);
+    const GeoPoint polar_next = makeGeoPoint(89.999, 170.0);
+    CHECK(fastDistanceKm(polar, polar_next) == haversineKm(polar, polar_next));
+    const GeoPoint origin = makeGeoPoint(47.0, 8.0);
+    for (double delta : {FAST_PATH_MAX_DEG * 0.9999, FAST_PATH_MAX_DEG, FAST_PATH_MAX_DEG * 1.0001}) {
+        const GeoPoint b = makeGeoPoint(47.0 + delta, 8.0 + delta);
+        CHECK(withinRelative(fastDistanceKm(origin, b), haversineKm(origin, b)));
+    }
+}
+
+void testAcrossTheAntimeridian() {
+    const GeoPoint west = makeGeoPoint(-16.5, 179.998);
+    const GeoPoint east = makeGeoPoint(-16.501, -179.997);
+    const double exact = haversineKm(west, east);
+    CHECK(exact < 1.0);   // a few hundred metres, not most of the globe
+    CHECK(withinRelative(equirectangularKm(west, east), exact));
+    CHECK(withinRelative(equirectangularKm(east, west), exact));
+    CHECK(withinRelative(fastDistanceKm(west, east), exact));
+}
+
+void testBatchMatchesHaversine() {
+    std::mt19937 rng(29);
+    std::uniform_real_distribution<> lat(-90.0, 90.0);
+    std::uniform_real_distribution<> lon(-180.0, 180.0);
+    std::vector<GeoPoint> origins = {makeGeoPoint(0.0, 0.0), makeGeoPoint(89.9999, 45.0),
+                                     makeGeoPoint(-89.9999, -120.0), makeGeoPoint(10.0, 179.9999)};
+    for (int i = 0; i < 16; ++i) origins.push_back(makeGeoPoint(lat(rng), lon(rng)));
+
+    for (const GeoPoint& origin : origins) {
+        // An odd count so the scalar tail runs too
+        std::vector<double> lats, lons;
+        for (int i = 0; i < 1001; ++i) {
+            lats.push_back(lat(rng));
+            lons.push_back(lon(rng));
+        }
+        // Antipodal and near it, just outside the slack, across the
+        // antimeridian, at the poles, coincident
+        const double anti_lon = origin.longitude > 0.0 ? origin.longitude - 180.0 : origin.longitude + 180.0;
+        const double outside = std::copysign(ANTIPODE_SLACK_DEG * 1.2, origin.latitude);
+        const double specials[][2] = {{-origin.latitude, anti_lon}, {-origin.latitude + 1e-4, anti_lon - 1e-4},
+                                      {-origin.latitude + outside, anti_lon},
+                                      {origin.latitude, origin.longitude > 0.0 ? -179.9999 : 179.9999},
+                                      {90.0, 0.0}, {-90.0, 0.0}, {origin.latitude, origin.longitude}};
+        for (const auto& s : specials) {
+            lats.push_back(s[0]);
+            lons.push_back(s[1]);
+        }
+
+        std::vector<double> out(lats.size());
+        haversineBatchKm(origin, lats.data(), lons.data(), lats.size(), out.data());
+        int failures = 0;
+        for (size_t i = 0; i < lats.size(); ++i) {
+            const double exact = haversineKm(origin, makeGeoPoint(lats[i], lons[i]));
+            const bool near_antipode = HALF_CIRCUMFERENCE_KM - exact < ANTIPODE_SLACK_KM;
+            if (!(std::abs(out[i] - exact) <= (near_antipode ? BATCH_NEAR_ANTIPODE_KM : BATCH_ABSOLUTE_KM))) {
+                failures++;
+            }
+        }
+        CHECK(failures == 0);
+    }
+}
+
+}  // namespace
+
+int main() {
+    testFastPathNearbyFixes();
+    testFastPathAtItsLimits();
+    testAcrossTheAntimeridian();
+    testBatchMatchesHaversine();
+    return checkResult();
+}
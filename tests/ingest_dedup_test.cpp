@@ -0,0 +1,60 @@
+// Duplicate suppression on ingest: readings carrying a sequence number are
+// deduplicated, unsequenced ones (sequence number 0) are all accepted.
+
+#include "advanced_telematics.hpp"
+#include "check.hpp"
+
+#include <chrono>
+
+namespace {
+
+struct Fleet {
+    SimulatedClock clock;
+    AdvancedDataManager manager;
+
+    static DataManagerOptions options(const Clock* clock) {
+        DataManagerOptions opts;
+        opts.seed = 1;
+        opts.write_logs = false;
+        opts.sample_fleet = false;
+        opts.clock = clock;
+        return opts;
+    }
+
+    Fleet() : manager(options(&clock)) { manager.registerVehicle(1, "Test Van", "TEST-001"); }
+
+    void send(uint64_t sequence_number, double speed) {
+        SensorReading reading(clock.now(), 1, speed, 2000.0, 90.0, 50.0, 20.0);
+        reading.sequence_number = sequence_number;
+        manager.processSensorReading(reading);
+        clock.advance(std::chrono::seconds(1));
+    }
+};
+
+void testUnsequencedReadingsAreAllAccepted() {
+    Fleet fleet;
+    for (int i = 0; i < 50; ++i) fleet.send(0, 40.0 + i);
+    const FleetStatus status = fleet.manager.getFleetStatus();
+    CHECK(status.ingest.accepted == 50);
+    CHECK(status.ingest.duplicates == 0);
+    CHECK(status.readings + status.buffered == 50);
+}
+
+void testSequencedRepeatsAreDropped() {
+    Fleet fleet;
+    for (uint64_t seq = 1; seq <= 20; ++seq) fleet.send(seq, 60.0);
+    fleet.send(7, 60.0);
+    fleet.send(20, 60.0);
+    fleet.send(0, 60.0);   // unsequenced, among sequenced readings
+    const FleetStatus status = fleet.manager.getFleetStatus();
+    CHECK(status.ingest.accepted == 21);
+    CHECK(status.ingest.duplicates == 2);
+}
+
+}  // namespace
+
+int main() {
+    testUnsequencedReadingsAreAllAccepted();
+    testSequencedRepeatsAreDropped();
+    return checkResult();
+}
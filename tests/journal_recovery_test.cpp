@@ -0,0 +1,171 @@
+// Journal snapshots split across frames: a fleet whose snapshot is many
+// times the frame size recovers in full, a snapshot in the original
+// single-frame layout still loads, and a damaged one is refused whole.
+
+#include "advanced_telematics.hpp"
+#include "check.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <limits>
+#include <string>
+
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Scratch journal directory, removed with everything in it
+struct TempDirectory {
+    std::string path;
+
+    TempDirectory() {
+#if !defined(_WIN32)
+        char pattern[] = "/tmp/telematics-journal-test-XXXXXX";
+        if (::mkdtemp(pattern)) path = pattern;
+#endif
+    }
+
+    ~TempDirectory() {
+#if !defined(_WIN32)
+        for (uint64_t generation : journal_detail::listJournals(path)) {
+            ::unlink(journalFilePath(path, generation).c_str());
+        }
+        ::unlink(journalSnapshotPath(path).c_str());
+        ::rmdir(path.c_str());
+#endif
+    }
+};
+
+struct Engine {
+    SimulatedClock clock;
+    AdvancedDataManager manager;
+
+    static DataManagerOptions options(const Clock* clock) {
+        DataManagerOptions opts;
+        opts.seed = 1;
+        opts.write_logs = false;
+        opts.sample_fleet = false;
+        opts.clock = clock;
+        return opts;
+    }
+
+    Engine() : manager(options(&clock)) {}
+};
+
+JournalConfig smallFrames(const std::string& directory) {
+    JournalConfig config;
+    config.directory = directory;
+    config.checkpoint_bytes = std::numeric_limits<uint64_t>::max();
+    config.snapshot_frame_bytes = 1024;
+    return config;
+}
+
+// Frames after the snapshot header; 0 if the file is unreadable or damaged
+size_t snapshotFrames(const std::string& directory) {
+    std::string file, error;
+#if !defined(_WIN32)
+    if (!journal_detail::readFile(journalSnapshotPath(directory), file, error)) return 0;
+#endif
+    size_t pos = sizeof(JOURNAL_SNAPSHOT_MAGIC) + sizeof(uint64_t);
+    size_t frames = 0;
+    uint8_t type;
+    const char* payload;
+    size_t size;
+    while (size_t frame = parseJournalFrame(file.data() + pos, file.size() - pos, type, payload, size)) {
+        pos += frame;
+        frames++;
+    }
+    return pos == file.size() ? frames : 0;
+}
+
+void testSnapshotLargerThanOneFrameRecovers() {
+    TempDirectory directory;
+    JournalRecovery recovery;
+    std::string error;
+    FleetStatus written;
+    {
+        Engine engine;
+        for (int id = 1; id <= 200; ++id) engine.manager.registerVehicle(id, "Test Van", "TEST-" + std::to_string(id));
+        CHECK(engine.manager.openJournal(smallFrames(directory.path), recovery, error));
+        // Out-of-range speed on every vehicle: an anomaly each
+        for (int id = 1; id <= 200; ++id) {
+            engine.manager.processSensorReading(SensorReading(engine.clock.now(), id, 250.0, 3000.0, 90.0));
+        }
+        engine.clock.advance(std::chrono::seconds(10));
+        for (int id = 1; id <= 200; ++id) {
+            engine.manager.processSensorReading(SensorReading(engine.clock.now(), id, 60.0, 2000.0, 90.0));
+        }
+        engine.manager.closeJournal();
+        written = engine.manager.getFleetStatus();
+    }
+    CHECK(written.anomalies >= 200);
+    CHECK(snapshotFrames(directory.path) > 20);
+
+    Engine restarted;
+    CHECK(restarted.manager.openJournal(smallFrames(directory.path), recovery, error));
+    CHECK(recovery.had_snapshot);
+    CHECK(recovery.records == 0);   // a clean shutdown leaves only the snapshot
+    const FleetStatus recovered = restarted.manager.getFleetStatus();
+    CHECK(recovered.vehicles == written.vehicles);
+    CHECK(recovered.readings == written.readings);
+    CHECK(recovered.anomalies == written.anomalies);
+}
+
+void testSingleFrameSnapshotStillLoads() {
+    TempDirectory directory;
+    std::string frame;
+    WireWriter out(frame);
+    out.put(uint64_t(42));   // readings
+    out.put(uint64_t(7));    // anomalies
+    out.put(uint32_t(0));    // profiles
+    out.put(uint64_t(0));    // anomaly records
+    std::string file(JOURNAL_SNAPSHOT_MAGIC_V1, sizeof(JOURNAL_SNAPSHOT_MAGIC_V1));
+    const uint64_t generation = 3;
+    file.append(reinterpret_cast<const char*>(&generation), sizeof(generation));
+    appendJournalFrame(file, 0, frame.data(), frame.size());
+    std::FILE* f = std::fopen(journalSnapshotPath(directory.path).c_str(), "wb");
+    CHECK(f && std::fwrite(file.data(), 1, file.size(), f) == file.size());
+    if (f) std::fclose(f);
+
+    Engine engine;
+    JournalRecovery recovery;
+    std::string error;
+    CHECK(engine.manager.openJournal(smallFrames(directory.path), recovery, error));
+    CHECK(recovery.snapshot_generation == 3);
+    CHECK(engine.manager.getFleetStatus().readings == 42);
+    CHECK(engine.manager.getFleetStatus().anomalies == 7);
+}
+
+void testDamagedSnapshotIsRefusedWhole() {
+    TempDirectory directory;
+    JournalRecovery recovery;
+    std::string error;
+    {
+        Engine engine;
+        for (int id = 1; id <= 50; ++id) engine.manager.registerVehicle(id, "Test Van", "TEST-" + std::to_string(id));
+        CHECK(engine.manager.openJournal(smallFrames(directory.path), recovery, error));
+        engine.manager.closeJournal();
+    }
+    CHECK(snapshotFrames(directory.path) > 1);
+    const std::string path = journalSnapshotPath(directory.path);
+    std::FILE* f = std::fopen(path.c_str(), "r+b");
+    CHECK(f && std::fseek(f, -5, SEEK_END) == 0 && std::fputc('!', f) != EOF);
+    if (f) std::fclose(f);
+
+    Engine engine;
+    CHECK(!engine.manager.openJournal(smallFrames(directory.path), recovery, error));
+    CHECK(error.find("corrupt snapshot") != std::string::npos);
+    CHECK(engine.manager.getFleetStatus().vehicles == 0);
+}
+
+}  // namespace
+
+int main() {
+    if (!JOURNAL_SUPPORTED) return 0;
+    testSnapshotLargerThanOneFrameRecovers();
+    testSingleFrameSnapshotStillLoads();
+    testDamagedSnapshotIsRefusedWhole();
+    return checkResult();
+}
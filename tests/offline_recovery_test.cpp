@@ -0,0 +1,69 @@
+// A vehicle that went OFFLINE comes back when its readings resume, even when
+// the engine is shedding duplicate readings and the new ones repeat the last
+// reading it sent before going silent.
+
+#include "advanced_telematics.hpp"
+#include "check.hpp"
+
+#include <chrono>
+
+namespace {
+
+struct Fleet {
+    SimulatedClock clock;
+    AdvancedDataManager manager;
+    uint64_t sequence = 0;
+
+    static DataManagerOptions options(const Clock* clock) {
+        DataManagerOptions opts;
+        opts.seed = 1;
+        opts.write_logs = false;
+        opts.sample_fleet = false;
+        opts.clock = clock;
+        opts.overload.adaptive = false;
+        opts.overload.min_mode = DegradedMode::SHED_DUPLICATES;
+        return opts;
+    }
+
+    Fleet() : manager(options(&clock)) { manager.registerVehicle(1, "Test Van", "TEST-001"); }
+
+    // One reading a second, every one in the same operating state
+    void drive(int seconds) {
+        for (int i = 0; i < seconds; ++i) {
+            SensorReading reading(clock.now(), 1, 60.0, 2000.0, 90.0, 50.0, 20.0);
+            reading.sequence_number = ++sequence;
+            manager.processSensorReading(reading);
+            clock.advance(std::chrono::seconds(1));
+        }
+    }
+};
+
+void testResumingWithIdenticalReadingsUnderOverload() {
+    Fleet fleet;
+    fleet.drive(20);
+    FleetStatus status = fleet.manager.getFleetStatus();
+    CHECK(status.shed[static_cast<size_t>(ShedWork::DUPLICATE_READINGS)] > 0);
+    CHECK(status.offline == 0);
+
+    fleet.clock.advance(std::chrono::minutes(2));
+    fleet.manager.checkHeartbeats();
+    status = fleet.manager.getFleetStatus();
+    CHECK(status.offline == 1);
+    CHECK(status.offline_events == 1);
+
+    fleet.drive(20);
+    status = fleet.manager.getFleetStatus();
+    CHECK(status.offline == 0);
+    CHECK(status.offline_events == 1);
+
+    // and it stays online while it keeps reporting
+    fleet.manager.checkHeartbeats();
+    CHECK(fleet.manager.getFleetStatus().offline == 0);
+}
+
+}  // namespace
+
+int main() {
+    testResumingWithIdenticalReadingsUnderOverload();
+    return checkResult();
+}
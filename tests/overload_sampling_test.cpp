@@ -0,0 +1,69 @@
+// Coarse analytics under overload keeps one reading in analytics_every per
+// vehicle, counted by the engine: unsequenced readings are sampled too, and
+// a device whose sequence numbers step by analytics_every is not let through
+// whole.
+
+#include "advanced_telematics.hpp"
+#include "check.hpp"
+
+#include <chrono>
+
+namespace {
+
+struct Fleet {
+    SimulatedClock clock;
+    AdvancedDataManager manager;
+
+    static DataManagerOptions options(const Clock* clock) {
+        DataManagerOptions opts;
+        opts.seed = 1;
+        opts.write_logs = false;
+        opts.sample_fleet = false;
+        opts.clock = clock;
+        opts.overload.adaptive = false;
+        opts.overload.min_mode = DegradedMode::COARSE_ANALYTICS;
+        opts.overload.analytics_every = 4;
+        return opts;
+    }
+
+    Fleet() : manager(options(&clock)) { manager.registerVehicle(1, "Test Van", "TEST-001"); }
+
+    // `count` readings a second apart, sequence numbers first, first + step, ...
+    FleetStatus drive(int count, uint64_t first, uint64_t step) {
+        for (int i = 0; i < count; ++i) {
+            SensorReading reading(clock.now(), 1, 40.0 + i % 30, 2000.0 + i, 90.0, 50.0, 20.0);
+            reading.sequence_number = first + step * static_cast<uint64_t>(i);
+            manager.processSensorReading(reading);
+            clock.advance(std::chrono::seconds(1));
+        }
+        clock.advance(std::chrono::minutes(1));
+        manager.flushReorderBuffers();
+        return manager.getFleetStatus();
+    }
+};
+
+uint64_t analyticsShed(const FleetStatus& status) {
+    return status.shed[static_cast<size_t>(ShedWork::ANALYTICS)];
+}
+
+void testUnsequencedReadingsAreSampled() {
+    Fleet fleet;
+    const FleetStatus status = fleet.drive(100, 0, 0);
+    CHECK(status.readings == 100);
+    CHECK(analyticsShed(status) == 75);
+}
+
+void testSequenceStepDoesNotSkewSampling() {
+    Fleet fleet;
+    const FleetStatus status = fleet.drive(100, 4, 4);   // every one a multiple of analytics_every
+    CHECK(status.readings == 100);
+    CHECK(analyticsShed(status) == 75);
+}
+
+}  // namespace
+
+int main() {
+    testUnsequencedReadingsAreSampled();
+    testSequenceStepDoesNotSkewSampling();
+    return checkResult();
+}
@@ -0,0 +1,109 @@
+// Fleet pattern clusters after warm-up: a new operating mode that persists is
+// learned instead of alerting forever, while scattered faults keep scoring
+// as anomalies.
+
+#include "telematics/pattern_clusters.hpp"
+#include "check.hpp"
+
+#include <random>
+#include <vector>
+
+namespace {
+
+using Features = PatternClusterDetector::Features;
+
+// speed, rpm, temperature, acceleration, fuel use around a fixed mode
+struct Mode {
+    Features mean;
+    Features spread;
+
+    Features draw(std::mt19937& rng) const {
+        Features x;
+        for (size_t f = 0; f < x.size(); ++f) x[f] = std::normal_distribution<>(mean[f], spread[f])(rng);
+        return x;
+    }
+};
+
+const Mode CITY = {{50.0, 2000.0, 90.0, 0.0, 0.010}, {5.0, 100.0, 2.0, 0.3, 0.002}};
+const Mode MOTORWAY = {{110.0, 3500.0, 96.0, 0.0, 0.025}, {5.0, 100.0, 2.0, 0.3, 0.002}};
+
+// Past SCORED_AFTER on city driving only
+uint32_t trainedGroup(PatternClusterDetector& detector, std::mt19937& rng) {
+    const uint32_t group = detector.groupFor("Test Van");
+    for (int i = 0; i < 2000; ++i) detector.observe(group, CITY.draw(rng));
+    return group;
+}
+
+void testNewModeAfterWarmUpBecomesNormal() {
+    std::mt19937 rng(7);
+    PatternClusterDetector detector;
+    const uint32_t group = trainedGroup(detector, rng);
+    CHECK(detector.score(group, CITY.draw(rng)) < detector.threshold());
+
+    // The first motorway readings are unlike anything the group has seen
+    CHECK(detector.observe(group, MOTORWAY.draw(rng)) > detector.threshold());
+
+    // Once the new mode has gathered support it scores as normal
+    for (int i = 0; i < 100; ++i) detector.observe(group, MOTORWAY.draw(rng));
+    int alerts = 0;
+    for (int i = 0; i < 200; ++i) {
+        if (detector.observe(group, MOTORWAY.draw(rng)) > detector.threshold()) alerts++;
+    }
+    CHECK(alerts <= 2);
+
+    // ... and the old mode is still normal
+    alerts = 0;
+    for (int i = 0; i < 200; ++i) {
+        if (detector.observe(group, CITY.draw(rng)) > detector.threshold()) alerts++;
+    }
+    CHECK(alerts <= 2);
+}
+
+void testScatteredFaultsStayAnomalous() {
+    std::mt19937 rng(11);
+    PatternClusterDetector detector;
+    const uint32_t group = trainedGroup(detector, rng);
+
+    // High rpm at walking pace with a hot engine, never twice in one place
+    std::uniform_real_distribution<> unit(0.0, 1.0);
+    int alerts = 0;
+    for (int fault = 0; fault < 60; ++fault) {
+        for (int i = 0; i < 20; ++i) detector.observe(group, CITY.draw(rng));
+        const Features x = {10.0 * unit(rng), 5000.0 + 3000.0 * unit(rng), 110.0 + 20.0 * unit(rng),
+                            4.0 * unit(rng) - 2.0, 0.05 * unit(rng)};
+        if (detector.observe(group, x) > detector.threshold()) alerts++;
+    }
+    CHECK(alerts == 60);
+}
+
+void testBatchScoresMatchSingleScores() {
+    std::mt19937 rng(3);
+    PatternClusterDetector detector;
+    const uint32_t group = trainedGroup(detector, rng);
+    for (int i = 0; i < 100; ++i) detector.observe(group, MOTORWAY.draw(rng));
+
+    constexpr size_t n = 37;
+    std::vector<double> columns[PatternClusterDetector::FEATURES];
+    std::vector<Features> readings;
+    for (size_t i = 0; i < n; ++i) {
+        readings.push_back(i % 3 ? CITY.draw(rng) : MOTORWAY.draw(rng));
+        for (size_t f = 0; f < PatternClusterDetector::FEATURES; ++f) columns[f].push_back(readings.back()[f]);
+    }
+    std::array<const double*, PatternClusterDetector::FEATURES> column_ptrs;
+    for (size_t f = 0; f < column_ptrs.size(); ++f) column_ptrs[f] = columns[f].data();
+    std::vector<double> scores(n);
+    detector.scoreBatch(group, column_ptrs, n, scores.data());
+    for (size_t i = 0; i < n; ++i) {
+        const double single = detector.score(group, readings[i]);
+        CHECK(std::abs(scores[i] - single) <= 1e-9 * (1.0 + single));
+    }
+}
+
+}  // namespace
+
+int main() {
+    testNewModeAfterWarmUpBecomesNormal();
+    testScatteredFaultsStayAnomalous();
+    testBatchScoresMatchSingleScores();
+    return checkResult();
+}